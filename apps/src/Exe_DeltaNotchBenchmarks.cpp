@@ -0,0 +1,168 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+#include "ExecutableSupport.hpp"
+#include "Exception.hpp"
+#include "PetscTools.hpp"
+
+#include "DeltaNotchBenchmarks.hpp"
+
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <boost/program_options/parsers.hpp>
+
+namespace po = boost::program_options;
+
+/*
+ * Runs the timing benchmarks in DeltaNotchBenchmarks. Usage:
+ *
+ *   Exe_DeltaNotchBenchmarks --benchmark fused --mesh-width 20 --mesh-height 20 --steps 500
+ */
+int main(int argc, char *argv[])
+{
+    ExecutableSupport::StandardStartup(&argc, &argv);
+
+    int exit_code = ExecutableSupport::EXIT_OK;
+
+    try
+    {
+        po::options_description desc("Allowed options");
+        desc.add_options()
+            ("help", "print this help message")
+            ("benchmark", po::value<std::string>()->default_value("fused"), "benchmark to run: fused, lookup, writers, vtk, adaptive, intervals, replicas, startup, memory, force, index, events, policy, lazy")
+            ("mesh-width", po::value<unsigned>()->default_value(20), "number of elements across the vertex mesh")
+            ("mesh-height", po::value<unsigned>()->default_value(20), "number of elements up the vertex mesh")
+            ("steps", po::value<unsigned>()->default_value(500), "number of time steps, lookup sweeps, output frames or force computations to time")
+            ("end-time", po::value<double>()->default_value(30.0), "simulation end time for the adaptive, intervals, replicas and events benchmarks")
+            ("ode-subcycles", po::value<unsigned>()->default_value(0), "Delta/Notch ODE sub-cycles per time step for the intervals benchmark")
+            ("replicas", po::value<unsigned>()->default_value(20), "number of replicas for the replicas benchmark, or runs with and without the log for the events benchmark")
+            ("workers", po::value<unsigned>()->default_value(1), "number of worker processes for the replicas benchmark")
+            ("tutorial-exe", po::value<std::string>()->default_value(""), "path to Exe_DeltaNotchTutorial, to time one process per replica")
+            ("max-elements", po::value<unsigned>()->default_value(1000000), "largest mesh for the startup benchmark")
+            ("mesh-cache-dir", po::value<std::string>()->default_value(""), "directory in which the startup benchmark caches meshes")
+            ("cells", po::value<unsigned>()->default_value(100000), "number of cells for the memory and index benchmarks");
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+        }
+        else
+        {
+            std::string benchmark = vm["benchmark"].as<std::string>();
+            unsigned width = vm["mesh-width"].as<unsigned>();
+            unsigned height = vm["mesh-height"].as<unsigned>();
+            unsigned steps = vm["steps"].as<unsigned>();
+
+            DeltaNotchBenchmarks benchmarks;
+            if (benchmark == "fused")
+            {
+                benchmarks.CompareFusedModifier(width, height, steps);
+            }
+            else if (benchmark == "lookup")
+            {
+                benchmarks.ComparePhenotypeLookup(width, height, steps);
+            }
+            else if (benchmark == "writers")
+            {
+                benchmarks.CompareQuantisedWriters(width, height, steps);
+            }
+            else if (benchmark == "vtk")
+            {
+                benchmarks.CompareVtkOutput(width, height, steps);
+            }
+            else if (benchmark == "adaptive")
+            {
+                benchmarks.CompareAdaptiveTimeStep(width, height, vm["end-time"].as<double>());
+            }
+            else if (benchmark == "intervals")
+            {
+                benchmarks.CompareUpdateIntervals(width, height, vm["end-time"].as<double>(), vm["ode-subcycles"].as<unsigned>());
+            }
+            else if (benchmark == "replicas")
+            {
+                benchmarks.CompareReplicaEngine(width, height, vm["end-time"].as<double>(), vm["replicas"].as<unsigned>(),
+                                                vm["workers"].as<unsigned>(), vm["tutorial-exe"].as<std::string>());
+            }
+            else if (benchmark == "startup")
+            {
+                benchmarks.CompareStartup(vm["max-elements"].as<unsigned>(), vm["mesh-cache-dir"].as<std::string>());
+            }
+            else if (benchmark == "memory")
+            {
+                benchmarks.CompareMemory(vm["cells"].as<unsigned>());
+            }
+            else if (benchmark == "force")
+            {
+                benchmarks.CompareNagaiHondaForce(width, height, steps);
+            }
+            else if (benchmark == "index")
+            {
+                benchmarks.CompareOutputIndex(vm["cells"].as<unsigned>(), steps);
+            }
+            else if (benchmark == "events")
+            {
+                benchmarks.CompareEventLog(width, height, vm["end-time"].as<double>(), vm["replicas"].as<unsigned>());
+            }
+            else if (benchmark == "policy")
+            {
+                benchmarks.ComparePhenotypePolicy(width, height, steps);
+            }
+            else if (benchmark == "lazy")
+            {
+                benchmarks.CompareLazyTargetAreas(width, height, steps);
+            }
+            else
+            {
+                EXCEPTION("Unknown benchmark: " + benchmark);
+            }
+        }
+    }
+    catch (const Exception &e)
+    {
+        ExecutableSupport::PrintError(e.GetMessage());
+        exit_code = ExecutableSupport::EXIT_ERROR;
+    }
+    catch (const po::error &e)
+    {
+        ExecutableSupport::PrintError(e.what());
+        exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
+    }
+
+    ExecutableSupport::FinalizePetsc();
+    return exit_code;
+}
@@ -0,0 +1,110 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+#include "ExecutableSupport.hpp"
+#include "Exception.hpp"
+#include "PetscTools.hpp"
+#include "Timer.hpp"
+
+#include "DeltaNotchEnsembleRunner.hpp"
+
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <boost/program_options/parsers.hpp>
+
+namespace po = boost::program_options;
+
+/*
+ * Runs an ensemble of Delta/Notch simulations described by a sweep file, spread over all
+ * MPI processes; see DeltaNotchEnsembleRunner. Process 0 hands out the replicas, so this runs
+ * four at a time:
+ *
+ *   mpirun -np 5 Exe_DeltaNotchEnsemble --sweep sweep.txt --repeats 10 --output-dir DeltaNotchEnsemble
+ */
+int main(int argc, char *argv[])
+{
+    ExecutableSupport::StandardStartup(&argc, &argv);
+
+    int exit_code = ExecutableSupport::EXIT_OK;
+
+    try
+    {
+        po::options_description desc("Allowed options");
+        desc.add_options()
+            ("help", "print this help message")
+            ("sweep", po::value<std::string>(), "sweep file: one line of simulation options per parameter set")
+            ("repeats", po::value<unsigned>()->default_value(1), "number of replicas, with consecutive seeds, per parameter set")
+            ("output-dir", po::value<std::string>()->default_value("DeltaNotchEnsemble"), "output directory");
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        if (vm.count("help") || !vm.count("sweep"))
+        {
+            if (PetscTools::AmMaster())
+            {
+                std::cout << desc << std::endl;
+            }
+        }
+        else
+        {
+            DeltaNotchEnsembleRunner runner(vm["output-dir"].as<std::string>());
+            runner.ReadSweepFile(vm["sweep"].as<std::string>(), vm["repeats"].as<unsigned>());
+
+            double start_time = Timer::GetWallTime();
+            runner.Run();
+            runner.WriteSummary();
+
+            if (PetscTools::AmMaster())
+            {
+                std::cout << "Ran " << runner.GetNumReplicas() << " replicas on " << PetscTools::GetNumProcs()
+                          << " processes in " << Timer::GetWallTime() - start_time << " s" << std::endl;
+            }
+        }
+    }
+    catch (const Exception &e)
+    {
+        ExecutableSupport::PrintError(e.GetMessage());
+        exit_code = ExecutableSupport::EXIT_ERROR;
+    }
+    catch (const po::error &e)
+    {
+        ExecutableSupport::PrintError(e.what());
+        exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
+    }
+
+    ExecutableSupport::FinalizePetsc();
+    return exit_code;
+}
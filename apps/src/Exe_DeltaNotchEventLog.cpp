@@ -0,0 +1,261 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+#include <cfloat>
+#include <iostream>
+
+#include "ExecutableSupport.hpp"
+#include "Exception.hpp"
+
+#include "DeltaNotchEventLog.hpp"
+
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <boost/program_options/parsers.hpp>
+
+namespace po = boost::program_options;
+
+/** Names of the Delta phenotypes, indexed by DeltaPhenotype. */
+static const char* PHENOTYPE_NAMES[3] = {"transient", "low", "high"};
+
+/** Names of the proliferative type codes, indexed by DeltaNotchEventLog::ProliferativeTypeCode. */
+static const char* PROLIFERATIVE_TYPE_NAMES[4] = {"differentiated", "stem", "transit", "other"};
+
+/**
+ * @return the name of a phenotype stored in an event
+ *
+ * @param phenotype the phenotype
+ */
+static std::string PhenotypeName(unsigned phenotype)
+{
+    return phenotype < 3 ? PHENOTYPE_NAMES[phenotype] : "none";
+}
+
+/**
+ * Print an event on one line.
+ *
+ * @param rEvent the event
+ */
+static void PrintEvent(const DeltaNotchEvent& rEvent)
+{
+    std::cout << rEvent.mTime << " ";
+    switch (rEvent.mType)
+    {
+        case EVENT_DIVISION:
+            std::cout << "division cell " << rEvent.mCellId << " parent " << rEvent.mRelatedCellId
+                      << " parent-phenotype " << PhenotypeName(rEvent.mPhenotype)
+                      << " daughter-type " << PROLIFERATIVE_TYPE_NAMES[rEvent.mProliferativeType];
+            break;
+        case EVENT_DEATH:
+            std::cout << "death cell " << rEvent.mCellId << " phenotype " << PhenotypeName(rEvent.mPhenotype)
+                      << " type " << PROLIFERATIVE_TYPE_NAMES[rEvent.mProliferativeType];
+            break;
+        default:
+            std::cout << "transition cell " << rEvent.mCellId << " " << PhenotypeName(rEvent.mPreviousPhenotype)
+                      << " -> " << PhenotypeName(rEvent.mPhenotype)
+                      << " type " << PROLIFERATIVE_TYPE_NAMES[rEvent.mProliferativeType];
+            break;
+    }
+    std::cout << "\n";
+}
+
+/*
+ * Queries a DeltaNotchEventLog written with --event-log. Usage:
+ *
+ *   Exe_DeltaNotchEventLog --file events.bin
+ *   Exe_DeltaNotchEventLog --file events.bin --cell 42
+ *   Exe_DeltaNotchEventLog --file events.bin --type division --from 10 --to 20
+ *
+ * With no query, prints the number of events of each kind, the divisions broken down by the
+ * parent's phenotype and the daughter's proliferative type, and the phenotype transitions
+ * broken down by the phenotypes before and after. With --cell, prints the cell's ancestors,
+ * its own events and its descendants. With --type, prints every event of that kind.
+ */
+int main(int argc, char *argv[])
+{
+    ExecutableSupport::StandardStartup(&argc, &argv);
+
+    int exit_code = ExecutableSupport::EXIT_OK;
+
+    try
+    {
+        po::options_description desc("Allowed options");
+        desc.add_options()
+            ("help", "print this help message")
+            ("file", po::value<std::string>(), "the event log")
+            ("cell", po::value<unsigned>(), "print the lineage and events of the cell with this ID")
+            ("type", po::value<std::string>(), "print every event of this kind: division, death or transition")
+            ("from", po::value<double>()->default_value(0.0), "ignore events before this time")
+            ("to", po::value<double>()->default_value(DBL_MAX), "ignore events after this time");
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        if (vm.count("help") || !vm.count("file"))
+        {
+            std::cout << desc << std::endl;
+        }
+        else
+        {
+            std::vector<DeltaNotchEvent> events;
+            DeltaNotchEventLog::ReadEvents(vm["file"].as<std::string>(), events);
+            double from_time = vm["from"].as<double>();
+            double to_time = vm["to"].as<double>();
+
+            if (vm.count("cell"))
+            {
+                unsigned cell_id = vm["cell"].as<unsigned>();
+                std::vector<unsigned> ancestors;
+                std::vector<unsigned> descendants;
+                DeltaNotchEventLog::GetLineage(events, cell_id, ancestors, descendants);
+
+                std::cout << "# ancestors";
+                for (unsigned i=0; i<ancestors.size(); i++)
+                {
+                    std::cout << " " << ancestors[i];
+                }
+                std::cout << "\n# descendants";
+                for (unsigned i=0; i<descendants.size(); i++)
+                {
+                    std::cout << " " << descendants[i];
+                }
+                std::cout << "\n";
+                for (unsigned i=0; i<events.size(); i++)
+                {
+                    if ((events[i].mCellId == cell_id || events[i].mRelatedCellId == cell_id)
+                        && events[i].mTime >= from_time && events[i].mTime <= to_time)
+                    {
+                        PrintEvent(events[i]);
+                    }
+                }
+            }
+            if (vm.count("type"))
+            {
+                std::string type_name = vm["type"].as<std::string>();
+                unsigned type;
+                if (type_name == "division")
+                {
+                    type = EVENT_DIVISION;
+                }
+                else if (type_name == "death")
+                {
+                    type = EVENT_DEATH;
+                }
+                else if (type_name == "transition")
+                {
+                    type = EVENT_PHENOTYPE_TRANSITION;
+                }
+                else
+                {
+                    EXCEPTION("Unknown event type: " + type_name);
+                }
+                for (unsigned i=0; i<events.size(); i++)
+                {
+                    if (events[i].mType == type && events[i].mTime >= from_time && events[i].mTime <= to_time)
+                    {
+                        PrintEvent(events[i]);
+                    }
+                }
+            }
+            if (!vm.count("cell") && !vm.count("type"))
+            {
+                unsigned num_events[3] = {0, 0, 0};
+                unsigned num_divisions[3][4] = {{0}};
+                unsigned num_transitions[4][3] = {{0}};
+                for (unsigned i=0; i<events.size(); i++)
+                {
+                    const DeltaNotchEvent& r_event = events[i];
+                    if (r_event.mTime < from_time || r_event.mTime > to_time || r_event.mType > EVENT_PHENOTYPE_TRANSITION)
+                    {
+                        continue;
+                    }
+                    num_events[r_event.mType]++;
+                    if (r_event.mType == EVENT_DIVISION && r_event.mPhenotype < 3)
+                    {
+                        num_divisions[r_event.mPhenotype][r_event.mProliferativeType & 3]++;
+                    }
+                    else if (r_event.mType == EVENT_PHENOTYPE_TRANSITION && r_event.mPhenotype < 3)
+                    {
+                        // Row 3 counts the first phenotype given to each cell
+                        unsigned previous = r_event.mPreviousPhenotype < 3 ? r_event.mPreviousPhenotype : 3;
+                        num_transitions[previous][r_event.mPhenotype]++;
+                    }
+                }
+
+                std::cout << events.size() << " events: " << num_events[EVENT_DIVISION] << " divisions, "
+                          << num_events[EVENT_DEATH] << " deaths, "
+                          << num_events[EVENT_PHENOTYPE_TRANSITION] << " phenotype transitions\n";
+                std::cout << "# divisions by parent phenotype and daughter type\n";
+                for (unsigned phenotype=0; phenotype<3; phenotype++)
+                {
+                    for (unsigned type=0; type<4; type++)
+                    {
+                        if (num_divisions[phenotype][type] > 0)
+                        {
+                            std::cout << PHENOTYPE_NAMES[phenotype] << " " << PROLIFERATIVE_TYPE_NAMES[type]
+                                      << " " << num_divisions[phenotype][type] << "\n";
+                        }
+                    }
+                }
+                std::cout << "# phenotype transitions by phenotype before and after\n";
+                for (unsigned previous=0; previous<4; previous++)
+                {
+                    for (unsigned phenotype=0; phenotype<3; phenotype++)
+                    {
+                        if (num_transitions[previous][phenotype] > 0)
+                        {
+                            std::cout << PhenotypeName(previous) << " " << PHENOTYPE_NAMES[phenotype]
+                                      << " " << num_transitions[previous][phenotype] << "\n";
+                        }
+                    }
+                }
+            }
+            std::cout << std::flush;
+        }
+    }
+    catch (const Exception &e)
+    {
+        ExecutableSupport::PrintError(e.GetMessage());
+        exit_code = ExecutableSupport::EXIT_ERROR;
+    }
+    catch (const po::error &e)
+    {
+        ExecutableSupport::PrintError(e.what());
+        exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
+    }
+
+    ExecutableSupport::FinalizePetsc();
+    return exit_code;
+}
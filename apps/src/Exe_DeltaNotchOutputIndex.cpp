@@ -0,0 +1,164 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+#include <iostream>
+
+#include "ExecutableSupport.hpp"
+#include "Exception.hpp"
+
+#include "DeltaNotchOutputIndex.hpp"
+
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <boost/program_options/parsers.hpp>
+
+namespace po = boost::program_options;
+
+/*
+ * Builds and queries DeltaNotchOutputIndex indexes of output files. Usage:
+ *
+ *   Exe_DeltaNotchOutputIndex --file results.vizcellphenotype --build --ids-from results.vizcellages
+ *   Exe_DeltaNotchOutputIndex --file results.vizcellphenotype --time 12.5
+ *   Exe_DeltaNotchOutputIndex --file results.vizcellphenotype --cell 42
+ *   Exe_DeltaNotchOutputIndex --file results.vizcellages.q16 --build
+ *
+ * Files written by the quantised cell writers carry their own cell IDs, so need no --ids-from.
+ * A time slice is printed as one "cell value" line per cell (or one value per line if the index
+ * has no cell IDs), and a trajectory as one "time value" line per output time.
+ */
+int main(int argc, char *argv[])
+{
+    ExecutableSupport::StandardStartup(&argc, &argv);
+
+    int exit_code = ExecutableSupport::EXIT_OK;
+
+    try
+    {
+        po::options_description desc("Allowed options");
+        desc.add_options()
+            ("help", "print this help message")
+            ("file", po::value<std::string>(), "the output file")
+            ("index", po::value<std::string>(), "the index file (defaults to the output file with \".idx\" appended)")
+            ("build", "build the index")
+            ("ids-from", po::value<std::string>()->default_value(""), "when building, a file in the same cell order giving cell IDs, such as results.vizcellages")
+            ("dim", po::value<unsigned>()->default_value(2), "spatial dimension, used to find the default layout")
+            ("stride", po::value<unsigned>(), "values per cell, or 0 for one record per line (defaults by file name)")
+            ("id-column", po::value<int>(), "column of the cell ID in a record, or -1 for none (defaults by file name)")
+            ("value-column", po::value<unsigned>(), "column of the value in a record (defaults by file name)")
+            ("time", po::value<double>(), "print the time slice at the last output time not after this time")
+            ("cell", po::value<unsigned>(), "print the trajectory of the cell with this ID");
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        if (vm.count("help") || !vm.count("file"))
+        {
+            std::cout << desc << std::endl;
+        }
+        else
+        {
+            std::string file = vm["file"].as<std::string>();
+            std::string index_file = vm.count("index") ? vm["index"].as<std::string>() : file + ".idx";
+
+            if (vm.count("build"))
+            {
+                DeltaNotchOutputLayout layout = DeltaNotchOutputIndex::GetDefaultLayout(file, vm["dim"].as<unsigned>());
+                if (vm.count("stride"))
+                {
+                    layout.mStride = vm["stride"].as<unsigned>();
+                }
+                if (vm.count("id-column"))
+                {
+                    layout.mIdColumn = vm["id-column"].as<int>();
+                }
+                if (vm.count("value-column"))
+                {
+                    layout.mValueColumn = vm["value-column"].as<unsigned>();
+                }
+
+                std::string id_file = vm["ids-from"].as<std::string>();
+                DeltaNotchOutputIndex::Build(file, index_file, layout, id_file,
+                                             DeltaNotchOutputIndex::GetDefaultLayout(id_file, vm["dim"].as<unsigned>()));
+            }
+
+            DeltaNotchOutputIndex index(file, index_file);
+            if (vm.count("time"))
+            {
+                unsigned frame = index.FindFrame(vm["time"].as<double>());
+                std::vector<double> values;
+                std::vector<unsigned> cell_ids;
+                index.GetTimeSlice(frame, values, &cell_ids);
+                std::cout << "# time " << index.GetTime(frame) << "\n";
+                for (unsigned i=0; i<values.size(); i++)
+                {
+                    if (index.HasCellIds())
+                    {
+                        std::cout << cell_ids[i] << " ";
+                    }
+                    std::cout << values[i] << "\n";
+                }
+            }
+            if (vm.count("cell"))
+            {
+                std::vector<double> times;
+                std::vector<double> values;
+                index.GetTrajectory(vm["cell"].as<unsigned>(), times, values);
+                for (unsigned i=0; i<times.size(); i++)
+                {
+                    std::cout << times[i] << " " << values[i] << "\n";
+                }
+            }
+            if (!vm.count("time") && !vm.count("cell"))
+            {
+                std::cout << file << ": " << index.GetNumFrames() << " output times"
+                          << (index.HasCellIds() ? ", with cell IDs" : ", without cell IDs") << "\n";
+            }
+            std::cout << std::flush;
+        }
+    }
+    catch (const Exception &e)
+    {
+        ExecutableSupport::PrintError(e.GetMessage());
+        exit_code = ExecutableSupport::EXIT_ERROR;
+    }
+    catch (const po::error &e)
+    {
+        ExecutableSupport::PrintError(e.what());
+        exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
+    }
+
+    ExecutableSupport::FinalizePetsc();
+    return exit_code;
+}
@@ -37,11 +37,13 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "AbstractCellBasedTestSuite.hpp"
 
 #include "DeltaNotchTutorialSimulation.hpp"
+#include "DeltaNotchSimulationParameters.hpp"
 
 #include "Debug.hpp"
 #include "LogFile.hpp"
 #include "ExecutableSupport.hpp"
 
+#include <boost/program_options/errors.hpp>
 #include <boost/program_options/options_description.hpp>
 #include <boost/program_options/variables_map.hpp>
 #include <boost/program_options/parsers.hpp>
@@ -60,8 +62,13 @@ int main(int argc, char *argv[])
     // you clean up PETSc before quitting.
     try
     {
-        DeltaNotchTutorialSimulation sim = DeltaNotchTutorialSimulation();
-        sim.VertexBasedMonolayerWithDeltaNotch();
+        // Run-time parameters, see DeltaNotchSimulationParameters or run with --help
+        DeltaNotchSimulationParameters parameters;
+        if (parameters.ParseCommandLine(argc, argv))
+        {
+            DeltaNotchTutorialSimulation sim = DeltaNotchTutorialSimulation();
+            sim.Run(parameters);
+        }
 
         return ExecutableSupport::EXIT_OK;
     }
@@ -70,6 +77,11 @@ int main(int argc, char *argv[])
         ExecutableSupport::PrintError(e.GetMessage());
         exit_code = ExecutableSupport::EXIT_ERROR;
     }
+    catch (const boost::program_options::error &e)
+    {
+        ExecutableSupport::PrintError(e.what());
+        exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
+    }
 
     // Optional - write the machine info to file.
     ExecutableSupport::WriteMachineInfoFile("machine_info");
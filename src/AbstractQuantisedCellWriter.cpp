@@ -0,0 +1,120 @@
+
+#include "AbstractQuantisedCellWriter.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "AbstractCellPopulation.hpp"
+#include "FileFinder.hpp"
+#include "OutputFileHandler.hpp"
+#include "SimulationTime.hpp"
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+AbstractQuantisedCellWriter<ELEMENT_DIM, SPACE_DIM>::AbstractQuantisedCellWriter(const std::string& rFileName, double scale)
+    : AbstractCellWriter<ELEMENT_DIM, SPACE_DIM>(rFileName),
+      mScale(scale),
+      mFrameTime(0.0),
+      mMaxError(0.0),
+      mNumValues(0),
+      mNumSaturated(0)
+{
+    assert(scale > 0.0);
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AbstractQuantisedCellWriter<ELEMENT_DIM, SPACE_DIM>::OpenOutputFile(OutputFileHandler& rOutputFileHandler)
+{
+    AbstractCellWriter<ELEMENT_DIM, SPACE_DIM>::OpenOutputFile(rOutputFileHandler);
+    mOutputDirectory = rOutputFileHandler.GetOutputDirectoryFullPath();
+
+    this->mpOutStream->write("DNQ1", 4);
+    this->mpOutStream->write(reinterpret_cast<const char*>(&mScale), sizeof(double));
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AbstractQuantisedCellWriter<ELEMENT_DIM, SPACE_DIM>::WriteTimeStamp()
+{
+    mFrameTime = SimulationTime::Instance()->GetTime();
+    mCellIds.clear();
+    mValues.clear();
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AbstractQuantisedCellWriter<ELEMENT_DIM, SPACE_DIM>::WriteNewline()
+{
+    uint32_t num_cells = mValues.size();
+    this->mpOutStream->write(reinterpret_cast<const char*>(&mFrameTime), sizeof(double));
+    this->mpOutStream->write(reinterpret_cast<const char*>(&num_cells), sizeof(uint32_t));
+    if (num_cells > 0)
+    {
+        this->mpOutStream->write(reinterpret_cast<const char*>(mCellIds.data()), num_cells*sizeof(uint32_t));
+        this->mpOutStream->write(reinterpret_cast<const char*>(mValues.data()), num_cells*sizeof(int16_t));
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AbstractQuantisedCellWriter<ELEMENT_DIM, SPACE_DIM>::VisitCell(CellPtr pCell, AbstractCellPopulation<ELEMENT_DIM, SPACE_DIM>* pCellPopulation)
+{
+    double value = this->GetCellDataForVtkOutput(pCell, pCellPopulation);
+    double scaled_value = floor(value*mScale + 0.5);
+
+    int16_t stored_value;
+    if (scaled_value > INT16_MAX)
+    {
+        stored_value = INT16_MAX;
+        mNumSaturated++;
+    }
+    else if (scaled_value < INT16_MIN)
+    {
+        stored_value = INT16_MIN;
+        mNumSaturated++;
+    }
+    else
+    {
+        stored_value = static_cast<int16_t>(scaled_value);
+        mMaxError = std::max(mMaxError, fabs(stored_value/mScale - value));
+    }
+    mNumValues++;
+
+    mCellIds.push_back(pCell->GetCellId());
+    mValues.push_back(stored_value);
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AbstractQuantisedCellWriter<ELEMENT_DIM, SPACE_DIM>::WriteErrorReport()
+{
+    OutputFileHandler handler(FileFinder(mOutputDirectory, RelativeTo::Absolute), false);
+    out_stream p_report = handler.OpenOutputFile(this->mFileName + ".report");
+    *p_report << "scale\t" << mScale << "\n";
+    *p_report << "error_bound\t" << 0.5/mScale << "\n";
+    *p_report << "max_error\t" << mMaxError << "\n";
+    *p_report << "values\t" << mNumValues << "\n";
+    *p_report << "saturated\t" << mNumSaturated << "\n";
+    p_report->close();
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double AbstractQuantisedCellWriter<ELEMENT_DIM, SPACE_DIM>::GetScale() const
+{
+    return mScale;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double AbstractQuantisedCellWriter<ELEMENT_DIM, SPACE_DIM>::GetMaxError() const
+{
+    return mMaxError;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned long AbstractQuantisedCellWriter<ELEMENT_DIM, SPACE_DIM>::GetNumSaturated() const
+{
+    return mNumSaturated;
+}
+
+// Explicit instantiation
+template class AbstractQuantisedCellWriter<1,1>;
+template class AbstractQuantisedCellWriter<1,2>;
+template class AbstractQuantisedCellWriter<2,2>;
+template class AbstractQuantisedCellWriter<1,3>;
+template class AbstractQuantisedCellWriter<2,3>;
+template class AbstractQuantisedCellWriter<3,3>;
@@ -0,0 +1,119 @@
+
+#ifndef ABSTRACTQUANTISEDCELLWRITER_HPP_
+#define ABSTRACTQUANTISEDCELLWRITER_HPP_
+
+#include <stdint.h>
+#include <vector>
+
+#include "AbstractCellWriter.hpp"
+
+/**
+ * Abstract class for cell writers that store one reduced-precision value per cell in a packed
+ * binary file, rather than as full-precision text.
+ *
+ * Each value v given by GetCellDataForVtkOutput() is stored as the 16-bit integer round(v*scale),
+ * so values are resolved to 1/scale and the absolute error of each stored value is at most
+ * 0.5/scale, provided |v*scale| does not exceed 32767. Values outside this range are clamped,
+ * and counted as saturated.
+ *
+ * The file starts with a header of the 4 characters "DNQ1" followed by the scale as a double.
+ * Each output time is then written as one frame made up of the time (double), the number of
+ * cells n (uint32), the n cell IDs (uint32) and the n stored values (int16), in the machine's
+ * native byte order. The cells are in the order they are visited, as in the text writers.
+ * QuantisedCellDataReader reads these files back, and DeltaNotchOutputIndex can index them.
+ *
+ * WriteErrorReport() writes the error bound and the largest error actually seen, which lets us
+ * check that the chosen scale was suitable.
+ *
+ * DeltaPhenotypeVertexBasedCellPopulation leaves quantised writers out of its VTK output, since
+ * writing their values there at full precision would undo the saving.
+ */
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+class AbstractQuantisedCellWriter : public AbstractCellWriter<ELEMENT_DIM, SPACE_DIM>
+{
+private:
+
+    /** The scale by which values are multiplied before rounding. */
+    double mScale;
+
+    /** The time of the frame being written. */
+    double mFrameTime;
+
+    /** The IDs of the cells visited in the frame being written. */
+    std::vector<uint32_t> mCellIds;
+
+    /** The stored values of the cells visited in the frame being written. */
+    std::vector<int16_t> mValues;
+
+    /** The largest absolute error of any stored value that was not saturated. */
+    double mMaxError;
+
+    /** The total number of values stored. */
+    unsigned long mNumValues;
+
+    /** The number of values that were clamped to the range of int16. */
+    unsigned long mNumSaturated;
+
+    /** The full path of the output directory, recorded when the file is first opened. */
+    std::string mOutputDirectory;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rFileName the name of the file to write to
+     * @param scale the scale by which values are multiplied before rounding
+     */
+    AbstractQuantisedCellWriter(const std::string& rFileName, double scale);
+
+    /**
+     * Overridden OpenOutputFile() method, which also writes the file header.
+     *
+     * @param rOutputFileHandler handler for the directory in which to open this file
+     */
+    virtual void OpenOutputFile(OutputFileHandler& rOutputFileHandler);
+
+    /**
+     * Overridden WriteTimeStamp() method. Starts a new frame.
+     */
+    virtual void WriteTimeStamp();
+
+    /**
+     * Overridden WriteNewline() method. Writes the current frame to file.
+     */
+    virtual void WriteNewline();
+
+    /**
+     * Overridden VisitCell() method.
+     *
+     * Quantises the value returned by GetCellDataForVtkOutput() and adds it to the current frame.
+     *
+     * @param pCell a cell
+     * @param pCellPopulation a pointer to the cell population owning the cell
+     */
+    virtual void VisitCell(CellPtr pCell, AbstractCellPopulation<ELEMENT_DIM, SPACE_DIM>* pCellPopulation);
+
+    /**
+     * Write the scale, error bound, largest observed error and number of saturated values
+     * to a file with the same name as the output file plus ".report".
+     */
+    void WriteErrorReport();
+
+    /**
+     * @return #mScale
+     */
+    double GetScale() const;
+
+    /**
+     * @return #mMaxError
+     */
+    double GetMaxError() const;
+
+    /**
+     * @return #mNumSaturated
+     */
+    unsigned long GetNumSaturated() const;
+};
+
+#endif /*ABSTRACTQUANTISEDCELLWRITER_HPP_*/
@@ -0,0 +1,318 @@
+
+#include "DeltaNotchAdaptiveSimulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "AbstractOdeSrnModel.hpp"
+#include "AbstractOffLatticeCellPopulation.hpp"
+#include "DeltaPhenotypeFusedModifier.hpp"
+#include "DeltaPhenotypeVertexBasedCellPopulation.hpp"
+#include "Exception.hpp"
+#include "MultiRateModifierScheduler.hpp"
+#include "SimulationTime.hpp"
+
+template<unsigned DIM>
+DeltaNotchAdaptiveSimulation<DIM>::DeltaNotchAdaptiveSimulation(AbstractCellPopulation<DIM>& rCellPopulation,
+                                                                bool deleteCellPopulationInDestructor,
+                                                                bool initialiseCells)
+    : OffLatticeSimulation<DIM>(rCellPopulation, deleteCellPopulationInDestructor, initialiseCells),
+      mUseAdaptiveTimeStep(false),
+      mMinDt(DOUBLE_UNSET),
+      mMaxDt(DOUBLE_UNSET),
+      mMaxNodeDisplacement(0.005),
+      mMaxOdeStateChange(0.01),
+      mTransitionRateThreshold(0.01),
+      mSamplingInterval(0.0),
+      mMaxNodeSpeed(0.0),
+      mLastNumTransitions(0),
+      mpPhenotypeModifier(NULL),
+      mpVtkPopulation(NULL),
+      mNumTimeStepsTaken(0),
+      mNumTimeStepChanges(0)
+{
+}
+
+template<unsigned DIM>
+void DeltaNotchAdaptiveSimulation<DIM>::SetupSolve()
+{
+    OffLatticeSimulation<DIM>::SetupSolve();
+
+    mSamplingInterval = this->mDt*this->mSamplingTimestepMultiple;
+    mMaxNodeSpeed = 0.0;
+    mNumTimeStepsTaken = 0;
+    mNumTimeStepChanges = 0;
+
+    /*
+     * Changing the time step restarts SimulationTime's count of time steps, by which the standard
+     * VTK output is named, so only a population that adds back the steps taken before the change
+     * can be used.
+     */
+    mpVtkPopulation = dynamic_cast<DeltaPhenotypeVertexBasedCellPopulation<DIM>*>(&(this->mrCellPopulation));
+    if (mpVtkPopulation)
+    {
+        mpVtkPopulation->SetTimeStepOffset(0);
+    }
+    else if (mUseAdaptiveTimeStep)
+    {
+        EXCEPTION("Adaptive time stepping needs a DeltaPhenotypeVertexBasedCellPopulation, which names its output across changes of time step");
+    }
+
+    if (mMinDt == DOUBLE_UNSET)
+    {
+        mMinDt = this->mDt;
+    }
+    if (mMaxDt == DOUBLE_UNSET)
+    {
+        mMaxDt = mSamplingInterval;
+    }
+    if (mMinDt > mMaxDt)
+    {
+        EXCEPTION("The smallest time step must not exceed the largest time step");
+    }
+
+    // Find the modifier that counts phenotype transitions, if there is one, looking inside any scheduler
+    std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<DIM,DIM> > > modifiers = this->mSimulationModifiers;
+    for (unsigned i=0; i<this->mSimulationModifiers.size(); i++)
+    {
+        boost::shared_ptr<MultiRateModifierScheduler<DIM> > p_scheduler =
+            boost::dynamic_pointer_cast<MultiRateModifierScheduler<DIM> >(this->mSimulationModifiers[i]);
+        if (p_scheduler)
+        {
+            modifiers.insert(modifiers.end(), p_scheduler->rGetModifiers().begin(), p_scheduler->rGetModifiers().end());
+        }
+    }
+
+    mpPhenotypeModifier = NULL;
+    for (unsigned i=0; i<modifiers.size(); i++)
+    {
+        boost::shared_ptr<DeltaPhenotypeTrackingModifier<DIM> > p_tracking_modifier =
+            boost::dynamic_pointer_cast<DeltaPhenotypeTrackingModifier<DIM> >(modifiers[i]);
+        boost::shared_ptr<DeltaPhenotypeFusedModifier<DIM> > p_fused_modifier =
+            boost::dynamic_pointer_cast<DeltaPhenotypeFusedModifier<DIM> >(modifiers[i]);
+        if (p_tracking_modifier)
+        {
+            mpPhenotypeModifier = p_tracking_modifier.get();
+        }
+        else if (p_fused_modifier)
+        {
+            mpPhenotypeModifier = &(p_fused_modifier->rGetPhenotypeModifier());
+        }
+    }
+    mLastNumTransitions = mpPhenotypeModifier ? mpPhenotypeModifier->GetNumTransitions() : 0;
+}
+
+template<unsigned DIM>
+void DeltaNotchAdaptiveSimulation<DIM>::UpdateAtEndOfTimeStep()
+{
+    OffLatticeSimulation<DIM>::UpdateAtEndOfTimeStep();
+    mNumTimeStepsTaken++;
+
+    if (!mUseAdaptiveTimeStep)
+    {
+        return;
+    }
+
+    // The applied forces are only available until the next time step, so record the largest node speed now
+    AbstractOffLatticeCellPopulation<DIM>& r_population = static_cast<AbstractOffLatticeCellPopulation<DIM>&>(this->mrCellPopulation);
+    for (typename AbstractMesh<DIM,DIM>::NodeIterator node_iter = r_population.rGetMesh().GetNodeIteratorBegin();
+         node_iter != r_population.rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        double speed = norm_2(node_iter->rGetAppliedForce())/r_population.GetDampingConstant(node_iter->GetIndex());
+        mMaxNodeSpeed = std::max(mMaxNodeSpeed, speed);
+    }
+
+    /*
+     * The time step is only changed at output times, and SimulationTime's count restarts from 0
+     * when it is, so this matches the test for output times in Solve().
+     */
+    SimulationTime* p_simulation_time = SimulationTime::Instance();
+    if ((p_simulation_time->GetTimeStepsElapsed() % this->mSamplingTimestepMultiple) == 0
+        && !p_simulation_time->IsFinished())
+    {
+        AdaptTimeStep();
+        mMaxNodeSpeed = 0.0;
+    }
+}
+
+template<unsigned DIM>
+double DeltaNotchAdaptiveSimulation<DIM>::GetMaxOdeRate()
+{
+    double time = SimulationTime::Instance()->GetTime();
+    double max_rate = 0.0;
+    std::vector<double> derivatives;
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mrCellPopulation.Begin();
+         cell_iter != this->mrCellPopulation.End();
+         ++cell_iter)
+    {
+        AbstractOdeSrnModel* p_srn_model = dynamic_cast<AbstractOdeSrnModel*>(cell_iter->GetSrnModel());
+        if (p_srn_model && p_srn_model->GetOdeSystem())
+        {
+            AbstractOdeSystem* p_ode_system = p_srn_model->GetOdeSystem();
+            derivatives.resize(p_ode_system->GetNumberOfStateVariables());
+            p_ode_system->EvaluateYDerivatives(time, p_ode_system->rGetStateVariables(), derivatives);
+            for (unsigned i=0; i<derivatives.size(); i++)
+            {
+                max_rate = std::max(max_rate, fabs(derivatives[i]));
+            }
+        }
+    }
+    return max_rate;
+}
+
+template<unsigned DIM>
+void DeltaNotchAdaptiveSimulation<DIM>::AdaptTimeStep()
+{
+    SimulationTime* p_simulation_time = SimulationTime::Instance();
+
+    double new_dt = std::min(mMaxDt, 2.0*this->mDt);
+    if (mMaxNodeSpeed > 0.0)
+    {
+        new_dt = std::min(new_dt, mMaxNodeDisplacement/mMaxNodeSpeed);
+    }
+    double max_ode_rate = GetMaxOdeRate();
+    if (max_ode_rate > 0.0)
+    {
+        new_dt = std::min(new_dt, mMaxOdeStateChange/max_ode_rate);
+    }
+    if (mpPhenotypeModifier)
+    {
+        unsigned num_transitions = mpPhenotypeModifier->GetNumTransitions();
+        double num_cells = std::max(1u, this->mrCellPopulation.GetNumRealCells());
+        double transition_rate = (num_transitions - mLastNumTransitions)/(mSamplingInterval*num_cells);
+        mLastNumTransitions = num_transitions;
+        if (transition_rate > mTransitionRateThreshold)
+        {
+            new_dt = mMinDt;
+        }
+    }
+    new_dt = std::max(new_dt, mMinDt);
+
+    // Keep the output times fixed by taking a whole number of steps per output interval
+    unsigned sampling_multiple = std::max(1u, (unsigned) ceil(mSamplingInterval/new_dt - 1e-9));
+    if (sampling_multiple == this->mSamplingTimestepMultiple)
+    {
+        return;
+    }
+
+    double remaining_time = this->mEndTime - p_simulation_time->GetTime();
+    unsigned num_time_steps = (unsigned) (remaining_time*sampling_multiple/mSamplingInterval + 0.5);
+    if (num_time_steps == 0)
+    {
+        return;
+    }
+
+    this->mDt = mSamplingInterval/sampling_multiple;
+    this->mSamplingTimestepMultiple = sampling_multiple;
+    p_simulation_time->ResetEndTimeAndNumberOfTimeSteps(this->mEndTime, num_time_steps);
+    mNumTimeStepChanges++;
+
+    // The steps taken so far, since SimulationTime now counts from 0 again
+    mpVtkPopulation->SetTimeStepOffset(mNumTimeStepsTaken);
+}
+
+template<unsigned DIM>
+bool DeltaNotchAdaptiveSimulation<DIM>::GetUseAdaptiveTimeStep()
+{
+    return mUseAdaptiveTimeStep;
+}
+
+template<unsigned DIM>
+void DeltaNotchAdaptiveSimulation<DIM>::SetUseAdaptiveTimeStep(bool useAdaptiveTimeStep)
+{
+    mUseAdaptiveTimeStep = useAdaptiveTimeStep;
+}
+
+template<unsigned DIM>
+double DeltaNotchAdaptiveSimulation<DIM>::GetMinDt()
+{
+    return mMinDt;
+}
+
+template<unsigned DIM>
+void DeltaNotchAdaptiveSimulation<DIM>::SetMinDt(double minDt)
+{
+    assert(minDt > 0.0);
+    mMinDt = minDt;
+}
+
+template<unsigned DIM>
+double DeltaNotchAdaptiveSimulation<DIM>::GetMaxDt()
+{
+    return mMaxDt;
+}
+
+template<unsigned DIM>
+void DeltaNotchAdaptiveSimulation<DIM>::SetMaxDt(double maxDt)
+{
+    assert(maxDt > 0.0);
+    mMaxDt = maxDt;
+}
+
+template<unsigned DIM>
+double DeltaNotchAdaptiveSimulation<DIM>::GetMaxNodeDisplacement()
+{
+    return mMaxNodeDisplacement;
+}
+
+template<unsigned DIM>
+void DeltaNotchAdaptiveSimulation<DIM>::SetMaxNodeDisplacement(double maxNodeDisplacement)
+{
+    mMaxNodeDisplacement = maxNodeDisplacement;
+}
+
+template<unsigned DIM>
+double DeltaNotchAdaptiveSimulation<DIM>::GetMaxOdeStateChange()
+{
+    return mMaxOdeStateChange;
+}
+
+template<unsigned DIM>
+void DeltaNotchAdaptiveSimulation<DIM>::SetMaxOdeStateChange(double maxOdeStateChange)
+{
+    mMaxOdeStateChange = maxOdeStateChange;
+}
+
+template<unsigned DIM>
+double DeltaNotchAdaptiveSimulation<DIM>::GetTransitionRateThreshold()
+{
+    return mTransitionRateThreshold;
+}
+
+template<unsigned DIM>
+void DeltaNotchAdaptiveSimulation<DIM>::SetTransitionRateThreshold(double transitionRateThreshold)
+{
+    mTransitionRateThreshold = transitionRateThreshold;
+}
+
+template<unsigned DIM>
+unsigned DeltaNotchAdaptiveSimulation<DIM>::GetNumTimeStepsTaken()
+{
+    return mNumTimeStepsTaken;
+}
+
+template<unsigned DIM>
+unsigned DeltaNotchAdaptiveSimulation<DIM>::GetNumTimeStepChanges()
+{
+    return mNumTimeStepChanges;
+}
+
+template<unsigned DIM>
+void DeltaNotchAdaptiveSimulation<DIM>::OutputSimulationParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t<UseAdaptiveTimeStep>" << mUseAdaptiveTimeStep << "</UseAdaptiveTimeStep>\n";
+    *rParamsFile << "\t\t<MinDt>" << mMinDt << "</MinDt>\n";
+    *rParamsFile << "\t\t<MaxDt>" << mMaxDt << "</MaxDt>\n";
+    *rParamsFile << "\t\t<MaxNodeDisplacement>" << mMaxNodeDisplacement << "</MaxNodeDisplacement>\n";
+    *rParamsFile << "\t\t<MaxOdeStateChange>" << mMaxOdeStateChange << "</MaxOdeStateChange>\n";
+    *rParamsFile << "\t\t<TransitionRateThreshold>" << mTransitionRateThreshold << "</TransitionRateThreshold>\n";
+
+    // Call method on direct parent class
+    OffLatticeSimulation<DIM>::OutputSimulationParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class DeltaNotchAdaptiveSimulation<1>;
+template class DeltaNotchAdaptiveSimulation<2>;
+template class DeltaNotchAdaptiveSimulation<3>;
@@ -0,0 +1,213 @@
+
+#ifndef DELTANOTCHADAPTIVESIMULATION_HPP_
+#define DELTANOTCHADAPTIVESIMULATION_HPP_
+
+#include "OffLatticeSimulation.hpp"
+#include "DeltaPhenotypeTrackingModifier.hpp"
+#include "DeltaPhenotypeVertexBasedCellPopulation.hpp"
+
+/**
+ * An off-lattice simulation whose time step grows and shrinks with the activity of the tissue.
+ *
+ * If adaptive time stepping is switched on with SetUseAdaptiveTimeStep(), the time step is
+ * reconsidered at each output time. The new time step is the largest one, within the bounds
+ * #mMinDt and #mMaxDt and at most twice the current one, for which
+ *
+ *  - no node moved further than #mMaxNodeDisplacement in a single time step since the last
+ *    output time, judging by the applied forces and damping constants (e.g. from NagaiHondaForce);
+ *
+ *  - no Delta/Notch state variable changes by more than #mMaxOdeStateChange in one time step,
+ *    judging by the current right-hand sides of the cells' ODE systems, which grow with the
+ *    stiffness of the system away from its steady state;
+ *
+ *  - and, if the phenotype-transition rate reported by DeltaPhenotypeTrackingModifier (or a
+ *    DeltaPhenotypeFusedModifier, possibly inside a MultiRateModifierScheduler) over the last
+ *    output interval exceeds #mTransitionRateThreshold per cell per unit time, the time step
+ *    is #mMinDt.
+ *
+ * The time step is always the output interval (the initial time step multiplied by the sampling
+ * timestep multiple) divided by a whole number, and the sampling timestep multiple is changed to
+ * match, so results are written at the same physical times as a fixed-dt run, provided that the
+ * end time is a multiple of the output interval.
+ *
+ * A change of time step restarts SimulationTime's count of time steps. Adaptive time stepping
+ * therefore needs a DeltaPhenotypeVertexBasedCellPopulation, which is told the number of steps
+ * taken before each change and names its VTK output by the total, so that file names keep
+ * increasing across changes.
+ */
+template<unsigned DIM>
+class DeltaNotchAdaptiveSimulation : public OffLatticeSimulation<DIM>
+{
+private:
+
+    /** Whether to adapt the time step. Defaults to false. */
+    bool mUseAdaptiveTimeStep;
+
+    /** Smallest time step allowed. Defaults to the initial time step. */
+    double mMinDt;
+
+    /** Largest time step allowed. Defaults to the output interval. */
+    double mMaxDt;
+
+    /** Largest node displacement allowed in one time step. Defaults to 0.005. */
+    double mMaxNodeDisplacement;
+
+    /** Largest change of a Delta/Notch state variable allowed in one time step. Defaults to 0.01. */
+    double mMaxOdeStateChange;
+
+    /** Phenotype transitions per cell per unit time above which the smallest time step is used. Defaults to 0.01. */
+    double mTransitionRateThreshold;
+
+    /** The output interval, fixed when the simulation is set up. */
+    double mSamplingInterval;
+
+    /** Largest force divided by damping constant on any node since the last output time. */
+    double mMaxNodeSpeed;
+
+    /** Number of phenotype transitions counted at the last output time. */
+    unsigned mLastNumTransitions;
+
+    /** The phenotype modifier of the simulation, if any, used to count phenotype transitions. */
+    DeltaPhenotypeTrackingModifier<DIM>* mpPhenotypeModifier;
+
+    /** The cell population, which names its VTK output by the time steps taken since the start of the solve. */
+    DeltaPhenotypeVertexBasedCellPopulation<DIM>* mpVtkPopulation;
+
+    /** Total number of time steps taken, across changes of time step. */
+    unsigned mNumTimeStepsTaken;
+
+    /** Number of times the time step has been changed. */
+    unsigned mNumTimeStepChanges;
+
+    /**
+     * @return the largest rate of change of any state variable of any cell's ODE-based SRN model
+     */
+    double GetMaxOdeRate();
+
+    /**
+     * Choose a new time step and, if it differs from the current one, restart the
+     * simulation time with it. Called at each output time.
+     */
+    void AdaptTimeStep();
+
+public:
+
+    /**
+     * Constructor. The arguments are as for OffLatticeSimulation.
+     *
+     * @param rCellPopulation Reference to a cell population object
+     * @param deleteCellPopulationInDestructor Whether to delete the cell population on destruction to
+     *     free up memory (defaults to false)
+     * @param initialiseCells Whether to initialise cells (defaults to true, set to false when loading
+     *     from an archive)
+     */
+    DeltaNotchAdaptiveSimulation(AbstractCellPopulation<DIM>& rCellPopulation,
+                                 bool deleteCellPopulationInDestructor=false,
+                                 bool initialiseCells=true);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Fixes the output interval, fills in the default time step bounds and finds the
+     * phenotype modifier, if any.
+     */
+    virtual void SetupSolve();
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Records the largest node speed, and adapts the time step at output times.
+     */
+    virtual void UpdateAtEndOfTimeStep();
+
+    /**
+     * @return #mUseAdaptiveTimeStep
+     */
+    bool GetUseAdaptiveTimeStep();
+
+    /**
+     * Set #mUseAdaptiveTimeStep.
+     *
+     * @param useAdaptiveTimeStep the new value of #mUseAdaptiveTimeStep
+     */
+    void SetUseAdaptiveTimeStep(bool useAdaptiveTimeStep);
+
+    /**
+     * @return #mMinDt
+     */
+    double GetMinDt();
+
+    /**
+     * Set #mMinDt.
+     *
+     * @param minDt the new value of #mMinDt
+     */
+    void SetMinDt(double minDt);
+
+    /**
+     * @return #mMaxDt
+     */
+    double GetMaxDt();
+
+    /**
+     * Set #mMaxDt.
+     *
+     * @param maxDt the new value of #mMaxDt
+     */
+    void SetMaxDt(double maxDt);
+
+    /**
+     * @return #mMaxNodeDisplacement
+     */
+    double GetMaxNodeDisplacement();
+
+    /**
+     * Set #mMaxNodeDisplacement.
+     *
+     * @param maxNodeDisplacement the new value of #mMaxNodeDisplacement
+     */
+    void SetMaxNodeDisplacement(double maxNodeDisplacement);
+
+    /**
+     * @return #mMaxOdeStateChange
+     */
+    double GetMaxOdeStateChange();
+
+    /**
+     * Set #mMaxOdeStateChange.
+     *
+     * @param maxOdeStateChange the new value of #mMaxOdeStateChange
+     */
+    void SetMaxOdeStateChange(double maxOdeStateChange);
+
+    /**
+     * @return #mTransitionRateThreshold
+     */
+    double GetTransitionRateThreshold();
+
+    /**
+     * Set #mTransitionRateThreshold.
+     *
+     * @param transitionRateThreshold the new value of #mTransitionRateThreshold
+     */
+    void SetTransitionRateThreshold(double transitionRateThreshold);
+
+    /**
+     * @return #mNumTimeStepsTaken
+     */
+    unsigned GetNumTimeStepsTaken();
+
+    /**
+     * @return #mNumTimeStepChanges
+     */
+    unsigned GetNumTimeStepChanges();
+
+    /**
+     * Overridden OutputSimulationParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    virtual void OutputSimulationParameters(out_stream& rParamsFile);
+};
+
+#endif /*DELTANOTCHADAPTIVESIMULATION_HPP_*/
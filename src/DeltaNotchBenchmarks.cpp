@@ -0,0 +1,1010 @@
+
+#include "DeltaNotchBenchmarks.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <sys/resource.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "CellAgesWriter.hpp"
+#include "CellVolumesWriter.hpp"
+#include "DeltaHighPhenotypeProperty.hpp"
+#include "DeltaLowPhenotypeProperty.hpp"
+#include "DeltaNotchEventLog.hpp"
+#include "DeltaNotchMemoryReport.hpp"
+#include "DeltaNotchNagaiHondaForce.hpp"
+#include "DeltaNotchOutputIndex.hpp"
+#include "DeltaNotchPopulationBuilder.hpp"
+#include "DeltaNotchReplicaContext.hpp"
+#include "DeltaNotchReplicaEngine.hpp"
+#include "DeltaNotchSrnModel.hpp"
+#include "DeltaNotchTutorialSimulation.hpp"
+#include "DeltaNotchTrackingModifier.hpp"
+#include "DeltaPhenotypeFlags.hpp"
+#include "DeltaPhenotypeFusedModifier.hpp"
+#include "DeltaPhenotypePolicyModifier.hpp"
+#include "DeltaPhenotypeTargetAreaModifier.hpp"
+#include "DeltaPhenotypeTrackingModifier.hpp"
+#include "DeltaPhenotypeVertexBasedCellPopulation.hpp"
+#include "DeltaPhenotypeWriter.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "Exception.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "MyCellCycleModel.hpp"
+#include "NagaiHondaForce.hpp"
+#include "OutputFileHandler.hpp"
+#include "QuantisedCellAgesWriter.hpp"
+#include "QuantisedCellVolumesWriter.hpp"
+#include "QuantisedDeltaPhenotypeWriter.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "SimulationTime.hpp"
+#include "SmartPointers.hpp"
+#include "Timer.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "WildTypeCellMutationState.hpp"
+
+void DeltaNotchBenchmarks::CompareFusedModifier(unsigned meshWidth, unsigned meshHeight, unsigned numSteps)
+{
+    std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> > > three_pass;
+    three_pass.push_back(boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> >(new DeltaNotchTrackingModifier<2>));
+    three_pass.push_back(boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> >(new DeltaPhenotypeTrackingModifier<2>));
+    three_pass.push_back(boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> >(new DeltaPhenotypeTargetAreaModifier<2>));
+
+    std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> > > fused;
+    fused.push_back(boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> >(new DeltaPhenotypeFusedModifier<2>));
+
+    double three_pass_checksum = 0.0;
+    double fused_checksum = 0.0;
+    double three_pass_time = TimeModifiers(meshWidth, meshHeight, numSteps, three_pass, three_pass_checksum);
+    double fused_time = TimeModifiers(meshWidth, meshHeight, numSteps, fused, fused_checksum);
+
+    std::cout << "Fused modifier benchmark: " << meshWidth << "x" << meshHeight << " cells, " << numSteps << " steps\n";
+    std::cout << std::setprecision(6);
+    std::cout << "  three-pass  " << three_pass_time << " s/step  checksum " << std::setprecision(15) << three_pass_checksum << "\n";
+    std::cout << std::setprecision(6);
+    std::cout << "  fused       " << fused_time << " s/step  checksum " << std::setprecision(15) << fused_checksum << "\n";
+    std::cout << std::setprecision(6);
+    std::cout << "  speedup     " << three_pass_time/fused_time << "\n";
+    std::cout << "  results " << (three_pass_checksum == fused_checksum ? "match" : "DIFFER") << std::endl;
+}
+
+void DeltaNotchBenchmarks::ComparePhenotypeLookup(unsigned meshWidth, unsigned meshHeight, unsigned numRepeats)
+{
+    DeltaNotchReplicaContext context(1);
+    SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 1);
+
+    HoneycombVertexMeshGenerator generator(meshWidth, meshHeight);
+    MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+
+    std::vector<CellPtr> cells;
+    CreateCells(p_mesh, cells);
+    VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+    // Label the cells, so that both lookups have something to find
+    DeltaNotchTrackingModifier<2> delta_notch_modifier;
+    delta_notch_modifier.SetupSolve(cell_population, "");
+    DeltaPhenotypeTrackingModifier<2> phenotype_modifier;
+    phenotype_modifier.SetupSolve(cell_population, "");
+
+    unsigned property_sum = 0;
+    double start_time = Timer::GetWallTime();
+    for (unsigned repeat=0; repeat<numRepeats; repeat++)
+    {
+        for (AbstractCellPopulation<2>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            if (cell_iter->HasCellProperty<DeltaLowPhenotypeProperty>())
+            {
+                property_sum += DELTA_LOW;
+            }
+            else if (cell_iter->HasCellProperty<DeltaHighPhenotypeProperty>())
+            {
+                property_sum += DELTA_HIGH;
+            }
+        }
+    }
+    double property_time = Timer::GetWallTime() - start_time;
+
+    unsigned flags_sum = 0;
+    start_time = Timer::GetWallTime();
+    for (unsigned repeat=0; repeat<numRepeats; repeat++)
+    {
+        for (AbstractCellPopulation<2>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            flags_sum += DeltaPhenotypeFlags::GetPhenotype(*cell_iter);
+        }
+    }
+    double flags_time = Timer::GetWallTime() - start_time;
+
+    double num_lookups = numRepeats*cell_population.GetNumRealCells();
+    std::cout << "Phenotype lookup benchmark: " << cell_population.GetNumRealCells() << " cells, " << numRepeats << " sweeps\n";
+    std::cout << "  properties  " << 1e9*property_time/num_lookups << " ns/cell\n";
+    std::cout << "  flags       " << 1e9*flags_time/num_lookups << " ns/cell\n";
+    std::cout << "  speedup     " << property_time/flags_time << "\n";
+    std::cout << "  results " << (property_sum == flags_sum ? "match" : "DIFFER") << std::endl;
+}
+
+void DeltaNotchBenchmarks::CompareQuantisedWriters(unsigned meshWidth, unsigned meshHeight, unsigned numFrames)
+{
+    DeltaNotchReplicaContext context(1);
+    SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(2*numFrames*0.002, 2*numFrames);
+
+    HoneycombVertexMeshGenerator generator(meshWidth, meshHeight);
+    MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+
+    std::vector<CellPtr> cells;
+    CreateCells(p_mesh, cells);
+    VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+    DeltaNotchTrackingModifier<2> delta_notch_modifier;
+    delta_notch_modifier.SetupSolve(cell_population, "");
+    DeltaPhenotypeTrackingModifier<2> phenotype_modifier;
+    phenotype_modifier.SetupSolve(cell_population, "");
+
+    std::vector<boost::shared_ptr<AbstractCellWriter<2,2> > > text_writers;
+    text_writers.push_back(boost::shared_ptr<AbstractCellWriter<2,2> >(new CellAgesWriter<2,2>));
+    text_writers.push_back(boost::shared_ptr<AbstractCellWriter<2,2> >(new CellVolumesWriter<2,2>));
+    text_writers.push_back(boost::shared_ptr<AbstractCellWriter<2,2> >(new DeltaPhenotypeWriter<2,2>));
+
+    boost::shared_ptr<AbstractQuantisedCellWriter<2,2> > p_ages_writer(new QuantisedCellAgesWriter<2,2>);
+    boost::shared_ptr<AbstractQuantisedCellWriter<2,2> > p_volumes_writer(new QuantisedCellVolumesWriter<2,2>);
+    boost::shared_ptr<AbstractQuantisedCellWriter<2,2> > p_phenotype_writer(new QuantisedDeltaPhenotypeWriter<2,2>);
+    std::vector<boost::shared_ptr<AbstractCellWriter<2,2> > > quantised_writers;
+    quantised_writers.push_back(p_ages_writer);
+    quantised_writers.push_back(p_volumes_writer);
+    quantised_writers.push_back(p_phenotype_writer);
+
+    unsigned long text_bytes = 0;
+    unsigned long quantised_bytes = 0;
+    double text_time = TimeWriters(text_writers, cell_population, "DeltaNotchBenchmarks/TextWriters", numFrames, text_bytes);
+    double quantised_time = TimeWriters(quantised_writers, cell_population, "DeltaNotchBenchmarks/QuantisedWriters", numFrames, quantised_bytes);
+
+    std::cout << "Quantised writer benchmark: " << cell_population.GetNumRealCells() << " cells, " << numFrames << " frames\n";
+    std::cout << "  text       " << text_bytes << " bytes  " << text_time << " s/frame\n";
+    std::cout << "  quantised  " << quantised_bytes << " bytes  " << quantised_time << " s/frame\n";
+    std::cout << "  size ratio " << (double)text_bytes/quantised_bytes << "  time ratio " << text_time/quantised_time << "\n";
+    std::cout << "  max error (bound): ages " << p_ages_writer->GetMaxError() << " (" << 0.5/p_ages_writer->GetScale() << ")"
+              << ", volumes " << p_volumes_writer->GetMaxError() << " (" << 0.5/p_volumes_writer->GetScale() << ")"
+              << ", phenotype " << p_phenotype_writer->GetMaxError() << " (" << 0.5/p_phenotype_writer->GetScale() << ")\n";
+    std::cout << "  saturated values: " << p_ages_writer->GetNumSaturated() + p_volumes_writer->GetNumSaturated()
+                 + p_phenotype_writer->GetNumSaturated() << std::endl;
+}
+
+void DeltaNotchBenchmarks::CompareVtkOutput(unsigned meshWidth, unsigned meshHeight, unsigned numFrames)
+{
+    std::cout << "VTK output benchmark: " << meshWidth << "x" << meshHeight << " cells, " << numFrames << " frames\n";
+    for (unsigned move_nodes=0; move_nodes<2; move_nodes++)
+    {
+        std::string mesh_name = move_nodes ? "moving" : "static";
+        unsigned long standard_bytes = 0;
+        unsigned long compressed_bytes = 0;
+        double standard_time = TimeVtkOutput(meshWidth, meshHeight, false, move_nodes, "DeltaNotchBenchmarks/StandardVtk", numFrames, standard_bytes);
+        double compressed_time = TimeVtkOutput(meshWidth, meshHeight, true, move_nodes, "DeltaNotchBenchmarks/CompressedVtk", numFrames, compressed_bytes);
+
+        std::cout << "  " << mesh_name << " mesh\n";
+        std::cout << "    standard    " << standard_bytes << " bytes  " << standard_time << " s/frame\n";
+        std::cout << "    compressed  " << compressed_bytes << " bytes  " << compressed_time << " s/frame\n";
+        std::cout << "    size ratio " << (double)standard_bytes/compressed_bytes << "  time ratio " << standard_time/compressed_time << "\n";
+    }
+    std::cout << std::flush;
+}
+
+void DeltaNotchBenchmarks::CompareAdaptiveTimeStep(unsigned meshWidth, unsigned meshHeight, double endTime)
+{
+    DeltaNotchSimulationParameters parameters;
+    parameters.mMeshWidth = meshWidth;
+    parameters.mMeshHeight = meshHeight;
+    parameters.mEndTime = endTime;
+    parameters.mWriters.clear();
+
+    DeltaNotchTutorialSimulation simulation;
+    parameters.mOutputDirectory = "DeltaNotchBenchmarks/FixedDt";
+    DeltaNotchSimulationSummary fixed = simulation.Run(parameters);
+
+    parameters.mUseAdaptiveTimeStep = true;
+    parameters.mOutputDirectory = "DeltaNotchBenchmarks/AdaptiveDt";
+    DeltaNotchSimulationSummary adaptive = simulation.Run(parameters);
+
+    std::cout << "Adaptive time step benchmark: " << meshWidth << "x" << meshHeight << " cells, end time " << endTime << "\n";
+    std::cout << "            wall time (s)  steps  cells  high  low  transient\n";
+    std::cout << "  fixed     " << std::setw(13) << fixed.mWallTime << "  " << fixed.mNumTimeSteps << "  " << fixed.mNumCells
+              << "  " << fixed.mNumDeltaHigh << "  " << fixed.mNumDeltaLow << "  " << fixed.mNumTransient << "\n";
+    std::cout << "  adaptive  " << std::setw(13) << adaptive.mWallTime << "  " << adaptive.mNumTimeSteps << "  " << adaptive.mNumCells
+              << "  " << adaptive.mNumDeltaHigh << "  " << adaptive.mNumDeltaLow << "  " << adaptive.mNumTransient << "\n";
+    std::cout << "  speedup   " << fixed.mWallTime/adaptive.mWallTime << "\n";
+    std::cout << "  Delta-high fraction: fixed " << (double)fixed.mNumDeltaHigh/fixed.mNumCells
+              << ", adaptive " << (double)adaptive.mNumDeltaHigh/adaptive.mNumCells << std::endl;
+}
+
+void DeltaNotchBenchmarks::CompareUpdateIntervals(unsigned meshWidth, unsigned meshHeight, double endTime, unsigned numOdeSubcycles)
+{
+    DeltaNotchSimulationParameters parameters;
+    parameters.mMeshWidth = meshWidth;
+    parameters.mMeshHeight = meshHeight;
+    parameters.mEndTime = endTime;
+    parameters.mNumOdeSubcycles = numOdeSubcycles;
+    parameters.mWriters.clear();
+
+    std::cout << "Update interval benchmark: " << meshWidth << "x" << meshHeight << " cells, end time " << endTime
+              << ", " << numOdeSubcycles << " ODE sub-cycles\n";
+    std::cout << "  interval  wall time (s)  steps/s  cells  high  low  transient  high fraction change\n";
+
+    const unsigned intervals[] = {1, 2, 5, 10, 20};
+    double reference_high_fraction = 0.0;
+    DeltaNotchTutorialSimulation simulation;
+    for (unsigned i=0; i<sizeof(intervals)/sizeof(intervals[0]); i++)
+    {
+        std::stringstream output_directory;
+        output_directory << "DeltaNotchBenchmarks/UpdateInterval" << intervals[i];
+        parameters.mOutputDirectory = output_directory.str();
+        parameters.mPhenotypeUpdateMultiple = intervals[i];
+        parameters.mTargetAreaUpdateMultiple = intervals[i];
+
+        DeltaNotchSimulationSummary summary = simulation.Run(parameters);
+        double high_fraction = (double)summary.mNumDeltaHigh/summary.mNumCells;
+        if (i == 0)
+        {
+            reference_high_fraction = high_fraction;
+        }
+
+        std::cout << "  " << std::setw(8) << intervals[i] << "  " << std::setw(13) << summary.mWallTime
+                  << "  " << std::setw(7) << summary.mNumTimeSteps/summary.mWallTime
+                  << "  " << summary.mNumCells << "  " << summary.mNumDeltaHigh << "  " << summary.mNumDeltaLow
+                  << "  " << summary.mNumTransient << "  " << high_fraction - reference_high_fraction << "\n";
+    }
+    std::cout << std::flush;
+}
+
+void DeltaNotchBenchmarks::CompareReplicaEngine(unsigned meshWidth, unsigned meshHeight, double endTime, unsigned numReplicas,
+                                                unsigned numWorkers, const std::string& rTutorialExecutable)
+{
+    DeltaNotchSimulationParameters parameters;
+    parameters.mMeshWidth = meshWidth;
+    parameters.mMeshHeight = meshHeight;
+    parameters.mEndTime = endTime;
+    parameters.mWriters.clear();
+
+    DeltaNotchReplicaEngine engine("DeltaNotchBenchmarks/ReplicaEngine");
+    for (unsigned i=0; i<numReplicas; i++)
+    {
+        parameters.mSeed = i + 1;
+        engine.AddReplica(parameters);
+    }
+    engine.Run();
+
+    std::cout << "Replica engine benchmark: " << meshWidth << "x" << meshHeight << " cells, end time " << endTime
+              << ", " << numReplicas << " replicas\n";
+    std::cout << "  in-process        " << numReplicas/engine.GetWallTime() << " replicas/s  "
+              << engine.GetPeakMemoryIncrease() << " kB peak growth (process peak "
+              << DeltaNotchReplicaEngine::GetPeakMemory() << " kB)\n";
+
+    if (numWorkers > 1)
+    {
+        DeltaNotchReplicaEngine pool_engine("DeltaNotchBenchmarks/ReplicaWorkers");
+        pool_engine.SetNumWorkers(numWorkers);
+        for (unsigned i=0; i<numReplicas; i++)
+        {
+            parameters.mSeed = i + 1;
+            pool_engine.AddReplica(parameters);
+        }
+        pool_engine.Run();
+
+        // Each worker runs the same replica as in-process, so must reach the same state
+        unsigned num_differing = 0;
+        for (unsigned i=0; i<numReplicas; i++)
+        {
+            if (pool_engine.rGetSummaries()[i].mChecksum != engine.rGetSummaries()[i].mChecksum)
+            {
+                num_differing++;
+            }
+        }
+        std::cout << "  " << std::setw(2) << numWorkers << " workers        " << numReplicas/pool_engine.GetWallTime()
+                  << " replicas/s  " << pool_engine.GetPeakMemoryIncrease() << " kB peak growth (largest worker), speedup "
+                  << engine.GetWallTime()/pool_engine.GetWallTime() << ", results "
+                  << (num_differing == 0 ? "match" : "DIFFER") << "\n";
+    }
+
+    if (!rTutorialExecutable.empty())
+    {
+        double start_time = Timer::GetWallTime();
+        for (unsigned i=0; i<numReplicas; i++)
+        {
+            std::stringstream command;
+            command << rTutorialExecutable << " --mesh-width " << meshWidth << " --mesh-height " << meshHeight
+                    << " --end-time " << endTime << " --seed " << i + 1 << " --writers none"
+                    << " --output-dir DeltaNotchBenchmarks/ProcessPerRun/replica_" << i << " > /dev/null";
+            if (std::system(command.str().c_str()) != 0)
+            {
+                EXCEPTION("Failed to run " + command.str());
+            }
+        }
+        double process_time = Timer::GetWallTime() - start_time;
+
+        struct rusage usage;
+        getrusage(RUSAGE_CHILDREN, &usage);
+        std::cout << "  process-per-run   " << numReplicas/process_time << " replicas/s  "
+                  << usage.ru_maxrss << " kB peak per process\n";
+        std::cout << "  speedup           " << process_time/engine.GetWallTime() << "\n";
+    }
+    std::cout << std::flush;
+}
+
+void DeltaNotchBenchmarks::CompareStartup(unsigned maxNumElements, const std::string& rMeshCacheDirectory)
+{
+    std::cout << "Start-up benchmark: time to build mesh, cells and population, in seconds\n";
+    std::cout << "  elements  one-at-a-time  builder  builder (writing cache)  builder (reading cache)\n";
+
+    const unsigned sides[] = {10, 100, 316, 1000};
+    for (unsigned i=0; i<sizeof(sides)/sizeof(sides[0]) && sides[i]*sides[i]<=maxNumElements; i++)
+    {
+        unsigned side = sides[i];
+        double one_at_a_time_time;
+        {
+            DeltaNotchReplicaContext context(1);
+            double start_time = Timer::GetWallTime();
+            HoneycombVertexMeshGenerator generator(side, side);
+            MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+            std::vector<CellPtr> cells;
+            CreateCells(p_mesh, cells);
+            VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+            one_at_a_time_time = Timer::GetWallTime() - start_time;
+        }
+
+        // Time the builder without a cache, then writing the cache, then reading it
+        std::vector<double> builder_times;
+        unsigned num_builder_runs = rMeshCacheDirectory.empty() ? 1 : 3;
+        for (unsigned run=0; run<num_builder_runs; run++)
+        {
+            if (run == 1)
+            {
+                boost::filesystem::remove(rMeshCacheDirectory + "/honeycomb_" + boost::lexical_cast<std::string>(side)
+                                          + "x" + boost::lexical_cast<std::string>(side) + ".bin");
+            }
+            DeltaNotchReplicaContext context(1);
+            double start_time = Timer::GetWallTime();
+            DeltaNotchPopulationBuilder builder(run == 0 ? "" : rMeshCacheDirectory);
+            MutableVertexMesh<2,2>* p_mesh = builder.BuildHoneycombMesh(side, side);
+            std::vector<CellPtr> cells;
+            builder.CreateCells(p_mesh->GetNumElements(), cells);
+            VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+            builder_times.push_back(Timer::GetWallTime() - start_time);
+        }
+
+        std::cout << "  " << std::setw(8) << side*side << "  " << std::setw(13) << one_at_a_time_time
+                  << "  " << std::setw(7) << builder_times[0];
+        if (builder_times.size() == 3)
+        {
+            std::cout << "  " << std::setw(23) << builder_times[1] << "  " << std::setw(23) << builder_times[2];
+        }
+        std::cout << "\n";
+    }
+    std::cout << std::flush;
+}
+
+void DeltaNotchBenchmarks::CompareMemory(unsigned numCells)
+{
+    unsigned side = (unsigned) (sqrt((double)numCells) + 0.5);
+    std::cout << "Memory benchmark: " << side << "x" << side << " cells\n";
+
+    for (unsigned compact=0; compact<2; compact++)
+    {
+        DeltaNotchReplicaContext context(1);
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 1);
+        double initial_heap_bytes = DeltaNotchMemoryReport::GetHeapBytesInUse();
+
+        DeltaNotchPopulationBuilder builder;
+        MutableVertexMesh<2,2>* p_mesh = builder.BuildHoneycombMesh(side, side);
+        std::vector<CellPtr> cells;
+        builder.CreateCells(p_mesh->GetNumElements(), cells);
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        cells.clear();
+
+        std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> > > modifiers;
+        boost::shared_ptr<DeltaPhenotypeFusedModifier<2> > p_fused_modifier;
+        if (compact)
+        {
+            p_fused_modifier.reset(new DeltaPhenotypeFusedModifier<2>);
+            p_fused_modifier->SetUseCompactStorage(true);
+            p_fused_modifier->rGetPhenotypeModifier().SetUsePhenotypeProperties(false);
+            modifiers.push_back(p_fused_modifier);
+        }
+        else
+        {
+            modifiers.push_back(boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> >(new DeltaNotchTrackingModifier<2>));
+            modifiers.push_back(boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> >(new DeltaPhenotypeTrackingModifier<2>));
+            modifiers.push_back(boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> >(new DeltaPhenotypeTargetAreaModifier<2>));
+        }
+        for (unsigned i=0; i<modifiers.size(); i++)
+        {
+            modifiers[i]->SetupSolve(cell_population, "");
+        }
+
+        double heap_bytes = DeltaNotchMemoryReport::GetHeapBytesInUse() - initial_heap_bytes;
+        DeltaNotchMemoryReport report;
+        report.Account(cell_population);
+        if (p_fused_modifier)
+        {
+            report.AccountModifier(*p_fused_modifier);
+        }
+
+        std::cout << (compact ? "  compact mode\n" : "  standard mode\n");
+        report.Write(std::cout);
+        std::cout << "  measured heap growth " << heap_bytes << " bytes, " << heap_bytes/cell_population.GetNumRealCells() << " bytes/cell\n";
+    }
+    std::cout << std::flush;
+}
+
+void DeltaNotchBenchmarks::CreateCells(MutableVertexMesh<2,2>* pMesh, std::vector<CellPtr>& rCells)
+{
+    MAKE_PTR(WildTypeCellMutationState, p_state);
+    MAKE_PTR(DifferentiatedCellProliferativeType, p_diff_type);
+
+    for (unsigned elem_index = 0; elem_index < pMesh->GetNumElements(); elem_index++)
+    {
+        MyCellCycleModel* p_cc_model = new MyCellCycleModel();
+        p_cc_model->SetDimension(2);
+
+        std::vector<double> initial_conditions;
+        initial_conditions.push_back(RandomNumberGenerator::Instance()->ranf());
+        initial_conditions.push_back(RandomNumberGenerator::Instance()->ranf());
+        DeltaNotchSrnModel* p_srn_model = new DeltaNotchSrnModel();
+        p_srn_model->SetInitialConditions(initial_conditions);
+
+        CellPtr p_cell(new Cell(p_state, p_cc_model, p_srn_model));
+        p_cell->SetCellProliferativeType(p_diff_type);
+        p_cell->SetBirthTime(-RandomNumberGenerator::Instance()->ranf() * 12.0);
+        rCells.push_back(p_cell);
+    }
+}
+
+void DeltaNotchBenchmarks::CompareNagaiHondaForce(unsigned meshWidth, unsigned meshHeight, unsigned numRepeats)
+{
+    DeltaNotchReplicaContext context(1);
+    SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 1);
+
+    DeltaNotchPopulationBuilder builder;
+    MutableVertexMesh<2,2>* p_mesh = builder.BuildHoneycombMesh(meshWidth, meshHeight);
+    std::vector<CellPtr> cells;
+    builder.CreateCells(p_mesh->GetNumElements(), cells);
+
+    // Move every node, so that elements have different shapes, as they do once a simulation is under way
+    for (unsigned node_index=0; node_index<p_mesh->GetNumNodes(); node_index++)
+    {
+        c_vector<double, 2>& r_location = p_mesh->GetNode(node_index)->rGetModifiableLocation();
+        r_location[0] += 0.2*(RandomNumberGenerator::Instance()->ranf() - 0.5);
+        r_location[1] += 0.2*(RandomNumberGenerator::Instance()->ranf() - 0.5);
+    }
+    DeltaPhenotypeVertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+    // Set phenotype-dependent target areas, as in the tutorial, which also fills the per-element array
+    DeltaNotchTrackingModifier<2> notch_modifier;
+    DeltaPhenotypeTrackingModifier<2> phenotype_modifier;
+    DeltaPhenotypeTargetAreaModifier<2> target_area_modifier;
+    target_area_modifier.SetDeltaHighPhenotypeTargetAreaCoefficient(1.5);
+    target_area_modifier.SetDeltaLowPhenotypeTargetAreaCoefficient(0.7);
+    notch_modifier.SetupSolve(cell_population, "");
+    phenotype_modifier.SetupSolve(cell_population, "");
+    target_area_modifier.SetupSolve(cell_population, "");
+
+    NagaiHondaForce<2> stock_force;
+    DeltaNotchNagaiHondaForce<2> project_force;
+
+    std::vector<double> stock_forces;
+    std::vector<double> array_forces;
+    double stock_time = TimeForce(stock_force, cell_population, numRepeats, stock_forces);
+    double array_time = TimeForce(project_force, cell_population, numRepeats, array_forces);
+
+    // Once the per-element array no longer matches the mesh, the force reads target areas from CellData
+    cell_population.rGetElementTargetAreas().clear();
+    std::vector<double> cell_data_forces;
+    double cell_data_time = TimeForce(project_force, cell_population, numRepeats, cell_data_forces);
+
+    double max_difference = 0.0;
+    double max_force = 0.0;
+    for (unsigned i=0; i<stock_forces.size(); i++)
+    {
+        max_difference = std::max(max_difference, fabs(array_forces[i] - stock_forces[i]));
+        max_difference = std::max(max_difference, fabs(cell_data_forces[i] - stock_forces[i]));
+        max_force = std::max(max_force, fabs(stock_forces[i]));
+    }
+
+    std::cout << "Nagai-Honda force benchmark: " << meshWidth << "x" << meshHeight << " cells, "
+              << numRepeats << " repeats\n";
+    std::cout << "  NagaiHondaForce                          " << stock_time << " s\n";
+    std::cout << "  DeltaNotchNagaiHondaForce (CellData)     " << cell_data_time << " s  speedup " << stock_time/cell_data_time << "\n";
+    std::cout << "  DeltaNotchNagaiHondaForce (element array) " << array_time << " s  speedup " << stock_time/array_time << "\n";
+    std::cout << "  largest force difference " << max_difference << " (largest force " << max_force << ")" << std::endl;
+}
+
+void DeltaNotchBenchmarks::CompareOutputIndex(unsigned numCells, unsigned numFrames)
+{
+    OutputFileHandler handler("DeltaNotchBenchmarks/OutputIndex", true);
+    std::string phenotype_file = handler.GetOutputDirectoryFullPath() + "results.vizcellphenotype";
+    std::string ages_file = handler.GetOutputDirectoryFullPath() + "results.vizcellages";
+
+    // Write the synthetic outputs, rotating the cell order at each output time as divisions and deaths would
+    {
+        out_stream p_phenotype_file = handler.OpenOutputFile("results.vizcellphenotype");
+        out_stream p_ages_file = handler.OpenOutputFile("results.vizcellages");
+        for (unsigned frame=0; frame<numFrames; frame++)
+        {
+            double time = 0.1*frame;
+            *p_phenotype_file << time << "\t";
+            *p_ages_file << time << "\t";
+            for (unsigned i=0; i<numCells; i++)
+            {
+                unsigned cell_id = (i + frame)%numCells;
+                *p_phenotype_file << (cell_id + frame/10)%3 << " ";
+                *p_ages_file << i << " " << cell_id << " " << 0.01*i << " " << 0.02*i << " " << time + cell_id << " ";
+            }
+            *p_phenotype_file << "\n";
+            *p_ages_file << "\n";
+        }
+        p_phenotype_file->close();
+        p_ages_file->close();
+    }
+
+    unsigned cell_id = numCells/2;
+    double slice_time = 0.1*(numFrames/2);
+
+    // Line-by-line baseline: the cell's position in each line is found from the ages file
+    double start_time = Timer::GetWallTime();
+    std::vector<double> scan_trajectory;
+    {
+        std::ifstream phenotype_stream(phenotype_file.c_str());
+        std::ifstream ages_stream(ages_file.c_str());
+        std::string phenotype_line;
+        std::string ages_line;
+        while (std::getline(phenotype_stream, phenotype_line) && std::getline(ages_stream, ages_line))
+        {
+            std::istringstream ages_line_stream(ages_line);
+            double time;
+            ages_line_stream >> time;
+            unsigned position = 0;
+            unsigned location_index, this_cell_id;
+            double x, y, age;
+            while (ages_line_stream >> location_index >> this_cell_id >> x >> y >> age)
+            {
+                if (this_cell_id == cell_id)
+                {
+                    break;
+                }
+                position++;
+            }
+            std::istringstream phenotype_line_stream(phenotype_line);
+            phenotype_line_stream >> time;
+            double value = 0.0;
+            for (unsigned i=0; i<=position; i++)
+            {
+                phenotype_line_stream >> value;
+            }
+            scan_trajectory.push_back(value);
+        }
+    }
+    double scan_trajectory_time = Timer::GetWallTime() - start_time;
+
+    start_time = Timer::GetWallTime();
+    std::vector<double> scan_slice;
+    {
+        std::ifstream phenotype_stream(phenotype_file.c_str());
+        std::string line;
+        while (std::getline(phenotype_stream, line))
+        {
+            std::istringstream line_stream(line);
+            double time;
+            line_stream >> time;
+            if (fabs(time - slice_time) < 1e-9)
+            {
+                double value;
+                while (line_stream >> value)
+                {
+                    scan_slice.push_back(value);
+                }
+                break;
+            }
+        }
+    }
+    double scan_slice_time = Timer::GetWallTime() - start_time;
+
+    start_time = Timer::GetWallTime();
+    std::string index_file = phenotype_file + ".idx";
+    DeltaNotchOutputIndex::Build(phenotype_file, index_file, DeltaNotchOutputIndex::GetDefaultLayout(phenotype_file),
+                                 ages_file, DeltaNotchOutputIndex::GetDefaultLayout(ages_file));
+    double build_time = Timer::GetWallTime() - start_time;
+
+    start_time = Timer::GetWallTime();
+    DeltaNotchOutputIndex index(phenotype_file, index_file);
+    std::vector<double> times;
+    std::vector<double> indexed_trajectory;
+    index.GetTrajectory(cell_id, times, indexed_trajectory);
+    double indexed_trajectory_time = Timer::GetWallTime() - start_time;
+
+    start_time = Timer::GetWallTime();
+    std::vector<double> indexed_slice;
+    index.GetTimeSlice(index.FindFrame(slice_time + 1e-9), indexed_slice);
+    double indexed_slice_time = Timer::GetWallTime() - start_time;
+
+    std::cout << "Output index benchmark: " << numCells << " cells, " << numFrames << " output times, "
+              << boost::filesystem::file_size(phenotype_file) + boost::filesystem::file_size(ages_file) << " bytes of output, "
+              << boost::filesystem::file_size(index_file) << " bytes of index\n";
+    std::cout << "  index build            " << build_time << " s\n";
+    std::cout << "  trajectory  line scan  " << scan_trajectory_time << " s  indexed " << indexed_trajectory_time
+              << " s  speedup " << scan_trajectory_time/indexed_trajectory_time << "\n";
+    std::cout << "  time slice  line scan  " << scan_slice_time << " s  indexed " << indexed_slice_time
+              << " s  speedup " << scan_slice_time/indexed_slice_time << "\n";
+    std::cout << "  results agree: " << (scan_trajectory == indexed_trajectory && scan_slice.size() == indexed_slice.size() ? "yes" : "no")
+              << std::endl;
+}
+
+void DeltaNotchBenchmarks::CompareEventLog(unsigned meshWidth, unsigned meshHeight, double endTime, unsigned numRepeats)
+{
+    DeltaNotchSimulationParameters parameters;
+    parameters.mMeshWidth = meshWidth;
+    parameters.mMeshHeight = meshHeight;
+    parameters.mEndTime = endTime;
+    parameters.mWriters.clear();
+
+    // Alternate the runs, so that drift in the machine's speed affects both equally
+    DeltaNotchTutorialSimulation simulation;
+    DeltaNotchSimulationSummary without_log;
+    DeltaNotchSimulationSummary with_log;
+    for (unsigned i=0; i<numRepeats; i++)
+    {
+        parameters.mEventLogFile = "";
+        parameters.mOutputDirectory = "DeltaNotchBenchmarks/WithoutEventLog";
+        DeltaNotchSimulationSummary summary = simulation.Run(parameters);
+        if (i == 0 || summary.mWallTime < without_log.mWallTime)
+        {
+            without_log = summary;
+        }
+
+        parameters.mEventLogFile = "events.bin";
+        parameters.mOutputDirectory = "DeltaNotchBenchmarks/WithEventLog";
+        summary = simulation.Run(parameters);
+        if (i == 0 || summary.mWallTime < with_log.mWallTime)
+        {
+            with_log = summary;
+        }
+    }
+
+    OutputFileHandler handler("DeltaNotchBenchmarks/WithEventLog", false);
+    std::string log_file = handler.GetOutputDirectoryFullPath() + "events.bin";
+    std::vector<DeltaNotchEvent> events;
+    DeltaNotchEventLog::ReadEvents(log_file, events);
+    unsigned num_events[3] = {0, 0, 0};
+    for (unsigned i=0; i<events.size(); i++)
+    {
+        num_events[events[i].mType]++;
+    }
+
+    double overhead = with_log.mWallTime/without_log.mWallTime - 1.0;
+    std::cout << "Event log benchmark: " << meshWidth << "x" << meshHeight << " cells, end time " << endTime
+              << ", fastest of " << numRepeats << " runs\n";
+    std::cout << "  without log  " << without_log.mWallTime << " s\n";
+    std::cout << "  with log     " << with_log.mWallTime << " s\n";
+    std::cout << "  overhead     " << 100.0*overhead << "% (" << (overhead < 0.02 ? "within" : "over") << " the 2% budget)\n";
+    std::cout << "  events       " << events.size() << ": " << num_events[EVENT_DIVISION] << " divisions, "
+              << num_events[EVENT_DEATH] << " deaths, " << num_events[EVENT_PHENOTYPE_TRANSITION] << " phenotype transitions, "
+              << boost::filesystem::file_size(log_file) << " bytes\n";
+    std::cout << "  same final state: " << (with_log.mChecksum == without_log.mChecksum
+                                            && with_log.mNumCells == without_log.mNumCells ? "yes" : "no") << std::endl;
+}
+
+void DeltaNotchBenchmarks::ComparePhenotypePolicy(unsigned meshWidth, unsigned meshHeight, unsigned numSteps)
+{
+    // The runtime modifiers, configured as the policy is
+    DeltaPhenotypeTargetAreaModifier<2>* p_target_area_modifier = new DeltaPhenotypeTargetAreaModifier<2>;
+    DeltaPhenotypeFusedModifier<2>* p_fused_modifier = new DeltaPhenotypeFusedModifier<2>;
+    p_target_area_modifier->SetDeltaLowPhenotypeTargetAreaCoefficient(ThreeBandDeltaPhenotypePolicy::GetTargetAreaCoefficient(0));
+    p_target_area_modifier->SetTransientPhenotypeTargetAreaCoefficient(ThreeBandDeltaPhenotypePolicy::GetTargetAreaCoefficient(1));
+    p_target_area_modifier->SetDeltaHighPhenotypeTargetAreaCoefficient(ThreeBandDeltaPhenotypePolicy::GetTargetAreaCoefficient(2));
+    p_fused_modifier->SetDeltaLowPhenotypeTargetAreaCoefficient(ThreeBandDeltaPhenotypePolicy::GetTargetAreaCoefficient(0));
+    p_fused_modifier->SetTransientPhenotypeTargetAreaCoefficient(ThreeBandDeltaPhenotypePolicy::GetTargetAreaCoefficient(1));
+    p_fused_modifier->SetDeltaHighPhenotypeTargetAreaCoefficient(ThreeBandDeltaPhenotypePolicy::GetTargetAreaCoefficient(2));
+
+    std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> > > three_pass;
+    three_pass.push_back(boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> >(new DeltaNotchTrackingModifier<2>));
+    three_pass.push_back(boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> >(new DeltaPhenotypeTrackingModifier<2>));
+    three_pass.push_back(boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> >(p_target_area_modifier));
+
+    std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> > > fused;
+    fused.push_back(boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> >(p_fused_modifier));
+
+    std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> > > three_band;
+    three_band.push_back(boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> >(new DeltaPhenotypePolicyModifier<2, ThreeBandDeltaPhenotypePolicy>));
+
+    std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> > > five_band;
+    five_band.push_back(boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> >(new DeltaPhenotypePolicyModifier<2, FiveBandDeltaPhenotypePolicy>));
+
+    double three_pass_checksum = 0.0;
+    double fused_checksum = 0.0;
+    double three_band_checksum = 0.0;
+    double five_band_checksum = 0.0;
+    double three_pass_time = TimeModifiers(meshWidth, meshHeight, numSteps, three_pass, three_pass_checksum);
+    double fused_time = TimeModifiers(meshWidth, meshHeight, numSteps, fused, fused_checksum);
+    double three_band_time = TimeModifiers(meshWidth, meshHeight, numSteps, three_band, three_band_checksum);
+    double five_band_time = TimeModifiers(meshWidth, meshHeight, numSteps, five_band, five_band_checksum);
+
+    // The classification alone, over a spread of Delta levels including the thresholds themselves
+    unsigned num_values = 1000000;
+    std::vector<double> delta(num_values);
+    for (unsigned i=0; i<num_values; i++)
+    {
+        delta[i] = (i%1000)/1000.0;
+    }
+    DeltaPhenotypeTrackingModifier<2> phenotype_modifier;
+    double runtime_sum = 0.0;
+    double start_time = Timer::GetWallTime();
+    for (unsigned i=0; i<num_values; i++)
+    {
+        unsigned phenotype = DELTA_TRANSIENT;
+        if (delta[i] > phenotype_modifier.GetDeltaHighThreshold())
+        {
+            phenotype = DELTA_HIGH;
+        }
+        else if (delta[i] < phenotype_modifier.GetDeltaLowThreshold())
+        {
+            phenotype = DELTA_LOW;
+        }
+        runtime_sum += p_target_area_modifier->GetTargetAreaCoefficient(phenotype);
+    }
+    double runtime_time = Timer::GetWallTime() - start_time;
+
+    double policy_sum = 0.0;
+    start_time = Timer::GetWallTime();
+    for (unsigned i=0; i<num_values; i++)
+    {
+        policy_sum += ThreeBandDeltaPhenotypePolicy::GetTargetAreaCoefficient(ClassifyDelta<ThreeBandDeltaPhenotypePolicy>(delta[i]));
+    }
+    double policy_time = Timer::GetWallTime() - start_time;
+
+    std::cout << "Phenotype policy benchmark: " << meshWidth << "x" << meshHeight << " cells, " << numSteps << " steps\n";
+    std::cout << std::setprecision(6);
+    std::cout << "  three-pass  " << three_pass_time << " s/step  checksum " << std::setprecision(15) << three_pass_checksum << "\n";
+    std::cout << std::setprecision(6);
+    std::cout << "  fused       " << fused_time << " s/step  checksum " << std::setprecision(15) << fused_checksum << "\n";
+    std::cout << std::setprecision(6);
+    std::cout << "  three-band  " << three_band_time << " s/step  checksum " << std::setprecision(15) << three_band_checksum << "\n";
+    std::cout << std::setprecision(6);
+    std::cout << "  five-band   " << five_band_time << " s/step  checksum " << std::setprecision(15) << five_band_checksum << "\n";
+    std::cout << std::setprecision(6);
+    std::cout << "  speedup     " << three_pass_time/three_band_time << " over three-pass, "
+              << fused_time/three_band_time << " over fused\n";
+    std::cout << "  results " << (three_pass_checksum == three_band_checksum ? "match" : "DIFFER") << "\n";
+    std::cout << "  classification  runtime " << 1e9*runtime_time/num_values << " ns/cell, policy "
+              << 1e9*policy_time/num_values << " ns/cell, speedup " << runtime_time/policy_time
+              << ", results " << (runtime_sum == policy_sum ? "match" : "DIFFER") << std::endl;
+}
+
+void DeltaNotchBenchmarks::CompareLazyTargetAreas(unsigned meshWidth, unsigned meshHeight, unsigned numSteps)
+{
+    std::string names[4] = {"three-pass eager", "three-pass lazy ", "fused eager     ", "fused lazy      "};
+    double times[4];
+    double checksums[4];
+    unsigned num_active_cells[4];
+    unsigned num_full_passes[4];
+    for (unsigned run=0; run<4; run++)
+    {
+        bool use_lazy_evaluation = (run%2 == 1);
+        std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> > > modifiers;
+        DeltaPhenotypeTargetAreaModifier<2>* p_target_area_modifier;
+        if (run < 2)
+        {
+            p_target_area_modifier = new DeltaPhenotypeTargetAreaModifier<2>;
+            p_target_area_modifier->SetUseLazyEvaluation(use_lazy_evaluation);
+            modifiers.push_back(boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> >(new DeltaNotchTrackingModifier<2>));
+            modifiers.push_back(boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> >(new DeltaPhenotypeTrackingModifier<2>));
+            modifiers.push_back(boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> >(p_target_area_modifier));
+        }
+        else
+        {
+            DeltaPhenotypeFusedModifier<2>* p_fused_modifier = new DeltaPhenotypeFusedModifier<2>;
+            p_fused_modifier->SetUseLazyEvaluation(use_lazy_evaluation);
+            modifiers.push_back(boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> >(p_fused_modifier));
+            p_target_area_modifier = p_fused_modifier;
+        }
+        checksums[run] = 0.0;
+        times[run] = TimeModifiers(meshWidth, meshHeight, numSteps, modifiers, checksums[run]);
+        num_active_cells[run] = p_target_area_modifier->GetNumActiveCells();
+        num_full_passes[run] = p_target_area_modifier->GetNumFullPasses();
+    }
+
+    std::cout << "Lazy target area benchmark: " << meshWidth << "x" << meshHeight << " cells, " << numSteps << " steps\n";
+    for (unsigned run=0; run<4; run++)
+    {
+        std::cout << std::setprecision(6);
+        std::cout << "  " << names[run] << "  " << times[run] << " s/step  checksum " << std::setprecision(15) << checksums[run];
+        if (run%2 == 1)
+        {
+            std::cout << "  active cells at end " << num_active_cells[run] << ", full passes " << num_full_passes[run];
+        }
+        std::cout << "\n";
+    }
+    std::cout << std::setprecision(6);
+    std::cout << "  speedup     " << times[0]/times[1] << " three-pass, " << times[2]/times[3] << " fused\n";
+    std::cout << "  results " << (checksums[0] == checksums[1] && checksums[2] == checksums[3] ? "match" : "DIFFER") << std::endl;
+}
+
+double DeltaNotchBenchmarks::TimeForce(AbstractForce<2,2>& rForce, VertexBasedCellPopulation<2>& rCellPopulation,
+                                       unsigned numRepeats, std::vector<double>& rForces)
+{
+    unsigned num_nodes = rCellPopulation.GetNumNodes();
+    double start_time = Timer::GetWallTime();
+    for (unsigned repeat=0; repeat<numRepeats; repeat++)
+    {
+        for (unsigned node_index=0; node_index<num_nodes; node_index++)
+        {
+            rCellPopulation.GetNode(node_index)->ClearAppliedForce();
+        }
+        rForce.AddForceContribution(rCellPopulation);
+    }
+    double time_per_repeat = (Timer::GetWallTime() - start_time)/numRepeats;
+
+    rForces.resize(2*num_nodes);
+    for (unsigned node_index=0; node_index<num_nodes; node_index++)
+    {
+        const c_vector<double, 2>& r_force = rCellPopulation.GetNode(node_index)->rGetAppliedForce();
+        rForces[2*node_index] = r_force[0];
+        rForces[2*node_index+1] = r_force[1];
+    }
+    return time_per_repeat;
+}
+
+double DeltaNotchBenchmarks::TimeModifiers(unsigned meshWidth, unsigned meshHeight, unsigned numSteps,
+                                           std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> > >& rModifiers,
+                                           double& rChecksum)
+{
+    DeltaNotchReplicaContext context(1);
+    double dt = 0.002;
+    SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(numSteps*dt, numSteps);
+
+    HoneycombVertexMeshGenerator generator(meshWidth, meshHeight);
+    MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+
+    std::vector<CellPtr> cells;
+    CreateCells(p_mesh, cells);
+    DeltaPhenotypeVertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+    for (unsigned i=0; i<rModifiers.size(); i++)
+    {
+        rModifiers[i]->SetupSolve(cell_population, "");
+    }
+
+    double start_time = Timer::GetWallTime();
+    for (unsigned step=0; step<numSteps; step++)
+    {
+        SimulationTime::Instance()->IncrementTimeOneStep();
+        for (unsigned i=0; i<rModifiers.size(); i++)
+        {
+            rModifiers[i]->UpdateAtEndOfTimeStep(cell_population);
+        }
+    }
+    double time_per_step = (Timer::GetWallTime() - start_time)/numSteps;
+
+    rChecksum = ComputeChecksum(cell_population);
+
+    return time_per_step;
+}
+
+double DeltaNotchBenchmarks::TimeWriters(std::vector<boost::shared_ptr<AbstractCellWriter<2,2> > >& rWriters,
+                                         AbstractCellPopulation<2,2>& rCellPopulation,
+                                         const std::string& rDirectory,
+                                         unsigned numFrames,
+                                         unsigned long& rNumBytes)
+{
+    OutputFileHandler handler(rDirectory, true);
+    for (unsigned i=0; i<rWriters.size(); i++)
+    {
+        rWriters[i]->OpenOutputFile(handler);
+    }
+
+    double start_time = Timer::GetWallTime();
+    for (unsigned frame=0; frame<numFrames; frame++)
+    {
+        SimulationTime::Instance()->IncrementTimeOneStep();
+        for (unsigned i=0; i<rWriters.size(); i++)
+        {
+            rWriters[i]->WriteTimeStamp();
+            for (AbstractCellPopulation<2>::Iterator cell_iter = rCellPopulation.Begin();
+                 cell_iter != rCellPopulation.End();
+                 ++cell_iter)
+            {
+                rWriters[i]->VisitCell(*cell_iter, &rCellPopulation);
+            }
+            rWriters[i]->WriteNewline();
+        }
+    }
+    for (unsigned i=0; i<rWriters.size(); i++)
+    {
+        rWriters[i]->CloseFile();
+    }
+    double time_per_frame = (Timer::GetWallTime() - start_time)/numFrames;
+
+    rNumBytes = 0;
+    for (unsigned i=0; i<rWriters.size(); i++)
+    {
+        rNumBytes += boost::filesystem::file_size(handler.GetOutputDirectoryFullPath() + rWriters[i]->GetFileName());
+    }
+    return time_per_frame;
+}
+
+double DeltaNotchBenchmarks::TimeVtkOutput(unsigned meshWidth, unsigned meshHeight,
+                                           bool useCompressedVtkOutput, bool moveNodes,
+                                           const std::string& rDirectory,
+                                           unsigned numFrames,
+                                           unsigned long& rNumBytes)
+{
+    DeltaNotchReplicaContext context(1);
+    SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(numFrames*0.002, numFrames);
+
+    HoneycombVertexMeshGenerator generator(meshWidth, meshHeight);
+    MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+
+    std::vector<CellPtr> cells;
+    CreateCells(p_mesh, cells);
+    DeltaPhenotypeVertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+    cell_population.SetUseCompressedVtkOutput(useCompressedVtkOutput);
+    cell_population.AddCellWriter<DeltaPhenotypeWriter>();
+
+    DeltaNotchTrackingModifier<2> delta_notch_modifier;
+    delta_notch_modifier.SetupSolve(cell_population, "");
+    DeltaPhenotypeTrackingModifier<2> phenotype_modifier;
+    phenotype_modifier.SetupSolve(cell_population, "");
+
+    OutputFileHandler handler(rDirectory, true);
+    cell_population.OpenWritersFiles(handler);
+
+    double start_time = Timer::GetWallTime();
+    for (unsigned frame=0; frame<numFrames; frame++)
+    {
+        SimulationTime::Instance()->IncrementTimeOneStep();
+        if (moveNodes)
+        {
+            for (unsigned node_index=0; node_index<p_mesh->GetNumNodes(); node_index++)
+            {
+                p_mesh->GetNode(node_index)->rGetModifiableLocation()[0] += 1e-4;
+            }
+        }
+        cell_population.WriteVtkResultsToFile(rDirectory);
+    }
+    cell_population.CloseOutputFiles();
+    double time_per_frame = (Timer::GetWallTime() - start_time)/numFrames;
+
+    // Only count the VTK output, not the cell writers' own files
+    rNumBytes = 0;
+    boost::filesystem::path output_path(handler.GetOutputDirectoryFullPath());
+    for (boost::filesystem::directory_iterator it(output_path); it != boost::filesystem::directory_iterator(); ++it)
+    {
+        std::string extension = it->path().extension().string();
+        if (extension == ".vtu" || extension == ".pvd")
+        {
+            rNumBytes += boost::filesystem::file_size(it->path());
+        }
+    }
+
+    return time_per_frame;
+}
+
+double DeltaNotchBenchmarks::ComputeChecksum(AbstractCellPopulation<2,2>& rCellPopulation)
+{
+    double checksum = 0.0;
+    for (AbstractCellPopulation<2>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        checksum += cell_iter->GetCellData()->GetItem("mean delta");
+        checksum += cell_iter->GetCellData()->GetItem("target area");
+        checksum += DeltaPhenotypeFlags::GetPhenotype(*cell_iter);
+    }
+    return checksum;
+}
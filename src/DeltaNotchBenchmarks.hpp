@@ -0,0 +1,278 @@
+
+#ifndef DELTANOTCHBENCHMARKS_HPP_
+#define DELTANOTCHBENCHMARKS_HPP_
+
+#include <string>
+#include <vector>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "AbstractCellWriter.hpp"
+#include "AbstractForce.hpp"
+#include "Cell.hpp"
+#include "MutableVertexMesh.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+/**
+ * Collection of timing benchmarks for the classes in this project.
+ *
+ * Each benchmark sets up and tears down its own DeltaNotchReplicaContext, and
+ * prints its results to std::cout as a short table, so benchmarks can be run
+ * one after another from Exe_DeltaNotchBenchmarks.
+ */
+class DeltaNotchBenchmarks
+{
+public:
+
+    /**
+     * Compare the cost per time step of running DeltaNotchTrackingModifier,
+     * DeltaPhenotypeTrackingModifier and DeltaPhenotypeTargetAreaModifier one
+     * after another with that of DeltaPhenotypeFusedModifier, and check that
+     * both leave the cells in the same state.
+     *
+     * @param meshWidth number of elements across the honeycomb vertex mesh
+     * @param meshHeight number of elements up the honeycomb vertex mesh
+     * @param numSteps number of time steps to run each set of modifiers for
+     */
+    void CompareFusedModifier(unsigned meshWidth, unsigned meshHeight, unsigned numSteps);
+
+    /**
+     * Compare the cost of finding each cell's Delta phenotype by testing its
+     * cell properties with that of reading the DeltaPhenotypeFlags.
+     *
+     * @param meshWidth number of elements across the honeycomb vertex mesh
+     * @param meshHeight number of elements up the honeycomb vertex mesh
+     * @param numRepeats number of sweeps over the population to time
+     */
+    void ComparePhenotypeLookup(unsigned meshWidth, unsigned meshHeight, unsigned numRepeats);
+
+    /**
+     * Compare the output size and write time of the full-precision text writers
+     * CellAgesWriter, CellVolumesWriter and DeltaPhenotypeWriter with those of their
+     * quantised counterparts, and report the largest quantisation errors.
+     *
+     * @param meshWidth number of elements across the honeycomb vertex mesh
+     * @param meshHeight number of elements up the honeycomb vertex mesh
+     * @param numFrames number of output times to write
+     */
+    void CompareQuantisedWriters(unsigned meshWidth, unsigned meshHeight, unsigned numFrames);
+
+    /**
+     * Compare the output size and write time of the standard VTK output with that of the
+     * compressed output of DeltaPhenotypeVertexBasedCellPopulation, both for a static mesh
+     * and for a mesh whose nodes move at every output time.
+     *
+     * @param meshWidth number of elements across the honeycomb vertex mesh
+     * @param meshHeight number of elements up the honeycomb vertex mesh
+     * @param numFrames number of output times to write
+     */
+    void CompareVtkOutput(unsigned meshWidth, unsigned meshHeight, unsigned numFrames);
+
+    /**
+     * Compare the wall time and final phenotype counts of the tutorial vertex simulation
+     * run with a fixed time step with those of the same simulation run with adaptive time
+     * stepping (see DeltaNotchAdaptiveSimulation).
+     *
+     * @param meshWidth number of elements across the honeycomb vertex mesh
+     * @param meshHeight number of elements up the honeycomb vertex mesh
+     * @param endTime simulation end time
+     */
+    void CompareAdaptiveTimeStep(unsigned meshWidth, unsigned meshHeight, double endTime);
+
+    /**
+     * Run the tutorial vertex simulation with the phenotype and target area modifiers updated
+     * every 1, 2, 5, 10 and 20 time steps (see MultiRateModifierScheduler), and compare the
+     * throughput and final phenotype counts with those of updating every time step.
+     *
+     * @param meshWidth number of elements across the honeycomb vertex mesh
+     * @param meshHeight number of elements up the honeycomb vertex mesh
+     * @param endTime simulation end time
+     * @param numOdeSubcycles number of Delta/Notch ODE sub-cycles per time step, or 0 for none
+     */
+    void CompareUpdateIntervals(unsigned meshWidth, unsigned meshHeight, double endTime, unsigned numOdeSubcycles);
+
+    /**
+     * Compare the replicas per second and memory per replica of running a batch of tutorial
+     * vertex simulations with DeltaNotchReplicaEngine, in this process and with a pool of
+     * worker processes, with those of running each one as a separate Exe_DeltaNotchTutorial
+     * process.
+     *
+     * @param meshWidth number of elements across the honeycomb vertex mesh
+     * @param meshHeight number of elements up the honeycomb vertex mesh
+     * @param endTime simulation end time
+     * @param numReplicas number of replicas, with seeds 1, 2, ..., numReplicas
+     * @param numWorkers number of worker processes; if 1, the worker pool is not timed
+     * @param rTutorialExecutable path to Exe_DeltaNotchTutorial; if empty, only the engine is timed
+     */
+    void CompareReplicaEngine(unsigned meshWidth, unsigned meshHeight, double endTime, unsigned numReplicas,
+                              unsigned numWorkers, const std::string& rTutorialExecutable);
+
+    /**
+     * Compare the time to build a square honeycomb vertex mesh, its cells and cell population
+     * by generating the mesh and creating cells one at a time with that of using
+     * DeltaNotchPopulationBuilder, with and without a mesh cache, for meshes of 10^2, 10^4,
+     * 10^5 and 10^6 elements, up to a given size.
+     *
+     * @param maxNumElements the largest number of elements to try
+     * @param rMeshCacheDirectory directory in which to cache meshes; if empty, caching is not timed
+     */
+    void CompareStartup(unsigned maxNumElements, const std::string& rMeshCacheDirectory);
+
+    /**
+     * Compare the memory used per cell by a square vertex population labelled with the three
+     * separate modifiers with that used in compact mode (DeltaPhenotypeFusedModifier with compact
+     * storage and no phenotype properties), giving both the DeltaNotchMemoryReport estimate and
+     * the measured growth in heap memory.
+     *
+     * @param numCells the approximate number of cells
+     */
+    void CompareMemory(unsigned numCells);
+
+    /**
+     * Compare the time taken by NagaiHondaForce to compute the forces on a deformed square vertex population
+     * with phenotype-dependent target areas with that taken by DeltaNotchNagaiHondaForce, both reading
+     * target areas from CellData and reading them from the per-element array filled by
+     * DeltaPhenotypeTargetAreaModifier, and give the largest difference between the forces.
+     *
+     * @param meshWidth number of elements across the mesh
+     * @param meshHeight number of elements up the mesh
+     * @param numRepeats number of times to compute the forces
+     */
+    void CompareNagaiHondaForce(unsigned meshWidth, unsigned meshHeight, unsigned numRepeats);
+
+    /**
+     * Compare the time to extract one cell's trajectory and one time slice from a results.vizcellphenotype
+     * file by reading it line by line with that taken using a DeltaNotchOutputIndex, together with the
+     * time to build the index. Synthetic results.vizcellphenotype and results.vizcellages files of the
+     * given size are written first, in the formats of DeltaPhenotypeWriter and CellAgesWriter, with cells
+     * listed in a different order at each output time.
+     *
+     * @param numCells the number of cells at each output time
+     * @param numFrames the number of output times
+     */
+    void CompareOutputIndex(unsigned numCells, unsigned numFrames);
+
+    /**
+     * Compare the wall time of the tutorial vertex simulation with and without a DeltaNotchEventLog,
+     * running each alternately a number of times and taking the fastest of each, and report the
+     * relative overhead of the log against the 2% budget, the number of events recorded of each kind
+     * and the size of the log file. The final states must match, since logging draws no random numbers.
+     *
+     * @param meshWidth number of elements across the honeycomb vertex mesh
+     * @param meshHeight number of elements up the honeycomb vertex mesh
+     * @param endTime simulation end time
+     * @param numRepeats number of runs with and without the log
+     */
+    void CompareEventLog(unsigned meshWidth, unsigned meshHeight, double endTime, unsigned numRepeats);
+
+    /**
+     * Compare the cost per time step of updating the phenotypes and target areas of a square vertex
+     * population with the runtime modifiers (DeltaNotchTrackingModifier, DeltaPhenotypeTrackingModifier
+     * and DeltaPhenotypeTargetAreaModifier, and DeltaPhenotypeFusedModifier) with that of
+     * DeltaPhenotypePolicyModifier with ThreeBandDeltaPhenotypePolicy, which must give the same final
+     * state, and with FiveBandDeltaPhenotypePolicy. Also compare the cost per cell of classifying
+     * a level of Delta and finding its target area coefficient at runtime and through the policy.
+     *
+     * @param meshWidth number of elements across the honeycomb vertex mesh
+     * @param meshHeight number of elements up the honeycomb vertex mesh
+     * @param numSteps number of time steps to time
+     */
+    void ComparePhenotypePolicy(unsigned meshWidth, unsigned meshHeight, unsigned numSteps);
+
+    /**
+     * Compare the cost per time step of DeltaPhenotypeTargetAreaModifier, after DeltaNotchTrackingModifier
+     * and DeltaPhenotypeTrackingModifier, and of DeltaPhenotypeFusedModifier, with lazy evaluation of target
+     * areas (see DeltaPhenotypeTargetAreaModifier::UpdateTargetAreas()) with that without it. Both must leave
+     * the cells in the same state. For the lazy runs, the number of active cells left at the end and the
+     * number of passes that visited every cell are also reported.
+     *
+     * @param meshWidth number of elements across the honeycomb vertex mesh
+     * @param meshHeight number of elements up the honeycomb vertex mesh
+     * @param numSteps number of time steps to time
+     */
+    void CompareLazyTargetAreas(unsigned meshWidth, unsigned meshHeight, unsigned numSteps);
+
+private:
+
+    /**
+     * Create one Delta/Notch cell per element of a vertex mesh, one cell at a time.
+     * DeltaNotchPopulationBuilder::CreateCells() creates the same cells in a batch.
+     *
+     * @param pMesh the vertex mesh
+     * @param rCells vector to fill with the new cells
+     */
+    void CreateCells(MutableVertexMesh<2,2>* pMesh, std::vector<CellPtr>& rCells);
+
+    /**
+     * Run a list of modifiers on a fresh vertex population, with no mechanics,
+     * for a given number of time steps.
+     *
+     * @param meshWidth number of elements across the honeycomb vertex mesh
+     * @param meshHeight number of elements up the honeycomb vertex mesh
+     * @param numSteps number of time steps
+     * @param rModifiers the modifiers, which are called in order at each time step
+     * @param rChecksum filled with a checksum of the final cell data, for comparing runs
+     *
+     * @return the wall time per time step, in seconds
+     */
+    double TimeModifiers(unsigned meshWidth, unsigned meshHeight, unsigned numSteps,
+                         std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> > >& rModifiers,
+                         double& rChecksum);
+
+    /**
+     * Write a number of frames of output with each of a set of cell writers.
+     *
+     * @param rWriters the writers
+     * @param rCellPopulation the cell population
+     * @param rDirectory output directory, relative to where Chaste output is stored
+     * @param numFrames number of output times to write; simulation time is advanced one step per frame
+     * @param rNumBytes filled with the total size of the files written
+     *
+     * @return the wall time per frame, in seconds
+     */
+    double TimeWriters(std::vector<boost::shared_ptr<AbstractCellWriter<2,2> > >& rWriters,
+                       AbstractCellPopulation<2,2>& rCellPopulation,
+                       const std::string& rDirectory,
+                       unsigned numFrames,
+                       unsigned long& rNumBytes);
+
+    /**
+     * Write a number of frames of VTK output for a fresh vertex population.
+     *
+     * @param meshWidth number of elements across the honeycomb vertex mesh
+     * @param meshHeight number of elements up the honeycomb vertex mesh
+     * @param useCompressedVtkOutput whether to use the compressed output
+     * @param moveNodes whether to move every node slightly before each frame
+     * @param rDirectory output directory, relative to where Chaste output is stored
+     * @param numFrames number of output times to write
+     * @param rNumBytes filled with the total size of the files written
+     *
+     * @return the wall time per frame, in seconds
+     */
+    double TimeVtkOutput(unsigned meshWidth, unsigned meshHeight,
+                         bool useCompressedVtkOutput, bool moveNodes,
+                         const std::string& rDirectory,
+                         unsigned numFrames,
+                         unsigned long& rNumBytes);
+
+    /**
+     * @return a checksum of the "mean delta" and "target area" CellData items,
+     * and the Delta phenotypes, of all cells in a population
+     *
+     * @param rCellPopulation the cell population
+     */
+    double ComputeChecksum(AbstractCellPopulation<2,2>& rCellPopulation);
+
+    /**
+     * Compute the forces on the nodes of a vertex population a number of times.
+     *
+     * @param rForce the force
+     * @param rCellPopulation the cell population
+     * @param numRepeats number of times to compute the forces
+     * @param rForces vector to fill with the last forces computed, stored as x0, y0, x1, y1, ...
+     * @return the wall time per computation, in seconds
+     */
+    double TimeForce(AbstractForce<2,2>& rForce, VertexBasedCellPopulation<2>& rCellPopulation,
+                     unsigned numRepeats, std::vector<double>& rForces);
+};
+
+#endif /*DELTANOTCHBENCHMARKS_HPP_*/
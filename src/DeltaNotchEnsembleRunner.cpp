@@ -0,0 +1,287 @@
+
+#include "DeltaNotchEnsembleRunner.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <sstream>
+
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/trim.hpp>
+
+#include "DeltaNotchTutorialSimulation.hpp"
+#include "Exception.hpp"
+#include "ExecutableSupport.hpp"
+#include "OutputFileHandler.hpp"
+
+/**
+ * Number of doubles sent to process 0 for each replica: replica index, rank, numbers of
+ * cells, Delta-high, Delta-low and transient cells, checksum, time steps and wall time.
+ */
+static const unsigned RESULT_SIZE = 9;
+
+/** MPI tag of a request to process 0 for a replica to run. */
+static const int REPLICA_REQUEST_TAG = 2901;
+
+/** MPI tag of the reply from process 0 giving the replica to run. */
+static const int REPLICA_ASSIGNMENT_TAG = 2902;
+
+DeltaNotchEnsembleRunner::DeltaNotchEnsembleRunner(const std::string& rOutputDirectory)
+    : mOutputDirectory(rOutputDirectory),
+      mNextReplica(0)
+{
+}
+
+void DeltaNotchEnsembleRunner::ReadSweepFile(const std::string& rSweepFile, unsigned numRepeats)
+{
+    std::ifstream sweep_stream(rSweepFile.c_str());
+    if (!sweep_stream.is_open())
+    {
+        EXCEPTION("Could not open sweep file " + rSweepFile);
+    }
+
+    std::string line;
+    while (std::getline(sweep_stream, line))
+    {
+        boost::trim(line);
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        std::vector<std::string> arguments;
+        boost::split(arguments, line, boost::is_any_of(" \t"), boost::token_compress_on);
+
+        DeltaNotchSimulationParameters parameters;
+        if (!parameters.Parse(arguments))
+        {
+            EXCEPTION("--help may not be given in a sweep file");
+        }
+
+        unsigned first_seed = parameters.mSeed;
+        for (unsigned repeat=0; repeat<numRepeats; repeat++)
+        {
+            parameters.mSeed = first_seed + repeat;
+            AddReplica(parameters);
+        }
+    }
+}
+
+void DeltaNotchEnsembleRunner::AddReplica(const DeltaNotchSimulationParameters& rParameters)
+{
+    std::stringstream output_directory;
+    output_directory << mOutputDirectory << "/replica_" << mReplicas.size();
+
+    mReplicas.push_back(rParameters);
+    mReplicas.back().mOutputDirectory = output_directory.str();
+}
+
+unsigned DeltaNotchEnsembleRunner::GetNumReplicas() const
+{
+    return mReplicas.size();
+}
+
+void DeltaNotchEnsembleRunner::Run()
+{
+    int rank;
+    int num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    // Create the top-level output directory collectively, before the processes go their own ways
+    OutputFileHandler handler(mOutputDirectory, false);
+
+    // Run replicas until none are left
+    std::vector<double> local_results;
+    mNextReplica = 0;
+    PetscTools::IsolateProcesses(true);
+    try
+    {
+        if (num_procs > 1 && rank == 0)
+        {
+            DispatchReplicas(num_procs - 1);
+        }
+        else
+        {
+            DeltaNotchTutorialSimulation simulation;
+            for (unsigned index = ClaimNextReplica(num_procs); index < mReplicas.size(); index = ClaimNextReplica(num_procs))
+            {
+                DeltaNotchSimulationSummary summary = simulation.Run(mReplicas[index]);
+
+                local_results.push_back(index);
+                local_results.push_back(rank);
+                local_results.push_back(summary.mNumCells);
+                local_results.push_back(summary.mNumDeltaHigh);
+                local_results.push_back(summary.mNumDeltaLow);
+                local_results.push_back(summary.mNumTransient);
+                local_results.push_back(summary.mChecksum);
+                local_results.push_back(summary.mNumTimeSteps);
+                local_results.push_back(summary.mWallTime);
+            }
+        }
+    }
+    catch (const Exception& e)
+    {
+        // A failed replica cannot be recovered from, since other processes are waiting on this one
+        PetscTools::IsolateProcesses(false);
+        ExecutableSupport::PrintError(e.GetMessage());
+        MPI_Abort(MPI_COMM_WORLD, ExecutableSupport::EXIT_ERROR);
+    }
+    catch (const std::exception& e)
+    {
+        PetscTools::IsolateProcesses(false);
+        ExecutableSupport::PrintError(e.what());
+        MPI_Abort(MPI_COMM_WORLD, ExecutableSupport::EXIT_ERROR);
+    }
+    catch (...)
+    {
+        PetscTools::IsolateProcesses(false);
+        ExecutableSupport::PrintError("Unknown exception in replica");
+        MPI_Abort(MPI_COMM_WORLD, ExecutableSupport::EXIT_ERROR);
+    }
+    PetscTools::IsolateProcesses(false);
+
+    // Gather the results on process 0
+    int local_size = local_results.size();
+    std::vector<int> sizes(num_procs, 0);
+    MPI_Gather(&local_size, 1, MPI_INT, sizes.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    std::vector<int> displacements(num_procs, 0);
+    int total_size = 0;
+    for (int proc=0; proc<num_procs; proc++)
+    {
+        displacements[proc] = total_size;
+        total_size += sizes[proc];
+    }
+
+    std::vector<double> all_results((rank == 0) ? total_size : 0);
+    MPI_Gatherv(local_results.data(), local_size, MPI_DOUBLE,
+                all_results.data(), sizes.data(), displacements.data(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+    if (rank == 0)
+    {
+        mSummaries.assign(mReplicas.size(), DeltaNotchSimulationSummary());
+        mReplicaRanks.assign(mReplicas.size(), 0);
+        std::vector<unsigned> num_runs(mReplicas.size(), 0);
+        for (unsigned i=0; i<all_results.size(); i += RESULT_SIZE)
+        {
+            unsigned index = static_cast<unsigned>(all_results[i]);
+            num_runs[index]++;
+            mReplicaRanks[index] = static_cast<unsigned>(all_results[i+1]);
+            mSummaries[index].mNumCells = static_cast<unsigned>(all_results[i+2]);
+            mSummaries[index].mNumDeltaHigh = static_cast<unsigned>(all_results[i+3]);
+            mSummaries[index].mNumDeltaLow = static_cast<unsigned>(all_results[i+4]);
+            mSummaries[index].mNumTransient = static_cast<unsigned>(all_results[i+5]);
+            mSummaries[index].mChecksum = all_results[i+6];
+            mSummaries[index].mNumTimeSteps = static_cast<unsigned>(all_results[i+7]);
+            mSummaries[index].mWallTime = all_results[i+8];
+        }
+
+        for (unsigned index=0; index<num_runs.size(); index++)
+        {
+            if (num_runs[index] != 1)
+            {
+                std::stringstream message;
+                message << "Replica " << index << " was run " << num_runs[index] << " times";
+                EXCEPTION(message.str());
+            }
+        }
+    }
+}
+
+const std::vector<DeltaNotchSimulationSummary>& DeltaNotchEnsembleRunner::rGetSummaries() const
+{
+    return mSummaries;
+}
+
+const std::vector<unsigned>& DeltaNotchEnsembleRunner::rGetReplicaRanks() const
+{
+    return mReplicaRanks;
+}
+
+void DeltaNotchEnsembleRunner::WriteSummary()
+{
+    OutputFileHandler handler(mOutputDirectory, false);
+    if (!PetscTools::AmMaster())
+    {
+        return;
+    }
+
+    out_stream p_file = handler.OpenOutputFile("ensemble_summary.dat");
+    *p_file << "# replica\trank\tseed\tcells\tdelta_high\tdelta_low\ttransient\ttime_steps\twall_time\n";
+
+    // Accumulate sums and sums of squares of each statistic
+    const unsigned num_stats = 5;
+    std::vector<double> sums(num_stats, 0.0);
+    std::vector<double> sums_of_squares(num_stats, 0.0);
+
+    for (unsigned index=0; index<mSummaries.size(); index++)
+    {
+        const DeltaNotchSimulationSummary& r_summary = mSummaries[index];
+        *p_file << index << "\t" << mReplicaRanks[index] << "\t" << mReplicas[index].mSeed << "\t"
+                << r_summary.mNumCells << "\t" << r_summary.mNumDeltaHigh << "\t" << r_summary.mNumDeltaLow << "\t"
+                << r_summary.mNumTransient << "\t" << r_summary.mNumTimeSteps << "\t" << r_summary.mWallTime << "\n";
+
+        double stats[num_stats] = {(double)r_summary.mNumCells, (double)r_summary.mNumDeltaHigh,
+                                   (double)r_summary.mNumDeltaLow, (double)r_summary.mNumTransient, r_summary.mWallTime};
+        for (unsigned i=0; i<num_stats; i++)
+        {
+            sums[i] += stats[i];
+            sums_of_squares[i] += stats[i]*stats[i];
+        }
+    }
+
+    if (!mSummaries.empty())
+    {
+        const char* names[num_stats] = {"cells", "delta_high", "delta_low", "transient", "wall_time"};
+        double n = mSummaries.size();
+        *p_file << "# statistic\tmean\tstd_dev\n";
+        for (unsigned i=0; i<num_stats; i++)
+        {
+            double mean = sums[i]/n;
+            double variance = std::max(0.0, sums_of_squares[i]/n - mean*mean);
+            *p_file << "# " << names[i] << "\t" << mean << "\t" << sqrt(variance) << "\n";
+        }
+    }
+    p_file->close();
+}
+
+void DeltaNotchEnsembleRunner::DispatchReplicas(int numWorkers)
+{
+    // Each worker keeps asking until it is given an index past the last replica
+    unsigned num_replicas = mReplicas.size();
+    int num_finished_workers = 0;
+    while (num_finished_workers < numWorkers)
+    {
+        unsigned request;
+        MPI_Status status;
+        MPI_Recv(&request, 1, MPI_UNSIGNED, MPI_ANY_SOURCE, REPLICA_REQUEST_TAG, MPI_COMM_WORLD, &status);
+
+        unsigned index = mNextReplica;
+        if (mNextReplica < num_replicas)
+        {
+            mNextReplica++;
+        }
+        else
+        {
+            num_finished_workers++;
+        }
+        MPI_Send(&index, 1, MPI_UNSIGNED, status.MPI_SOURCE, REPLICA_ASSIGNMENT_TAG, MPI_COMM_WORLD);
+    }
+}
+
+unsigned DeltaNotchEnsembleRunner::ClaimNextReplica(int numProcs)
+{
+    if (numProcs == 1)
+    {
+        return (mNextReplica < mReplicas.size()) ? mNextReplica++ : mReplicas.size();
+    }
+
+    unsigned request = 0;
+    unsigned index;
+    MPI_Send(&request, 1, MPI_UNSIGNED, 0, REPLICA_REQUEST_TAG, MPI_COMM_WORLD);
+    MPI_Recv(&index, 1, MPI_UNSIGNED, 0, REPLICA_ASSIGNMENT_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    return index;
+}
@@ -0,0 +1,122 @@
+
+#ifndef DELTANOTCHENSEMBLERUNNER_HPP_
+#define DELTANOTCHENSEMBLERUNNER_HPP_
+
+#include <string>
+#include <vector>
+
+#include "DeltaNotchSimulationParameters.hpp"
+#include "DeltaNotchSimulationSummary.hpp"
+#include "PetscTools.hpp"
+
+/**
+ * Runs an ensemble of independent Delta/Notch simulations ("replicas") across MPI processes.
+ *
+ * Every process reads the same sweep file, so all processes agree on the list of replicas.
+ * Replicas are handed out dynamically: whenever a process finishes a replica it asks process 0
+ * for the next unclaimed replica index, so a process that draws short runs simply runs more of
+ * them and no process waits on a fixed share of the work. With more than one process, process 0
+ * only hands out replicas, so that it always answers requests promptly (an MPI implementation
+ * without asynchronous progress would otherwise hold every request until process 0 finished its
+ * own replica); run with one more process than the number of replicas to run at once. With a
+ * single process, that process runs every replica.
+ *
+ * Each process is isolated from the others (see PetscTools::IsolateProcesses()) while running
+ * replicas, so that Chaste's output and barriers behave as in a sequential run. At the end the
+ * summary of every replica is gathered on process 0, which writes a table of per-replica results
+ * and the ensemble mean and standard deviation of each statistic.
+ *
+ * Run with, e.g., mpirun -np 5 Exe_DeltaNotchEnsemble --sweep sweep.txt
+ */
+class DeltaNotchEnsembleRunner
+{
+private:
+
+    /** The parameters of each replica. */
+    std::vector<DeltaNotchSimulationParameters> mReplicas;
+
+    /** The summary of each replica; only filled on process 0 after Run(). */
+    std::vector<DeltaNotchSimulationSummary> mSummaries;
+
+    /** Which process ran each replica; only filled on process 0 after Run(). */
+    std::vector<unsigned> mReplicaRanks;
+
+    /** Directory, relative to where Chaste output is stored, in which replica output directories are created. */
+    std::string mOutputDirectory;
+
+    /** The next replica to run, when running on a single process. */
+    unsigned mNextReplica;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rOutputDirectory directory in which each replica's output directory is created
+     */
+    DeltaNotchEnsembleRunner(const std::string& rOutputDirectory);
+
+    /**
+     * Read replicas from a sweep file.
+     *
+     * Each line that is neither blank nor starts with '#' holds the command-line options of one
+     * set of parameters (see DeltaNotchSimulationParameters), e.g. "--mesh-width 10 --seed 3".
+     * Each set is run numRepeats times, with seeds seed, seed+1, ..., seed+numRepeats-1.
+     *
+     * @param rSweepFile path to the sweep file
+     * @param numRepeats number of replicas to run for each line
+     */
+    void ReadSweepFile(const std::string& rSweepFile, unsigned numRepeats);
+
+    /**
+     * Add a single replica. Its output directory is replaced by one below #mOutputDirectory.
+     *
+     * @param rParameters the replica's parameters
+     */
+    void AddReplica(const DeltaNotchSimulationParameters& rParameters);
+
+    /**
+     * @return the number of replicas
+     */
+    unsigned GetNumReplicas() const;
+
+    /**
+     * Run all replicas. Must be called on every process.
+     */
+    void Run();
+
+    /**
+     * @return the summary of each replica, in replica order (process 0 only)
+     */
+    const std::vector<DeltaNotchSimulationSummary>& rGetSummaries() const;
+
+    /**
+     * @return the process that ran each replica, in replica order (process 0 only)
+     */
+    const std::vector<unsigned>& rGetReplicaRanks() const;
+
+    /**
+     * Write the per-replica summaries and ensemble statistics to "ensemble_summary.dat" in
+     * #mOutputDirectory. Must be called on every process; only process 0 writes.
+     */
+    void WriteSummary();
+
+private:
+
+    /**
+     * Hand out replica indices, on process 0, until every other process has been told that none
+     * are left.
+     *
+     * @param numWorkers the number of processes running replicas
+     */
+    void DispatchReplicas(int numWorkers);
+
+    /**
+     * @return the index of the next replica to run, or GetNumReplicas() if none are left
+     *
+     * @param numProcs the number of processes
+     */
+    unsigned ClaimNextReplica(int numProcs);
+};
+
+#endif /*DELTANOTCHENSEMBLERUNNER_HPP_*/
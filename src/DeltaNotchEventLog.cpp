@@ -0,0 +1,219 @@
+
+#include "DeltaNotchEventLog.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+
+#include <boost/unordered_map.hpp>
+
+#include "DeltaPhenotypeFlags.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "Exception.hpp"
+#include "SimulationTime.hpp"
+#include "StemCellProliferativeType.hpp"
+#include "TransitCellProliferativeType.hpp"
+
+const uint32_t DeltaNotchEvent::NO_CELL;
+const uint8_t DeltaNotchEvent::NO_PHENOTYPE;
+
+namespace
+{
+    /** Magic number at the start of a log file. */
+    const char EVENT_LOG_MAGIC[4] = {'D', 'N', 'E', '1'};
+
+    /**
+     * @return an event with the given type and cell, at the current simulation time
+     *
+     * @param type the DeltaNotchEventType
+     * @param pCell the cell
+     */
+    DeltaNotchEvent MakeEvent(DeltaNotchEventType type, CellPtr pCell)
+    {
+        DeltaNotchEvent event;
+        event.mTime = SimulationTime::Instance()->GetTime();
+        event.mCellId = pCell->GetCellId();
+        event.mRelatedCellId = DeltaNotchEvent::NO_CELL;
+        event.mType = type;
+        event.mPhenotype = DeltaNotchEvent::NO_PHENOTYPE;
+        event.mPreviousPhenotype = DeltaNotchEvent::NO_PHENOTYPE;
+        event.mProliferativeType = DeltaNotchEventLog::GetProliferativeTypeCode(pCell);
+        event.mPadding = 0;
+        return event;
+    }
+}
+
+DeltaNotchEventLog::DeltaNotchEventLog(const std::string& rFileName, unsigned bufferSize)
+    : mBuffer(bufferSize),
+      mNumBuffered(0),
+      mNumEvents(0),
+      mNumFlushes(0)
+{
+    if (bufferSize == 0)
+    {
+        EXCEPTION("The event log buffer size must be positive");
+    }
+
+    mFile.open(rFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!mFile.is_open())
+    {
+        EXCEPTION("Could not open event log " + rFileName);
+    }
+    uint32_t record_size = sizeof(DeltaNotchEvent);
+    mFile.write(EVENT_LOG_MAGIC, sizeof(EVENT_LOG_MAGIC));
+    mFile.write(reinterpret_cast<const char*>(&record_size), sizeof(record_size));
+}
+
+DeltaNotchEventLog::~DeltaNotchEventLog()
+{
+    // As Flush(), but without throwing from a destructor
+    if (mNumBuffered > 0)
+    {
+        mFile.write(reinterpret_cast<const char*>(&mBuffer[0]), mNumBuffered*sizeof(DeltaNotchEvent));
+    }
+    mFile.close();
+}
+
+void DeltaNotchEventLog::RecordDivision(CellPtr pParentCell, CellPtr pDaughterCell)
+{
+    DeltaNotchEvent event = MakeEvent(EVENT_DIVISION, pDaughterCell);
+    event.mRelatedCellId = pParentCell->GetCellId();
+    event.mPhenotype = DeltaPhenotypeFlags::GetPhenotype(pParentCell);
+    Append(event);
+}
+
+void DeltaNotchEventLog::RecordDeath(CellPtr pCell)
+{
+    DeltaNotchEvent event = MakeEvent(EVENT_DEATH, pCell);
+    event.mPhenotype = DeltaPhenotypeFlags::GetPhenotype(pCell);
+    Append(event);
+}
+
+void DeltaNotchEventLog::RecordPhenotypeTransition(CellPtr pCell, unsigned previousPhenotype, unsigned phenotype)
+{
+    DeltaNotchEvent event = MakeEvent(EVENT_PHENOTYPE_TRANSITION, pCell);
+    event.mPreviousPhenotype = previousPhenotype;
+    event.mPhenotype = phenotype;
+    Append(event);
+}
+
+void DeltaNotchEventLog::Flush()
+{
+    if (mNumBuffered == 0)
+    {
+        return;
+    }
+    mFile.write(reinterpret_cast<const char*>(&mBuffer[0]), mNumBuffered*sizeof(DeltaNotchEvent));
+    mFile.flush();
+    if (!mFile.good())
+    {
+        EXCEPTION("Could not write to event log");
+    }
+    mNumBuffered = 0;
+    mNumFlushes++;
+}
+
+unsigned DeltaNotchEventLog::GetNumEvents() const
+{
+    return mNumEvents;
+}
+
+unsigned DeltaNotchEventLog::GetNumFlushes() const
+{
+    return mNumFlushes;
+}
+
+unsigned DeltaNotchEventLog::GetProliferativeTypeCode(CellPtr pCell)
+{
+    boost::shared_ptr<AbstractCellProperty> p_type = pCell->GetCellProliferativeType();
+    if (p_type->IsType<DifferentiatedCellProliferativeType>())
+    {
+        return DIFFERENTIATED;
+    }
+    if (p_type->IsType<StemCellProliferativeType>())
+    {
+        return STEM;
+    }
+    if (p_type->IsType<TransitCellProliferativeType>())
+    {
+        return TRANSIT;
+    }
+    return OTHER;
+}
+
+void DeltaNotchEventLog::ReadEvents(const std::string& rFileName, std::vector<DeltaNotchEvent>& rEvents)
+{
+    std::ifstream file(rFileName.c_str(), std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+        EXCEPTION("Could not open event log " + rFileName);
+    }
+
+    char magic[4];
+    uint32_t record_size = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&record_size), sizeof(record_size));
+    if (!file.good() || memcmp(magic, EVENT_LOG_MAGIC, sizeof(magic)) != 0)
+    {
+        EXCEPTION(rFileName + " is not a Delta/Notch event log");
+    }
+    if (record_size != sizeof(DeltaNotchEvent))
+    {
+        EXCEPTION(rFileName + " was written with a different event record layout");
+    }
+
+    file.seekg(0, std::ios::end);
+    std::streamoff data_size = static_cast<std::streamoff>(file.tellg()) - static_cast<std::streamoff>(sizeof(magic) + sizeof(record_size));
+    file.seekg(sizeof(magic) + sizeof(record_size), std::ios::beg);
+
+    // A log cut short by a crash may end in a partial record, which is ignored
+    rEvents.resize(data_size/sizeof(DeltaNotchEvent));
+    if (!rEvents.empty())
+    {
+        file.read(reinterpret_cast<char*>(&rEvents[0]), rEvents.size()*sizeof(DeltaNotchEvent));
+        if (!file.good())
+        {
+            EXCEPTION("Could not read event log " + rFileName);
+        }
+    }
+}
+
+void DeltaNotchEventLog::GetLineage(const std::vector<DeltaNotchEvent>& rEvents,
+                                    unsigned cellId,
+                                    std::vector<unsigned>& rAncestors,
+                                    std::vector<unsigned>& rDescendants)
+{
+    boost::unordered_map<unsigned, unsigned> parents;
+    boost::unordered_map<unsigned, std::vector<unsigned> > children;
+    for (unsigned i=0; i<rEvents.size(); i++)
+    {
+        if (rEvents[i].mType == EVENT_DIVISION)
+        {
+            parents[rEvents[i].mCellId] = rEvents[i].mRelatedCellId;
+            children[rEvents[i].mRelatedCellId].push_back(rEvents[i].mCellId);
+        }
+    }
+
+    rAncestors.clear();
+    boost::unordered_map<unsigned, unsigned>::const_iterator parent_iter = parents.find(cellId);
+    while (parent_iter != parents.end())
+    {
+        rAncestors.push_back(parent_iter->second);
+        parent_iter = parents.find(parent_iter->second);
+    }
+
+    // Cell ids increase with birth time, so sorting a breadth-first search gives the birth order
+    rDescendants.clear();
+    std::deque<unsigned> to_visit(1, cellId);
+    while (!to_visit.empty())
+    {
+        boost::unordered_map<unsigned, std::vector<unsigned> >::const_iterator child_iter = children.find(to_visit.front());
+        to_visit.pop_front();
+        if (child_iter != children.end())
+        {
+            rDescendants.insert(rDescendants.end(), child_iter->second.begin(), child_iter->second.end());
+            to_visit.insert(to_visit.end(), child_iter->second.begin(), child_iter->second.end());
+        }
+    }
+    std::sort(rDescendants.begin(), rDescendants.end());
+}
@@ -0,0 +1,223 @@
+
+#ifndef DELTANOTCHEVENTLOG_HPP_
+#define DELTANOTCHEVENTLOG_HPP_
+
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <boost/utility.hpp>
+
+#include "Cell.hpp"
+
+/**
+ * The kinds of event recorded in a DeltaNotchEventLog.
+ */
+typedef enum DeltaNotchEventType_
+{
+    EVENT_DIVISION = 0,
+    EVENT_DEATH = 1,
+    EVENT_PHENOTYPE_TRANSITION = 2
+} DeltaNotchEventType;
+
+/**
+ * One record of a DeltaNotchEventLog, as stored in the log file.
+ *
+ * The meaning of the fields depends on the event type:
+ *
+ *  - division: mCellId is the daughter cell, mRelatedCellId the parent cell, mPhenotype the
+ *    parent's Delta phenotype and mProliferativeType the daughter's proliferative type, as
+ *    chosen by MyCellCycleModel::InitialiseDaughterCell();
+ *
+ *  - death: mCellId is the cell removed and mPhenotype and mProliferativeType are its own;
+ *
+ *  - phenotype transition: mCellId is the cell, mPreviousPhenotype and mPhenotype its Delta
+ *    phenotype before and after, and mProliferativeType the type it was given for the new
+ *    phenotype. When a cell is labelled for the first time mPreviousPhenotype is NO_PHENOTYPE.
+ *
+ * Phenotypes are DeltaPhenotype values; proliferative types are the ProliferativeTypeCode values
+ * of DeltaNotchEventLog. Unused cell ids are NO_CELL.
+ */
+struct DeltaNotchEvent
+{
+    /** Simulation time of the event. */
+    double mTime;
+
+    /** Id of the cell the event happened to. */
+    uint32_t mCellId;
+
+    /** Id of the parent cell of a division, or NO_CELL. */
+    uint32_t mRelatedCellId;
+
+    /** The DeltaNotchEventType. */
+    uint8_t mType;
+
+    /** Delta phenotype, as described above. */
+    uint8_t mPhenotype;
+
+    /** Previous Delta phenotype of a transition, or NO_PHENOTYPE. */
+    uint8_t mPreviousPhenotype;
+
+    /** Proliferative type, as described above. */
+    uint8_t mProliferativeType;
+
+    /** Unused; keeps records 8-byte aligned in the file. */
+    uint32_t mPadding;
+
+    /** Value of the cell id fields when there is no such cell. */
+    static const uint32_t NO_CELL = 0xFFFFFFFFu;
+
+    /** Value of the phenotype fields when there is no phenotype. */
+    static const uint8_t NO_PHENOTYPE = 0xFFu;
+};
+
+/**
+ * An append-only log of cell divisions, deaths and Delta phenotype transitions, for reconstructing
+ * lineages and phenotype histories without per-frame output.
+ *
+ * Events are appended to a fixed-size in-memory buffer, and the buffer is written to the log file
+ * in one block when it fills, when Flush() is called and when the log is destroyed. The file
+ * starts with the four bytes "DNE1" and the size of a record (uint32), followed by the records
+ * as laid out in DeltaNotchEvent.
+ *
+ * Events are recorded from the places they happen: divisions and deaths by
+ * DeltaPhenotypeVertexBasedCellPopulation as cells are added and removed, and phenotype
+ * transitions by DeltaPhenotypeTrackingModifier (or DeltaPhenotypePolicyModifier). The log is
+ * usually owned by a DeltaNotchEventLogModifier, which hands it to the cell population for the
+ * duration of a solve; the phenotype modifiers take it from the population. Recording costs a
+ * single pointer test when no log is in use, and each simulation has its own log.
+ */
+class DeltaNotchEventLog : private boost::noncopyable
+{
+public:
+
+    /**
+     * Proliferative type codes used in DeltaNotchEvent::mProliferativeType.
+     */
+    typedef enum ProliferativeTypeCode_
+    {
+        DIFFERENTIATED = 0,
+        STEM = 1,
+        TRANSIT = 2,
+        OTHER = 3
+    } ProliferativeTypeCode;
+
+private:
+
+    /** The log file. */
+    std::ofstream mFile;
+
+    /** Events not yet written to the file. */
+    std::vector<DeltaNotchEvent> mBuffer;
+
+    /** Number of events in #mBuffer. */
+    unsigned mNumBuffered;
+
+    /** Total number of events recorded. */
+    unsigned mNumEvents;
+
+    /** Number of times #mBuffer has been written to the file. */
+    unsigned mNumFlushes;
+
+    /**
+     * Append an event to the buffer, writing the buffer to the file first if it is full.
+     *
+     * @param rEvent the event
+     */
+    void Append(const DeltaNotchEvent& rEvent)
+    {
+        if (mNumBuffered == mBuffer.size())
+        {
+            Flush();
+        }
+        mBuffer[mNumBuffered++] = rEvent;
+        mNumEvents++;
+    }
+
+public:
+
+    /**
+     * Constructor. Creates the log file.
+     *
+     * @param rFileName the full path of the log file
+     * @param bufferSize the number of events buffered in memory between writes (defaults to 65536)
+     */
+    DeltaNotchEventLog(const std::string& rFileName, unsigned bufferSize=65536);
+
+    /**
+     * Destructor. Writes any buffered events.
+     */
+    ~DeltaNotchEventLog();
+
+    /**
+     * Record the division of a cell.
+     *
+     * @param pParentCell the parent cell
+     * @param pDaughterCell the new daughter cell, whose proliferative type has been set
+     */
+    void RecordDivision(CellPtr pParentCell, CellPtr pDaughterCell);
+
+    /**
+     * Record the death of a cell. Deaths are recorded as dead cells are removed, at the start of the
+     * time step after the one in which they were killed, so the death of a cell removed by a T2 swap
+     * is given the time of the following step.
+     *
+     * @param pCell the cell, before it is removed from the population
+     */
+    void RecordDeath(CellPtr pCell);
+
+    /**
+     * Record a change of a cell's Delta phenotype.
+     *
+     * @param pCell the cell, whose proliferative type has been set for its new phenotype
+     * @param previousPhenotype the previous phenotype, or DeltaNotchEvent::NO_PHENOTYPE
+     * @param phenotype the new phenotype
+     */
+    void RecordPhenotypeTransition(CellPtr pCell, unsigned previousPhenotype, unsigned phenotype);
+
+    /**
+     * Write any buffered events to the log file.
+     */
+    void Flush();
+
+    /**
+     * @return the total number of events recorded
+     */
+    unsigned GetNumEvents() const;
+
+    /**
+     * @return the number of times the buffer has been written to the log file
+     */
+    unsigned GetNumFlushes() const;
+
+    /**
+     * @return the ProliferativeTypeCode of a cell
+     *
+     * @param pCell the cell
+     */
+    static unsigned GetProliferativeTypeCode(CellPtr pCell);
+
+    /**
+     * Read all the events in a log file.
+     *
+     * @param rFileName the log file
+     * @param rEvents filled with the events, in the order recorded
+     */
+    static void ReadEvents(const std::string& rFileName, std::vector<DeltaNotchEvent>& rEvents);
+
+    /**
+     * Find the ancestors and descendants of a cell from the division events of a log.
+     *
+     * @param rEvents the events
+     * @param cellId the cell
+     * @param rAncestors filled with the ids of the cell's parent, grandparent and so on, in that order
+     * @param rDescendants filled with the ids of the cell's descendants, in the order they were born
+     */
+    static void GetLineage(const std::vector<DeltaNotchEvent>& rEvents,
+                           unsigned cellId,
+                           std::vector<unsigned>& rAncestors,
+                           std::vector<unsigned>& rDescendants);
+};
+
+#endif /*DELTANOTCHEVENTLOG_HPP_*/
@@ -0,0 +1,117 @@
+
+#include "DeltaNotchEventLogModifier.hpp"
+
+#include "Exception.hpp"
+#include "OutputFileHandler.hpp"
+
+template<unsigned DIM>
+DeltaNotchEventLogModifier<DIM>::DeltaNotchEventLogModifier(const std::string& rFileName)
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mFileName(rFileName),
+      mBufferSize(65536),
+      mpCellPopulation(NULL),
+      mNumEvents(0)
+{
+    if (mFileName.empty())
+    {
+        EXCEPTION("The event log file name must not be empty");
+    }
+}
+
+template<unsigned DIM>
+DeltaNotchEventLogModifier<DIM>::~DeltaNotchEventLogModifier()
+{
+}
+
+template<unsigned DIM>
+unsigned DeltaNotchEventLogModifier<DIM>::GetBufferSize()
+{
+    return mBufferSize;
+}
+
+template<unsigned DIM>
+void DeltaNotchEventLogModifier<DIM>::SetBufferSize(unsigned bufferSize)
+{
+    if (bufferSize == 0)
+    {
+        EXCEPTION("The event log buffer size must be positive");
+    }
+    mBufferSize = bufferSize;
+}
+
+template<unsigned DIM>
+const std::string& DeltaNotchEventLogModifier<DIM>::rGetFullPath() const
+{
+    return mFullPath;
+}
+
+template<unsigned DIM>
+unsigned DeltaNotchEventLogModifier<DIM>::GetNumEvents()
+{
+    return mpLog ? mpLog->GetNumEvents() : mNumEvents;
+}
+
+template<unsigned DIM>
+void DeltaNotchEventLogModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+}
+
+template<unsigned DIM>
+void DeltaNotchEventLogModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    DeltaPhenotypeVertexBasedCellPopulation<DIM>* p_cell_population = dynamic_cast<DeltaPhenotypeVertexBasedCellPopulation<DIM>*>(&rCellPopulation);
+    if (p_cell_population == NULL)
+    {
+        EXCEPTION("DeltaNotchEventLogModifier is to be used with a DeltaPhenotypeVertexBasedCellPopulation only");
+    }
+
+    if (mFileName[0] == '/')
+    {
+        mFullPath = mFileName;
+    }
+    else
+    {
+        OutputFileHandler handler(outputDirectory, false);
+        mFullPath = handler.GetOutputDirectoryFullPath() + mFileName;
+    }
+
+    // Close any log left open by a simulation that threw, before opening the new one
+    p_cell_population->SetEventLog(NULL);
+    mpLog.reset();
+    mpLog.reset(new DeltaNotchEventLog(mFullPath, mBufferSize));
+    mNumEvents = 0;
+
+    mpCellPopulation = p_cell_population;
+    mpCellPopulation->SetEventLog(mpLog.get());
+}
+
+template<unsigned DIM>
+void DeltaNotchEventLogModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (mpCellPopulation)
+    {
+        mpCellPopulation->SetEventLog(NULL);
+        mpCellPopulation = NULL;
+    }
+    if (mpLog)
+    {
+        mpLog->Flush();
+        mNumEvents = mpLog->GetNumEvents();
+        mpLog.reset();
+    }
+}
+
+template<unsigned DIM>
+void DeltaNotchEventLogModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<EventLogFile>" << mFileName << "</EventLogFile>\n";
+    *rParamsFile << "\t\t\t<EventLogBufferSize>" << mBufferSize << "</EventLogBufferSize>\n";
+
+    // Next, call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class DeltaNotchEventLogModifier<1>;
+template class DeltaNotchEventLogModifier<2>;
+template class DeltaNotchEventLogModifier<3>;
@@ -0,0 +1,121 @@
+
+#ifndef DELTANOTCHEVENTLOGMODIFIER_HPP_
+#define DELTANOTCHEVENTLOGMODIFIER_HPP_
+
+#include <string>
+
+#include <boost/scoped_ptr.hpp>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "DeltaNotchEventLog.hpp"
+#include "DeltaPhenotypeVertexBasedCellPopulation.hpp"
+
+/**
+ * A modifier class that records cell divisions, deaths and Delta phenotype transitions in a
+ * DeltaNotchEventLog for the duration of a simulation.
+ *
+ * The log is created in SetupSolve(), handed to the cell population, which must be a
+ * DeltaPhenotypeVertexBasedCellPopulation, and closed in UpdateAtEndOfSolve(). Events are
+ * recorded by the classes in which they happen, not by this modifier: the population records
+ * divisions and deaths, and the phenotype modifiers take the log from the population to record
+ * phenotype transitions. This modifier must therefore be added to the simulation before
+ * DeltaPhenotypeTrackingModifier (or DeltaPhenotypeFusedModifier) for the initial phenotype of
+ * each cell to be logged. Use Exe_DeltaNotchEventLog to query the log.
+ */
+template<unsigned DIM>
+class DeltaNotchEventLogModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+private:
+
+    /**
+     * The log file. A relative path is taken relative to the simulation output directory.
+     */
+    std::string mFileName;
+
+    /** The full path of the log file, set in SetupSolve(). */
+    std::string mFullPath;
+
+    /** The number of events buffered in memory between writes of the log file. Defaults to 65536. */
+    unsigned mBufferSize;
+
+    /** The log, while the simulation is running. */
+    boost::scoped_ptr<DeltaNotchEventLog> mpLog;
+
+    /** The cell population recording events in #mpLog, while the simulation is running. */
+    DeltaPhenotypeVertexBasedCellPopulation<DIM>* mpCellPopulation;
+
+    /** Number of events recorded in the last completed simulation. */
+    unsigned mNumEvents;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rFileName the log file; a relative path is taken relative to the simulation output directory
+     */
+    DeltaNotchEventLogModifier(const std::string& rFileName="events.bin");
+
+    /**
+     * Destructor.
+     */
+    virtual ~DeltaNotchEventLogModifier();
+
+    /**
+     * @return #mBufferSize
+     */
+    unsigned GetBufferSize();
+
+    /**
+     * Set #mBufferSize.
+     *
+     * @param bufferSize the new value of #mBufferSize
+     */
+    void SetBufferSize(unsigned bufferSize);
+
+    /**
+     * @return the full path of the log file, once SetupSolve() has been called
+     */
+    const std::string& rGetFullPath() const;
+
+    /**
+     * @return the number of events recorded so far in the running simulation, or in the last one
+     */
+    unsigned GetNumEvents();
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method. Does nothing.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Resolves the path of the log file, creates the log and hands it to the cell population.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method.
+     *
+     * Takes the log back from the cell population, writes any buffered events and closes the log.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#endif /*DELTANOTCHEVENTLOGMODIFIER_HPP_*/
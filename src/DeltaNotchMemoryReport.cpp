@@ -0,0 +1,173 @@
+
+#include "DeltaNotchMemoryReport.hpp"
+
+#include <iomanip>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "AbstractOdeSrnModel.hpp"
+#include "CellData.hpp"
+#include "DeltaNotchOdeSystem.hpp"
+#include "DeltaNotchSrnModel.hpp"
+#include "Exception.hpp"
+#include "MyCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+/** Estimated size of a std::map or std::set tree node, excluding the value. */
+static const double TREE_NODE_OVERHEAD = 4*sizeof(void*);
+
+/** Estimated size of a boost::shared_ptr control block. */
+static const double SHARED_COUNT_SIZE = 2*sizeof(void*) + 2*sizeof(long);
+
+DeltaNotchMemoryReport::DeltaNotchMemoryReport()
+    : mNumCells(0),
+      mBytes(NUM_CATEGORIES, 0.0)
+{
+}
+
+void DeltaNotchMemoryReport::Account(AbstractCellPopulation<2>& rCellPopulation)
+{
+    mNumCells = 0;
+    mBytes.assign(NUM_CATEGORIES, 0.0);
+
+    for (AbstractCellPopulation<2>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        mNumCells++;
+        mBytes[CELLS] += sizeof(Cell) + SHARED_COUNT_SIZE;
+
+        // Each cell has its own CellData, held in its property collection
+        CellPropertyCollection& r_collection = cell_iter->rGetCellPropertyCollection();
+        std::vector<std::string> keys = cell_iter->GetCellData()->GetKeys();
+        mBytes[CELL_DATA] += sizeof(CellData) + SHARED_COUNT_SIZE + TREE_NODE_OVERHEAD + sizeof(boost::shared_ptr<AbstractCellProperty>);
+        for (unsigned i=0; i<keys.size(); i++)
+        {
+            mBytes[CELL_DATA] += TREE_NODE_OVERHEAD + sizeof(std::pair<const std::string, double>);
+            if (keys[i].size() > 15)
+            {
+                mBytes[CELL_DATA] += keys[i].size() + 1;
+            }
+        }
+
+        // The other properties are shared, so only count the collection entries
+        mBytes[PROPERTY_COLLECTIONS] += sizeof(CellPropertyCollection)
+            + (r_collection.GetSize() - 1)*(TREE_NODE_OVERHEAD + sizeof(boost::shared_ptr<AbstractCellProperty>));
+
+        // MyCellCycleModel also holds the cell's DeltaPhenotypeFlags
+        AbstractCellCycleModel* p_cell_cycle_model = cell_iter->GetCellCycleModel();
+        mBytes[CELL_CYCLE_MODELS] += dynamic_cast<MyCellCycleModel*>(p_cell_cycle_model) ? sizeof(MyCellCycleModel) : sizeof(AbstractCellCycleModel);
+
+        AbstractSrnModel* p_srn_model = cell_iter->GetSrnModel();
+        mBytes[SRN_MODELS] += dynamic_cast<DeltaNotchSrnModel*>(p_srn_model) ? sizeof(DeltaNotchSrnModel) : sizeof(AbstractSrnModel);
+        AbstractOdeSrnModel* p_ode_srn_model = dynamic_cast<AbstractOdeSrnModel*>(p_srn_model);
+        if (p_ode_srn_model && p_ode_srn_model->GetOdeSystem())
+        {
+            AbstractOdeSystem* p_ode_system = p_ode_srn_model->GetOdeSystem();
+            mBytes[SRN_MODELS] += sizeof(DeltaNotchOdeSystem)
+                + p_ode_system->rGetStateVariables().capacity()*sizeof(double)
+                + p_ode_system->GetNumberOfParameters()*sizeof(double);
+        }
+    }
+
+    VertexBasedCellPopulation<2>* p_vertex_population = dynamic_cast<VertexBasedCellPopulation<2>*>(&rCellPopulation);
+    if (p_vertex_population)
+    {
+        MutableVertexMesh<2,2>& r_mesh = p_vertex_population->rGetMesh();
+        for (VertexMesh<2,2>::VertexElementIterator elem_iter = r_mesh.GetElementIteratorBegin();
+             elem_iter != r_mesh.GetElementIteratorEnd();
+             ++elem_iter)
+        {
+            mBytes[MESH_ELEMENTS] += sizeof(VertexElement<2,2>) + sizeof(void*) + elem_iter->GetNumNodes()*sizeof(Node<2>*);
+        }
+    }
+
+    for (AbstractMesh<2,2>::NodeIterator node_iter = rCellPopulation.rGetMesh().GetNodeIteratorBegin();
+         node_iter != rCellPopulation.rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        mBytes[MESH_NODES] += sizeof(Node<2>) + sizeof(void*)
+            + node_iter->GetNumContainingElements()*(TREE_NODE_OVERHEAD + sizeof(unsigned));
+    }
+}
+
+void DeltaNotchMemoryReport::AccountModifier(const DeltaPhenotypeFusedModifier<2>& rModifier)
+{
+    mBytes[MODIFIER_ARRAYS] += rModifier.GetStorageBytes();
+}
+
+double DeltaNotchMemoryReport::GetBytes(Category category) const
+{
+    assert(category < NUM_CATEGORIES);
+    return mBytes[category];
+}
+
+double DeltaNotchMemoryReport::GetBytesPerCell() const
+{
+    double total = 0.0;
+    for (unsigned i=0; i<NUM_CATEGORIES; i++)
+    {
+        total += mBytes[i];
+    }
+    return mNumCells > 0 ? total/mNumCells : 0.0;
+}
+
+void DeltaNotchMemoryReport::Write(std::ostream& rStream) const
+{
+    rStream << "  " << std::setw(22) << std::left << "category" << std::right << std::setw(14) << "bytes"
+            << std::setw(12) << "bytes/cell" << "\n";
+    double total = 0.0;
+    for (unsigned i=0; i<NUM_CATEGORIES; i++)
+    {
+        total += mBytes[i];
+        rStream << "  " << std::setw(22) << std::left << GetCategoryName(static_cast<Category>(i)) << std::right
+                << std::setw(14) << std::fixed << std::setprecision(0) << mBytes[i]
+                << std::setw(12) << std::setprecision(1) << (mNumCells > 0 ? mBytes[i]/mNumCells : 0.0) << "\n";
+    }
+    rStream << "  " << std::setw(22) << std::left << "total" << std::right
+            << std::setw(14) << std::setprecision(0) << total
+            << std::setw(12) << std::setprecision(1) << GetBytesPerCell() << "\n";
+    rStream.unsetf(std::ios::fixed);
+    rStream << std::setprecision(6);
+}
+
+std::string DeltaNotchMemoryReport::GetCategoryName(Category category)
+{
+    switch (category)
+    {
+        case CELLS:
+            return "cells";
+        case CELL_DATA:
+            return "CellData entries";
+        case PROPERTY_COLLECTIONS:
+            return "property collections";
+        case CELL_CYCLE_MODELS:
+            return "cell-cycle models";
+        case SRN_MODELS:
+            return "SRN models";
+        case MESH_ELEMENTS:
+            return "mesh elements";
+        case MESH_NODES:
+            return "mesh nodes";
+        case MODIFIER_ARRAYS:
+            return "modifier arrays";
+        default:
+            NEVER_REACHED;
+    }
+    return "";
+}
+
+double DeltaNotchMemoryReport::GetHeapBytesInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#elif defined(__GLIBC__)
+    struct mallinfo info = mallinfo();
+    return (double)info.uordblks + (double)info.hblkhd;
+#else
+    return 0.0;
+#endif
+}
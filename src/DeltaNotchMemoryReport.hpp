@@ -0,0 +1,103 @@
+
+#ifndef DELTANOTCHMEMORYREPORT_HPP_
+#define DELTANOTCHMEMORYREPORT_HPP_
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "AbstractCellPopulation.hpp"
+#include "DeltaPhenotypeFusedModifier.hpp"
+
+/**
+ * An estimate of the memory used per cell by a 2D Delta/Notch cell population, broken down into
+ * cell objects, CellData entries, cell property collections, cell-cycle models (which hold the
+ * DeltaPhenotypeFlags), SRN models (including their ODE systems), mesh elements, mesh nodes and
+ * the arrays kept by modifiers between time steps.
+ *
+ * The estimates add up the sizes of the objects and of the containers' heap storage, assuming
+ * red-black tree nodes of four pointers for std::map and std::set entries; allocator overheads
+ * are not included, so compare with GetHeapBytesInUse() for the true total. Objects shared by
+ * many cells, such as cell properties other than CellData, are not counted.
+ */
+class DeltaNotchMemoryReport
+{
+public:
+
+    /** The categories of memory in the report. */
+    enum Category
+    {
+        CELLS = 0,
+        CELL_DATA,
+        PROPERTY_COLLECTIONS,
+        CELL_CYCLE_MODELS,
+        SRN_MODELS,
+        MESH_ELEMENTS,
+        MESH_NODES,
+        MODIFIER_ARRAYS,
+        NUM_CATEGORIES
+    };
+
+private:
+
+    /** Number of cells accounted for. */
+    unsigned mNumCells;
+
+    /** Estimated bytes used by each category. */
+    std::vector<double> mBytes;
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    DeltaNotchMemoryReport();
+
+    /**
+     * Estimate the memory used by a cell population, replacing any previous estimate.
+     *
+     * @param rCellPopulation the cell population
+     */
+    void Account(AbstractCellPopulation<2>& rCellPopulation);
+
+    /**
+     * Add the arrays kept by a fused modifier to the estimate made by Account().
+     *
+     * @param rModifier the modifier
+     */
+    void AccountModifier(const DeltaPhenotypeFusedModifier<2>& rModifier);
+
+    /**
+     * @return the estimated bytes used by a category
+     *
+     * @param category the category
+     */
+    double GetBytes(Category category) const;
+
+    /**
+     * @return the estimated total bytes used per cell
+     */
+    double GetBytesPerCell() const;
+
+    /**
+     * Write a table of bytes and bytes per cell for each category.
+     *
+     * @param rStream the stream to write to
+     */
+    void Write(std::ostream& rStream) const;
+
+    /**
+     * @return the name of a category
+     *
+     * @param category the category
+     */
+    static std::string GetCategoryName(Category category);
+
+    /**
+     * @return the number of bytes of heap memory currently allocated by this process,
+     * or 0 if this cannot be found on this platform
+     */
+    static double GetHeapBytesInUse();
+};
+
+#endif /*DELTANOTCHMEMORYREPORT_HPP_*/
@@ -0,0 +1,239 @@
+
+#include "DeltaNotchMetricsModifier.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h>
+
+#include "DeltaPhenotypeFlags.hpp"
+#include "Exception.hpp"
+#include "OutputFileHandler.hpp"
+#include "PetscTools.hpp"
+#include "SimulationTime.hpp"
+#include "Timer.hpp"
+#include "Warnings.hpp"
+
+template<unsigned DIM>
+DeltaNotchMetricsModifier<DIM>::DeltaNotchMetricsModifier(const std::string& rFileName)
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mFileName(rFileName),
+      mInterval(1.0),
+      mpPhenotypeModifier(NULL),
+      mNumTimeSteps(0),
+      mStartWallTime(0.0),
+      mLastWriteWallTime(0.0),
+      mLastWriteNumTimeSteps(0),
+      mNumWrites(0)
+{
+    if (mFileName.empty())
+    {
+        EXCEPTION("The metrics file name must not be empty");
+    }
+}
+
+template<unsigned DIM>
+DeltaNotchMetricsModifier<DIM>::~DeltaNotchMetricsModifier()
+{
+}
+
+template<unsigned DIM>
+double DeltaNotchMetricsModifier<DIM>::GetInterval()
+{
+    return mInterval;
+}
+
+template<unsigned DIM>
+void DeltaNotchMetricsModifier<DIM>::SetInterval(double interval)
+{
+    if (interval < 0.0)
+    {
+        EXCEPTION("The metrics interval must not be negative");
+    }
+    mInterval = interval;
+}
+
+template<unsigned DIM>
+void DeltaNotchMetricsModifier<DIM>::SetPhenotypeModifier(DeltaPhenotypeTrackingModifier<DIM>* pPhenotypeModifier)
+{
+    mpPhenotypeModifier = pPhenotypeModifier;
+}
+
+template<unsigned DIM>
+void DeltaNotchMetricsModifier<DIM>::SetScheduler(boost::shared_ptr<MultiRateModifierScheduler<DIM> > pScheduler)
+{
+    mpScheduler = pScheduler;
+}
+
+template<unsigned DIM>
+const std::string& DeltaNotchMetricsModifier<DIM>::rGetFullPath() const
+{
+    return mFullPath;
+}
+
+template<unsigned DIM>
+unsigned DeltaNotchMetricsModifier<DIM>::GetNumWrites()
+{
+    return mNumWrites;
+}
+
+template<unsigned DIM>
+void DeltaNotchMetricsModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    mNumTimeSteps++;
+    if (Timer::GetWallTime() - mLastWriteWallTime >= mInterval)
+    {
+        WriteMetrics(rCellPopulation, true);
+    }
+}
+
+template<unsigned DIM>
+void DeltaNotchMetricsModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    if (mFileName[0] == '/')
+    {
+        mFullPath = mFileName;
+
+        // An absolute path may be shared by the processes of an ensemble, so give each its own file
+        if (PetscTools::GetNumProcs() > 1)
+        {
+            std::stringstream rank_suffix;
+            rank_suffix << ".rank" << PetscTools::GetMyRank();
+            std::size_t name_start = mFullPath.rfind('/') + 1;
+            std::size_t extension_start = mFullPath.rfind('.');
+            if (extension_start == std::string::npos || extension_start <= name_start)
+            {
+                extension_start = mFullPath.size();
+            }
+            mFullPath.insert(extension_start, rank_suffix.str());
+        }
+    }
+    else
+    {
+        OutputFileHandler handler(outputDirectory, false);
+        mFullPath = handler.GetOutputDirectoryFullPath() + mFileName;
+    }
+
+    mNumTimeSteps = 0;
+    mNumWrites = 0;
+    mStartWallTime = Timer::GetWallTime();
+    mLastWriteWallTime = mStartWallTime;
+    mLastWriteNumTimeSteps = 0;
+    WriteMetrics(rCellPopulation, true);
+}
+
+template<unsigned DIM>
+void DeltaNotchMetricsModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    WriteMetrics(rCellPopulation, false);
+}
+
+template<unsigned DIM>
+void DeltaNotchMetricsModifier<DIM>::WriteMetrics(AbstractCellPopulation<DIM,DIM>& rCellPopulation, bool running)
+{
+    double now = Timer::GetWallTime();
+    double elapsed = now - mStartWallTime;
+    double interval = now - mLastWriteWallTime;
+    double steps_per_second = interval > 0.0 ? (mNumTimeSteps - mLastWriteNumTimeSteps)/interval : 0.0;
+    double mean_steps_per_second = elapsed > 0.0 ? mNumTimeSteps/elapsed : 0.0;
+
+    unsigned num_cells = 0;
+    unsigned num_phenotype[3] = {0, 0, 0};
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        num_cells++;
+        num_phenotype[DeltaPhenotypeFlags::GetPhenotype(*cell_iter)]++;
+    }
+
+    /*
+     * Write to a temporary file, named for this process so that processes sharing the stats file
+     * do not write to the same one, and rename it over the stats file, so readers never see a
+     * partial file. Metrics are not worth stopping a simulation for, so failures only warn.
+     */
+    std::stringstream temp_path_stream;
+    temp_path_stream << mFullPath << "." << getpid() << ".tmp";
+    std::string temp_path = temp_path_stream.str();
+    std::ofstream file(temp_path.c_str());
+    if (!file.is_open())
+    {
+        WARN_ONCE_ONLY("Could not open metrics file " + temp_path + "; metrics are not being written");
+        mLastWriteWallTime = now;
+        mLastWriteNumTimeSteps = mNumTimeSteps;
+        return;
+    }
+    file << std::setprecision(10);
+    file << "# HELP deltanotch_running Whether the simulation is still running.\n"
+         << "# TYPE deltanotch_running gauge\n"
+         << "deltanotch_running " << (running ? 1 : 0) << "\n"
+         << "# HELP deltanotch_simulated_time Current simulated time, in hours.\n"
+         << "# TYPE deltanotch_simulated_time gauge\n"
+         << "deltanotch_simulated_time " << SimulationTime::Instance()->GetTime() << "\n"
+         << "# HELP deltanotch_time_steps_total Time steps taken since the start of the simulation.\n"
+         << "# TYPE deltanotch_time_steps_total counter\n"
+         << "deltanotch_time_steps_total " << mNumTimeSteps << "\n"
+         << "# HELP deltanotch_wall_seconds_total Wall time since the start of the simulation.\n"
+         << "# TYPE deltanotch_wall_seconds_total counter\n"
+         << "deltanotch_wall_seconds_total " << elapsed << "\n"
+         << "# HELP deltanotch_steps_per_second Time steps per second of wall time since the last update.\n"
+         << "# TYPE deltanotch_steps_per_second gauge\n"
+         << "deltanotch_steps_per_second " << steps_per_second << "\n"
+         << "# HELP deltanotch_mean_steps_per_second Time steps per second of wall time since the start of the simulation.\n"
+         << "# TYPE deltanotch_mean_steps_per_second gauge\n"
+         << "deltanotch_mean_steps_per_second " << mean_steps_per_second << "\n"
+         << "# HELP deltanotch_cells Number of cells.\n"
+         << "# TYPE deltanotch_cells gauge\n"
+         << "deltanotch_cells " << num_cells << "\n"
+         << "# HELP deltanotch_phenotype_cells Number of cells of each Delta phenotype.\n"
+         << "# TYPE deltanotch_phenotype_cells gauge\n"
+         << "deltanotch_phenotype_cells{phenotype=\"high\"} " << num_phenotype[DELTA_HIGH] << "\n"
+         << "deltanotch_phenotype_cells{phenotype=\"low\"} " << num_phenotype[DELTA_LOW] << "\n"
+         << "deltanotch_phenotype_cells{phenotype=\"transient\"} " << num_phenotype[DELTA_TRANSIENT] << "\n";
+
+    if (mpPhenotypeModifier)
+    {
+        file << "# HELP deltanotch_phenotype_transitions_total Phenotype changes of labelled cells.\n"
+             << "# TYPE deltanotch_phenotype_transitions_total counter\n"
+             << "deltanotch_phenotype_transitions_total " << mpPhenotypeModifier->GetNumTransitions() << "\n";
+    }
+
+    if (mpScheduler)
+    {
+        file << "# HELP deltanotch_modifier_wall_seconds_total Wall time spent in each modifier's end of time step update.\n"
+             << "# TYPE deltanotch_modifier_wall_seconds_total counter\n";
+        for (unsigned i=0; i<mpScheduler->rGetModifiers().size(); i++)
+        {
+            file << "deltanotch_modifier_wall_seconds_total{index=\"" << i << "\",modifier=\""
+                 << mpScheduler->rGetModifiers()[i]->GetIdentifier() << "\"} "
+                 << mpScheduler->GetModifierWallTime(i) << "\n";
+        }
+    }
+    file.close();
+
+    mLastWriteWallTime = now;
+    mLastWriteNumTimeSteps = mNumTimeSteps;
+    if (file.fail() || std::rename(temp_path.c_str(), mFullPath.c_str()) != 0)
+    {
+        std::remove(temp_path.c_str());
+        WARN_ONCE_ONLY("Could not write metrics file " + mFullPath + "; metrics are not being written");
+        return;
+    }
+    mNumWrites++;
+}
+
+template<unsigned DIM>
+void DeltaNotchMetricsModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<MetricsFile>" << mFileName << "</MetricsFile>\n";
+    *rParamsFile << "\t\t\t<MetricsInterval>" << mInterval << "</MetricsInterval>\n";
+
+    // Next, call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class DeltaNotchMetricsModifier<1>;
+template class DeltaNotchMetricsModifier<2>;
+template class DeltaNotchMetricsModifier<3>;
@@ -0,0 +1,164 @@
+
+#ifndef DELTANOTCHMETRICSMODIFIER_HPP_
+#define DELTANOTCHMETRICSMODIFIER_HPP_
+
+#include <string>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "DeltaPhenotypeTrackingModifier.hpp"
+#include "MultiRateModifierScheduler.hpp"
+
+/**
+ * A modifier class that publishes live metrics of a running simulation in a stats file.
+ *
+ * At most once every #mInterval seconds of wall time, and at the end of the simulation, the
+ * file is rewritten with the current simulated time, the number of time steps taken, the
+ * steps per second since the last write and since the start, the number of cells of each
+ * Delta phenotype, the number of phenotype transitions counted by the phenotype modifier
+ * (if one is given) and the wall time spent in each modifier run by the scheduler (if one
+ * is given; the tutorial simulation always runs its modifiers in a scheduler when metrics are
+ * published, for this purpose). The file uses the Prometheus text exposition format, so it may be read by
+ * any local scraper, for example the node exporter's textfile collector, or simply by cat.
+ *
+ * Each write goes to a temporary file, named for the writing process, which is then renamed
+ * over the stats file, so a reader never sees a partly written file. If the file cannot be
+ * written, a warning is given and the simulation carries on. When running on more than one
+ * process, an absolute stats file name gets the process's rank before its extension, for
+ * example "metrics.rank2.prom", so that the processes of an ensemble do not overwrite each
+ * other's metrics; a relative name is already in each replica's own output directory.
+ * Between writes the only cost is a clock read per time step, so the modifier may be left on
+ * for long runs.
+ */
+template<unsigned DIM>
+class DeltaNotchMetricsModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+private:
+
+    /**
+     * The stats file. A relative path is taken relative to the simulation output directory.
+     */
+    std::string mFileName;
+
+    /** The full path of the stats file, including any rank suffix, set in SetupSolve(). */
+    std::string mFullPath;
+
+    /** Minimum wall time between writes of the stats file, in seconds. Defaults to 1. */
+    double mInterval;
+
+    /** The phenotype modifier whose transitions are reported, if any. Not owned. */
+    DeltaPhenotypeTrackingModifier<DIM>* mpPhenotypeModifier;
+
+    /** The scheduler whose modifier wall times are reported, if any. */
+    boost::shared_ptr<MultiRateModifierScheduler<DIM> > mpScheduler;
+
+    /** Number of time steps since the start of Solve(). */
+    unsigned mNumTimeSteps;
+
+    /** Wall time at the start of Solve(). */
+    double mStartWallTime;
+
+    /** Wall time of the last write of the stats file. */
+    double mLastWriteWallTime;
+
+    /** Value of #mNumTimeSteps at the last write of the stats file. */
+    unsigned mLastWriteNumTimeSteps;
+
+    /** Number of times the stats file has been written successfully. */
+    unsigned mNumWrites;
+
+    /**
+     * Rewrite the stats file.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param running whether the simulation is still running
+     */
+    void WriteMetrics(AbstractCellPopulation<DIM,DIM>& rCellPopulation, bool running);
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rFileName the stats file; a relative path is taken relative to the simulation output directory
+     */
+    DeltaNotchMetricsModifier(const std::string& rFileName="metrics.prom");
+
+    /**
+     * Destructor.
+     */
+    virtual ~DeltaNotchMetricsModifier();
+
+    /**
+     * @return #mInterval
+     */
+    double GetInterval();
+
+    /**
+     * Set #mInterval.
+     *
+     * @param interval the new value of #mInterval
+     */
+    void SetInterval(double interval);
+
+    /**
+     * Set #mpPhenotypeModifier.
+     *
+     * @param pPhenotypeModifier the phenotype modifier, which must outlive this modifier's use in a simulation
+     */
+    void SetPhenotypeModifier(DeltaPhenotypeTrackingModifier<DIM>* pPhenotypeModifier);
+
+    /**
+     * Set #mpScheduler.
+     *
+     * @param pScheduler the scheduler
+     */
+    void SetScheduler(boost::shared_ptr<MultiRateModifierScheduler<DIM> > pScheduler);
+
+    /**
+     * @return the full path of the stats file, once SetupSolve() has been called
+     */
+    const std::string& rGetFullPath() const;
+
+    /**
+     * @return #mNumWrites
+     */
+    unsigned GetNumWrites();
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Rewrites the stats file if #mInterval has passed since the last write.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Resolves the path of the stats file and writes the initial metrics.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method.
+     *
+     * Writes the final metrics.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#endif /*DELTANOTCHMETRICSMODIFIER_HPP_*/
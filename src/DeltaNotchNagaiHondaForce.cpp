@@ -0,0 +1,180 @@
+
+#include "DeltaNotchNagaiHondaForce.hpp"
+
+#include <cmath>
+
+#include "DeltaPhenotypeVertexBasedCellPopulation.hpp"
+#include "Exception.hpp"
+
+template<unsigned DIM>
+DeltaNotchNagaiHondaForce<DIM>::DeltaNotchNagaiHondaForce()
+    : NagaiHondaForce<DIM>()
+{
+}
+
+template<unsigned DIM>
+DeltaNotchNagaiHondaForce<DIM>::~DeltaNotchNagaiHondaForce()
+{
+}
+
+template<unsigned DIM>
+const std::vector<double>& DeltaNotchNagaiHondaForce<DIM>::rGetTargetAreas(VertexBasedCellPopulation<DIM>& rCellPopulation)
+{
+    unsigned num_elements = rCellPopulation.rGetMesh().GetNumAllElements();
+
+    DeltaPhenotypeVertexBasedCellPopulation<DIM>* p_population = dynamic_cast<DeltaPhenotypeVertexBasedCellPopulation<DIM>*>(&rCellPopulation);
+    if (p_population && p_population->AreElementTargetAreasCurrent())
+    {
+        return p_population->rGetElementTargetAreas();
+    }
+
+    mTargetAreas.resize(num_elements);
+    for (typename VertexMesh<DIM,DIM>::VertexElementIterator elem_iter = rCellPopulation.rGetMesh().GetElementIteratorBegin();
+         elem_iter != rCellPopulation.rGetMesh().GetElementIteratorEnd();
+         ++elem_iter)
+    {
+        unsigned elem_index = elem_iter->GetIndex();
+        try
+        {
+            mTargetAreas[elem_index] = rCellPopulation.GetCellUsingLocationIndex(elem_index)->GetCellData()->GetItem("target area");
+        }
+        catch (Exception&)
+        {
+            EXCEPTION("You need to add an AbstractTargetAreaModifier to the simulation in order to use NagaiHondaForce");
+        }
+    }
+    return mTargetAreas;
+}
+
+template<unsigned DIM>
+void DeltaNotchNagaiHondaForce<DIM>::AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    if (DIM != 2)
+    {
+        NagaiHondaForce<DIM>::AddForceContribution(rCellPopulation);
+        return;
+    }
+
+    VertexBasedCellPopulation<DIM>* p_cell_population = dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation);
+    if (p_cell_population == nullptr)
+    {
+        EXCEPTION("DeltaNotchNagaiHondaForce is to be used with a VertexBasedCellPopulation only");
+    }
+    MutableVertexMesh<DIM,DIM>& r_mesh = p_cell_population->rGetMesh();
+    unsigned num_nodes = r_mesh.GetNumAllNodes();
+    unsigned num_elements = r_mesh.GetNumAllElements();
+
+    const std::vector<double>& r_target_areas = rGetTargetAreas(*p_cell_population);
+
+    // Gather each element's node positions, relative to its first node, and its edge adhesion parameters
+    mElementOffsets.assign(num_elements + 1, 0);
+    mNodeIndices.clear();
+    mRelativeX.clear();
+    mRelativeY.clear();
+    mEdgeAdhesionParameters.clear();
+    for (unsigned elem_index=0; elem_index<num_elements; elem_index++)
+    {
+        mElementOffsets[elem_index] = mNodeIndices.size();
+        VertexElement<DIM,DIM>* p_element = r_mesh.GetElement(elem_index);
+        if (p_element->IsDeleted())
+        {
+            continue;
+        }
+
+        unsigned num_nodes_elem = p_element->GetNumNodes();
+        const c_vector<double, DIM>& r_first_location = p_element->GetNode(0)->rGetLocation();
+        for (unsigned local_index=0; local_index<num_nodes_elem; local_index++)
+        {
+            Node<DIM>* p_node = p_element->GetNode(local_index);
+            Node<DIM>* p_next_node = p_element->GetNode((local_index+1)%num_nodes_elem);
+
+            // Allow for periodic meshes
+            c_vector<double, DIM> relative_location = r_mesh.GetVectorFromAtoB(r_first_location, p_node->rGetLocation());
+            mNodeIndices.push_back(p_node->GetIndex());
+            mRelativeX.push_back(relative_location[0]);
+            mRelativeY.push_back(relative_location[1]);
+            mEdgeAdhesionParameters.push_back(this->GetAdhesionParameter(p_node, p_next_node, *p_cell_population));
+        }
+    }
+    mElementOffsets[num_elements] = mNodeIndices.size();
+
+    const double deformation_parameter = this->GetNagaiHondaDeformationEnergyParameter();
+    const double membrane_parameter = this->GetNagaiHondaMembraneSurfaceEnergyParameter();
+    const double* p_x = mRelativeX.empty() ? nullptr : &mRelativeX[0];
+    const double* p_y = mRelativeY.empty() ? nullptr : &mRelativeY[0];
+
+    mNodeForces.assign(2*num_nodes, 0.0);
+    for (unsigned elem_index=0; elem_index<num_elements; elem_index++)
+    {
+        const unsigned begin = mElementOffsets[elem_index];
+        const unsigned end = mElementOffsets[elem_index+1];
+        if (begin == end)
+        {
+            continue;
+        }
+        const unsigned last = end - 1;
+
+        // Signed area (by the shoelace formula) and perimeter
+        double twice_area = p_x[last]*p_y[begin] - p_x[begin]*p_y[last];
+        double perimeter = std::sqrt((p_x[begin]-p_x[last])*(p_x[begin]-p_x[last]) + (p_y[begin]-p_y[last])*(p_y[begin]-p_y[last]));
+        for (unsigned i=begin; i<last; i++)
+        {
+            double dx = p_x[i+1] - p_x[i];
+            double dy = p_y[i+1] - p_y[i];
+            twice_area += p_x[i]*p_y[i+1] - p_x[i+1]*p_y[i];
+            perimeter += std::sqrt(dx*dx + dy*dy);
+        }
+
+        // The area is unsigned, as in VertexMesh::GetVolumeOfElement(), so that an element whose nodes run
+        // clockwise gets the same deformation force as from NagaiHondaForce
+        double target_area = r_target_areas[elem_index];
+        double area_coefficient = 2.0*deformation_parameter*(fabs(0.5*twice_area) - target_area);
+        double perimeter_coefficient = 2.0*membrane_parameter*(perimeter - 2.0*std::sqrt(M_PI*target_area));
+
+        for (unsigned i=begin; i<end; i++)
+        {
+            unsigned previous = (i == begin) ? last : i - 1;
+            unsigned next = (i == last) ? begin : i + 1;
+            unsigned node_index = mNodeIndices[i];
+
+            // Deformation: minus the area coefficient times the area gradient at this node
+            mNodeForces[2*node_index] -= 0.5*area_coefficient*(p_y[next] - p_y[previous]);
+            mNodeForces[2*node_index+1] += 0.5*area_coefficient*(p_x[next] - p_x[previous]);
+
+            // Adhesion and membrane surface tension pull this node along the edge to the next node, and that node back
+            double dx = p_x[next] - p_x[i];
+            double dy = p_y[next] - p_y[i];
+            double edge_coefficient = (mEdgeAdhesionParameters[i] + perimeter_coefficient)/std::sqrt(dx*dx + dy*dy);
+            unsigned next_node_index = mNodeIndices[next];
+            mNodeForces[2*node_index] += edge_coefficient*dx;
+            mNodeForces[2*node_index+1] += edge_coefficient*dy;
+            mNodeForces[2*next_node_index] -= edge_coefficient*dx;
+            mNodeForces[2*next_node_index+1] -= edge_coefficient*dy;
+        }
+    }
+
+    for (unsigned node_index=0; node_index<num_nodes; node_index++)
+    {
+        Node<DIM>* p_node = r_mesh.GetNode(node_index);
+        if (p_node->IsDeleted())
+        {
+            continue;
+        }
+        c_vector<double, DIM> force_on_node;
+        force_on_node[0] = mNodeForces[2*node_index];
+        force_on_node[1] = mNodeForces[2*node_index+1];
+        p_node->AddAppliedForceContribution(force_on_node);
+    }
+}
+
+template<unsigned DIM>
+void DeltaNotchNagaiHondaForce<DIM>::OutputForceParameters(out_stream& rParamsFile)
+{
+    // No parameters to output, so just call method on direct parent class
+    NagaiHondaForce<DIM>::OutputForceParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class DeltaNotchNagaiHondaForce<1>;
+template class DeltaNotchNagaiHondaForce<2>;
+template class DeltaNotchNagaiHondaForce<3>;
@@ -0,0 +1,92 @@
+
+#ifndef DELTANOTCHNAGAIHONDAFORCE_HPP_
+#define DELTANOTCHNAGAIHONDAFORCE_HPP_
+
+#include <vector>
+
+#include "NagaiHondaForce.hpp"
+
+/**
+ * A NagaiHondaForce that computes the same forces with fewer lookups, for 2D vertex-based populations.
+ *
+ * NagaiHondaForce looks up each element's cell and its "target area" CellData item, computes element
+ * areas and perimeters through the mesh, and then, for every node, searches each containing element for
+ * the node's local index and intersects node element sets to find the adhesion parameter of each edge.
+ *
+ * This force instead:
+ *
+ *  - reads target areas from the contiguous per-element array kept by DeltaPhenotypeVertexBasedCellPopulation
+ *    and filled by DeltaPhenotypeTargetAreaModifier, falling back to CellData only when the array is not
+ *    current (for example just after a division or death);
+ *
+ *  - gathers node positions, relative to each element's first node, into flat arrays and computes each
+ *    element's area, perimeter, and so its deformation and membrane surface tension coefficients, in a
+ *    single pass over elements whose inner loops run over contiguous memory;
+ *
+ *  - adds each edge's contribution to the forces on its two nodes directly, calling GetAdhesionParameter()
+ *    once per edge of each element rather than twice.
+ *
+ * The forces match those of NagaiHondaForce up to rounding. In 1D and 3D NagaiHondaForce is used unchanged.
+ */
+template<unsigned DIM>
+class DeltaNotchNagaiHondaForce : public NagaiHondaForce<DIM>
+{
+private:
+
+    /** Offset of each element's first node in the flat arrays below, with one extra entry at the end. */
+    std::vector<unsigned> mElementOffsets;
+
+    /** Global index of each node of each element. */
+    std::vector<unsigned> mNodeIndices;
+
+    /** x coordinate of each node of each element, relative to the element's first node. */
+    std::vector<double> mRelativeX;
+
+    /** y coordinate of each node of each element, relative to the element's first node. */
+    std::vector<double> mRelativeY;
+
+    /** Adhesion parameter of the edge from each node of each element to the next. */
+    std::vector<double> mEdgeAdhesionParameters;
+
+    /** Target area of each element, when read from CellData. */
+    std::vector<double> mTargetAreas;
+
+    /** Force on each node, stored as x0, y0, x1, y1, ... */
+    std::vector<double> mNodeForces;
+
+    /**
+     * @return the target area of each element: the population's per-element array if it is current,
+     * or otherwise #mTargetAreas, filled from CellData
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    const std::vector<double>& rGetTargetAreas(VertexBasedCellPopulation<DIM>& rCellPopulation);
+
+public:
+
+    /**
+     * Constructor.
+     */
+    DeltaNotchNagaiHondaForce();
+
+    /**
+     * Destructor.
+     */
+    virtual ~DeltaNotchNagaiHondaForce();
+
+    /**
+     * Overridden AddForceContribution() method.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Overridden OutputForceParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputForceParameters(out_stream& rParamsFile);
+};
+
+#endif /*DELTANOTCHNAGAIHONDAFORCE_HPP_*/
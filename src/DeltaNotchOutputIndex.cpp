@@ -0,0 +1,663 @@
+
+#include "DeltaNotchOutputIndex.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdint.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Exception.hpp"
+#include "QuantisedCellDataReader.hpp"
+
+/** The first four bytes of an index file. */
+static const char INDEX_MAGIC[4] = {'D', 'N', 'I', '1'};
+
+/** Size of the index file header in bytes. */
+static const std::size_t INDEX_HEADER_SIZE = 56;
+
+/** Size of a line table entry in bytes. */
+static const std::size_t INDEX_FRAME_SIZE = 40;
+
+/** A cell entry of the index: a cell ID and the offset of its record within the line. */
+struct DeltaNotchOutputIndexEntry
+{
+    /** The cell ID. */
+    uint32_t mCellId;
+
+    /** The offset of the cell's record from the start of the line. */
+    uint32_t mRecordOffset;
+
+    /**
+     * @return whether this entry's cell ID is less than another's
+     *
+     * @param rOther the other entry
+     */
+    bool operator<(const DeltaNotchOutputIndexEntry& rOther) const
+    {
+        return mCellId < rOther.mCellId;
+    }
+};
+
+/**
+ * Memory-map a file read-only.
+ *
+ * @param rPath the file
+ * @param rSize set to the size of the file
+ * @param pStat if not NULL, filled with the file's status
+ * @return the mapping, or NULL if the file is empty
+ */
+static const char* MapFile(const std::string& rPath, std::size_t& rSize, struct stat* pStat=NULL)
+{
+    int fd = open(rPath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        EXCEPTION("Could not open " + rPath);
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0)
+    {
+        close(fd);
+        EXCEPTION("Could not stat " + rPath);
+    }
+    if (pStat)
+    {
+        *pStat = file_stat;
+    }
+    rSize = file_stat.st_size;
+    if (rSize == 0)
+    {
+        close(fd);
+        return NULL;
+    }
+    void* p_map = mmap(NULL, rSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p_map == MAP_FAILED)
+    {
+        EXCEPTION("Could not memory-map " + rPath);
+    }
+    return static_cast<const char*>(p_map);
+}
+
+/**
+ * Find the whitespace-separated tokens of a line after its leading time.
+ *
+ * @param pLine the start of the line
+ * @param pLineEnd the end of the line
+ * @param rTime set to the time
+ * @param rTokens vector to fill with the start of each token
+ * @return false if the line is blank, so has no time
+ */
+static bool TokeniseLine(const char* pLine, const char* pLineEnd, double& rTime, std::vector<const char*>& rTokens)
+{
+    rTokens.clear();
+    bool first = true;
+    const char* p = pLine;
+    while (p < pLineEnd)
+    {
+        while (p < pLineEnd && (*p == ' ' || *p == '\t' || *p == '\r'))
+        {
+            p++;
+        }
+        if (p == pLineEnd)
+        {
+            break;
+        }
+        if (first)
+        {
+            rTime = atof(std::string(p, std::find(p, pLineEnd, '\t')).c_str());
+            first = false;
+        }
+        else
+        {
+            rTokens.push_back(p);
+        }
+        while (p < pLineEnd && *p != ' ' && *p != '\t' && *p != '\r')
+        {
+            p++;
+        }
+    }
+    return !first;
+}
+
+/**
+ * @return the numerical value of the token starting at a given position
+ *
+ * @param pToken the start of the token
+ * @param pLineEnd the end of its line
+ */
+static double ParseToken(const char* pToken, const char* pLineEnd)
+{
+    char buffer[64];
+    unsigned length = 0;
+    while (pToken + length < pLineEnd && length < sizeof(buffer) - 1
+           && pToken[length] != ' ' && pToken[length] != '\t' && pToken[length] != '\r')
+    {
+        buffer[length] = pToken[length];
+        length++;
+    }
+    buffer[length] = '\0';
+    return strtod(buffer, NULL);
+}
+
+/**
+ * Write a value to a binary stream.
+ *
+ * @param rStream the stream
+ * @param value the value
+ */
+template<typename T>
+static void WriteBinary(std::ofstream& rStream, T value)
+{
+    rStream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * @return a value read from memory
+ *
+ * @param p the location of the value
+ */
+template<typename T>
+static T ReadBinary(const char* p)
+{
+    T value;
+    memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+/** A line table entry of the index, as built. */
+struct DeltaNotchOutputIndexFrame
+{
+    /** The time of the line. */
+    double mTime;
+
+    /** The offset of the line from the start of the output file. */
+    uint64_t mLineOffset;
+
+    /** The length of the line in bytes. */
+    uint64_t mLineLength;
+
+    /** The index of the line's first cell entry. */
+    uint64_t mFirstEntry;
+
+    /** The number of records in the line. */
+    uint32_t mNumRecords;
+
+    /** The number of cell entries of the line. */
+    uint32_t mNumEntries;
+};
+
+/**
+ * Open an index file for writing, and leave room for its header.
+ *
+ * @param rPath the index file
+ * @param rIndex the stream to open
+ */
+static void OpenIndexFile(const std::string& rPath, std::ofstream& rIndex)
+{
+    rIndex.open(rPath.c_str(), std::ios::binary | std::ios::trunc);
+    if (!rIndex.is_open())
+    {
+        EXCEPTION("Could not open " + rPath + " for writing");
+    }
+
+    // The header is rewritten once the number of lines and entries are known
+    for (std::size_t i=0; i<INDEX_HEADER_SIZE; i++)
+    {
+        rIndex.put('\0');
+    }
+}
+
+/**
+ * Write the line table and header of an index file, whose cell entries have been written, and close it.
+ *
+ * @param rIndex the index file
+ * @param rFrames the line table
+ * @param numEntries the number of cell entries written
+ * @param rLayout the layout to record, with an ID column of -1 if there are no cell IDs
+ * @param rDataStat the status of the output file
+ */
+static void WriteFrameTableAndHeader(std::ofstream& rIndex,
+                                     const std::vector<DeltaNotchOutputIndexFrame>& rFrames,
+                                     uint64_t numEntries,
+                                     const DeltaNotchOutputLayout& rLayout,
+                                     const struct stat& rDataStat)
+{
+    uint64_t frames_offset = INDEX_HEADER_SIZE + numEntries*sizeof(DeltaNotchOutputIndexEntry);
+    for (unsigned i=0; i<rFrames.size(); i++)
+    {
+        WriteBinary<double>(rIndex, rFrames[i].mTime);
+        WriteBinary<uint64_t>(rIndex, rFrames[i].mLineOffset);
+        WriteBinary<uint64_t>(rIndex, rFrames[i].mLineLength);
+        WriteBinary<uint64_t>(rIndex, rFrames[i].mFirstEntry);
+        WriteBinary<uint32_t>(rIndex, rFrames[i].mNumRecords);
+        WriteBinary<uint32_t>(rIndex, rFrames[i].mNumEntries);
+    }
+
+    rIndex.seekp(0);
+    rIndex.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    WriteBinary<uint32_t>(rIndex, rLayout.mStride);
+    WriteBinary<int32_t>(rIndex, rLayout.mIdColumn);
+    WriteBinary<uint32_t>(rIndex, rLayout.mValueColumn);
+    WriteBinary<uint64_t>(rIndex, rDataStat.st_size);
+    WriteBinary<int64_t>(rIndex, rDataStat.st_mtime);
+    WriteBinary<uint64_t>(rIndex, rFrames.size());
+    WriteBinary<uint64_t>(rIndex, numEntries);
+    WriteBinary<uint64_t>(rIndex, frames_offset);
+    rIndex.close();
+}
+
+/**
+ * Build the index of a file written by a quantised cell writer. Each frame is indexed as a line
+ * whose records are its stored values, two bytes each, with the frame's own cell IDs.
+ *
+ * @param rDataFile the output file
+ * @param rIndexFile the index file to write
+ */
+static void BuildQuantised(const std::string& rDataFile, const std::string& rIndexFile)
+{
+    QuantisedCellDataReader reader(rDataFile);
+    struct stat data_stat;
+    if (stat(rDataFile.c_str(), &data_stat) != 0)
+    {
+        EXCEPTION("Could not stat " + rDataFile);
+    }
+
+    std::ofstream index;
+    OpenIndexFile(rIndexFile, index);
+
+    std::vector<DeltaNotchOutputIndexFrame> frames(reader.GetNumFrames());
+    std::vector<DeltaNotchOutputIndexEntry> entries;
+    std::vector<unsigned> cell_ids;
+    std::vector<double> values;
+    uint64_t num_entries = 0;
+    for (unsigned frame=0; frame<reader.GetNumFrames(); frame++)
+    {
+        reader.GetFrame(frame, cell_ids, values);
+        frames[frame].mTime = reader.GetTime(frame);
+        frames[frame].mLineOffset = reader.GetValuesOffset(frame);
+        frames[frame].mLineLength = cell_ids.size()*sizeof(int16_t);
+        frames[frame].mFirstEntry = num_entries;
+        frames[frame].mNumRecords = cell_ids.size();
+        frames[frame].mNumEntries = cell_ids.size();
+
+        entries.resize(cell_ids.size());
+        for (unsigned i=0; i<cell_ids.size(); i++)
+        {
+            entries[i].mCellId = cell_ids[i];
+            entries[i].mRecordOffset = i*sizeof(int16_t);
+        }
+        std::sort(entries.begin(), entries.end());
+        for (unsigned i=0; i<entries.size(); i++)
+        {
+            WriteBinary<uint32_t>(index, entries[i].mCellId);
+            WriteBinary<uint32_t>(index, entries[i].mRecordOffset);
+        }
+        num_entries += entries.size();
+    }
+
+    WriteFrameTableAndHeader(index, frames, num_entries, DeltaNotchOutputLayout(1, 0, 0), data_stat);
+}
+
+DeltaNotchOutputIndex::DeltaNotchOutputIndex(const std::string& rDataFile, const std::string& rIndexFile)
+    : mpData(NULL),
+      mDataSize(0),
+      mpIndex(NULL),
+      mIndexSize(0),
+      mNumFrames(0),
+      mIsQuantised(false),
+      mQuantisedScale(1.0)
+{
+    struct stat data_stat;
+    mpData = MapFile(rDataFile, mDataSize, &data_stat);
+    try
+    {
+        if (QuantisedCellDataReader::IsQuantisedFile(rDataFile))
+        {
+            // The scale follows the four-byte magic number
+            mIsQuantised = true;
+            mQuantisedScale = ReadBinary<double>(mpData + 4);
+        }
+        mpIndex = MapFile(rIndexFile, mIndexSize);
+        if (mIndexSize < INDEX_HEADER_SIZE || memcmp(mpIndex, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0)
+        {
+            EXCEPTION(rIndexFile + " is not an output index");
+        }
+        if (ReadBinary<uint64_t>(mpIndex + 16) != (uint64_t)data_stat.st_size
+            || ReadBinary<int64_t>(mpIndex + 24) != (int64_t)data_stat.st_mtime)
+        {
+            EXCEPTION(rIndexFile + " is out of date; rebuild it from " + rDataFile);
+        }
+        mLayout = DeltaNotchOutputLayout(ReadBinary<uint32_t>(mpIndex + 4), ReadBinary<int32_t>(mpIndex + 8), ReadBinary<uint32_t>(mpIndex + 12));
+        mNumFrames = ReadBinary<uint64_t>(mpIndex + 32);
+        uint64_t num_entries = ReadBinary<uint64_t>(mpIndex + 40);
+        uint64_t frames_offset = ReadBinary<uint64_t>(mpIndex + 48);
+        if (frames_offset != INDEX_HEADER_SIZE + num_entries*sizeof(DeltaNotchOutputIndexEntry)
+            || mIndexSize != frames_offset + mNumFrames*INDEX_FRAME_SIZE)
+        {
+            EXCEPTION(rIndexFile + " is truncated");
+        }
+    }
+    catch (Exception&)
+    {
+        Unmap();
+        throw;
+    }
+}
+
+DeltaNotchOutputIndex::~DeltaNotchOutputIndex()
+{
+    Unmap();
+}
+
+void DeltaNotchOutputIndex::Unmap()
+{
+    if (mpData)
+    {
+        munmap(const_cast<char*>(mpData), mDataSize);
+        mpData = NULL;
+    }
+    if (mpIndex)
+    {
+        munmap(const_cast<char*>(mpIndex), mIndexSize);
+        mpIndex = NULL;
+    }
+}
+
+void DeltaNotchOutputIndex::Build(const std::string& rDataFile,
+                                  const std::string& rIndexFile,
+                                  const DeltaNotchOutputLayout& rLayout,
+                                  const std::string& rIdFile,
+                                  const DeltaNotchOutputLayout& rIdLayout)
+{
+    if (QuantisedCellDataReader::IsQuantisedFile(rDataFile))
+    {
+        BuildQuantised(rDataFile, rIndexFile);
+        return;
+    }
+    if (rLayout.mStride > 0 && (rLayout.mValueColumn >= rLayout.mStride || rLayout.mIdColumn >= (int)rLayout.mStride))
+    {
+        EXCEPTION("Output layout columns must lie within the stride");
+    }
+    if (!rIdFile.empty() && (rIdLayout.mStride == 0 || rIdLayout.mIdColumn < 0 || rIdLayout.mIdColumn >= (int)rIdLayout.mStride))
+    {
+        EXCEPTION("The layout of the cell ID file must have an ID column");
+    }
+
+    std::size_t data_size = 0;
+    struct stat data_stat;
+    const char* p_data = MapFile(rDataFile, data_size, &data_stat);
+    std::size_t id_size = 0;
+    const char* p_ids = NULL;
+    if (!rIdFile.empty())
+    {
+        p_ids = MapFile(rIdFile, id_size);
+    }
+
+    bool has_ids = rLayout.mStride > 0 && (rLayout.mIdColumn >= 0 || p_ids != NULL);
+    int32_t id_column = p_ids ? rIdLayout.mIdColumn : rLayout.mIdColumn;
+
+    std::ofstream index;
+    OpenIndexFile(rIndexFile, index);
+
+    std::vector<DeltaNotchOutputIndexFrame> frames;
+    std::vector<DeltaNotchOutputIndexEntry> entries;
+    std::vector<const char*> tokens;
+    std::vector<const char*> id_tokens;
+    uint64_t num_entries = 0;
+
+    const char* p_data_end = p_data + data_size;
+    const char* p_id_line = p_ids;
+    const char* p_ids_end = p_ids + id_size;
+    for (const char* p_line = p_data; p_line < p_data_end; )
+    {
+        const char* p_line_end = std::find(p_line, p_data_end, '\n');
+
+        // Blank lines, such as a trailing one, are not output times
+        DeltaNotchOutputIndexFrame frame;
+        frame.mTime = 0.0;
+        if (!TokeniseLine(p_line, p_line_end, frame.mTime, tokens))
+        {
+            p_line = p_line_end + 1;
+            continue;
+        }
+        frame.mLineOffset = p_line - p_data;
+        frame.mLineLength = p_line_end - p_line;
+        frame.mFirstEntry = num_entries;
+        frame.mNumRecords = (rLayout.mStride == 0) ? 1 : tokens.size()/rLayout.mStride;
+        frame.mNumEntries = 0;
+        if (frame.mLineLength > std::numeric_limits<uint32_t>::max())
+        {
+            EXCEPTION("Lines of " + rDataFile + " are too long to index");
+        }
+
+        if (has_ids)
+        {
+            // Take cell IDs from the file itself, or from the matching line of the companion file
+            const std::vector<const char*>* p_id_tokens = &tokens;
+            const char* p_id_tokens_end = p_line_end;
+            unsigned id_stride = rLayout.mStride;
+            if (p_ids)
+            {
+                const char* p_id_line_end = p_id_line;
+                double id_time = 0.0;
+                bool found_id_line = false;
+                while (!found_id_line)
+                {
+                    if (p_id_line >= p_ids_end)
+                    {
+                        EXCEPTION(rIdFile + " has fewer lines than " + rDataFile);
+                    }
+                    p_id_line_end = std::find(p_id_line, p_ids_end, '\n');
+                    found_id_line = TokeniseLine(p_id_line, p_id_line_end, id_time, id_tokens);
+                    if (!found_id_line)
+                    {
+                        p_id_line = p_id_line_end + 1;
+                    }
+                }
+                if (id_tokens.size()/rIdLayout.mStride != frame.mNumRecords)
+                {
+                    EXCEPTION(rIdFile + " does not have the same cells as " + rDataFile);
+                }
+                p_id_tokens = &id_tokens;
+                p_id_tokens_end = p_id_line_end;
+                id_stride = rIdLayout.mStride;
+                p_id_line = p_id_line_end + 1;
+            }
+
+            entries.resize(frame.mNumRecords);
+            for (unsigned record=0; record<frame.mNumRecords; record++)
+            {
+                entries[record].mCellId = (uint32_t) ParseToken((*p_id_tokens)[record*id_stride + id_column], p_id_tokens_end);
+                entries[record].mRecordOffset = tokens[record*rLayout.mStride] - p_line;
+            }
+            std::sort(entries.begin(), entries.end());
+            for (unsigned record=0; record<frame.mNumRecords; record++)
+            {
+                WriteBinary<uint32_t>(index, entries[record].mCellId);
+                WriteBinary<uint32_t>(index, entries[record].mRecordOffset);
+            }
+            frame.mNumEntries = frame.mNumRecords;
+            num_entries += frame.mNumEntries;
+        }
+
+        frames.push_back(frame);
+        p_line = p_line_end + 1;
+    }
+
+    DeltaNotchOutputLayout index_layout(rLayout.mStride, has_ids ? (rLayout.mIdColumn >= 0 ? rLayout.mIdColumn : -2) : -1, rLayout.mValueColumn);
+    WriteFrameTableAndHeader(index, frames, num_entries, index_layout, data_stat);
+
+    if (p_data)
+    {
+        munmap(const_cast<char*>(p_data), data_size);
+    }
+    if (p_ids)
+    {
+        munmap(const_cast<char*>(p_ids), id_size);
+    }
+}
+
+DeltaNotchOutputLayout DeltaNotchOutputIndex::GetDefaultLayout(const std::string& rFileName, unsigned spaceDim)
+{
+    std::string extension = rFileName.substr(std::min(rFileName.size(), rFileName.rfind('.')));
+    if (extension == ".vizcellphenotype")
+    {
+        return DeltaNotchOutputLayout(1, -1, 0);
+    }
+    if (extension == ".vizcellages" || extension == ".vizcellvolumes")
+    {
+        return DeltaNotchOutputLayout(3 + spaceDim, 1, 2 + spaceDim);
+    }
+    if (extension == ".q16")
+    {
+        return DeltaNotchOutputLayout(1, 0, 0);
+    }
+    return DeltaNotchOutputLayout(0, -1, 0);
+}
+
+const DeltaNotchOutputLayout& DeltaNotchOutputIndex::rGetLayout() const
+{
+    return mLayout;
+}
+
+unsigned DeltaNotchOutputIndex::GetNumFrames() const
+{
+    return mNumFrames;
+}
+
+const char* DeltaNotchOutputIndex::GetFrameRecord(unsigned frame) const
+{
+    assert(frame < mNumFrames);
+    return mpIndex + mIndexSize - (mNumFrames - frame)*INDEX_FRAME_SIZE;
+}
+
+double DeltaNotchOutputIndex::GetTime(unsigned frame) const
+{
+    return ReadBinary<double>(GetFrameRecord(frame));
+}
+
+unsigned DeltaNotchOutputIndex::FindFrame(double time) const
+{
+    // Output times increase down the file, so binary search
+    unsigned low = 0;
+    unsigned high = mNumFrames;
+    while (high - low > 1)
+    {
+        unsigned middle = (low + high)/2;
+        if (GetTime(middle) <= time)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+bool DeltaNotchOutputIndex::HasCellIds() const
+{
+    return mLayout.mIdColumn != -1;
+}
+
+double DeltaNotchOutputIndex::ParseValue(const char* pRecord, const char* pLineEnd) const
+{
+    if (mIsQuantised)
+    {
+        return ReadBinary<int16_t>(pRecord)/mQuantisedScale;
+    }
+
+    const char* p = pRecord;
+    for (unsigned column=0; column<mLayout.mValueColumn; column++)
+    {
+        while (p < pLineEnd && *p != ' ' && *p != '\t')
+        {
+            p++;
+        }
+        while (p < pLineEnd && (*p == ' ' || *p == '\t'))
+        {
+            p++;
+        }
+    }
+    return ParseToken(p, pLineEnd);
+}
+
+void DeltaNotchOutputIndex::GetTimeSlice(unsigned frame, std::vector<double>& rValues, std::vector<unsigned>* pCellIds) const
+{
+    const char* p_frame = GetFrameRecord(frame);
+    const char* p_line = mpData + ReadBinary<uint64_t>(p_frame + 8);
+    const char* p_line_end = p_line + ReadBinary<uint64_t>(p_frame + 16);
+    uint64_t first_entry = ReadBinary<uint64_t>(p_frame + 24);
+    uint32_t num_entries = ReadBinary<uint32_t>(p_frame + 36);
+
+    rValues.clear();
+    if (pCellIds)
+    {
+        pCellIds->clear();
+    }
+
+    if (HasCellIds())
+    {
+        const DeltaNotchOutputIndexEntry* p_entries =
+            reinterpret_cast<const DeltaNotchOutputIndexEntry*>(mpIndex + INDEX_HEADER_SIZE) + first_entry;
+        rValues.reserve(num_entries);
+        for (uint32_t i=0; i<num_entries; i++)
+        {
+            rValues.push_back(ParseValue(p_line + p_entries[i].mRecordOffset, p_line_end));
+            if (pCellIds)
+            {
+                pCellIds->push_back(p_entries[i].mCellId);
+            }
+        }
+        return;
+    }
+
+    double time;
+    std::vector<const char*> tokens;
+    TokeniseLine(p_line, p_line_end, time, tokens);
+    for (unsigned i=0; i<tokens.size(); i++)
+    {
+        if (mLayout.mStride == 0 || i%mLayout.mStride == mLayout.mValueColumn)
+        {
+            rValues.push_back(ParseToken(tokens[i], p_line_end));
+        }
+    }
+}
+
+void DeltaNotchOutputIndex::GetTrajectory(unsigned cellId, std::vector<double>& rTimes, std::vector<double>& rValues) const
+{
+    if (!HasCellIds())
+    {
+        EXCEPTION("This output index has no cell IDs, so trajectories cannot be queried");
+    }
+
+    rTimes.clear();
+    rValues.clear();
+    const DeltaNotchOutputIndexEntry* p_all_entries = reinterpret_cast<const DeltaNotchOutputIndexEntry*>(mpIndex + INDEX_HEADER_SIZE);
+    DeltaNotchOutputIndexEntry key;
+    key.mCellId = cellId;
+    key.mRecordOffset = 0;
+    for (unsigned frame=0; frame<mNumFrames; frame++)
+    {
+        const char* p_frame = GetFrameRecord(frame);
+        const DeltaNotchOutputIndexEntry* p_begin = p_all_entries + ReadBinary<uint64_t>(p_frame + 24);
+        const DeltaNotchOutputIndexEntry* p_end = p_begin + ReadBinary<uint32_t>(p_frame + 36);
+        const DeltaNotchOutputIndexEntry* p_entry = std::lower_bound(p_begin, p_end, key);
+        if (p_entry != p_end && p_entry->mCellId == cellId)
+        {
+            const char* p_line = mpData + ReadBinary<uint64_t>(p_frame + 8);
+            const char* p_line_end = p_line + ReadBinary<uint64_t>(p_frame + 16);
+            rTimes.push_back(ReadBinary<double>(p_frame));
+            rValues.push_back(ParseValue(p_line + p_entry->mRecordOffset, p_line_end));
+        }
+    }
+}
@@ -0,0 +1,211 @@
+
+#ifndef DELTANOTCHOUTPUTINDEX_HPP_
+#define DELTANOTCHOUTPUTINDEX_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * The layout of the records in a line of a text output file written by a cell writer or a
+ * cell population count writer. Each line is a time, a tab, then whitespace-separated values.
+ */
+struct DeltaNotchOutputLayout
+{
+    /** Number of values per cell, or 0 if the whole line is a single record (count writers). */
+    unsigned mStride;
+
+    /** Column of the cell ID within a cell's record, or -1 if the file has no cell IDs. */
+    int mIdColumn;
+
+    /** Column of the value of interest within a record. */
+    unsigned mValueColumn;
+
+    /**
+     * Constructor.
+     *
+     * @param stride number of values per cell, or 0 if the whole line is a single record
+     * @param idColumn column of the cell ID within a record, or -1 if there is none
+     * @param valueColumn column of the value of interest within a record
+     */
+    DeltaNotchOutputLayout(unsigned stride=1, int idColumn=-1, unsigned valueColumn=0)
+        : mStride(stride),
+          mIdColumn(idColumn),
+          mValueColumn(valueColumn)
+    {
+    }
+};
+
+/**
+ * A time and cell index over an output file of this project, for fast time-slice and
+ * per-cell trajectory queries without re-reading the file line by line.
+ *
+ * The index is built once with Build(), which scans the output file and writes a binary index
+ * file. It holds the byte offset and time of every line and, if cell IDs are known, for every
+ * line the offset of each cell's record sorted by cell ID. Cell IDs come either from a column of
+ * the file itself (as for results.vizcellages, which writes location index, cell ID, centroid and
+ * age) or, for files such as results.vizcellphenotype that write only values, from a companion
+ * file written in the same cell order at the same times.
+ *
+ * The packed binary files of the quantised cell writers (".q16", see AbstractQuantisedCellWriter)
+ * are recognised by their header and indexed with QuantisedCellDataReader. Each frame there plays
+ * the part of a line, with the frame's own cell IDs, and values are decoded as they are read.
+ *
+ * Queries memory-map the output and index files, so a time slice reads only the bytes of one
+ * line and a trajectory reads one record per line, found by binary search. An index records the
+ * size and modification time of the file it was built from, and is refused if the file changes.
+ *
+ * The index file holds "DNI1", the layout (stride, ID column and value column, as uint32, int32
+ * and uint32, with an ID column of -2 if the IDs came from a companion file), the size and modification time of the output file (uint64, int64), the number of
+ * lines and of cell entries and the offset of the line table (uint64 each); then the cell entries,
+ * each a cell ID and record offset within its line (uint32 each), sorted by cell ID within each
+ * line; then the line table, each a time (double), line offset, line length and first cell entry
+ * (uint64 each), and number of records and cell entries (uint32 each).
+ */
+class DeltaNotchOutputIndex
+{
+private:
+
+    /** The memory-mapped output file. */
+    const char* mpData;
+
+    /** Size of the output file in bytes. */
+    std::size_t mDataSize;
+
+    /** The memory-mapped index file. */
+    const char* mpIndex;
+
+    /** Size of the index file in bytes. */
+    std::size_t mIndexSize;
+
+    /** The layout of the output file. */
+    DeltaNotchOutputLayout mLayout;
+
+    /** Number of lines (output times) in the output file. */
+    unsigned mNumFrames;
+
+    /** Whether the output file was written by a quantised cell writer. */
+    bool mIsQuantised;
+
+    /** The scale of the output file, if it was written by a quantised cell writer. */
+    double mQuantisedScale;
+
+    /**
+     * Unmap the output and index files.
+     */
+    void Unmap();
+
+    /**
+     * @return the start of the line table entry for a line
+     *
+     * @param frame the line index
+     */
+    const char* GetFrameRecord(unsigned frame) const;
+
+    /**
+     * Parse the value of interest of a record, or decode it if the output file is quantised.
+     *
+     * @param pRecord the start of the record
+     * @param pLineEnd the end of its line
+     * @return the value
+     */
+    double ParseValue(const char* pRecord, const char* pLineEnd) const;
+
+public:
+
+    /**
+     * Open an output file and its index for queries.
+     *
+     * Throws an exception if either cannot be mapped, or if the index is not for this file as it now is.
+     *
+     * @param rDataFile the output file
+     * @param rIndexFile the index file
+     */
+    DeltaNotchOutputIndex(const std::string& rDataFile, const std::string& rIndexFile);
+
+    /**
+     * Destructor. Unmaps the files.
+     */
+    ~DeltaNotchOutputIndex();
+
+    /**
+     * Build the index of an output file. Blank lines, in the output file or the companion file,
+     * are skipped. If the output file was written by a quantised cell writer, the layout and
+     * companion file are ignored, since each frame holds its own cell IDs.
+     *
+     * @param rDataFile the output file
+     * @param rIndexFile the index file to write
+     * @param rLayout the layout of the output file
+     * @param rIdFile a companion file giving the cell IDs, in the same cell order, if the output file has none
+     *     (defaults to empty)
+     * @param rIdLayout the layout of the companion file (defaults to that of results.vizcellages in 2D)
+     */
+    static void Build(const std::string& rDataFile,
+                      const std::string& rIndexFile,
+                      const DeltaNotchOutputLayout& rLayout,
+                      const std::string& rIdFile="",
+                      const DeltaNotchOutputLayout& rIdLayout=DeltaNotchOutputLayout(5, 1, 4));
+
+    /**
+     * @return the layout of the files written by this project's writers and Chaste's cell writers,
+     * judged by file name: ".vizcellphenotype" files have one value per cell; ".vizcellages" and
+     * ".vizcellvolumes" files have location index, cell ID, centroid and value; ".q16" files have a
+     * cell ID and value per cell; other files are taken to be count writer outputs, with one record per line
+     *
+     * @param rFileName the output file name
+     * @param spaceDim the spatial dimension of the simulation (defaults to 2)
+     */
+    static DeltaNotchOutputLayout GetDefaultLayout(const std::string& rFileName, unsigned spaceDim=2);
+
+    /**
+     * @return the layout of the output file
+     */
+    const DeltaNotchOutputLayout& rGetLayout() const;
+
+    /**
+     * @return the number of lines (output times) in the output file
+     */
+    unsigned GetNumFrames() const;
+
+    /**
+     * @return the time of a line
+     *
+     * @param frame the line index
+     */
+    double GetTime(unsigned frame) const;
+
+    /**
+     * @return the index of the last line whose time does not exceed a given time, or 0 if there is none
+     *
+     * @param time the time
+     */
+    unsigned FindFrame(double time) const;
+
+    /**
+     * @return whether the index has cell IDs, so trajectories may be queried
+     */
+    bool HasCellIds() const;
+
+    /**
+     * Get the values of interest of every record in a line. If the index has cell IDs the values
+     * are in order of cell ID; otherwise they are in the order written.
+     *
+     * @param frame the line index
+     * @param rValues vector to fill with the values
+     * @param pCellIds if not NULL and the index has cell IDs, vector to fill with the cell IDs
+     */
+    void GetTimeSlice(unsigned frame, std::vector<double>& rValues, std::vector<unsigned>* pCellIds=NULL) const;
+
+    /**
+     * Get the value of interest of one cell at every time at which it appears.
+     *
+     * Throws an exception if the index has no cell IDs.
+     *
+     * @param cellId the cell ID
+     * @param rTimes vector to fill with the times
+     * @param rValues vector to fill with the values
+     */
+    void GetTrajectory(unsigned cellId, std::vector<double>& rTimes, std::vector<double>& rValues) const;
+};
+
+#endif /*DELTANOTCHOUTPUTINDEX_HPP_*/
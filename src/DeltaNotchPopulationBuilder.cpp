@@ -0,0 +1,265 @@
+
+#include "DeltaNotchPopulationBuilder.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "DeltaNotchSrnModel.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "Exception.hpp"
+#include "MyCellCycleModel.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "SmartPointers.hpp"
+#include "Warnings.hpp"
+#include "WildTypeCellMutationState.hpp"
+
+/** The first four bytes of a mesh cache file. */
+static const char MESH_CACHE_MAGIC[4] = {'D', 'N', 'M', '1'};
+
+DeltaNotchPopulationBuilder::DeltaNotchPopulationBuilder(const std::string& rMeshCacheDirectory)
+    : mMeshCacheDirectory(rMeshCacheDirectory),
+      mLastMeshWasCached(false)
+{
+}
+
+MutableVertexMesh<2,2>* DeltaNotchPopulationBuilder::BuildHoneycombMesh(unsigned width, unsigned height)
+{
+    mpGenerator.reset();
+    mpCachedMesh.reset();
+    mLastMeshWasCached = false;
+
+    std::string cache_path;
+    if (!mMeshCacheDirectory.empty())
+    {
+        cache_path = GetCacheFilePath(width, height);
+        if (ReadMeshCache(cache_path, width, height))
+        {
+            mLastMeshWasCached = true;
+            return mpCachedMesh.get();
+        }
+    }
+
+    mpGenerator.reset(new HoneycombVertexMeshGenerator(width, height));
+    MutableVertexMesh<2,2>* p_mesh = mpGenerator->GetMesh();
+    if (!cache_path.empty())
+    {
+        WriteMeshCache(cache_path, width, height, *p_mesh);
+    }
+    return p_mesh;
+}
+
+bool DeltaNotchPopulationBuilder::GetLastMeshWasCached() const
+{
+    return mLastMeshWasCached;
+}
+
+void DeltaNotchPopulationBuilder::CreateCells(unsigned numCells, std::vector<CellPtr>& rCells) const
+{
+    MAKE_PTR(WildTypeCellMutationState, p_state);
+    MAKE_PTR(DifferentiatedCellProliferativeType, p_diff_type);
+
+    // Draw all random numbers first, in the order cells created one at a time would draw them
+    std::vector<double> random_numbers(3*numCells);
+    RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+    for (unsigned i=0; i<random_numbers.size(); i++)
+    {
+        random_numbers[i] = p_gen->ranf();
+    }
+
+    rCells.reserve(rCells.size() + numCells);
+    std::vector<double> initial_conditions(2);
+    for (unsigned cell_index=0; cell_index<numCells; cell_index++)
+    {
+        MyCellCycleModel* p_cc_model = new MyCellCycleModel();
+        p_cc_model->SetDimension(2);
+
+        initial_conditions[0] = random_numbers[3*cell_index];
+        initial_conditions[1] = random_numbers[3*cell_index + 1];
+        DeltaNotchSrnModel* p_srn_model = new DeltaNotchSrnModel();
+        p_srn_model->SetInitialConditions(initial_conditions);
+
+        CellPtr p_cell(new Cell(p_state, p_cc_model, p_srn_model));
+        p_cell->SetCellProliferativeType(p_diff_type);
+        p_cell->SetBirthTime(-random_numbers[3*cell_index + 2] * 12.0);
+        rCells.push_back(p_cell);
+    }
+}
+
+std::string DeltaNotchPopulationBuilder::GetCacheFilePath(unsigned width, unsigned height) const
+{
+    std::stringstream path;
+    path << mMeshCacheDirectory;
+    if (*mMeshCacheDirectory.rbegin() != '/')
+    {
+        path << "/";
+    }
+    path << "honeycomb_" << width << "x" << height << ".bin";
+    return path.str();
+}
+
+bool DeltaNotchPopulationBuilder::ReadMeshCache(const std::string& rPath, unsigned width, unsigned height)
+{
+    std::ifstream file(rPath.c_str(), std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    // Every count read from the file is checked against the bytes left, so a corrupt count cannot cause a huge allocation
+    file.seekg(0, std::ios::end);
+    std::streamoff bytes_left = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    char magic[4];
+    uint32_t header[3];
+    file.read(magic, 4);
+    file.read(reinterpret_cast<char*>(header), 3*sizeof(uint32_t));
+    bytes_left -= 4 + 3*sizeof(uint32_t);
+    if (!file || !std::equal(magic, magic + 4, MESH_CACHE_MAGIC) || header[0] != width || header[1] != height)
+    {
+        return false;
+    }
+
+    const std::streamoff node_size = 2*sizeof(double) + sizeof(uint8_t);
+    uint32_t num_nodes = header[2];
+    if (static_cast<std::streamoff>(num_nodes) > bytes_left/node_size)
+    {
+        return false;
+    }
+    bytes_left -= num_nodes*node_size;
+
+    std::vector<Node<2>*> nodes;
+    nodes.reserve(num_nodes);
+    for (unsigned node_index=0; node_index<num_nodes && file; node_index++)
+    {
+        double location[2];
+        uint8_t is_boundary_node;
+        file.read(reinterpret_cast<char*>(location), 2*sizeof(double));
+        file.read(reinterpret_cast<char*>(&is_boundary_node), sizeof(uint8_t));
+        nodes.push_back(new Node<2>(node_index, is_boundary_node != 0, location[0], location[1]));
+    }
+
+    uint32_t num_elements = 0;
+    file.read(reinterpret_cast<char*>(&num_elements), sizeof(uint32_t));
+    bytes_left -= sizeof(uint32_t);
+
+    // Each element takes at least its node count
+    bool is_corrupt = !file || static_cast<std::streamoff>(num_elements) > bytes_left/static_cast<std::streamoff>(sizeof(uint32_t));
+    std::vector<VertexElement<2,2>*> elements;
+    if (!is_corrupt)
+    {
+        elements.reserve(num_elements);
+    }
+    std::vector<uint32_t> node_indices;
+    std::vector<Node<2>*> element_nodes;
+    for (unsigned elem_index=0; elem_index<num_elements && !is_corrupt; elem_index++)
+    {
+        uint32_t num_element_nodes;
+        file.read(reinterpret_cast<char*>(&num_element_nodes), sizeof(uint32_t));
+        bytes_left -= sizeof(uint32_t);
+
+        // A vertex element is a polygon, so needs at least three nodes
+        if (!file || num_element_nodes < 3
+            || static_cast<std::streamoff>(num_element_nodes) > bytes_left/static_cast<std::streamoff>(sizeof(uint32_t)))
+        {
+            is_corrupt = true;
+            break;
+        }
+        node_indices.resize(num_element_nodes);
+        file.read(reinterpret_cast<char*>(node_indices.data()), num_element_nodes*sizeof(uint32_t));
+        bytes_left -= num_element_nodes*sizeof(uint32_t);
+
+        element_nodes.clear();
+        for (unsigned i=0; i<num_element_nodes; i++)
+        {
+            if (node_indices[i] >= num_nodes)
+            {
+                is_corrupt = true;
+                break;
+            }
+            element_nodes.push_back(nodes[node_indices[i]]);
+        }
+        if (!file || is_corrupt)
+        {
+            is_corrupt = true;
+            break;
+        }
+        elements.push_back(new VertexElement<2,2>(elem_index, element_nodes));
+    }
+
+    if (is_corrupt || !file)
+    {
+        for (unsigned i=0; i<elements.size(); i++)
+        {
+            delete elements[i];
+        }
+        for (unsigned i=0; i<nodes.size(); i++)
+        {
+            delete nodes[i];
+        }
+        // A truncated or corrupt cache file is rebuilt
+        return false;
+    }
+
+    mpCachedMesh.reset(new MutableVertexMesh<2,2>(nodes, elements));
+    return true;
+}
+
+void DeltaNotchPopulationBuilder::WriteMeshCache(const std::string& rPath, unsigned width, unsigned height, MutableVertexMesh<2,2>& rMesh) const
+{
+    /*
+     * The cache only saves time, so a simulation goes ahead without it. Write to a temporary
+     * file, named for this process so that processes building the same mesh do not write to the
+     * same one, and rename it into place, so readers never see a partial file.
+     */
+    std::stringstream temp_path_stream;
+    temp_path_stream << rPath << "." << getpid() << ".tmp";
+    std::string temp_path = temp_path_stream.str();
+    std::ofstream file(temp_path.c_str(), std::ios::binary);
+    if (!file.is_open())
+    {
+        WARNING("Could not open mesh cache file " + temp_path + "; the mesh will not be cached");
+        return;
+    }
+
+    uint32_t header[3] = {width, height, rMesh.GetNumNodes()};
+    file.write(MESH_CACHE_MAGIC, 4);
+    file.write(reinterpret_cast<const char*>(header), 3*sizeof(uint32_t));
+    for (unsigned node_index=0; node_index<rMesh.GetNumNodes(); node_index++)
+    {
+        Node<2>* p_node = rMesh.GetNode(node_index);
+        const c_vector<double, 2>& r_location = p_node->rGetLocation();
+        double location[2] = {r_location[0], r_location[1]};
+        uint8_t is_boundary_node = p_node->IsBoundaryNode();
+        file.write(reinterpret_cast<const char*>(location), 2*sizeof(double));
+        file.write(reinterpret_cast<const char*>(&is_boundary_node), sizeof(uint8_t));
+    }
+
+    uint32_t num_elements = rMesh.GetNumElements();
+    file.write(reinterpret_cast<const char*>(&num_elements), sizeof(uint32_t));
+    std::vector<uint32_t> node_indices;
+    for (unsigned elem_index=0; elem_index<num_elements; elem_index++)
+    {
+        VertexElement<2,2>* p_element = rMesh.GetElement(elem_index);
+        uint32_t num_element_nodes = p_element->GetNumNodes();
+        node_indices.resize(num_element_nodes);
+        for (unsigned i=0; i<num_element_nodes; i++)
+        {
+            node_indices[i] = p_element->GetNodeGlobalIndex(i);
+        }
+        file.write(reinterpret_cast<const char*>(&num_element_nodes), sizeof(uint32_t));
+        file.write(reinterpret_cast<const char*>(node_indices.data()), num_element_nodes*sizeof(uint32_t));
+    }
+
+    file.close();
+    if (file.fail() || std::rename(temp_path.c_str(), rPath.c_str()) != 0)
+    {
+        // Do not leave a partial file behind
+        std::remove(temp_path.c_str());
+        WARNING("Could not write mesh cache file " + rPath + "; the mesh will not be cached");
+    }
+}
@@ -0,0 +1,113 @@
+
+#ifndef DELTANOTCHPOPULATIONBUILDER_HPP_
+#define DELTANOTCHPOPULATIONBUILDER_HPP_
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "Cell.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "MutableVertexMesh.hpp"
+
+/**
+ * Builds the honeycomb vertex mesh and Delta/Notch cells of the tutorial simulations quickly
+ * for large tissues.
+ *
+ * Meshes may be cached: if a cache directory is given, the first time a mesh of a given size
+ * is built it is saved there as a binary file "honeycomb_<width>x<height>.bin", and later builds
+ * of the same size read that file instead of running HoneycombVertexMeshGenerator. The file holds
+ * "DNM1", the width and height (uint32), the number of nodes (uint32), each node's x and y (double)
+ * and boundary flag (uint8), the number of elements (uint32), then for each element its number
+ * of nodes (uint32) and their indices (uint32).
+ *
+ * Cells are created in one batch: the random initial conditions and birth times of all cells are
+ * drawn first, in the same order as cells created one at a time would draw them, so that results
+ * are unchanged, and the cell vector is reserved before the cells are constructed.
+ *
+ * The builder owns the mesh it returns, so must outlive any cell population that uses the mesh.
+ */
+class DeltaNotchPopulationBuilder
+{
+private:
+
+    /** Directory in which meshes are cached, or empty for no caching. */
+    std::string mMeshCacheDirectory;
+
+    /** The generator of the last mesh built without the cache, if any. */
+    boost::shared_ptr<HoneycombVertexMeshGenerator> mpGenerator;
+
+    /** The last mesh read from the cache, if any. */
+    boost::shared_ptr<MutableVertexMesh<2,2> > mpCachedMesh;
+
+    /** Whether the last mesh built was read from the cache. */
+    bool mLastMeshWasCached;
+
+    /**
+     * @return the path of the cache file for a mesh of a given size
+     *
+     * @param width number of elements across the mesh
+     * @param height number of elements up the mesh
+     */
+    std::string GetCacheFilePath(unsigned width, unsigned height) const;
+
+    /**
+     * Read a mesh from a cache file into #mpCachedMesh.
+     *
+     * @param rPath path of the cache file
+     * @param width number of elements across the mesh
+     * @param height number of elements up the mesh
+     * @return whether the file was read; false if it could not be opened, is truncated or corrupt
+     * (a count larger than the rest of the file allows, an element with fewer than three nodes,
+     * or a node index out of range), or is for another mesh
+     */
+    bool ReadMeshCache(const std::string& rPath, unsigned width, unsigned height);
+
+    /**
+     * Write a mesh to a cache file, through a temporary file for this process that is renamed
+     * into place, so that processes writing the same cache file do not interfere. If the file
+     * cannot be written, a warning is given and no file is left behind.
+     *
+     * @param rPath path of the cache file
+     * @param width number of elements across the mesh
+     * @param height number of elements up the mesh
+     * @param rMesh the mesh
+     */
+    void WriteMeshCache(const std::string& rPath, unsigned width, unsigned height, MutableVertexMesh<2,2>& rMesh) const;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rMeshCacheDirectory directory in which to cache meshes (defaults to empty, for no caching)
+     */
+    DeltaNotchPopulationBuilder(const std::string& rMeshCacheDirectory="");
+
+    /**
+     * Build a honeycomb vertex mesh, as HoneycombVertexMeshGenerator(width, height) would,
+     * reading it from the cache if possible.
+     *
+     * @param width number of elements across the mesh
+     * @param height number of elements up the mesh
+     * @return the mesh, which is owned by the builder
+     */
+    MutableVertexMesh<2,2>* BuildHoneycombMesh(unsigned width, unsigned height);
+
+    /**
+     * @return #mLastMeshWasCached
+     */
+    bool GetLastMeshWasCached() const;
+
+    /**
+     * Create differentiated Delta/Notch cells with MyCellCycleModel, random initial Delta and Notch
+     * and random birth times, as in the tutorial.
+     *
+     * @param numCells the number of cells to create
+     * @param rCells vector to which the new cells are appended
+     */
+    void CreateCells(unsigned numCells, std::vector<CellPtr>& rCells) const;
+};
+
+#endif /*DELTANOTCHPOPULATIONBUILDER_HPP_*/
@@ -0,0 +1,37 @@
+
+#include "DeltaNotchReplicaContext.hpp"
+
+#include "CellId.hpp"
+#include "CellPropertyRegistry.hpp"
+#include "Exception.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "SimulationTime.hpp"
+
+bool DeltaNotchReplicaContext::msActive = false;
+
+DeltaNotchReplicaContext::DeltaNotchReplicaContext(unsigned seed)
+{
+    if (msActive)
+    {
+        EXCEPTION("Only one DeltaNotchReplicaContext may exist at a time");
+    }
+    msActive = true;
+
+    SimulationTime::Instance()->SetStartTime(0.0);
+    RandomNumberGenerator::Instance()->Reseed(seed);
+    CellPropertyRegistry::Instance()->Clear();
+    CellId::ResetMaxCellId();
+}
+
+DeltaNotchReplicaContext::~DeltaNotchReplicaContext()
+{
+    SimulationTime::Destroy();
+    RandomNumberGenerator::Destroy();
+    CellPropertyRegistry::Instance()->Clear();
+    msActive = false;
+}
+
+bool DeltaNotchReplicaContext::IsActive()
+{
+    return msActive;
+}
@@ -0,0 +1,46 @@
+
+#ifndef DELTANOTCHREPLICACONTEXT_HPP_
+#define DELTANOTCHREPLICACONTEXT_HPP_
+
+#include <boost/utility.hpp>
+
+/**
+ * The global state used by one Delta/Notch simulation ("replica").
+ *
+ * Creating a context starts the simulation time at 0, reseeds the random number generator,
+ * and clears the cell property registry and cell ids, as a cell-based test suite's setUp()
+ * would; destroying it tears this state down again, as tearDown() would. Declare the context
+ * before any meshes, cells or populations, so that these are destroyed first.
+ *
+ * Chaste keeps this state in process-wide singletons (SimulationTime, RandomNumberGenerator,
+ * CellPropertyRegistry), so only one context may exist at a time; creating a second one
+ * throws an exception rather than silently sharing the state.
+ */
+class DeltaNotchReplicaContext : private boost::noncopyable
+{
+private:
+
+    /** Whether a context currently exists. */
+    static bool msActive;
+
+public:
+
+    /**
+     * Constructor. Sets up the global state for a new replica.
+     *
+     * @param seed the random number generator seed
+     */
+    DeltaNotchReplicaContext(unsigned seed);
+
+    /**
+     * Destructor. Tears down the global state of the replica.
+     */
+    ~DeltaNotchReplicaContext();
+
+    /**
+     * @return whether a context currently exists
+     */
+    static bool IsActive();
+};
+
+#endif /*DELTANOTCHREPLICACONTEXT_HPP_*/
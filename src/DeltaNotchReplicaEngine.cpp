@@ -0,0 +1,239 @@
+
+#include "DeltaNotchReplicaEngine.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "DeltaNotchTutorialSimulation.hpp"
+#include "Exception.hpp"
+#include "OutputFileHandler.hpp"
+#include "PetscTools.hpp"
+#include "Timer.hpp"
+
+/** What a worker process sends back through its pipe. */
+struct WorkerResult
+{
+    /** The summary of the replica. */
+    DeltaNotchSimulationSummary mSummary;
+
+    /** Growth of the worker's peak resident set size while running the replica, in kilobytes. */
+    long mPeakMemoryIncrease;
+};
+
+DeltaNotchReplicaEngine::DeltaNotchReplicaEngine(const std::string& rOutputDirectory)
+    : mOutputDirectory(rOutputDirectory),
+      mWallTime(0.0),
+      mNumWorkers(1),
+      mPeakMemoryIncrease(0)
+{
+}
+
+void DeltaNotchReplicaEngine::AddReplica(const DeltaNotchSimulationParameters& rParameters)
+{
+    std::stringstream output_directory;
+    output_directory << mOutputDirectory << "/replica_" << mReplicas.size();
+
+    mReplicas.push_back(rParameters);
+    mReplicas.back().mOutputDirectory = output_directory.str();
+}
+
+unsigned DeltaNotchReplicaEngine::GetNumReplicas() const
+{
+    return mReplicas.size();
+}
+
+unsigned DeltaNotchReplicaEngine::GetNumWorkers() const
+{
+    return mNumWorkers;
+}
+
+void DeltaNotchReplicaEngine::SetNumWorkers(unsigned numWorkers)
+{
+    if (numWorkers == 0)
+    {
+        EXCEPTION("The number of replica workers must be positive");
+    }
+    mNumWorkers = numWorkers;
+}
+
+void DeltaNotchReplicaEngine::Run()
+{
+    mSummaries.assign(mReplicas.size(), DeltaNotchSimulationSummary());
+
+    double start_time = Timer::GetWallTime();
+    if (mNumWorkers > 1)
+    {
+        if (PetscTools::IsParallel())
+        {
+            EXCEPTION("Replica workers are forked, so cannot be used with more than one MPI process; use DeltaNotchEnsembleRunner instead");
+        }
+        RunInWorkers();
+    }
+    else
+    {
+        RunInProcess();
+    }
+    mWallTime = Timer::GetWallTime() - start_time;
+}
+
+void DeltaNotchReplicaEngine::RunInProcess()
+{
+    long initial_peak_memory = GetPeakMemory();
+
+    DeltaNotchTutorialSimulation simulation;
+    for (unsigned i=0; i<mReplicas.size(); i++)
+    {
+        mSummaries[i] = simulation.Run(mReplicas[i]);
+    }
+
+    mPeakMemoryIncrease = GetPeakMemory() - initial_peak_memory;
+}
+
+void DeltaNotchReplicaEngine::RunInWorkers()
+{
+    // Create the shared output directory here, so that the workers do not race to create it
+    OutputFileHandler handler(mOutputDirectory, false);
+
+    // Anything still buffered would otherwise be written again by every worker
+    std::cout << std::flush;
+    std::cerr << std::flush;
+
+    // The replica run by, and the read end of the pipe from, each running worker
+    std::map<pid_t, std::pair<unsigned, int> > workers;
+    mPeakMemoryIncrease = 0;
+    std::vector<unsigned> failed_replicas;
+    std::string error;
+    unsigned next_replica = 0;
+    while (!workers.empty() || (next_replica < mReplicas.size() && error.empty()))
+    {
+        if (next_replica < mReplicas.size() && error.empty() && workers.size() < mNumWorkers)
+        {
+            int pipe_fds[2];
+            if (pipe(pipe_fds) != 0)
+            {
+                error = "Could not create a pipe to a replica worker";
+                continue;
+            }
+            pid_t pid = fork();
+            if (pid < 0)
+            {
+                close(pipe_fds[0]);
+                close(pipe_fds[1]);
+                error = "Could not fork a replica worker";
+                continue;
+            }
+            if (pid == 0)
+            {
+                // Worker: run one replica, send back its summary and leave without running the parent's exit handlers
+                close(pipe_fds[0]);
+                int exit_code = EXIT_FAILURE;
+                try
+                {
+                    long initial_peak_memory = GetPeakMemory();
+                    DeltaNotchTutorialSimulation simulation;
+                    WorkerResult result;
+                    result.mSummary = simulation.Run(mReplicas[next_replica]);
+                    result.mPeakMemoryIncrease = GetPeakMemory() - initial_peak_memory;
+                    if (write(pipe_fds[1], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result)))
+                    {
+                        exit_code = EXIT_SUCCESS;
+                    }
+                }
+                catch (Exception& e)
+                {
+                    std::cerr << "Replica " << next_replica << ": " << e.GetMessage() << std::endl;
+                }
+                catch (std::exception& e)
+                {
+                    std::cerr << "Replica " << next_replica << ": " << e.what() << std::endl;
+                }
+                catch (...)
+                {
+                    std::cerr << "Replica " << next_replica << ": unknown exception" << std::endl;
+                }
+                close(pipe_fds[1]);
+                std::cout << std::flush;
+                _exit(exit_code);
+            }
+            close(pipe_fds[1]);
+            workers[pid] = std::make_pair(next_replica, pipe_fds[0]);
+            next_replica++;
+            continue;
+        }
+
+        // Wait for any worker to finish, then collect its summary
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            EXCEPTION("Lost track of the replica workers");
+        }
+        std::map<pid_t, std::pair<unsigned, int> >::iterator iter = workers.find(pid);
+        if (iter == workers.end())
+        {
+            continue;
+        }
+        unsigned replica = iter->second.first;
+        int read_fd = iter->second.second;
+        workers.erase(iter);
+
+        WorkerResult result;
+        bool succeeded = WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS
+                         && read(read_fd, &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result));
+        close(read_fd);
+        if (succeeded)
+        {
+            mSummaries[replica] = result.mSummary;
+            mPeakMemoryIncrease = std::max(mPeakMemoryIncrease, result.mPeakMemoryIncrease);
+        }
+        else
+        {
+            failed_replicas.push_back(replica);
+        }
+    }
+
+    if (!error.empty())
+    {
+        EXCEPTION(error);
+    }
+    if (!failed_replicas.empty())
+    {
+        std::stringstream message;
+        message << failed_replicas.size() << " of " << mReplicas.size() << " replicas failed, including replica "
+                << failed_replicas[0];
+        EXCEPTION(message.str());
+    }
+}
+
+const std::vector<DeltaNotchSimulationSummary>& DeltaNotchReplicaEngine::rGetSummaries() const
+{
+    return mSummaries;
+}
+
+double DeltaNotchReplicaEngine::GetWallTime() const
+{
+    return mWallTime;
+}
+
+long DeltaNotchReplicaEngine::GetPeakMemoryIncrease() const
+{
+    return mPeakMemoryIncrease;
+}
+
+long DeltaNotchReplicaEngine::GetPeakMemory()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
@@ -0,0 +1,130 @@
+
+#ifndef DELTANOTCHREPLICAENGINE_HPP_
+#define DELTANOTCHREPLICAENGINE_HPP_
+
+#include <string>
+#include <vector>
+
+#include "DeltaNotchSimulationParameters.hpp"
+#include "DeltaNotchSimulationSummary.hpp"
+
+/**
+ * Runs many small Delta/Notch simulations ("replicas") from a single process, so that process
+ * start-up (PETSc, MPI and library loading) is paid only once.
+ *
+ * Each replica runs inside its own DeltaNotchReplicaContext, which sets up and tears down
+ * the global simulation state, so replicas are independent and each gives the same results
+ * as running it on its own. That state lives in process-wide Chaste singletons (this project
+ * keeps its own per-cell state, such as DeltaPhenotypeFlags, in the cells), so with one
+ * worker (the default) the replicas run one after another in this process. With more workers,
+ * the engine forks one child process per replica, keeping up to #mNumWorkers of them running
+ * at once; each child inherits the already initialised process, runs its replica and returns
+ * the summary through a pipe.
+ *
+ * Forking an MPI process is only safe while the children make no MPI calls and no other rank
+ * is waiting on this one, so a worker pool is refused when there is more than one MPI process;
+ * across MPI processes, use DeltaNotchEnsembleRunner.
+ *
+ * The engine records the wall time of the whole batch and the growth of the peak resident
+ * memory of the processes running it, from which the replicas per second and memory per
+ * replica can be compared with those of running each replica in its own process.
+ */
+class DeltaNotchReplicaEngine
+{
+private:
+
+    /** The parameters of each replica. */
+    std::vector<DeltaNotchSimulationParameters> mReplicas;
+
+    /** The summary of each replica, filled by Run(). */
+    std::vector<DeltaNotchSimulationSummary> mSummaries;
+
+    /** Directory, relative to where Chaste output is stored, in which replica output directories are created. */
+    std::string mOutputDirectory;
+
+    /** Wall time of the last call to Run(), in seconds. */
+    double mWallTime;
+
+    /** Number of replicas to run at once. Defaults to 1, which runs them in this process. */
+    unsigned mNumWorkers;
+
+    /**
+     * Growth of the peak resident set size of the process running the replicas during the last
+     * call to Run(), in kilobytes: of this process, or with more than one worker, the largest
+     * growth within a worker after it was forked. Both count only the memory the replicas
+     * added, not that of the process they started from.
+     */
+    long mPeakMemoryIncrease;
+
+    /**
+     * Run all replicas in turn in this process.
+     */
+    void RunInProcess();
+
+    /**
+     * Run all replicas in forked worker processes, #mNumWorkers at a time.
+     */
+    void RunInWorkers();
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rOutputDirectory directory in which each replica's output directory is created
+     */
+    DeltaNotchReplicaEngine(const std::string& rOutputDirectory);
+
+    /**
+     * Add a replica. Its output directory is replaced by one below #mOutputDirectory.
+     *
+     * @param rParameters the replica's parameters
+     */
+    void AddReplica(const DeltaNotchSimulationParameters& rParameters);
+
+    /**
+     * @return the number of replicas
+     */
+    unsigned GetNumReplicas() const;
+
+    /**
+     * @return #mNumWorkers
+     */
+    unsigned GetNumWorkers() const;
+
+    /**
+     * Set #mNumWorkers.
+     *
+     * @param numWorkers the number of replicas to run at once
+     */
+    void SetNumWorkers(unsigned numWorkers);
+
+    /**
+     * Run all replicas. If a replica fails in a worker process, the others are still
+     * run, then an exception is thrown. An exception is also thrown if more than one worker
+     * is asked for in a run with more than one MPI process.
+     */
+    void Run();
+
+    /**
+     * @return the summary of each replica, in replica order
+     */
+    const std::vector<DeltaNotchSimulationSummary>& rGetSummaries() const;
+
+    /**
+     * @return #mWallTime
+     */
+    double GetWallTime() const;
+
+    /**
+     * @return #mPeakMemoryIncrease
+     */
+    long GetPeakMemoryIncrease() const;
+
+    /**
+     * @return the peak resident set size of this process so far, in kilobytes
+     */
+    static long GetPeakMemory();
+};
+
+#endif /*DELTANOTCHREPLICAENGINE_HPP_*/
@@ -0,0 +1,282 @@
+
+#include "DeltaNotchSimulationParameters.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include "Exception.hpp"
+
+namespace po = boost::program_options;
+
+/**
+ * Throw an exception if any of the given unsigned options has a negative value. Boost's
+ * conversion to unsigned accepts a leading minus sign and wraps, so "-1" would otherwise
+ * become a huge count.
+ *
+ * @param rOptions the options as parsed, before conversion
+ */
+static void CheckUnsignedOptions(const po::parsed_options& rOptions)
+{
+    static const char* unsigned_options[] = {"mesh-width", "mesh-height", "sampling-multiple", "seed",
+                                             "phenotype-update-multiple", "target-area-update-multiple",
+                                             "ode-subcycles"};
+    static const unsigned num_unsigned_options = sizeof(unsigned_options)/sizeof(unsigned_options[0]);
+    for (unsigned i=0; i<rOptions.options.size(); i++)
+    {
+        const po::option& r_option = rOptions.options[i];
+        if (std::find(unsigned_options, unsigned_options + num_unsigned_options, r_option.string_key)
+            == unsigned_options + num_unsigned_options)
+        {
+            continue;
+        }
+        for (unsigned j=0; j<r_option.value.size(); j++)
+        {
+            std::size_t first = r_option.value[j].find_first_not_of(" \t");
+            if (first != std::string::npos && r_option.value[j][first] == '-')
+            {
+                EXCEPTION("The option " + r_option.string_key + " must not be negative");
+            }
+        }
+    }
+}
+
+DeltaNotchSimulationParameters::DeltaNotchSimulationParameters()
+    : mMeshWidth(5),
+      mMeshHeight(5),
+      mPopulationType("vertex"),
+      mDt(DOUBLE_UNSET),
+      mEndTime(30.0),
+      mSamplingTimestepMultiple(10),
+      mDeltaHighThreshold(0.6),
+      mDeltaLowThreshold(0.2),
+      mDeltaHighTargetAreaCoefficient(1.5),
+      mDeltaLowTargetAreaCoefficient(0.7),
+      mTransientTargetAreaCoefficient(1.0),
+      mSeed(1),
+      mOutputDirectory("TestVertexBasedMonolayerWithDeltaNotchProjectMySim"),
+      mQuantisedAgesScale(100.0),
+      mQuantisedVolumesScale(1000.0),
+      mUseFusedModifier(false),
+      mUseCompactStorage(false),
+      mUseCompressedVtkOutput(false),
+      mVtkGeometryTolerance(0.01),
+      mUseAdaptiveTimeStep(false),
+      mMinDt(DOUBLE_UNSET),
+      mMaxDt(DOUBLE_UNSET),
+      mPhenotypeUpdateMultiple(1),
+      mTargetAreaUpdateMultiple(1),
+      mNumOdeSubcycles(0),
+      mMetricsInterval(1.0),
+      mUseFastNagaiHondaForce(false),
+      mUseLazyTargetAreas(true)
+{
+    std::vector<std::string> writer_names = GetWriterNames();
+    for (unsigned i=0; i<writer_names.size(); i++)
+    {
+        if (writer_names[i].find("quantised-") != 0)
+        {
+            mWriters.push_back(writer_names[i]);
+        }
+    }
+}
+
+bool DeltaNotchSimulationParameters::Parse(const std::vector<std::string>& rArguments)
+{
+    std::string writers;
+    std::string config_file;
+
+    po::options_description desc("Delta/Notch simulation options");
+    desc.add_options()
+        ("help", "print this help message")
+        ("config", po::value<std::string>(&config_file), "file of \"option = value\" lines")
+        ("mesh-width", po::value<unsigned>(&mMeshWidth)->default_value(mMeshWidth), "number of cells across the initial mesh")
+        ("mesh-height", po::value<unsigned>(&mMeshHeight)->default_value(mMeshHeight), "number of cells up the initial mesh")
+        ("population", po::value<std::string>(&mPopulationType)->default_value(mPopulationType), "cell population type: vertex or node")
+        ("dt", po::value<double>(&mDt), "time step (defaults to that of the simulation class)")
+        ("end-time", po::value<double>(&mEndTime)->default_value(mEndTime), "simulation end time")
+        ("sampling-multiple", po::value<unsigned>(&mSamplingTimestepMultiple)->default_value(mSamplingTimestepMultiple), "time steps between outputs")
+        ("delta-high-threshold", po::value<double>(&mDeltaHighThreshold)->default_value(mDeltaHighThreshold), "Delta above which cells are Delta-high")
+        ("delta-low-threshold", po::value<double>(&mDeltaLowThreshold)->default_value(mDeltaLowThreshold), "Delta below which cells are Delta-low")
+        ("delta-high-coefficient", po::value<double>(&mDeltaHighTargetAreaCoefficient)->default_value(mDeltaHighTargetAreaCoefficient), "target area coefficient of Delta-high cells")
+        ("delta-low-coefficient", po::value<double>(&mDeltaLowTargetAreaCoefficient)->default_value(mDeltaLowTargetAreaCoefficient), "target area coefficient of Delta-low cells")
+        ("transient-coefficient", po::value<double>(&mTransientTargetAreaCoefficient)->default_value(mTransientTargetAreaCoefficient), "target area coefficient of other cells")
+        ("seed", po::value<unsigned>(&mSeed)->default_value(mSeed), "random number generator seed")
+        ("output-dir", po::value<std::string>(&mOutputDirectory)->default_value(mOutputDirectory), "output directory")
+        ("writers", po::value<std::string>(&writers), "comma-separated list of writers to enable, or \"none\"")
+        ("quantised-ages-scale", po::value<double>(&mQuantisedAgesScale)->default_value(mQuantisedAgesScale), "scale of the quantised-ages writer")
+        ("quantised-volumes-scale", po::value<double>(&mQuantisedVolumesScale)->default_value(mQuantisedVolumesScale), "scale of the quantised-volumes writer")
+        ("fused", po::value<bool>(&mUseFusedModifier)->default_value(mUseFusedModifier), "use DeltaPhenotypeFusedModifier")
+        ("compact", po::value<bool>(&mUseCompactStorage)->default_value(mUseCompactStorage), "use the fused modifier with compact per-cell storage")
+        ("compressed-vtk", po::value<bool>(&mUseCompressedVtkOutput)->default_value(mUseCompressedVtkOutput), "write compressed VTK output, reusing the mesh geometry of earlier output times while it is unchanged (vertex only)")
+        ("vtk-geometry-tolerance", po::value<double>(&mVtkGeometryTolerance)->default_value(mVtkGeometryTolerance), "node displacement above which compressed VTK output records new mesh geometry; 0 records it on any movement")
+        ("adaptive-dt", po::value<bool>(&mUseAdaptiveTimeStep)->default_value(mUseAdaptiveTimeStep), "adapt the time step to the tissue activity, keeping output times fixed")
+        ("min-dt", po::value<double>(&mMinDt), "smallest adaptive time step (defaults to the initial time step)")
+        ("max-dt", po::value<double>(&mMaxDt), "largest adaptive time step (defaults to the output interval)")
+        ("phenotype-update-multiple", po::value<unsigned>(&mPhenotypeUpdateMultiple)->default_value(mPhenotypeUpdateMultiple), "time steps between phenotype updates")
+        ("target-area-update-multiple", po::value<unsigned>(&mTargetAreaUpdateMultiple)->default_value(mTargetAreaUpdateMultiple), "time steps between target area updates")
+        ("ode-subcycles", po::value<unsigned>(&mNumOdeSubcycles)->default_value(mNumOdeSubcycles), "Delta/Notch ODE steps per time step, or 0 for the default ODE time step")
+        ("mesh-cache-dir", po::value<std::string>(&mMeshCacheDirectory), "directory in which to cache vertex meshes")
+        ("metrics-file", po::value<std::string>(&mMetricsFile), "file in which to publish live metrics, including the wall time of each modifier, relative to the output directory unless absolute")
+        ("metrics-interval", po::value<double>(&mMetricsInterval)->default_value(mMetricsInterval), "wall time in seconds between rewrites of the metrics file")
+        ("fast-nagai-honda", po::value<bool>(&mUseFastNagaiHondaForce)->default_value(mUseFastNagaiHondaForce), "use DeltaNotchNagaiHondaForce, reading target areas from a per-element array (vertex only)")
+        ("event-log", po::value<std::string>(&mEventLogFile), "file in which to log cell divisions, deaths and phenotype transitions, relative to the output directory unless absolute")
+        ("phenotype-policy", po::value<std::string>(&mPhenotypePolicy), "compile-time phenotype policy to use in place of the phenotype modifiers: three-band or five-band")
+        ("lazy-target-areas", po::value<bool>(&mUseLazyTargetAreas)->default_value(mUseLazyTargetAreas), "skip target area updates of cells whose target area cannot have changed");
+
+    po::variables_map vm;
+    po::parsed_options command_line_options = po::command_line_parser(rArguments).options(desc).run();
+    CheckUnsignedOptions(command_line_options);
+    po::store(command_line_options, vm);
+
+    if (vm.count("help"))
+    {
+        std::cout << desc << std::endl;
+        return false;
+    }
+
+    // Options already stored take precedence, so the config file is read after the command line
+    if (vm.count("config"))
+    {
+        std::string config_path = vm["config"].as<std::string>();
+        std::ifstream config_stream(config_path.c_str());
+        if (!config_stream.is_open())
+        {
+            EXCEPTION("Could not open config file " + config_path);
+        }
+        po::parsed_options config_options = po::parse_config_file(config_stream, desc);
+        CheckUnsignedOptions(config_options);
+        po::store(config_options, vm);
+    }
+    po::notify(vm);
+
+    if (mPopulationType != "vertex" && mPopulationType != "node")
+    {
+        EXCEPTION("Unknown population type: " + mPopulationType);
+    }
+    if (mUseAdaptiveTimeStep && mPopulationType != "vertex")
+    {
+        EXCEPTION("Adaptive time stepping is only available for the vertex population");
+    }
+    if (!mEventLogFile.empty() && mPopulationType != "vertex")
+    {
+        EXCEPTION("The event log is only available for the vertex population");
+    }
+    if (mDeltaLowThreshold > mDeltaHighThreshold)
+    {
+        EXCEPTION("The Delta-low threshold must not exceed the Delta-high threshold");
+    }
+    if (mQuantisedAgesScale <= 0.0 || mQuantisedVolumesScale <= 0.0)
+    {
+        EXCEPTION("Quantisation scales must be positive");
+    }
+    if (mVtkGeometryTolerance < 0.0)
+    {
+        EXCEPTION("The VTK geometry tolerance must not be negative");
+    }
+    if (mDt != DOUBLE_UNSET && mDt <= 0.0)
+    {
+        EXCEPTION("The time step must be positive");
+    }
+    if (mEndTime <= 0.0)
+    {
+        EXCEPTION("The end time must be positive");
+    }
+    if ((mMinDt != DOUBLE_UNSET && mMinDt <= 0.0) || (mMaxDt != DOUBLE_UNSET && mMaxDt <= 0.0))
+    {
+        EXCEPTION("Time step bounds must be positive");
+    }
+    if (mMinDt != DOUBLE_UNSET && mMaxDt != DOUBLE_UNSET && mMinDt > mMaxDt)
+    {
+        EXCEPTION("The smallest adaptive time step must not exceed the largest");
+    }
+    if (mPhenotypeUpdateMultiple == 0 || mTargetAreaUpdateMultiple == 0)
+    {
+        EXCEPTION("Update multiples must be positive");
+    }
+    if (mMetricsInterval < 0.0)
+    {
+        EXCEPTION("The metrics interval must not be negative");
+    }
+    if (mSamplingTimestepMultiple == 0)
+    {
+        EXCEPTION("The sampling multiple must be positive");
+    }
+    if (!mPhenotypePolicy.empty())
+    {
+        if (mPhenotypePolicy != "three-band" && mPhenotypePolicy != "five-band")
+        {
+            EXCEPTION("Unknown phenotype policy: " + mPhenotypePolicy);
+        }
+        const char* compiled_options[] = {"delta-high-threshold", "delta-low-threshold", "delta-high-coefficient",
+                                          "delta-low-coefficient", "transient-coefficient"};
+        for (unsigned i=0; i<sizeof(compiled_options)/sizeof(compiled_options[0]); i++)
+        {
+            if (!vm[compiled_options[i]].defaulted())
+            {
+                EXCEPTION(std::string("The option ") + compiled_options[i] + " cannot be used with a phenotype policy, whose thresholds and coefficients are compiled in");
+            }
+        }
+        if (mPhenotypeUpdateMultiple > 1 || mTargetAreaUpdateMultiple > 1)
+        {
+            EXCEPTION("A phenotype policy updates every cell's mean Delta, phenotype and target area together, so cannot be used with update multiples greater than 1");
+        }
+    }
+
+    if (vm.count("writers"))
+    {
+        mWriters.clear();
+        if (writers != "none")
+        {
+            boost::split(mWriters, writers, boost::is_any_of(","));
+        }
+
+        std::vector<std::string> known_writers = GetWriterNames();
+        for (unsigned i=0; i<mWriters.size(); i++)
+        {
+            if (std::find(known_writers.begin(), known_writers.end(), mWriters[i]) == known_writers.end())
+            {
+                EXCEPTION("Unknown writer: " + mWriters[i]);
+            }
+        }
+    }
+
+    return true;
+}
+
+bool DeltaNotchSimulationParameters::ParseCommandLine(int argc, char* argv[])
+{
+    std::vector<std::string> arguments;
+    for (int i=1; i<argc; i++)
+    {
+        arguments.push_back(argv[i]);
+    }
+    return Parse(arguments);
+}
+
+std::vector<std::string> DeltaNotchSimulationParameters::GetWriterNames()
+{
+    std::vector<std::string> names;
+    names.push_back("mutation-states-count");
+    names.push_back("proliferative-types-count");
+    names.push_back("proliferative-phases-count");
+    names.push_back("proliferative-phases");
+    names.push_back("ages");
+    names.push_back("volumes");
+    names.push_back("phenotype");
+    names.push_back("quantised-ages");
+    names.push_back("quantised-volumes");
+    names.push_back("quantised-phenotype");
+    return names;
+}
+
+bool DeltaNotchSimulationParameters::IsWriterEnabled(const std::string& rName) const
+{
+    return std::find(mWriters.begin(), mWriters.end(), rName) != mWriters.end();
+}
@@ -0,0 +1,191 @@
+
+#ifndef DELTANOTCHSIMULATIONPARAMETERS_HPP_
+#define DELTANOTCHSIMULATIONPARAMETERS_HPP_
+
+#include <string>
+#include <vector>
+
+/**
+ * Run-time parameters of the Delta/Notch phenotype scenario run by DeltaNotchTutorialSimulation.
+ *
+ * The default values reproduce the original tutorial: a 5x5 vertex monolayer, seeded with 1,
+ * run to t=30 with results sampled every 10 time steps.
+ *
+ * Parameters may be given on the command line (e.g. --mesh-width 20) or in a config file of
+ * "key = value" lines using the same names without the leading dashes, passed with --config.
+ * Values on the command line take precedence over those in the config file.
+ */
+class DeltaNotchSimulationParameters
+{
+public:
+
+    /** Number of elements (or nodes) across the initial honeycomb mesh. */
+    unsigned mMeshWidth;
+
+    /** Number of elements (or nodes) up the initial honeycomb mesh. */
+    unsigned mMeshHeight;
+
+    /** Cell population type: "vertex" or "node". */
+    std::string mPopulationType;
+
+    /** Time step, in hours. If DOUBLE_UNSET the default of the simulation class is used. */
+    double mDt;
+
+    /** End time of the simulation, in hours. */
+    double mEndTime;
+
+    /** Number of time steps between each output of results. */
+    unsigned mSamplingTimestepMultiple;
+
+    /** Cells with Delta above this value have the Delta-high phenotype. */
+    double mDeltaHighThreshold;
+
+    /** Cells with Delta below this value have the Delta-low phenotype. */
+    double mDeltaLowThreshold;
+
+    /** Target area coefficient of Delta-high cells. */
+    double mDeltaHighTargetAreaCoefficient;
+
+    /** Target area coefficient of Delta-low cells. */
+    double mDeltaLowTargetAreaCoefficient;
+
+    /** Target area coefficient of cells with neither phenotype. */
+    double mTransientTargetAreaCoefficient;
+
+    /** Seed for the random number generator. */
+    unsigned mSeed;
+
+    /** Output directory, relative to where Chaste output is stored. */
+    std::string mOutputDirectory;
+
+    /**
+     * Names of the cell writers and cell population count writers to add; see GetWriterNames().
+     * By default all writers except the quantised ones are added. A quantised writer is added as
+     * well as the full-precision writer of the same quantity ("ages", "volumes" or "phenotype");
+     * to write a quantity only at reduced precision, leave its full-precision writer out.
+     */
+    std::vector<std::string> mWriters;
+
+    /** Scale used by the "quantised-ages" writer; see AbstractQuantisedCellWriter. */
+    double mQuantisedAgesScale;
+
+    /** Scale used by the "quantised-volumes" writer; see AbstractQuantisedCellWriter. */
+    double mQuantisedVolumesScale;
+
+    /** Whether to use DeltaPhenotypeFusedModifier in place of the three separate modifiers. */
+    bool mUseFusedModifier;
+
+    /**
+     * Whether to use compact storage: implies the fused modifier, with Delta read from the SRN
+     * models instead of CellData and no phenotype cell properties.
+     */
+    bool mUseCompactStorage;
+
+    /** Whether to write compressed VTK output; see DeltaPhenotypeVertexBasedCellPopulation. */
+    bool mUseCompressedVtkOutput;
+
+    /**
+     * Node displacement above which compressed VTK output records new mesh geometry. Defaults to
+     * 0.01; with 0 the geometry is recorded at almost every output time, as nodes always move.
+     */
+    double mVtkGeometryTolerance;
+
+    /** Whether to adapt the time step; see DeltaNotchAdaptiveSimulation. */
+    bool mUseAdaptiveTimeStep;
+
+    /** Smallest adaptive time step (defaults to the initial time step). */
+    double mMinDt;
+
+    /** Largest adaptive time step (defaults to the output interval). */
+    double mMaxDt;
+
+    /**
+     * Number of time steps between updates of the Delta phenotypes; see MultiRateModifierScheduler
+     * and DeltaPhenotypeFusedModifier. The mean neighbouring Delta is updated every time step.
+     */
+    unsigned mPhenotypeUpdateMultiple;
+
+    /** Number of time steps between updates of the target areas; see MultiRateModifierScheduler. */
+    unsigned mTargetAreaUpdateMultiple;
+
+    /** Number of Delta/Notch ODE sub-cycles per time step, or 0 for the SRN models' own time step. */
+    unsigned mNumOdeSubcycles;
+
+    /** Directory in which to cache vertex meshes, or empty for no caching; see DeltaNotchPopulationBuilder. */
+    std::string mMeshCacheDirectory;
+
+    /**
+     * Live metrics file, relative to the output directory unless absolute, or empty for no
+     * metrics; see DeltaNotchMetricsModifier. To report the wall time of each modifier, the
+     * modifiers are then run by a MultiRateModifierScheduler even if all update multiples are 1,
+     * which does not change results but adds two clock reads per modifier per time step.
+     */
+    std::string mMetricsFile;
+
+    /** Minimum wall time between rewrites of the metrics file, in seconds. */
+    double mMetricsInterval;
+
+    /** Whether to use DeltaNotchNagaiHondaForce in place of NagaiHondaForce (vertex only). */
+    bool mUseFastNagaiHondaForce;
+
+    /**
+     * Log of cell divisions, deaths and phenotype transitions, relative to the output directory
+     * unless absolute, or empty for no log; see DeltaNotchEventLogModifier.
+     */
+    std::string mEventLogFile;
+
+    /**
+     * Compile-time phenotype policy to use in place of the phenotype and target area modifiers:
+     * "three-band" or "five-band" (see DeltaPhenotypePolicy.hpp), or empty for none. The policy's
+     * thresholds and target area coefficients are compiled in, so may not be given as options, and it
+     * updates every cell at every time step, so the update multiples must be 1.
+     */
+    std::string mPhenotypePolicy;
+
+    /**
+     * Whether the target area modifiers skip cells whose target area cannot have changed; see
+     * DeltaPhenotypeTargetAreaModifier::UpdateTargetAreas(). Results are the same either way.
+     */
+    bool mUseLazyTargetAreas;
+
+    /**
+     * Default constructor. Sets the tutorial defaults.
+     */
+    DeltaNotchSimulationParameters();
+
+    /**
+     * Overwrite parameters with those given in command-line style arguments and in any
+     * config file given with --config. An option given in both takes its value from the arguments.
+     *
+     * Throws an exception if an option or writer name is not recognised, if a count or seed is
+     * negative, if the time step or end time is not positive, or if the smallest adaptive time
+     * step exceeds the largest.
+     *
+     * @param rArguments the arguments, not including the program name
+     * @return false if --help was given, in which case the options are printed and nothing is changed
+     */
+    bool Parse(const std::vector<std::string>& rArguments);
+
+    /**
+     * Overwrite parameters with those given on the command line.
+     *
+     * @param argc number of command-line arguments
+     * @param argv the command-line arguments
+     * @return false if --help was given
+     */
+    bool ParseCommandLine(int argc, char* argv[]);
+
+    /**
+     * @return the names of all writers that may be listed in #mWriters
+     */
+    static std::vector<std::string> GetWriterNames();
+
+    /**
+     * @return whether a given writer is listed in #mWriters
+     *
+     * @param rName the writer name
+     */
+    bool IsWriterEnabled(const std::string& rName) const;
+};
+
+#endif /*DELTANOTCHSIMULATIONPARAMETERS_HPP_*/
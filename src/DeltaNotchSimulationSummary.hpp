@@ -0,0 +1,101 @@
+
+#ifndef DELTANOTCHSIMULATIONSUMMARY_HPP_
+#define DELTANOTCHSIMULATIONSUMMARY_HPP_
+
+#include "AbstractCellPopulation.hpp"
+#include "DeltaPhenotypeFlags.hpp"
+
+/**
+ * Summary statistics of a finished Delta/Notch simulation, as returned by
+ * DeltaNotchTutorialSimulation::Run() and aggregated by DeltaNotchEnsembleRunner.
+ */
+struct DeltaNotchSimulationSummary
+{
+    /** Number of cells at the end of the simulation. */
+    unsigned mNumCells;
+
+    /** Number of Delta-high cells at the end of the simulation. */
+    unsigned mNumDeltaHigh;
+
+    /** Number of Delta-low cells at the end of the simulation. */
+    unsigned mNumDeltaLow;
+
+    /** Number of cells with neither phenotype at the end of the simulation. */
+    unsigned mNumTransient;
+
+    /**
+     * Checksum of the final state: the sum over cells of "mean delta", "target area" (where
+     * present) and the Delta phenotype. Used to check that runs reproduce each other.
+     */
+    double mChecksum;
+
+    /** Number of time steps taken. */
+    unsigned mNumTimeSteps;
+
+    /** Wall time spent in Solve(), in seconds. */
+    double mWallTime;
+
+    /** Wall time spent building the mesh, cells, population and simulation before Solve(), in seconds. */
+    double mSetupTime;
+
+    /**
+     * Default constructor.
+     */
+    DeltaNotchSimulationSummary()
+        : mNumCells(0),
+          mNumDeltaHigh(0),
+          mNumDeltaLow(0),
+          mNumTransient(0),
+          mChecksum(0.0),
+          mNumTimeSteps(0),
+          mWallTime(0.0),
+          mSetupTime(0.0)
+    {
+    }
+
+    /**
+     * Count the cells of each phenotype in a cell population, and compute #mChecksum.
+     *
+     * @param rCellPopulation the cell population
+     */
+    template<unsigned DIM>
+    void CountCells(AbstractCellPopulation<DIM>& rCellPopulation)
+    {
+        mNumCells = 0;
+        mNumDeltaHigh = 0;
+        mNumDeltaLow = 0;
+        mNumTransient = 0;
+        mChecksum = 0.0;
+        for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+             cell_iter != rCellPopulation.End();
+             ++cell_iter)
+        {
+            mNumCells++;
+            boost::shared_ptr<CellData> p_cell_data = cell_iter->GetCellData();
+            if (p_cell_data->HasItem("mean delta"))
+            {
+                mChecksum += p_cell_data->GetItem("mean delta");
+            }
+            if (p_cell_data->HasItem("target area"))
+            {
+                mChecksum += p_cell_data->GetItem("target area");
+            }
+            DeltaPhenotype phenotype = DeltaPhenotypeFlags::GetPhenotype(*cell_iter);
+            mChecksum += phenotype;
+            switch (phenotype)
+            {
+                case DELTA_HIGH:
+                    mNumDeltaHigh++;
+                    break;
+                case DELTA_LOW:
+                    mNumDeltaLow++;
+                    break;
+                default:
+                    mNumTransient++;
+                    break;
+            }
+        }
+    }
+};
+
+#endif /*DELTANOTCHSIMULATIONSUMMARY_HPP_*/
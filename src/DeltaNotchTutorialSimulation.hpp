@@ -116,11 +116,44 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "DeltaPhenotypeTargetAreaModifier.hpp"
 #include "DeltaPhenotypeWriter.hpp"
 
+#include "DeltaPhenotypeFusedModifier.hpp"
+#include "DeltaPhenotypePolicyModifier.hpp"
+#include "DeltaPhenotypeVertexBasedCellPopulation.hpp"
+#include "DeltaNotchAdaptiveSimulation.hpp"
+#include "DeltaNotchMetricsModifier.hpp"
+#include "DeltaNotchEventLogModifier.hpp"
+#include "DeltaNotchNagaiHondaForce.hpp"
+#include "MultiRateModifierScheduler.hpp"
+#include "DeltaNotchSimulationParameters.hpp"
+#include "DeltaNotchSimulationSummary.hpp"
+#include "DeltaNotchReplicaContext.hpp"
+#include "DeltaNotchPopulationBuilder.hpp"
+#include "QuantisedCellAgesWriter.hpp"
+#include "QuantisedCellVolumesWriter.hpp"
+#include "QuantisedDeltaPhenotypeWriter.hpp"
+#include "Timer.hpp"
+
 /* Having included all the necessary header files, we proceed by defining the test class.
+ * Each simulation takes a {{{DeltaNotchSimulationParameters}}} object, whose defaults
+ * reproduce the tutorial; the parameters can be changed at run time from the command line
+ * or a config file.
  */
 class DeltaNotchTutorialSimulation
 {
 public:
+    /*
+     * Run the simulation whose population type is given in the parameters, and return
+     * summary statistics of the final state.
+     */
+    DeltaNotchSimulationSummary Run(const DeltaNotchSimulationParameters& rParameters)
+    {
+        if (rParameters.mPopulationType == "node")
+        {
+            return NodeBasedMonolayerWithDeltaNotch(rParameters);
+        }
+        return VertexBasedMonolayerWithDeltaNotch(rParameters);
+    }
+
     /*
      * EMPTYLINE
      *
@@ -131,97 +164,109 @@ public:
      * In the first test, we demonstrate how to simulate a monolayer that incorporates
      * Delta/Notch signalling, using a vertex-based approach.
      */
-    void VertexBasedMonolayerWithDeltaNotch()
+    DeltaNotchSimulationSummary VertexBasedMonolayerWithDeltaNotch(const DeltaNotchSimulationParameters& rParameters = DeltaNotchSimulationParameters())
     {
-        SetupSingletons(1);
-        LogFile::Instance()->Set(2, "TestVertexBasedMonolayerWithDeltaNotchProjectMySim");
-
-        /* First we create a regular vertex mesh. */
-        HoneycombVertexMeshGenerator generator(5, 5);
-        MutableVertexMesh<2, 2> *p_mesh = generator.GetMesh();
-
-        /* We then create some cells, each with a cell-cycle model, {{{UniformG1GenerationalCellCycleModel}}} and a subcellular reaction network model
-         * {{{DeltaNotchSrnModel}}}, which
-         * incorporates a Delta/Notch ODE system, here we use the hard coded initial conditions of 1.0 and 1.0.
-         * In this example we choose to make each cell differentiated,
-         * so that no cell division occurs. */
-        std::vector<CellPtr> cells;
-        MAKE_PTR(WildTypeCellMutationState, p_state);
-        MAKE_PTR(DifferentiatedCellProliferativeType, p_diff_type);
-        MAKE_PTR(StemCellProliferativeType, p_stem_type);
+        DeltaNotchReplicaContext context(rParameters.mSeed);
+        double setup_start_time = Timer::GetWallTime();
+        LogFile::Instance()->Set(2, rParameters.mOutputDirectory);
 
-        for (unsigned elem_index = 0; elem_index < p_mesh->GetNumElements(); elem_index++)
-        {
-            MyCellCycleModel *p_cc_model = new MyCellCycleModel();
-            p_cc_model->SetDimension(2);
-
-            /* We choose to initialise the concentrations to random levels in each cell. */
-            std::vector<double> initial_conditions;
-            initial_conditions.push_back(RandomNumberGenerator::Instance()->ranf());
-            initial_conditions.push_back(RandomNumberGenerator::Instance()->ranf());
-            DeltaNotchSrnModel *p_srn_model = new DeltaNotchSrnModel();
-            p_srn_model->SetInitialConditions(initial_conditions);
-
-            CellPtr p_cell(new Cell(p_state, p_cc_model, p_srn_model));
-            p_cell->SetCellProliferativeType(p_diff_type);
-            double birth_time = 0.0;
-            p_cell->SetCellProliferativeType(p_diff_type);
-            birth_time = -RandomNumberGenerator::Instance()->ranf() * 12.0;
-            /*if (elem_index % 3 == 0)
-            {
-                p_cell->SetCellProliferativeType(p_stem_type);
-                birth_time = -RandomNumberGenerator::Instance()->ranf() * (p_cc_model->GetStemCellG1Duration() + p_cc_model->GetSG2MDuration());
-            }
-            else
-            {
-                p_cell->SetCellProliferativeType(p_diff_type);
-                birth_time = -RandomNumberGenerator::Instance()->ranf() * 12.0;
-            }*/
-            p_cell->SetBirthTime(birth_time);
-            cells.push_back(p_cell);
-        }
+        /* First we create a regular vertex mesh. For large tissues, the {{{DeltaNotchPopulationBuilder}}} can
+         * read the mesh from a binary cache file instead of generating it again. */
+        DeltaNotchPopulationBuilder builder(rParameters.mMeshCacheDirectory);
+        MutableVertexMesh<2, 2> *p_mesh = builder.BuildHoneycombMesh(rParameters.mMeshWidth, rParameters.mMeshHeight);
+
+        /* We then create some cells, one per element, each with a cell-cycle model, {{{MyCellCycleModel}}} and a
+         * subcellular reaction network model {{{DeltaNotchSrnModel}}}, which incorporates a Delta/Notch ODE system.
+         * In this example we choose to make each cell differentiated, so that no cell division occurs
+         * until the phenotype modifier makes Delta-high cells into stem cells. We choose to initialise the
+         * concentrations to random levels in each cell. */
+        std::vector<CellPtr> cells;
+        builder.CreateCells(p_mesh->GetNumElements(), cells);
 
         /* Using the vertex mesh and cells, we create a cell-based population object, and specify which results to
          * output to file. */
-        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
-        cell_population.AddCellPopulationCountWriter<CellMutationStatesCountWriter>();
-        cell_population.AddCellPopulationCountWriter<CellProliferativeTypesCountWriter>();
-        cell_population.AddCellPopulationCountWriter<CellProliferativePhasesCountWriter>();
-        cell_population.AddCellWriter<CellProliferativePhasesWriter>();
-        cell_population.AddCellWriter<CellAgesWriter>();
-        cell_population.AddCellWriter<CellVolumesWriter>();
-        cell_population.AddCellWriter<DeltaPhenotypeWriter>();
+        DeltaPhenotypeVertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        cell_population.SetUseCompressedVtkOutput(rParameters.mUseCompressedVtkOutput);
+        cell_population.SetGeometryTolerance(rParameters.mVtkGeometryTolerance);
+        AddWriters(cell_population, rParameters);
 
         //or cell area for different cell types is different 
 
         /* We are now in a position to create and configure the cell-based simulation object, pass a force law to it,
          * and run the simulation. We can make the simulation run for longer to see more patterning by increasing the end time. */
-        OffLatticeSimulation<2> simulator(cell_population);
-        simulator.SetOutputDirectory("TestVertexBasedMonolayerWithDeltaNotchProjectMySim");
-        simulator.SetSamplingTimestepMultiple(10);
-        simulator.SetEndTime(30.0);
+        DeltaNotchAdaptiveSimulation<2> simulator(cell_population);
+        ConfigureSimulation(simulator, rParameters);
 
-        /* Then, we define the modifier class, which automatically updates the values of Delta and Notch within the cells in {{{CellData}}} and passes it to the simulation.*/
-        MAKE_PTR(DeltaNotchTrackingModifier<2>, p_modifier);
-        simulator.AddSimulationModifier(p_modifier);
+        /* {{{DeltaNotchNagaiHondaForce}}} computes the same forces as {{{NagaiHondaForce}}}, reading target areas
+         * from an array kept by the cell population rather than from each cell's {{{CellData}}}. */
+        if (rParameters.mUseFastNagaiHondaForce)
+        {
+            MAKE_PTR(DeltaNotchNagaiHondaForce<2>, p_force);
+            simulator.AddForce(p_force);
+        }
+        else
+        {
+            MAKE_PTR(NagaiHondaForce<2>, p_force);
+            simulator.AddForce(p_force);
+        }
 
-        MAKE_PTR(DeltaPhenotypeTrackingModifier<2>, p_dphenotype_modifier);
-        simulator.AddSimulationModifier(p_dphenotype_modifier);
+        DeltaNotchSimulationSummary summary;
+        double start_time = Timer::GetWallTime();
+        summary.mSetupTime = start_time - setup_start_time;
+        simulator.Solve();
+        summary.mWallTime = Timer::GetWallTime() - start_time;
+        summary.mNumTimeSteps = simulator.GetNumTimeStepsTaken();
+        summary.CountCells(cell_population);
+        WriteQuantisationReports();
 
-        MAKE_PTR(NagaiHondaForce<2>, p_force);
-        simulator.AddForce(p_force);
+        return summary;
+    }
 
-        /* This modifier assigns target areas to each cell, which are required by the {{{NagaiHondaForce}}}.
-         */
-        //MAKE_PTR(SimpleTargetAreaModifier<2>, p_growth_modifier);
-        MAKE_PTR(DeltaPhenotypeTargetAreaModifier<2>, p_growth_modifier);
-        p_growth_modifier->SetDeltaHighPhenotypeTargetAreaCoefficient(1.5);
-        p_growth_modifier->SetDeltaLowPhenotypeTargetAreaCoefficient(0.7);
-        simulator.AddSimulationModifier(p_growth_modifier);
+    /*
+     * EMPTYLINE
+     *
+     * == Test 2: a node-based monolayer with Delta/Notch signalling ==
+     *
+     * EMPTYLINE
+     *
+     * The same scenario can be run using a node-based approach, in which cells interact
+     * through a spring force rather than through a shared vertex mesh.
+     */
+    DeltaNotchSimulationSummary NodeBasedMonolayerWithDeltaNotch(const DeltaNotchSimulationParameters& rParameters = DeltaNotchSimulationParameters())
+    {
+        DeltaNotchReplicaContext context(rParameters.mSeed);
+        double setup_start_time = Timer::GetWallTime();
+        LogFile::Instance()->Set(2, rParameters.mOutputDirectory);
+
+        /* We create a mesh of nodes with an interaction cut-off length of 1.5 cell diameters. */
+        HoneycombMeshGenerator generator(rParameters.mMeshWidth, rParameters.mMeshHeight);
+        TetrahedralMesh<2,2>* p_generating_mesh = generator.GetMesh();
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(*p_generating_mesh, 1.5);
+
+        std::vector<CellPtr> cells;
+        DeltaNotchPopulationBuilder builder;
+        builder.CreateCells(mesh.GetNumNodes(), cells);
 
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+        AddWriters(cell_population, rParameters);
+
+        DeltaNotchAdaptiveSimulation<2> simulator(cell_population);
+        ConfigureSimulation(simulator, rParameters);
+
+        MAKE_PTR(GeneralisedLinearSpringForce<2>, p_force);
+        simulator.AddForce(p_force);
+
+        DeltaNotchSimulationSummary summary;
+        double start_time = Timer::GetWallTime();
+        summary.mSetupTime = start_time - setup_start_time;
         simulator.Solve();
+        summary.mWallTime = Timer::GetWallTime() - start_time;
+        summary.mNumTimeSteps = simulator.GetNumTimeStepsTaken();
+        summary.CountCells(cell_population);
+        WriteQuantisationReports();
 
-        DestroySingletons();
+        return summary;
     }
 
     /*
@@ -234,26 +279,219 @@ public:
      */
 private:
 
-    void SetupSingletons(unsigned seed)
+    /*
+     * Add the writers enabled in the parameters to the cell population. The quantised writers are
+     * also stored in {{{mQuantisedWriters}}}, so that their error reports can be written after the run.
+     * A quantised writer is added alongside, not in place of, the full-precision writer of the same quantity.
+     */
+    void AddWriters(AbstractCellPopulation<2>& rCellPopulation, const DeltaNotchSimulationParameters& rParameters)
     {
-        // Set up what the test suite would do
-        SimulationTime::Instance()->SetStartTime(0.0);
-        //RandomNumberGenerator::Instance()->Reseed(time(NULL));
-        //std::stringstream message;
-        //message << "Reseeding with seed " << std::to_string(seed) << std::endl;
-        //std::cout << message.str() << std::flush;
-        RandomNumberGenerator::Instance()->Reseed(seed);
-        CellPropertyRegistry::Instance()->Clear();
-        CellId::ResetMaxCellId();
+        mQuantisedWriters.clear();
+        if (rParameters.IsWriterEnabled("quantised-ages"))
+        {
+            mQuantisedWriters.push_back(boost::shared_ptr<AbstractQuantisedCellWriter<2,2> >(new QuantisedCellAgesWriter<2,2>(rParameters.mQuantisedAgesScale)));
+        }
+        if (rParameters.IsWriterEnabled("quantised-volumes"))
+        {
+            mQuantisedWriters.push_back(boost::shared_ptr<AbstractQuantisedCellWriter<2,2> >(new QuantisedCellVolumesWriter<2,2>(rParameters.mQuantisedVolumesScale)));
+        }
+        if (rParameters.IsWriterEnabled("quantised-phenotype"))
+        {
+            mQuantisedWriters.push_back(boost::shared_ptr<AbstractQuantisedCellWriter<2,2> >(new QuantisedDeltaPhenotypeWriter<2,2>()));
+        }
+        for (unsigned i=0; i<mQuantisedWriters.size(); i++)
+        {
+            rCellPopulation.AddCellWriter(mQuantisedWriters[i]);
+        }
+
+        if (rParameters.IsWriterEnabled("mutation-states-count"))
+        {
+            rCellPopulation.AddCellPopulationCountWriter<CellMutationStatesCountWriter>();
+        }
+        if (rParameters.IsWriterEnabled("proliferative-types-count"))
+        {
+            rCellPopulation.AddCellPopulationCountWriter<CellProliferativeTypesCountWriter>();
+        }
+        if (rParameters.IsWriterEnabled("proliferative-phases-count"))
+        {
+            rCellPopulation.AddCellPopulationCountWriter<CellProliferativePhasesCountWriter>();
+        }
+        if (rParameters.IsWriterEnabled("proliferative-phases"))
+        {
+            rCellPopulation.AddCellWriter<CellProliferativePhasesWriter>();
+        }
+        if (rParameters.IsWriterEnabled("ages"))
+        {
+            rCellPopulation.AddCellWriter<CellAgesWriter>();
+        }
+        if (rParameters.IsWriterEnabled("volumes"))
+        {
+            rCellPopulation.AddCellWriter<CellVolumesWriter>();
+        }
+        if (rParameters.IsWriterEnabled("phenotype"))
+        {
+            rCellPopulation.AddCellWriter<DeltaPhenotypeWriter>();
+        }
+    }
+
+    /*
+     * Set the output directory, time step, sampling and end time of the simulation,
+     * switch on adaptive time stepping if asked to, and add the Delta/Notch modifiers.
+     */
+    void ConfigureSimulation(DeltaNotchAdaptiveSimulation<2>& rSimulator, const DeltaNotchSimulationParameters& rParameters)
+    {
+        rSimulator.SetOutputDirectory(rParameters.mOutputDirectory);
+        if (rParameters.mDt != DOUBLE_UNSET)
+        {
+            rSimulator.SetDt(rParameters.mDt);
+        }
+        rSimulator.SetSamplingTimestepMultiple(rParameters.mSamplingTimestepMultiple);
+        rSimulator.SetEndTime(rParameters.mEndTime);
+
+        rSimulator.SetUseAdaptiveTimeStep(rParameters.mUseAdaptiveTimeStep);
+        if (rParameters.mMinDt != DOUBLE_UNSET)
+        {
+            rSimulator.SetMinDt(rParameters.mMinDt);
+        }
+        if (rParameters.mMaxDt != DOUBLE_UNSET)
+        {
+            rSimulator.SetMaxDt(rParameters.mMaxDt);
+        }
+
+        /* If an event log is wanted, its modifier is added first, so that it has handed the log to the cell
+         * population before the phenotype modifier labels each cell for the first time. Divisions, deaths and
+         * phenotype transitions are then recorded where they happen; see {{{DeltaNotchEventLog}}}. */
+        if (!rParameters.mEventLogFile.empty())
+        {
+            boost::shared_ptr<DeltaNotchEventLogModifier<2> > p_event_log_modifier(new DeltaNotchEventLogModifier<2>(rParameters.mEventLogFile));
+            rSimulator.AddSimulationModifier(p_event_log_modifier);
+        }
+
+        /* If some modifiers are to be updated less often than every time step, or the Delta/Notch ODEs are
+         * sub-cycled, the modifiers are added to a {{{MultiRateModifierScheduler}}} instead of the simulation.
+         * The scheduler is also used when live metrics are published, as it times each modifier; with update
+         * multiples of 1 and no sub-cycles it runs every modifier every time step, so results are unchanged. */
+        boost::shared_ptr<MultiRateModifierScheduler<2> > p_scheduler;
+        if (rParameters.mPhenotypeUpdateMultiple > 1 || rParameters.mTargetAreaUpdateMultiple > 1 || rParameters.mNumOdeSubcycles > 0
+            || !rParameters.mMetricsFile.empty())
+        {
+            p_scheduler.reset(new MultiRateModifierScheduler<2>);
+            p_scheduler->SetNumOdeSubcycles(rParameters.mNumOdeSubcycles);
+            rSimulator.AddSimulationModifier(p_scheduler);
+        }
+
+        /* The metrics modifier is added after the scheduler, so it sees the modifiers' work for each time step. */
+        boost::shared_ptr<DeltaNotchMetricsModifier<2> > p_metrics_modifier;
+        if (!rParameters.mMetricsFile.empty())
+        {
+            p_metrics_modifier.reset(new DeltaNotchMetricsModifier<2>(rParameters.mMetricsFile));
+            p_metrics_modifier->SetInterval(rParameters.mMetricsInterval);
+            p_metrics_modifier->SetScheduler(p_scheduler);
+            rSimulator.AddSimulationModifier(p_metrics_modifier);
+        }
+
+        /* A {{{DeltaPhenotypePolicyModifier}}} also does the work of the three modifiers below, with the phenotype
+         * bands, thresholds and target area coefficients fixed at compile time by a policy class. */
+        if (rParameters.mPhenotypePolicy == "three-band")
+        {
+            boost::shared_ptr<DeltaPhenotypePolicyModifier<2, ThreeBandDeltaPhenotypePolicy> > p_policy_modifier(
+                new DeltaPhenotypePolicyModifier<2, ThreeBandDeltaPhenotypePolicy>);
+            p_policy_modifier->SetUseCompactStorage(rParameters.mUseCompactStorage);
+            p_policy_modifier->SetUseLazyEvaluation(rParameters.mUseLazyTargetAreas);
+            AddModifier(rSimulator, p_scheduler, p_policy_modifier, 1);
+            return;
+        }
+        if (rParameters.mPhenotypePolicy == "five-band")
+        {
+            boost::shared_ptr<DeltaPhenotypePolicyModifier<2, FiveBandDeltaPhenotypePolicy> > p_policy_modifier(
+                new DeltaPhenotypePolicyModifier<2, FiveBandDeltaPhenotypePolicy>);
+            p_policy_modifier->SetUseCompactStorage(rParameters.mUseCompactStorage);
+            p_policy_modifier->SetUseLazyEvaluation(rParameters.mUseLazyTargetAreas);
+            AddModifier(rSimulator, p_scheduler, p_policy_modifier, 1);
+            return;
+        }
+
+        if (rParameters.mUseFusedModifier || rParameters.mUseCompactStorage)
+        {
+            /* The fused modifier does the work of the three modifiers below in a single pass over the cells.
+             * In compact mode it stores less per cell; see {{{DeltaPhenotypeFusedModifier}}}. It updates the mean
+             * neighbouring Delta every time step, and applies the update multiples to the phenotype and target area
+             * work itself, so it is always scheduled every time step. */
+            MAKE_PTR(DeltaPhenotypeFusedModifier<2>, p_fused_modifier);
+            p_fused_modifier->SetUseCompactStorage(rParameters.mUseCompactStorage);
+            p_fused_modifier->SetUseLazyEvaluation(rParameters.mUseLazyTargetAreas);
+            p_fused_modifier->rGetPhenotypeModifier().SetUsePhenotypeProperties(!rParameters.mUseCompactStorage);
+            p_fused_modifier->rGetPhenotypeModifier().SetDeltaHighThreshold(rParameters.mDeltaHighThreshold);
+            p_fused_modifier->rGetPhenotypeModifier().SetDeltaLowThreshold(rParameters.mDeltaLowThreshold);
+            p_fused_modifier->SetDeltaHighPhenotypeTargetAreaCoefficient(rParameters.mDeltaHighTargetAreaCoefficient);
+            p_fused_modifier->SetDeltaLowPhenotypeTargetAreaCoefficient(rParameters.mDeltaLowTargetAreaCoefficient);
+            p_fused_modifier->SetTransientPhenotypeTargetAreaCoefficient(rParameters.mTransientTargetAreaCoefficient);
+            p_fused_modifier->SetPhenotypeUpdateMultiple(rParameters.mPhenotypeUpdateMultiple);
+            p_fused_modifier->SetTargetAreaUpdateMultiple(rParameters.mTargetAreaUpdateMultiple);
+            AddModifier(rSimulator, p_scheduler, p_fused_modifier, 1);
+            if (p_metrics_modifier)
+            {
+                p_metrics_modifier->SetPhenotypeModifier(&(p_fused_modifier->rGetPhenotypeModifier()));
+            }
+            return;
+        }
+
+        /* Then, we define the modifier class, which automatically updates the values of Delta and Notch within the cells in {{{CellData}}} and passes it to the simulation.*/
+        MAKE_PTR(DeltaNotchTrackingModifier<2>, p_modifier);
+        AddModifier(rSimulator, p_scheduler, p_modifier, 1);
+
+        MAKE_PTR(DeltaPhenotypeTrackingModifier<2>, p_dphenotype_modifier);
+        p_dphenotype_modifier->SetDeltaHighThreshold(rParameters.mDeltaHighThreshold);
+        p_dphenotype_modifier->SetDeltaLowThreshold(rParameters.mDeltaLowThreshold);
+        AddModifier(rSimulator, p_scheduler, p_dphenotype_modifier, rParameters.mPhenotypeUpdateMultiple);
+        if (p_metrics_modifier)
+        {
+            p_metrics_modifier->SetPhenotypeModifier(p_dphenotype_modifier.get());
+        }
+
+        /* This modifier assigns target areas to each cell, which are required by the {{{NagaiHondaForce}}}.
+         */
+        MAKE_PTR(DeltaPhenotypeTargetAreaModifier<2>, p_growth_modifier);
+        p_growth_modifier->SetDeltaHighPhenotypeTargetAreaCoefficient(rParameters.mDeltaHighTargetAreaCoefficient);
+        p_growth_modifier->SetDeltaLowPhenotypeTargetAreaCoefficient(rParameters.mDeltaLowTargetAreaCoefficient);
+        p_growth_modifier->SetTransientPhenotypeTargetAreaCoefficient(rParameters.mTransientTargetAreaCoefficient);
+        p_growth_modifier->SetUseLazyEvaluation(rParameters.mUseLazyTargetAreas);
+        AddModifier(rSimulator, p_scheduler, p_growth_modifier, rParameters.mTargetAreaUpdateMultiple);
     }
 
-    void DestroySingletons()
+    /*
+     * Add a modifier to the scheduler, if there is one, to be updated every {{{updateMultiple}}} time steps,
+     * or otherwise to the simulation.
+     */
+    void AddModifier(DeltaNotchAdaptiveSimulation<2>& rSimulator,
+                     boost::shared_ptr<MultiRateModifierScheduler<2> > pScheduler,
+                     boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> > pModifier,
+                     unsigned updateMultiple)
     {
-        // This is from the tearDown method of the test suite
-        SimulationTime::Destroy();
-        RandomNumberGenerator::Destroy();
-        CellPropertyRegistry::Instance()->Clear();
+        if (pScheduler)
+        {
+            pScheduler->AddModifier(pModifier, updateMultiple);
+        }
+        else
+        {
+            rSimulator.AddSimulationModifier(pModifier);
+        }
     }
+
+    /*
+     * Write the error report of each quantised writer.
+     */
+    void WriteQuantisationReports()
+    {
+        for (unsigned i=0; i<mQuantisedWriters.size(); i++)
+        {
+            mQuantisedWriters[i]->WriteErrorReport();
+        }
+        mQuantisedWriters.clear();
+    }
+
+    /** The quantised writers added to the current simulation, if any. */
+    std::vector<boost::shared_ptr<AbstractQuantisedCellWriter<2,2> > > mQuantisedWriters;
 };
 
 #endif /*DELTANOTCHTUTORIALSIMULATION_HPP_*/
@@ -0,0 +1,166 @@
+#ifndef DELTAPHENOTYPEFLAGS_HPP_
+#define DELTAPHENOTYPEFLAGS_HPP_
+
+#include "Cell.hpp"
+#include "DeltaHighPhenotypeProperty.hpp"
+#include "DeltaLowPhenotypeProperty.hpp"
+#include "Exception.hpp"
+#include "MyCellCycleModel.hpp"
+
+/**
+ * The Delta phenotype of a cell. The values match those written by DeltaPhenotypeWriter.
+ */
+typedef enum DeltaPhenotype_
+{
+    DELTA_TRANSIENT = 0,
+    DELTA_LOW = 1,
+    DELTA_HIGH = 2
+} DeltaPhenotype;
+
+/**
+ * Compact per-cell Delta phenotype flags.
+ *
+ * HasCellProperty<DeltaLowPhenotypeProperty>() and HasCellProperty<DeltaHighPhenotypeProperty>()
+ * each scan the cell's CellPropertyCollection, casting every property in turn, and so does
+ * GetCellData(). Instead, the flags are kept in the cell's own MyCellCycleModel, so a lookup
+ * follows one pointer from the cell, without touching its properties. The flags therefore
+ * belong to the cell: they are not shared between populations or replicas, are copied to the
+ * daughter cell at division along with the rest of the cell-cycle model, and go when the cell
+ * is destroyed.
+ *
+ * The flags are set by DeltaPhenotypeTrackingModifier (or DeltaPhenotypePolicyModifier) and read
+ * by the target area modifier and the writers. Until a cell's flags have been set, its phenotype
+ * is read from its properties.
+ *
+ * The DeltaLowPhenotypeProperty and DeltaHighPhenotypeProperty objects are still attached to
+ * cells (by the tracking modifier, only when a cell's phenotype changes), so the visualizer
+ * colours given by GetColour() are unaffected.
+ *
+ * The lowest two bits hold the DeltaPhenotype. The next six bits hold the phenotype band given by
+ * a DeltaPhenotypePolicyModifier, whose policy may have more bands than there are DeltaPhenotype
+ * values; higher bits are free for other per-cell flags.
+ */
+class DeltaPhenotypeFlags
+{
+private:
+
+    /**
+     * @return the cell's MyCellCycleModel, or NULL if it has another cell-cycle model
+     *
+     * @param pCell the cell
+     */
+    static MyCellCycleModel* GetModel(const CellPtr& pCell)
+    {
+        return dynamic_cast<MyCellCycleModel*>(pCell->GetCellCycleModel());
+    }
+
+public:
+
+    /** Mask selecting the DeltaPhenotype bits of the flags. */
+    static const unsigned PHENOTYPE_MASK = 0x3u;
+
+    /** Position of the lowest phenotype band bit in the flags. */
+    static const unsigned BAND_SHIFT = 2u;
+
+    /** Mask selecting the phenotype band bits of the flags. */
+    static const unsigned BAND_MASK = 0xFCu;
+
+    /**
+     * @return the flags of a cell; if they have not yet been set, the phenotype given by its properties
+     *
+     * @param pCell the cell
+     */
+    static unsigned GetFlags(const CellPtr& pCell)
+    {
+        MyCellCycleModel* p_model = GetModel(pCell);
+        if (p_model == NULL || p_model->GetDeltaPhenotypeFlags() == MyCellCycleModel::NO_DELTA_PHENOTYPE_FLAGS)
+        {
+            return FromProperties(pCell);
+        }
+        return p_model->GetDeltaPhenotypeFlags();
+    }
+
+    /**
+     * Set the flags of a cell. The cell must have a MyCellCycleModel, which holds them.
+     *
+     * @param pCell the cell
+     * @param flags the new flags
+     */
+    static void SetFlags(const CellPtr& pCell, unsigned flags)
+    {
+        MyCellCycleModel* p_model = GetModel(pCell);
+        if (p_model == NULL)
+        {
+            EXCEPTION("DeltaPhenotypeFlags are kept in the cell-cycle model, so cells must use MyCellCycleModel");
+        }
+        p_model->SetDeltaPhenotypeFlags(flags);
+    }
+
+    /**
+     * @return the Delta phenotype of a cell
+     *
+     * If the flags have not been set, for example because DeltaPhenotypeTrackingModifier
+     * has not yet visited this cell, the phenotype is read from the cell's properties.
+     *
+     * @param pCell the cell
+     */
+    static DeltaPhenotype GetPhenotype(const CellPtr& pCell)
+    {
+        return static_cast<DeltaPhenotype>(GetFlags(pCell) & PHENOTYPE_MASK);
+    }
+
+    /**
+     * Set the Delta phenotype of a cell, leaving any other flags unchanged.
+     * This does not add or remove any cell properties.
+     *
+     * @param pCell the cell
+     * @param phenotype the new phenotype
+     */
+    static void SetPhenotype(const CellPtr& pCell, DeltaPhenotype phenotype)
+    {
+        SetFlags(pCell, (GetFlags(pCell) & ~PHENOTYPE_MASK) | static_cast<unsigned>(phenotype));
+    }
+
+    /**
+     * @return the phenotype band of a cell, as set by a DeltaPhenotypePolicyModifier, or 0 if none has been set
+     *
+     * @param pCell the cell
+     */
+    static unsigned GetBand(const CellPtr& pCell)
+    {
+        return (GetFlags(pCell) & BAND_MASK) >> BAND_SHIFT;
+    }
+
+    /**
+     * @return whether the flags of a cell have been set
+     *
+     * @param pCell the cell
+     */
+    static bool HasFlags(const CellPtr& pCell)
+    {
+        MyCellCycleModel* p_model = GetModel(pCell);
+        return p_model != NULL && p_model->GetDeltaPhenotypeFlags() != MyCellCycleModel::NO_DELTA_PHENOTYPE_FLAGS;
+    }
+
+private:
+
+    /**
+     * @return the Delta phenotype of a cell, as given by its cell properties
+     *
+     * @param pCell the cell
+     */
+    static unsigned FromProperties(const CellPtr& pCell)
+    {
+        if (pCell->HasCellProperty<DeltaLowPhenotypeProperty>())
+        {
+            return DELTA_LOW;
+        }
+        if (pCell->HasCellProperty<DeltaHighPhenotypeProperty>())
+        {
+            return DELTA_HIGH;
+        }
+        return DELTA_TRANSIENT;
+    }
+};
+
+#endif /*DELTAPHENOTYPEFLAGS_HPP_*/
@@ -0,0 +1,199 @@
+
+#include "DeltaPhenotypeFusedModifier.hpp"
+#include "DeltaNotchSrnModel.hpp"
+#include "Exception.hpp"
+
+template<unsigned DIM>
+DeltaPhenotypeFusedModifier<DIM>::DeltaPhenotypeFusedModifier()
+    : DeltaPhenotypeTargetAreaModifier<DIM>(),
+      mPhenotypeModifier(),
+      mUseCompactStorage(false),
+      mPhenotypeUpdateMultiple(1),
+      mTargetAreaUpdateMultiple(1),
+      mNumTimeSteps(0)
+{
+}
+
+template<unsigned DIM>
+DeltaPhenotypeFusedModifier<DIM>::~DeltaPhenotypeFusedModifier()
+{
+}
+
+template<unsigned DIM>
+DeltaPhenotypeTrackingModifier<DIM>& DeltaPhenotypeFusedModifier<DIM>::rGetPhenotypeModifier()
+{
+    return mPhenotypeModifier;
+}
+
+template<unsigned DIM>
+bool DeltaPhenotypeFusedModifier<DIM>::GetUseCompactStorage()
+{
+    return mUseCompactStorage;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeFusedModifier<DIM>::SetUseCompactStorage(bool useCompactStorage)
+{
+    mUseCompactStorage = useCompactStorage;
+}
+
+template<unsigned DIM>
+double DeltaPhenotypeFusedModifier<DIM>::GetStorageBytes() const
+{
+    return mDeltaByLocation.capacity()*sizeof(double);
+}
+
+template<unsigned DIM>
+unsigned DeltaPhenotypeFusedModifier<DIM>::GetPhenotypeUpdateMultiple()
+{
+    return mPhenotypeUpdateMultiple;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeFusedModifier<DIM>::SetPhenotypeUpdateMultiple(unsigned phenotypeUpdateMultiple)
+{
+    if (phenotypeUpdateMultiple == 0)
+    {
+        EXCEPTION("The phenotype update multiple must be positive");
+    }
+    mPhenotypeUpdateMultiple = phenotypeUpdateMultiple;
+}
+
+template<unsigned DIM>
+unsigned DeltaPhenotypeFusedModifier<DIM>::GetTargetAreaUpdateMultiple()
+{
+    return mTargetAreaUpdateMultiple;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeFusedModifier<DIM>::SetTargetAreaUpdateMultiple(unsigned targetAreaUpdateMultiple)
+{
+    if (targetAreaUpdateMultiple == 0)
+    {
+        EXCEPTION("The target area update multiple must be positive");
+    }
+    mTargetAreaUpdateMultiple = targetAreaUpdateMultiple;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeFusedModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    // Count time steps as MultiRateModifierScheduler does, so results match scheduling the separate modifiers
+    mNumTimeSteps++;
+    UpdateCellData(rCellPopulation, mNumTimeSteps % mPhenotypeUpdateMultiple == 0, mNumTimeSteps % mTargetAreaUpdateMultiple == 0);
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeFusedModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    /*
+     * We must update CellData in SetupSolve(), otherwise it will not have been
+     * fully initialised by the time we enter the main time loop.
+     */
+    mNumTimeSteps = 0;
+    this->ClearStableTargetAreas();
+    UpdateCellData(rCellPopulation);
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeFusedModifier<DIM>::UpdateCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation, bool updatePhenotypes, bool updateTargetAreas)
+{
+    // Make sure the cell population is updated
+    rCellPopulation.Update();
+
+    /*
+     * First recover each cell's Notch and Delta concentrations from the ODEs and store in CellData, or
+     * in compact mode keep Delta for this update, before any target area update can advance an ODE
+     */
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        DeltaNotchSrnModel* p_model = static_cast<DeltaNotchSrnModel*>(cell_iter->GetSrnModel());
+        if (mUseCompactStorage)
+        {
+            unsigned location_index = rCellPopulation.GetLocationIndexUsingCell(*cell_iter);
+            if (location_index >= mDeltaByLocation.size())
+            {
+                mDeltaByLocation.resize(location_index + 1);
+            }
+            mDeltaByLocation[location_index] = p_model->GetDelta();
+        }
+        else
+        {
+            cell_iter->GetCellData()->SetItem("notch", p_model->GetNotch());
+            cell_iter->GetCellData()->SetItem("delta", p_model->GetDelta());
+        }
+    }
+
+    // Next compute each cell's mean neighbouring Delta concentration, then update its phenotype if required
+    if (updatePhenotypes)
+    {
+        mPhenotypeModifier.SetCellPopulation(rCellPopulation);
+    }
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        std::set<unsigned> neighbour_indices = rCellPopulation.GetNeighbouringLocationIndices(*cell_iter);
+
+        if (!neighbour_indices.empty())
+        {
+            double mean_delta = 0.0;
+            for (std::set<unsigned>::iterator iter = neighbour_indices.begin();
+                 iter != neighbour_indices.end();
+                 ++iter)
+            {
+                double this_delta = mUseCompactStorage ? mDeltaByLocation[*iter]
+                                                       : rCellPopulation.GetCellUsingLocationIndex(*iter)->GetCellData()->GetItem("delta");
+                mean_delta += this_delta/neighbour_indices.size();
+            }
+            cell_iter->GetCellData()->SetItem("mean delta", mean_delta);
+        }
+        else
+        {
+            cell_iter->GetCellData()->SetItem("mean delta", -1);
+        }
+
+        if (updatePhenotypes)
+        {
+            if (mUseCompactStorage)
+            {
+                mPhenotypeModifier.UpdatePhenotypeOfCell(*cell_iter, mDeltaByLocation[rCellPopulation.GetLocationIndexUsingCell(*cell_iter)]);
+            }
+            else
+            {
+                mPhenotypeModifier.UpdatePhenotypeOfCell(*cell_iter);
+            }
+        }
+    }
+
+    /*
+     * Finally update the target areas, of the active cells only where possible (see
+     * UpdateTargetAreas()). This must come after every cell's mean Delta, since
+     * UpdateTargetAreaOfCell() may call ReadyToDivide(), which runs the cell's Delta/Notch ODEs
+     * using the "mean delta" stored in CellData. The ODEs only read the cell's own CellData, so
+     * updating target areas here rather than in the loop above does not change results.
+     */
+    if (updateTargetAreas)
+    {
+        this->UpdateTargetAreas(rCellPopulation);
+    }
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeFusedModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<UseCompactStorage>" << mUseCompactStorage << "</UseCompactStorage>\n";
+    *rParamsFile << "\t\t\t<PhenotypeUpdateMultiple>" << mPhenotypeUpdateMultiple << "</PhenotypeUpdateMultiple>\n";
+    *rParamsFile << "\t\t\t<TargetAreaUpdateMultiple>" << mTargetAreaUpdateMultiple << "</TargetAreaUpdateMultiple>\n";
+
+    // Output the parameters of the phenotype modifier, then call method on direct parent class
+    mPhenotypeModifier.OutputSimulationModifierParameters(rParamsFile);
+    DeltaPhenotypeTargetAreaModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class DeltaPhenotypeFusedModifier<1>;
+template class DeltaPhenotypeFusedModifier<2>;
+template class DeltaPhenotypeFusedModifier<3>;
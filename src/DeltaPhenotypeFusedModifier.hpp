@@ -0,0 +1,168 @@
+
+#ifndef DELTAPHENOTYPEFUSEDMODIFIER_HPP_
+#define DELTAPHENOTYPEFUSEDMODIFIER_HPP_
+
+#include <vector>
+
+#include "DeltaPhenotypeTargetAreaModifier.hpp"
+#include "DeltaPhenotypeTrackingModifier.hpp"
+
+/**
+ * A modifier class that performs the work of DeltaNotchTrackingModifier,
+ * DeltaPhenotypeTrackingModifier and DeltaPhenotypeTargetAreaModifier
+ * (in that order) while traversing the cell population as few times as possible.
+ *
+ * The first pass copies each cell's Delta and Notch concentrations from its
+ * DeltaNotchSrnModel into CellData. Since the mean neighbouring Delta needs
+ * every cell's "delta" to be up to date, the mean neighbouring Delta, Delta
+ * phenotype and proliferative type of each cell are then updated together in
+ * a second pass. Target areas are updated last, as by
+ * DeltaPhenotypeTargetAreaModifier::UpdateTargetAreas(), which with lazy
+ * evaluation only visits the cells whose target area may have changed. Results
+ * match running the three modifiers separately.
+ *
+ * Use this modifier in place of the three modifiers above, not in addition to them.
+ *
+ * In compact storage mode, each cell's Delta is read directly from its DeltaNotchSrnModel, so
+ * "delta" and "notch" are not copied into CellData, saving two CellData entries per cell (they
+ * no longer appear in VTK output). When modifiers are called, each SRN model is one time step
+ * behind, having last been solved when the population was updated at the start of the step, and
+ * its Delta is the value that would otherwise be copied into CellData. Updating a cell's target
+ * area may call ReadyToDivide(), which advances that cell's SRN model to the current time, so
+ * every cell's Delta is gathered before any target area is updated, and results are unchanged.
+ *
+ * Each cell's mean neighbouring Delta is updated every time step, since the Delta/Notch ODEs read
+ * it from CellData when they are next solved. The Delta phenotype and target area of each cell may
+ * be updated less often, every #mPhenotypeUpdateMultiple and #mTargetAreaUpdateMultiple time steps
+ * respectively, which gives the same results as scheduling the three modifiers above with these
+ * multiples in a MultiRateModifierScheduler. This modifier should itself be updated every time step.
+ */
+template<unsigned DIM>
+class DeltaPhenotypeFusedModifier : public DeltaPhenotypeTargetAreaModifier<DIM>
+{
+private:
+
+    /**
+     * Modifier used to update the Delta phenotype of each cell.
+     */
+    DeltaPhenotypeTrackingModifier<DIM> mPhenotypeModifier;
+
+    /**
+     * Whether to read Delta from the SRN models rather than storing "delta" and "notch"
+     * in CellData. Defaults to false.
+     */
+    bool mUseCompactStorage;
+
+    /** In compact storage mode, the level of Delta of each cell during an update, indexed by location index. */
+    std::vector<double> mDeltaByLocation;
+
+    /** Number of time steps between updates of the Delta phenotype of each cell. Defaults to 1. */
+    unsigned mPhenotypeUpdateMultiple;
+
+    /** Number of time steps between updates of the target area of each cell. Defaults to 1. */
+    unsigned mTargetAreaUpdateMultiple;
+
+    /** Number of time steps taken since SetupSolve() was called. */
+    unsigned mNumTimeSteps;
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    DeltaPhenotypeFusedModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~DeltaPhenotypeFusedModifier();
+
+    /**
+     * @return reference to the modifier used to update the Delta phenotype of each cell,
+     * for example to set its thresholds
+     */
+    DeltaPhenotypeTrackingModifier<DIM>& rGetPhenotypeModifier();
+
+    /**
+     * @return #mUseCompactStorage
+     */
+    bool GetUseCompactStorage();
+
+    /**
+     * Set #mUseCompactStorage.
+     *
+     * @param useCompactStorage the new value of #mUseCompactStorage
+     */
+    void SetUseCompactStorage(bool useCompactStorage);
+
+    /**
+     * @return the bytes of heap storage this modifier keeps between time steps, for DeltaNotchMemoryReport
+     */
+    double GetStorageBytes() const;
+
+    /**
+     * @return #mPhenotypeUpdateMultiple
+     */
+    unsigned GetPhenotypeUpdateMultiple();
+
+    /**
+     * Set #mPhenotypeUpdateMultiple.
+     *
+     * @param phenotypeUpdateMultiple the new value of #mPhenotypeUpdateMultiple
+     */
+    void SetPhenotypeUpdateMultiple(unsigned phenotypeUpdateMultiple);
+
+    /**
+     * @return #mTargetAreaUpdateMultiple
+     */
+    unsigned GetTargetAreaUpdateMultiple();
+
+    /**
+     * Set #mTargetAreaUpdateMultiple.
+     *
+     * @param targetAreaUpdateMultiple the new value of #mTargetAreaUpdateMultiple
+     */
+    void SetTargetAreaUpdateMultiple(unsigned targetAreaUpdateMultiple);
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Specifies what to do in the simulation at the end of each time step.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Specifies what to do in the simulation before the start of the time loop.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Helper method to update the CellData of every cell in the population and,
+     * if required, its Delta phenotype, proliferative type and target area.
+     *
+     * If a cell has no neighbours, we store the value -1 as its "mean delta",
+     * as is done by DeltaNotchTrackingModifier.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param updatePhenotypes whether to update the Delta phenotype and proliferative type of each cell
+     * @param updateTargetAreas whether to update the target area of each cell
+     */
+    void UpdateCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation, bool updatePhenotypes=true, bool updateTargetAreas=true);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#endif /*DELTAPHENOTYPEFUSEDMODIFIER_HPP_*/
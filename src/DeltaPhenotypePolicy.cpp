@@ -0,0 +1,11 @@
+
+#include "DeltaPhenotypePolicy.hpp"
+
+// Definitions of the policy tables, which are indexed at run time
+constexpr double ThreeBandDeltaPhenotypePolicy::msThresholds[];
+constexpr double ThreeBandDeltaPhenotypePolicy::msTargetAreaCoefficients[];
+constexpr DeltaPhenotype ThreeBandDeltaPhenotypePolicy::msPhenotypes[];
+
+constexpr double FiveBandDeltaPhenotypePolicy::msThresholds[];
+constexpr double FiveBandDeltaPhenotypePolicy::msTargetAreaCoefficients[];
+constexpr DeltaPhenotype FiveBandDeltaPhenotypePolicy::msPhenotypes[];
@@ -0,0 +1,182 @@
+
+#ifndef DELTAPHENOTYPEPOLICY_HPP_
+#define DELTAPHENOTYPEPOLICY_HPP_
+
+#include "DeltaPhenotypeFlags.hpp"
+
+/*
+ * Compile-time phenotype policies for DeltaPhenotypePolicyModifier.
+ *
+ * A policy divides the range of Delta into NUM_BANDS phenotype bands and gives the action for
+ * each band. It is a class with
+ *
+ *  - static const unsigned NUM_BANDS, at least 2 and at most 64;
+ *
+ *  - static const unsigned TRANSIENT_BAND, the band between the Delta-low and Delta-high bands;
+ *
+ *  - static double GetThreshold(unsigned i), for i < NUM_BANDS-1, in increasing order: the
+ *    boundary between band i and band i+1. As in DeltaPhenotypeTrackingModifier, where a cell is
+ *    Delta-low if its Delta is below the low threshold and Delta-high if it is above the high
+ *    threshold, a Delta exactly on a threshold lies in the band nearer TRANSIENT_BAND;
+ *
+ *  - static double GetTargetAreaCoefficient(unsigned band), the target area coefficient of the band;
+ *
+ *  - static bool IsStem(unsigned band), whether cells in the band are made stem cells (otherwise
+ *    they are made differentiated);
+ *
+ *  - static DeltaPhenotype GetPhenotype(unsigned band), the Delta phenotype reported for the band
+ *    by DeltaPhenotypeWriter and the other users of DeltaPhenotypeFlags.
+ *
+ * Since all of these are known to the compiler, the classification and target area coefficient
+ * of each cell reduce to a fixed sequence of comparisons and a table lookup.
+ */
+
+/**
+ * The tutorial's three phenotypes, with the default thresholds and target area coefficients of
+ * DeltaNotchSimulationParameters: Delta-low below 0.2, Delta-high above 0.6 and transient from
+ * 0.2 to 0.6 inclusive, exactly as classified by DeltaPhenotypeTrackingModifier.
+ */
+struct ThreeBandDeltaPhenotypePolicy
+{
+    /** Number of bands. */
+    static const unsigned NUM_BANDS = 3;
+
+    /** The transient band. */
+    static const unsigned TRANSIENT_BAND = 1;
+
+    /** The threshold between each band and the next. */
+    static constexpr double msThresholds[NUM_BANDS-1] = {0.2, 0.6};
+
+    /** The target area coefficient of each band. */
+    static constexpr double msTargetAreaCoefficients[NUM_BANDS] = {0.7, 1.0, 1.5};
+
+    /** The Delta phenotype reported for each band. */
+    static constexpr DeltaPhenotype msPhenotypes[NUM_BANDS] = {DELTA_LOW, DELTA_TRANSIENT, DELTA_HIGH};
+
+    /**
+     * @return the threshold between band i and band i+1
+     *
+     * @param i the index of the threshold
+     */
+    static double GetThreshold(unsigned i)
+    {
+        return msThresholds[i];
+    }
+
+    /**
+     * @return the target area coefficient of a band
+     *
+     * @param band the band
+     */
+    static double GetTargetAreaCoefficient(unsigned band)
+    {
+        return msTargetAreaCoefficients[band];
+    }
+
+    /**
+     * @return whether cells in a band are stem cells
+     *
+     * @param band the band
+     */
+    static bool IsStem(unsigned band)
+    {
+        return band == 2;
+    }
+
+    /**
+     * @return the Delta phenotype reported for a band
+     *
+     * @param band the band
+     */
+    static DeltaPhenotype GetPhenotype(unsigned band)
+    {
+        return msPhenotypes[band];
+    }
+};
+
+/**
+ * Five phenotypes, splitting the tutorial's Delta-low and Delta-high phenotypes into moderate and
+ * extreme bands with their own target area coefficients. Cells above the Delta-high threshold of
+ * 0.6 are stem cells, as for ThreeBandDeltaPhenotypePolicy.
+ */
+struct FiveBandDeltaPhenotypePolicy
+{
+    /** Number of bands. */
+    static const unsigned NUM_BANDS = 5;
+
+    /** The transient band. */
+    static const unsigned TRANSIENT_BAND = 2;
+
+    /** The threshold between each band and the next. */
+    static constexpr double msThresholds[NUM_BANDS-1] = {0.1, 0.2, 0.6, 0.8};
+
+    /** The target area coefficient of each band. */
+    static constexpr double msTargetAreaCoefficients[NUM_BANDS] = {0.6, 0.7, 1.0, 1.5, 1.8};
+
+    /** The Delta phenotype reported for each band. */
+    static constexpr DeltaPhenotype msPhenotypes[NUM_BANDS] = {DELTA_LOW, DELTA_LOW, DELTA_TRANSIENT, DELTA_HIGH, DELTA_HIGH};
+
+    /**
+     * @return the threshold between band i and band i+1
+     *
+     * @param i the index of the threshold
+     */
+    static double GetThreshold(unsigned i)
+    {
+        return msThresholds[i];
+    }
+
+    /**
+     * @return the target area coefficient of a band
+     *
+     * @param band the band
+     */
+    static double GetTargetAreaCoefficient(unsigned band)
+    {
+        return msTargetAreaCoefficients[band];
+    }
+
+    /**
+     * @return whether cells in a band are stem cells
+     *
+     * @param band the band
+     */
+    static bool IsStem(unsigned band)
+    {
+        return band >= 3;
+    }
+
+    /**
+     * @return the Delta phenotype reported for a band
+     *
+     * @param band the band
+     */
+    static DeltaPhenotype GetPhenotype(unsigned band)
+    {
+        return msPhenotypes[band];
+    }
+};
+
+/**
+ * @return the band of a policy in which a level of Delta lies
+ *
+ * Delta passes a threshold below the transient band if it is at or above it, and one at or above
+ * the transient band if it is strictly above it, so the band agrees with DeltaPhenotypeTrackingModifier.
+ * The loop has a fixed trip count and which comparison each threshold uses is known at compile
+ * time, so once unrolled it is a sequence of comparisons without branches, and loops classifying
+ * many cells at once may be vectorised.
+ *
+ * @param delta the level of Delta
+ */
+template<class POLICY>
+inline unsigned ClassifyDelta(double delta)
+{
+    unsigned band = 0;
+    for (unsigned i=0; i<POLICY::NUM_BANDS-1; i++)
+    {
+        band += (i < POLICY::TRANSIENT_BAND) ? (delta >= POLICY::GetThreshold(i)) : (delta > POLICY::GetThreshold(i));
+    }
+    return band;
+}
+
+#endif /*DELTAPHENOTYPEPOLICY_HPP_*/
@@ -0,0 +1,197 @@
+
+#include "DeltaPhenotypePolicyModifier.hpp"
+
+#include "CellPropertyRegistry.hpp"
+#include "DeltaNotchEventLog.hpp"
+#include "DeltaNotchSrnModel.hpp"
+#include "DeltaPhenotypeVertexBasedCellPopulation.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "StemCellProliferativeType.hpp"
+
+template<unsigned DIM, class POLICY>
+DeltaPhenotypePolicyModifier<DIM, POLICY>::DeltaPhenotypePolicyModifier()
+    : DeltaPhenotypeTargetAreaModifier<DIM>(),
+      mUseCompactStorage(false),
+      mNumTransitions(0)
+{
+}
+
+template<unsigned DIM, class POLICY>
+DeltaPhenotypePolicyModifier<DIM, POLICY>::~DeltaPhenotypePolicyModifier()
+{
+}
+
+template<unsigned DIM, class POLICY>
+bool DeltaPhenotypePolicyModifier<DIM, POLICY>::GetUseCompactStorage()
+{
+    return mUseCompactStorage;
+}
+
+template<unsigned DIM, class POLICY>
+void DeltaPhenotypePolicyModifier<DIM, POLICY>::SetUseCompactStorage(bool useCompactStorage)
+{
+    mUseCompactStorage = useCompactStorage;
+}
+
+template<unsigned DIM, class POLICY>
+unsigned DeltaPhenotypePolicyModifier<DIM, POLICY>::GetNumTransitions()
+{
+    return mNumTransitions;
+}
+
+template<unsigned DIM, class POLICY>
+void DeltaPhenotypePolicyModifier<DIM, POLICY>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    UpdateCellData(rCellPopulation);
+}
+
+template<unsigned DIM, class POLICY>
+void DeltaPhenotypePolicyModifier<DIM, POLICY>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    /*
+     * We must update CellData in SetupSolve(), otherwise it will not have been
+     * fully initialised by the time we enter the main time loop.
+     */
+    this->ClearStableTargetAreas();
+    UpdateCellData(rCellPopulation);
+}
+
+template<unsigned DIM, class POLICY>
+void DeltaPhenotypePolicyModifier<DIM, POLICY>::UpdateCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    // Make sure the cell population is updated
+    rCellPopulation.Update();
+
+    // Gather each cell's Delta from its ODEs, storing Delta and Notch in CellData unless storage is compact
+    mCells.clear();
+    mDelta.clear();
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        DeltaNotchSrnModel* p_model = static_cast<DeltaNotchSrnModel*>(cell_iter->GetSrnModel());
+        double delta = p_model->GetDelta();
+        if (!mUseCompactStorage)
+        {
+            cell_iter->GetCellData()->SetItem("notch", p_model->GetNotch());
+            cell_iter->GetCellData()->SetItem("delta", delta);
+        }
+
+        unsigned location_index = rCellPopulation.GetLocationIndexUsingCell(*cell_iter);
+        if (location_index >= mDeltaByLocation.size())
+        {
+            mDeltaByLocation.resize(location_index + 1);
+        }
+        mDeltaByLocation[location_index] = delta;
+        mCells.push_back(*cell_iter);
+        mDelta.push_back(delta);
+    }
+    unsigned num_cells = mCells.size();
+
+    // Compute each cell's mean neighbouring Delta, which its SRN model reads from CellData
+    for (unsigned i=0; i<num_cells; i++)
+    {
+        std::set<unsigned> neighbour_indices = rCellPopulation.GetNeighbouringLocationIndices(mCells[i]);
+
+        double mean_delta = -1.0;
+        if (!neighbour_indices.empty())
+        {
+            mean_delta = 0.0;
+            for (std::set<unsigned>::iterator iter = neighbour_indices.begin();
+                 iter != neighbour_indices.end();
+                 ++iter)
+            {
+                mean_delta += mDeltaByLocation[*iter]/neighbour_indices.size();
+            }
+        }
+        mCells[i]->GetCellData()->SetItem("mean delta", mean_delta);
+    }
+
+    // Classify every cell; the policy is known at compile time, so once ClassifyDelta() and the
+    // coefficient lookup are inlined this loop is only comparisons and table loads
+    mBands.resize(num_cells);
+    mCoefficients.resize(num_cells);
+    for (unsigned i=0; i<num_cells; i++)
+    {
+        unsigned band = ClassifyDelta<POLICY>(mDelta[i]);
+        mBands[i] = band;
+        mCoefficients[i] = POLICY::GetTargetAreaCoefficient(band);
+    }
+
+    // Apply each cell's band, then update its target area
+    boost::shared_ptr<AbstractCellProperty> p_stem_type = CellPropertyRegistry::Instance()->Get<StemCellProliferativeType>();
+    boost::shared_ptr<AbstractCellProperty> p_differentiated_type = CellPropertyRegistry::Instance()->Get<DifferentiatedCellProliferativeType>();
+    DeltaPhenotypeVertexBasedCellPopulation<DIM>* p_population = dynamic_cast<DeltaPhenotypeVertexBasedCellPopulation<DIM>*>(&rCellPopulation);
+    DeltaNotchEventLog* p_log = p_population ? p_population->GetEventLog() : NULL;
+    for (unsigned i=0; i<num_cells; i++)
+    {
+        CellPtr p_cell = mCells[i];
+        unsigned band = mBands[i];
+        p_cell->SetCellProliferativeType(POLICY::IsStem(band) ? p_stem_type : p_differentiated_type);
+        p_cell->InitialiseCellCycleModel();
+
+        unsigned phenotype = POLICY::GetPhenotype(band);
+        bool has_flags = DeltaPhenotypeFlags::HasFlags(p_cell);
+        unsigned flags = has_flags ? DeltaPhenotypeFlags::GetFlags(p_cell) : 0u;
+        unsigned new_flags = (flags & ~(DeltaPhenotypeFlags::PHENOTYPE_MASK | DeltaPhenotypeFlags::BAND_MASK))
+                             | (band << DeltaPhenotypeFlags::BAND_SHIFT) | phenotype;
+        if (!has_flags || new_flags != flags)
+        {
+            unsigned previous_phenotype = DeltaNotchEvent::NO_PHENOTYPE;
+            if (has_flags)
+            {
+                previous_phenotype = flags & DeltaPhenotypeFlags::PHENOTYPE_MASK;
+                mNumTransitions++;
+            }
+            if (p_log && previous_phenotype != phenotype)
+            {
+                p_log->RecordPhenotypeTransition(p_cell, previous_phenotype, phenotype);
+            }
+            DeltaPhenotypeFlags::SetFlags(p_cell, new_flags);
+        }
+    }
+
+    this->PrepareStableTargetAreas(rCellPopulation);
+    std::vector<double>* p_element_target_areas = this->PrepareElementTargetAreas(rCellPopulation);
+    for (unsigned i=0; i<num_cells; i++)
+    {
+        double target_area = this->UpdateTargetAreaOfCellIfNeeded(mCells[i], mBands[i], mCoefficients[i]);
+        if (p_element_target_areas)
+        {
+            (*p_element_target_areas)[rCellPopulation.GetLocationIndexUsingCell(mCells[i])] = target_area;
+        }
+    }
+    if (p_element_target_areas)
+    {
+        static_cast<DeltaPhenotypeVertexBasedCellPopulation<DIM>*>(&rCellPopulation)->SetElementTargetAreasCurrent();
+    }
+
+    // Do not keep the cells alive past this update
+    mCells.clear();
+}
+
+template<unsigned DIM, class POLICY>
+void DeltaPhenotypePolicyModifier<DIM, POLICY>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<UseCompactStorage>" << mUseCompactStorage << "</UseCompactStorage>\n";
+    *rParamsFile << "\t\t\t<NumPhenotypeBands>" << POLICY::NUM_BANDS << "</NumPhenotypeBands>\n";
+    for (unsigned i=0; i<POLICY::NUM_BANDS-1; i++)
+    {
+        *rParamsFile << "\t\t\t<PhenotypeBandThreshold>" << POLICY::GetThreshold(i) << "</PhenotypeBandThreshold>\n";
+    }
+    for (unsigned band=0; band<POLICY::NUM_BANDS; band++)
+    {
+        *rParamsFile << "\t\t\t<PhenotypeBandTargetAreaCoefficient>" << POLICY::GetTargetAreaCoefficient(band) << "</PhenotypeBandTargetAreaCoefficient>\n";
+    }
+
+    // Next, call method on direct parent class
+    DeltaPhenotypeTargetAreaModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class DeltaPhenotypePolicyModifier<1, ThreeBandDeltaPhenotypePolicy>;
+template class DeltaPhenotypePolicyModifier<2, ThreeBandDeltaPhenotypePolicy>;
+template class DeltaPhenotypePolicyModifier<3, ThreeBandDeltaPhenotypePolicy>;
+template class DeltaPhenotypePolicyModifier<1, FiveBandDeltaPhenotypePolicy>;
+template class DeltaPhenotypePolicyModifier<2, FiveBandDeltaPhenotypePolicy>;
+template class DeltaPhenotypePolicyModifier<3, FiveBandDeltaPhenotypePolicy>;
@@ -0,0 +1,134 @@
+
+#ifndef DELTAPHENOTYPEPOLICYMODIFIER_HPP_
+#define DELTAPHENOTYPEPOLICYMODIFIER_HPP_
+
+#include <vector>
+
+#include <boost/static_assert.hpp>
+
+#include "DeltaPhenotypePolicy.hpp"
+#include "DeltaPhenotypeTargetAreaModifier.hpp"
+
+/**
+ * A modifier class that does the work of DeltaPhenotypeFusedModifier, with the phenotype bands,
+ * their thresholds and their actions fixed at compile time by a policy class; see
+ * DeltaPhenotypePolicy.hpp.
+ *
+ * Rather than updating one cell at a time through DeltaPhenotypeTrackingModifier and the runtime
+ * coefficients of DeltaPhenotypeTargetAreaModifier, each update runs over the population in
+ * passes: gather every cell's Delta from its DeltaNotchSrnModel into a contiguous array; compute
+ * each cell's mean neighbouring Delta from that array; classify every cell and look up its target
+ * area coefficient in a branch-free loop over the arrays, which the compiler may vectorise; and
+ * apply the result to each cell. The cell's proliferative type and cell-cycle model are updated
+ * exactly as by DeltaPhenotypeTrackingModifier, in the same cell order, so with
+ * ThreeBandDeltaPhenotypePolicy the simulation follows the same random number stream and reaches
+ * the same state as with the default modifiers.
+ *
+ * The band of each cell is kept in DeltaPhenotypeFlags, alongside the Delta phenotype reported for
+ * it by the policy, so policies may have more bands than there are DeltaPhenotype values. The
+ * DeltaLowPhenotypeProperty and DeltaHighPhenotypeProperty objects are not attached to cells.
+ *
+ * Policies other than those in DeltaPhenotypePolicy.hpp need their own explicit instantiation
+ * at the end of DeltaPhenotypePolicyModifier.cpp.
+ */
+template<unsigned DIM, class POLICY>
+class DeltaPhenotypePolicyModifier : public DeltaPhenotypeTargetAreaModifier<DIM>
+{
+private:
+
+    /** A cell's band is kept in the six bits of DeltaPhenotypeFlags::BAND_MASK. */
+    BOOST_STATIC_ASSERT(POLICY::NUM_BANDS >= 2 && POLICY::NUM_BANDS <= 64);
+
+    /**
+     * Whether to read Delta from the SRN models rather than storing "delta" and "notch"
+     * in CellData, as for DeltaPhenotypeFusedModifier. Defaults to false.
+     */
+    bool mUseCompactStorage;
+
+    /** Number of times a cell already labelled by this modifier has changed band. */
+    unsigned mNumTransitions;
+
+    /** The cells of the population, in iteration order, during an update. */
+    std::vector<CellPtr> mCells;
+
+    /** The level of Delta of each cell in #mCells. */
+    std::vector<double> mDelta;
+
+    /** The level of Delta of each cell, indexed by location index. */
+    std::vector<double> mDeltaByLocation;
+
+    /** The band of each cell in #mCells. */
+    std::vector<unsigned> mBands;
+
+    /** The target area coefficient of each cell in #mCells. */
+    std::vector<double> mCoefficients;
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    DeltaPhenotypePolicyModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~DeltaPhenotypePolicyModifier();
+
+    /**
+     * @return #mUseCompactStorage
+     */
+    bool GetUseCompactStorage();
+
+    /**
+     * Set #mUseCompactStorage.
+     *
+     * @param useCompactStorage the new value of #mUseCompactStorage
+     */
+    void SetUseCompactStorage(bool useCompactStorage);
+
+    /**
+     * @return #mNumTransitions
+     */
+    unsigned GetNumTransitions();
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Specifies what to do in the simulation at the end of each time step.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Specifies what to do in the simulation before the start of the time loop.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Helper method to update the CellData, phenotype band, proliferative type and target area
+     * of every cell in the population.
+     *
+     * If a cell has no neighbours, we store the value -1 as its "mean delta",
+     * as is done by DeltaNotchTrackingModifier.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void UpdateCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#endif /*DELTAPHENOTYPEPOLICYMODIFIER_HPP_*/
@@ -1,9 +1,14 @@
 
 #include "DeltaPhenotypeTargetAreaModifier.hpp"
+
+#include <boost/unordered_set.hpp>
+
 #include "AbstractPhaseBasedCellCycleModel.hpp"
 #include "ApoptoticCellProperty.hpp"
-#include "DeltaHighPhenotypeProperty.hpp"
-#include "DeltaLowPhenotypeProperty.hpp"
+#include "CellPropertyRegistry.hpp"
+#include "DeltaPhenotypeFlags.hpp"
+#include "DeltaPhenotypeVertexBasedCellPopulation.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
 
 template<unsigned DIM>
 DeltaPhenotypeTargetAreaModifier<DIM>::DeltaPhenotypeTargetAreaModifier()
@@ -11,7 +16,11 @@ DeltaPhenotypeTargetAreaModifier<DIM>::DeltaPhenotypeTargetAreaModifier()
       mGrowthDuration(DOUBLE_UNSET),
       mDeltaHighPhenotypeTargetAreaCoefficient(1.0),
       mDeltaLowPhenotypeTargetAreaCoefficient(1.0),
-      mTransientPhenotypeTargetAreaCoefficient(1.0)
+      mTransientPhenotypeTargetAreaCoefficient(1.0),
+      mUseLazyEvaluation(true),
+      mStableReferenceTargetArea(DOUBLE_UNSET),
+      mFullPassNeeded(true),
+      mNumFullPasses(0)
 {
 }
 
@@ -23,43 +32,34 @@ DeltaPhenotypeTargetAreaModifier<DIM>::~DeltaPhenotypeTargetAreaModifier()
 template<unsigned DIM>
 void DeltaPhenotypeTargetAreaModifier<DIM>::UpdateTargetAreaOfCell(CellPtr pCell)
 {
-    // Get target area A of a healthy cell in S, G2 or M phase
-    double cell_target_area = this->mReferenceTargetArea;
+    double cell_target_area = CalculateTargetArea(pCell, GetTargetAreaCoefficient(DeltaPhenotypeFlags::GetPhenotype(pCell)));
 
-    //This is the only bit I change for Delta phenotypes
-    if(pCell->HasCellProperty<DeltaLowPhenotypeProperty>())
-    {
-        cell_target_area *=mDeltaLowPhenotypeTargetAreaCoefficient;
-    }
-    else if(pCell->HasCellProperty<DeltaHighPhenotypeProperty>())
+    // Set cell data
+    pCell->GetCellData()->SetItem("target area", cell_target_area);
+}
+
+template<unsigned DIM>
+double DeltaPhenotypeTargetAreaModifier<DIM>::GetTargetAreaCoefficient(unsigned phenotype)
+{
+    if(phenotype == DELTA_LOW)
     {
-        cell_target_area *=mDeltaHighPhenotypeTargetAreaCoefficient;
+        return mDeltaLowPhenotypeTargetAreaCoefficient;
     }
-    else
-    //if(!((pCell->HasCellProperty<PanethCellProperty>())||(pCell->HasCellProperty<StemCellProperty>())))
+    else if(phenotype == DELTA_HIGH)
     {
-        cell_target_area *=mTransientPhenotypeTargetAreaCoefficient;
+        return mDeltaHighPhenotypeTargetAreaCoefficient;
     }
-    // end of changes
-
-    double growth_duration = mGrowthDuration;
-    if (growth_duration == DOUBLE_UNSET)
-    {
-        if (dynamic_cast<AbstractPhaseBasedCellCycleModel*>(pCell->GetCellCycleModel()) == nullptr)
-        {
-            EXCEPTION("If SetGrowthDuration() has not been called, a subclass of AbstractPhaseBasedCellCycleModel must be used");
-        }
-        AbstractPhaseBasedCellCycleModel* p_model = static_cast<AbstractPhaseBasedCellCycleModel*>(pCell->GetCellCycleModel());
+    return mTransientPhenotypeTargetAreaCoefficient;
+}
 
-        growth_duration = p_model->GetG1Duration();
+template<unsigned DIM>
+double DeltaPhenotypeTargetAreaModifier<DIM>::CalculateTargetArea(const CellPtr pCell, double coefficient)
+{
+    // Get target area A of a healthy cell in S, G2 or M phase
+    double cell_target_area = this->mReferenceTargetArea;
+    cell_target_area *= coefficient;
 
-        // If the cell is differentiated then its G1 duration is infinite
-        if (growth_duration == DBL_MAX)
-        {
-            // This is just for fixed cell-cycle models, need to work out how to find the g1 duration
-            growth_duration = p_model->GetTransitCellG1Duration();
-        }
-    }
+    double growth_duration = GetGrowthDurationOfCell(pCell);
 
     if (pCell->HasCellProperty<ApoptoticCellProperty>())
     {
@@ -102,9 +102,269 @@ void DeltaPhenotypeTargetAreaModifier<DIM>::UpdateTargetAreaOfCell(CellPtr pCell
             }
         }
     }
+    return cell_target_area;
+}
 
-    // Set cell data
-    pCell->GetCellData()->SetItem("target area", cell_target_area);
+template<unsigned DIM>
+double DeltaPhenotypeTargetAreaModifier<DIM>::GetGrowthDurationOfCell(const CellPtr pCell)
+{
+    double growth_duration = mGrowthDuration;
+    if (growth_duration == DOUBLE_UNSET)
+    {
+        if (dynamic_cast<AbstractPhaseBasedCellCycleModel*>(pCell->GetCellCycleModel()) == nullptr)
+        {
+            EXCEPTION("If SetGrowthDuration() has not been called, a subclass of AbstractPhaseBasedCellCycleModel must be used");
+        }
+        AbstractPhaseBasedCellCycleModel* p_model = static_cast<AbstractPhaseBasedCellCycleModel*>(pCell->GetCellCycleModel());
+
+        growth_duration = p_model->GetG1Duration();
+
+        // If the cell is differentiated then its G1 duration is infinite
+        if (growth_duration == DBL_MAX)
+        {
+            // This is just for fixed cell-cycle models, need to work out how to find the g1 duration
+            growth_duration = p_model->GetTransitCellG1Duration();
+        }
+    }
+    return growth_duration;
+}
+
+template<unsigned DIM>
+double DeltaPhenotypeTargetAreaModifier<DIM>::UpdateTargetAreaOfCellIfNeeded(const CellPtr pCell)
+{
+    unsigned phenotype = DeltaPhenotypeFlags::GetPhenotype(pCell);
+    return UpdateTargetAreaOfCellIfNeeded(pCell, phenotype, GetTargetAreaCoefficient(phenotype));
+}
+
+template<unsigned DIM>
+double DeltaPhenotypeTargetAreaModifier<DIM>::UpdateTargetAreaOfCellIfNeeded(const CellPtr pCell, unsigned phenotype, double coefficient)
+{
+    bool is_stable;
+    return UpdateTargetAreaOfCellIfNeeded(pCell, phenotype, coefficient, is_stable);
+}
+
+template<unsigned DIM>
+double DeltaPhenotypeTargetAreaModifier<DIM>::UpdateTargetAreaOfCellIfNeeded(const CellPtr pCell, unsigned phenotype, double coefficient, bool& rIsStable)
+{
+    rIsStable = false;
+    if (!mUseLazyEvaluation)
+    {
+        double target_area = CalculateTargetArea(pCell, coefficient);
+        pCell->GetCellData()->SetItem("target area", target_area);
+        return target_area;
+    }
+
+    typename boost::unordered_map<Cell*, StableTargetArea>::iterator iter = mStableTargetAreas.find(pCell.get());
+    if (iter != mStableTargetAreas.end())
+    {
+        // While the recorded cell is alive, no other cell can have its address
+        const StableTargetArea& r_stable = iter->second;
+        if (!r_stable.mpCell.expired()
+            && r_stable.mBirthTime == pCell->GetBirthTime()
+            && r_stable.mPhenotype == phenotype
+            && !pCell->HasCellProperty<ApoptoticCellProperty>())
+        {
+            rIsStable = true;
+            return r_stable.mTargetArea;
+        }
+        mStableTargetAreas.erase(iter);
+    }
+
+    double target_area = CalculateTargetArea(pCell, coefficient);
+    pCell->GetCellData()->SetItem("target area", target_area);
+
+    /*
+     * Only differentiated cells that have finished growing are recorded: the target area of a growing
+     * or apoptotic cell changes every step, and a proliferating cell's is halved when it is ready to divide.
+     */
+    if (pCell->GetCellProliferativeType()->IsType<DifferentiatedCellProliferativeType>()
+        && !pCell->HasCellProperty<ApoptoticCellProperty>()
+        && pCell->GetAge() >= GetGrowthDurationOfCell(pCell))
+    {
+        StableTargetArea stable;
+        stable.mpCell = pCell;
+        stable.mBirthTime = pCell->GetBirthTime();
+        stable.mPhenotype = phenotype;
+        stable.mTargetArea = target_area;
+        mStableTargetAreas[pCell.get()] = stable;
+        rIsStable = true;
+    }
+    return target_area;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeTargetAreaModifier<DIM>::PrepareStableTargetAreas(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (this->mReferenceTargetArea != mStableReferenceTargetArea)
+    {
+        ClearStableTargetAreas();
+        mStableReferenceTargetArea = this->mReferenceTargetArea;
+    }
+
+    // Entries of dead cells are only found by a full scan, so rebuild the table when they could dominate it
+    unsigned num_cells = rCellPopulation.GetNumRealCells();
+    if (mStableTargetAreas.size() > 2*num_cells)
+    {
+        boost::unordered_map<Cell*, StableTargetArea> live_stable_target_areas;
+        for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+             cell_iter != rCellPopulation.End();
+             ++cell_iter)
+        {
+            typename boost::unordered_map<Cell*, StableTargetArea>::iterator iter = mStableTargetAreas.find(cell_iter->get());
+            if (iter != mStableTargetAreas.end())
+            {
+                live_stable_target_areas.insert(*iter);
+            }
+        }
+        mStableTargetAreas.swap(live_stable_target_areas);
+    }
+}
+
+template<unsigned DIM>
+unsigned DeltaPhenotypeTargetAreaModifier<DIM>::GetNumStableTargetAreas()
+{
+    return mStableTargetAreas.size();
+}
+
+template<unsigned DIM>
+unsigned DeltaPhenotypeTargetAreaModifier<DIM>::GetNumActiveCells()
+{
+    return mActiveCells.size();
+}
+
+template<unsigned DIM>
+unsigned DeltaPhenotypeTargetAreaModifier<DIM>::GetNumFullPasses()
+{
+    return mNumFullPasses;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeTargetAreaModifier<DIM>::UpdateTargetAreas(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    PrepareStableTargetAreas(rCellPopulation);
+
+    // Also fill the population's per-element target areas, if it keeps them
+    std::vector<double>* p_element_target_areas = PrepareElementTargetAreas(rCellPopulation);
+    DeltaPhenotypeVertexBasedCellPopulation<DIM>* p_population = dynamic_cast<DeltaPhenotypeVertexBasedCellPopulation<DIM>*>(&rCellPopulation);
+    bool use_active_cells = mUseLazyEvaluation && p_population;
+
+    if (use_active_cells && !mFullPassNeeded && p_population->AreElementTargetAreasCurrent())
+    {
+        // Visit the active cells and the cells marked since the last pass, once each
+        std::vector<CellPtr>& r_stale_cells = p_population->rGetCellsWithStaleTargetAreas();
+        mActiveCells.insert(mActiveCells.end(), r_stale_cells.begin(), r_stale_cells.end());
+        r_stale_cells.clear();
+
+        std::vector<CellPtr> still_active_cells;
+        boost::unordered_set<Cell*> visited_cells;
+        unsigned num_apoptotic_cells = 0;
+        for (unsigned i=0; i<mActiveCells.size(); i++)
+        {
+            CellPtr p_cell = mActiveCells[i];
+            if (p_cell->IsDead() || !visited_cells.insert(p_cell.get()).second)
+            {
+                continue;
+            }
+
+            bool is_stable;
+            unsigned phenotype = DeltaPhenotypeFlags::GetPhenotype(p_cell);
+            double target_area = UpdateTargetAreaOfCellIfNeeded(p_cell, phenotype, GetTargetAreaCoefficient(phenotype), is_stable);
+            (*p_element_target_areas)[rCellPopulation.GetLocationIndexUsingCell(p_cell)] = target_area;
+            if (!is_stable)
+            {
+                still_active_cells.push_back(p_cell);
+            }
+            if (p_cell->HasCellProperty<ApoptoticCellProperty>())
+            {
+                num_apoptotic_cells++;
+            }
+        }
+        mActiveCells.swap(still_active_cells);
+
+        // Apoptotic cells are never stable, so any apoptotic cell not visited was stable until now
+        if (num_apoptotic_cells == rCellPopulation.GetCellPropertyRegistry()->template Get<ApoptoticCellProperty>()->GetCellCount())
+        {
+            p_population->SetElementTargetAreasCurrent();
+            return;
+        }
+    }
+
+    // Otherwise update every cell, noting the cells that are not stable if they are to be tracked
+    mFullPassNeeded = false;
+    mNumFullPasses++;
+    mActiveCells.clear();
+    if (p_population)
+    {
+        p_population->rGetCellsWithStaleTargetAreas().clear();
+        p_population->SetRecordCellsWithStaleTargetAreas(use_active_cells);
+    }
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        bool is_stable;
+        unsigned phenotype = DeltaPhenotypeFlags::GetPhenotype(*cell_iter);
+        double target_area = UpdateTargetAreaOfCellIfNeeded(*cell_iter, phenotype, GetTargetAreaCoefficient(phenotype), is_stable);
+        if (p_element_target_areas)
+        {
+            (*p_element_target_areas)[rCellPopulation.GetLocationIndexUsingCell(*cell_iter)] = target_area;
+        }
+        if (use_active_cells && !is_stable)
+        {
+            mActiveCells.push_back(*cell_iter);
+        }
+    }
+    if (p_population)
+    {
+        p_population->SetElementTargetAreasCurrent();
+    }
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeTargetAreaModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    UpdateTargetAreas(rCellPopulation);
+}
+
+template<unsigned DIM>
+std::vector<double>* DeltaPhenotypeTargetAreaModifier<DIM>::PrepareElementTargetAreas(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    DeltaPhenotypeVertexBasedCellPopulation<DIM>* p_population = dynamic_cast<DeltaPhenotypeVertexBasedCellPopulation<DIM>*>(&rCellPopulation);
+    if (p_population == nullptr)
+    {
+        return nullptr;
+    }
+    std::vector<double>& r_element_target_areas = p_population->rGetElementTargetAreas();
+    r_element_target_areas.resize(p_population->rGetMesh().GetNumAllElements());
+    return &r_element_target_areas;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeTargetAreaModifier<DIM>::ClearStableTargetAreas()
+{
+    mStableTargetAreas.clear();
+    mActiveCells.clear();
+    mFullPassNeeded = true;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeTargetAreaModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    ClearStableTargetAreas();
+    UpdateAtEndOfTimeStep(rCellPopulation);
+}
+
+template<unsigned DIM>
+bool DeltaPhenotypeTargetAreaModifier<DIM>::GetUseLazyEvaluation()
+{
+    return mUseLazyEvaluation;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeTargetAreaModifier<DIM>::SetUseLazyEvaluation(bool useLazyEvaluation)
+{
+    mUseLazyEvaluation = useLazyEvaluation;
+    ClearStableTargetAreas();
 }
 
 template<unsigned DIM>
@@ -118,6 +378,7 @@ void DeltaPhenotypeTargetAreaModifier<DIM>::SetGrowthDuration(double growthDurat
 {
     assert(growthDuration >= 0.0);
     mGrowthDuration = growthDuration;
+    ClearStableTargetAreas();
 }
 
 template<unsigned DIM> double DeltaPhenotypeTargetAreaModifier<DIM>::GetDeltaHighPhenotypeTargetAreaCoefficient()
@@ -129,6 +390,7 @@ template<unsigned DIM> void DeltaPhenotypeTargetAreaModifier<DIM>::SetDeltaHighP
 {
     assert(deltaHighPhenotypeTargetAreaCoefficient >= 0.0);
     mDeltaHighPhenotypeTargetAreaCoefficient = deltaHighPhenotypeTargetAreaCoefficient;
+    ClearStableTargetAreas();
 }
 
 template<unsigned DIM> double DeltaPhenotypeTargetAreaModifier<DIM>::GetDeltaLowPhenotypeTargetAreaCoefficient()
@@ -140,6 +402,7 @@ template<unsigned DIM> void DeltaPhenotypeTargetAreaModifier<DIM>::SetDeltaLowPh
 {
     assert(deltaLowPhenotypeTargetAreaCoefficient >= 0.0);
     mDeltaLowPhenotypeTargetAreaCoefficient = deltaLowPhenotypeTargetAreaCoefficient;
+    ClearStableTargetAreas();
 }
 
 template<unsigned DIM> double DeltaPhenotypeTargetAreaModifier<DIM>::GetTransientPhenotypeTargetAreaCoefficient()
@@ -151,6 +414,7 @@ template<unsigned DIM> void DeltaPhenotypeTargetAreaModifier<DIM>::SetTransientP
 {
     assert(transientPhenotypeTargetAreaCoefficient >= 0.0);
     mTransientPhenotypeTargetAreaCoefficient = transientPhenotypeTargetAreaCoefficient;
+    ClearStableTargetAreas();
 }
 
 template<unsigned DIM>
@@ -160,6 +424,7 @@ void DeltaPhenotypeTargetAreaModifier<DIM>::OutputSimulationModifierParameters(o
     *rParamsFile << "\t\t\t<DeltaHighPhenotypeTargetAreaCoefficient>" << mDeltaHighPhenotypeTargetAreaCoefficient << "</DeltaHighPhenotypeTargetAreaCoefficient>\n";
     *rParamsFile << "\t\t\t<DeltaLowPhenotypeTargetAreaCoefficient>" << mDeltaLowPhenotypeTargetAreaCoefficient << "</DeltaLowPhenotypeTargetAreaCoefficient>\n";
     *rParamsFile << "\t\t\t<TransientPhenotypeTargetAreaCoefficient>" << mTransientPhenotypeTargetAreaCoefficient << "</TransientPhenotypeTargetAreaCoefficient>\n";
+    *rParamsFile << "\t\t\t<UseLazyEvaluation>" << mUseLazyEvaluation << "</UseLazyEvaluation>\n";
 
     // Next, call method on direct parent class
     AbstractTargetAreaModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
@@ -2,11 +2,35 @@
 #ifndef DELTAPHENOTYPETARGETAREAMODIFIER_HPP_
 #define DELTAPHENOTYPETARGETAREAMODIFIER_HPP_
 
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+#include <boost/weak_ptr.hpp>
+
 #include "AbstractTargetAreaModifier.hpp"
 
 // consider that Delta-high cells and Delta-low cells have different target areas
 // cells which are neither Delta-high nor Delta low have another target area
- 
+
+/**
+ * The state of a cell when its target area was last computed, kept by DeltaPhenotypeTargetAreaModifier
+ * to decide whether the target area may have changed since.
+ */
+struct StableTargetArea
+{
+    /** The cell, which has expired if the cell has died and its address may have been reused. */
+    boost::weak_ptr<Cell> mpCell;
+
+    /** The cell's birth time, which changes when the cell divides. */
+    double mBirthTime;
+
+    /** The cell's Delta phenotype. */
+    unsigned mPhenotype;
+
+    /** The target area. */
+    double mTargetArea;
+};
+
 template<unsigned DIM>
 class DeltaPhenotypeTargetAreaModifier : public AbstractTargetAreaModifier<DIM>
 {
@@ -22,6 +46,75 @@ class DeltaPhenotypeTargetAreaModifier : public AbstractTargetAreaModifier<DIM>
     double mDeltaLowPhenotypeTargetAreaCoefficient;
     double mTransientPhenotypeTargetAreaCoefficient;
 
+    /**
+     * Whether to skip cells whose target area cannot have changed since it was last computed;
+     * see UpdateTargetAreaOfCellIfNeeded(). Defaults to true.
+     */
+    bool mUseLazyEvaluation;
+
+    /**
+     * The state of each cell with a stable target area when it was computed, keyed by cell.
+     * Cells whose target area changes from step to step (growing, apoptotic or proliferating
+     * cells) have no entry.
+     */
+    boost::unordered_map<Cell*, StableTargetArea> mStableTargetAreas;
+
+    /** The reference target area when #mStableTargetAreas was filled. */
+    double mStableReferenceTargetArea;
+
+    /**
+     * The cells whose target area was not stable at the last pass of UpdateTargetAreas(), which with
+     * lazy evaluation and a DeltaPhenotypeVertexBasedCellPopulation are the cells updated at the next.
+     */
+    std::vector<CellPtr> mActiveCells;
+
+    /** Whether the next pass of UpdateTargetAreas() must update every cell. */
+    bool mFullPassNeeded;
+
+    /** Number of passes of UpdateTargetAreas() that updated every cell. */
+    unsigned mNumFullPasses;
+
+    /**
+     * @return the duration over which a cell's target area grows after birth
+     *
+     * @param pCell pointer to the cell
+     */
+    double GetGrowthDurationOfCell(const CellPtr pCell);
+
+    /**
+     * As UpdateTargetAreaOfCellIfNeeded(const CellPtr, unsigned, double), also reporting whether
+     * the cell's target area is now recorded as stable.
+     *
+     * @param pCell pointer to the cell
+     * @param phenotype the cell's phenotype, or any value that changes whenever the coefficient does
+     * @param coefficient the target area coefficient of the cell's phenotype
+     * @param rIsStable set to whether the cell has an entry in #mStableTargetAreas
+     * @return the cell's target area
+     */
+    double UpdateTargetAreaOfCellIfNeeded(const CellPtr pCell, unsigned phenotype, double coefficient, bool& rIsStable);
+
+protected:
+
+    /**
+     * @return the target area of a cell with the given target area coefficient, allowing for its
+     * growth after birth, apoptosis and imminent division
+     *
+     * @param pCell pointer to the cell
+     * @param coefficient the target area coefficient of the cell's phenotype
+     */
+    double CalculateTargetArea(const CellPtr pCell, double coefficient);
+
+    /**
+     * As UpdateTargetAreaOfCellIfNeeded(const CellPtr), for a cell whose phenotype and target area
+     * coefficient are already known, for example from a DeltaPhenotypePolicyModifier's policy.
+     *
+     * @param pCell pointer to the cell
+     * @param phenotype the cell's phenotype, or any value that changes whenever the coefficient does
+     * @param coefficient the target area coefficient of the cell's phenotype
+     * @return the cell's target area
+     */
+    double UpdateTargetAreaOfCellIfNeeded(const CellPtr pCell, unsigned phenotype, double coefficient);
+
 public:
 
     /**
@@ -41,6 +134,126 @@ public:
      */
     virtual void UpdateTargetAreaOfCell(const CellPtr pCell);
 
+    /**
+     * Update the target area of a cell, unless it cannot have changed since it was last computed.
+     *
+     * Once a differentiated, non-apoptotic cell has finished growing its target area depends only on
+     * its phenotype, so it is stable until the cell changes phenotype, becomes apoptotic or divides.
+     * Such cells are recorded in #mStableTargetAreas, and for them this method only looks up the
+     * table and checks the cell's birth time and apoptotic state, rather than computing the target
+     * area and writing it to CellData. Growing, apoptotic and proliferating cells are updated every
+     * time, as without lazy evaluation.
+     *
+     * Lazy evaluation does not save the work of a stable cell's Delta/Notch ODEs: skipping
+     * CalculateTargetArea() skips a ReadyToDivide() call, and the ODEs are then solved in the next
+     * time step's division check instead, with the same inputs, so results are unchanged. See
+     * UpdateTargetAreas() for how stable cells are skipped without being visited.
+     *
+     * @param pCell pointer to the cell
+     * @return the cell's target area
+     */
+    double UpdateTargetAreaOfCellIfNeeded(const CellPtr pCell);
+
+    /**
+     * Update the target area of every cell of the population whose target area may have changed,
+     * and fill the population's per-element target areas if it keeps them.
+     *
+     * Without lazy evaluation, or with a population other than DeltaPhenotypeVertexBasedCellPopulation,
+     * every cell is visited, through UpdateTargetAreaOfCellIfNeeded(). Otherwise only the active cells
+     * are visited: those whose target area was not stable at the last pass (growing, apoptotic and
+     * proliferating cells), and those the population has marked as stale since, because they divided
+     * or changed phenotype (see DeltaPhenotypeVertexBasedCellPopulation::MarkTargetAreaStale()). A
+     * stable cell leaves the active cells and is not visited again until it is marked. So between
+     * full passes, the cost of a pass is proportional to the number of active cells rather than to
+     * the size of the population.
+     *
+     * Every cell is visited at the first pass, after the stable target areas have been forgotten,
+     * after cells are removed (which renumbers the elements, so every per-element target area must
+     * be rewritten), and when a cell has become apoptotic while stable. The last is detected by
+     * comparing the apoptotic cells among the active cells with the cell count of the population's
+     * ApoptoticCellProperty, so is caught at the pass it happens.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void UpdateTargetAreas(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * @return the target area coefficient of a Delta phenotype
+     *
+     * @param phenotype the phenotype
+     */
+    double GetTargetAreaCoefficient(unsigned phenotype);
+
+    /**
+     * If the cell population is a DeltaPhenotypeVertexBasedCellPopulation, size its per-element
+     * target areas for filling. The caller fills them and calls SetElementTargetAreasCurrent().
+     *
+     * @param rCellPopulation reference to the cell population
+     * @return the per-element target areas, or nullptr if the population does not keep them
+     */
+    std::vector<double>* PrepareElementTargetAreas(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Prepare #mStableTargetAreas for a pass over the cell population: forget every cell if the
+     * reference target area has changed, and forget cells that are no longer in the population
+     * once they make up most of the table.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void PrepareStableTargetAreas(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Forget every stable target area, so that each cell is updated at the next pass.
+     */
+    void ClearStableTargetAreas();
+
+    /**
+     * @return the number of cells whose target area is currently recorded as stable
+     */
+    unsigned GetNumStableTargetAreas();
+
+    /**
+     * @return the number of cells to be updated at the next pass of UpdateTargetAreas(), besides
+     * any marked as stale by the population, unless it updates every cell
+     */
+    unsigned GetNumActiveCells();
+
+    /**
+     * @return #mNumFullPasses
+     */
+    unsigned GetNumFullPasses();
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Updates the target area of each cell, skipping cells with a stable target area; see UpdateTargetAreas().
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Forgets any stable target areas and updates the target area of every cell.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * @return #mUseLazyEvaluation
+     */
+    bool GetUseLazyEvaluation();
+
+    /**
+     * Set #mUseLazyEvaluation.
+     *
+     * @param useLazyEvaluation the new value of #mUseLazyEvaluation
+     */
+    void SetUseLazyEvaluation(bool useLazyEvaluation);
+
     /**
      * @return #mGrowthDuration
      */
@@ -5,6 +5,7 @@
 #include "CellPropertyRegistry.hpp"
 #include "DeltaHighPhenotypeProperty.hpp"
 #include "DeltaLowPhenotypeProperty.hpp"
+#include "DeltaPhenotypeFlags.hpp"
 
 #include "DifferentiatedCellProliferativeType.hpp"
 #include "StemCellProliferativeType.hpp"
@@ -12,7 +13,12 @@
 
 template<unsigned DIM>
 DeltaPhenotypeTrackingModifier<DIM>::DeltaPhenotypeTrackingModifier()
-    : AbstractCellBasedSimulationModifier<DIM>()
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mUsePhenotypeProperties(true),
+      mDeltaHighThreshold(0.6),
+      mDeltaLowThreshold(0.2),
+      mNumTransitions(0),
+      mpCellPopulation(NULL)
 {
 }
 
@@ -42,54 +48,148 @@ void DeltaPhenotypeTrackingModifier<DIM>::UpdateCellData(AbstractCellPopulation<
 {
     // Make sure the cell population is updated
     rCellPopulation.Update();
-
-    MAKE_PTR(DeltaHighPhenotypeProperty, p_dhigh);
-    MAKE_PTR(DeltaLowPhenotypeProperty, p_dlow);
-    
+    SetCellPopulation(rCellPopulation);
 
     for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
          cell_iter != rCellPopulation.End();
          ++cell_iter)
     {
-        
-        double this_delta = cell_iter->GetCellData()->GetItem("delta");
+        UpdatePhenotypeOfCell(*cell_iter);
+    }
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeTrackingModifier<DIM>::UpdatePhenotypeOfCell(CellPtr pCell)
+{
+    UpdatePhenotypeOfCell(pCell, pCell->GetCellData()->GetItem("delta"));
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeTrackingModifier<DIM>::UpdatePhenotypeOfCell(CellPtr pCell, double this_delta)
+{
+    DeltaPhenotype new_phenotype = DELTA_TRANSIENT;
+    if(this_delta>mDeltaHighThreshold)
+    {
+        new_phenotype = DELTA_HIGH;
+        pCell->SetCellProliferativeType(CellPropertyRegistry::Instance()->Get<StemCellProliferativeType>());
+        pCell->InitialiseCellCycleModel();
+    }
+    else
+    {
+        // if Delta is below the Delta-high threshold, the cell stops dividing
+        pCell->SetCellProliferativeType(CellPropertyRegistry::Instance()->Get<DifferentiatedCellProliferativeType>());
+        pCell->InitialiseCellCycleModel();
+
+        if(this_delta<mDeltaLowThreshold)
+        {
+            new_phenotype = DELTA_LOW;
+        }
+        // otherwise delta lies between the thresholds, and the cell has neither Delta-high nor Delta-low phenotype
+    }
 
-        if(this_delta>0.6)
+    /*
+     * The phenotype properties are only touched when the phenotype changes, or the first
+     * time we see a cell; otherwise the cell's DeltaPhenotypeFlags are enough.
+     */
+    unsigned previous_phenotype = DeltaNotchEvent::NO_PHENOTYPE;
+    if (DeltaPhenotypeFlags::HasFlags(pCell))
+    {
+        previous_phenotype = DeltaPhenotypeFlags::GetPhenotype(pCell);
+        if (previous_phenotype == static_cast<unsigned>(new_phenotype))
+        {
+            return;
+        }
+        mNumTransitions++;
+    }
+
+    if (mpCellPopulation)
+    {
+        if (mpCellPopulation->GetEventLog())
+        {
+            mpCellPopulation->GetEventLog()->RecordPhenotypeTransition(pCell, previous_phenotype, new_phenotype);
+        }
+        mpCellPopulation->MarkTargetAreaStale(pCell);
+    }
+
+    if (mUsePhenotypeProperties)
+    {
+        // The properties are shared by all cells, via the registry
+        if (new_phenotype != DELTA_LOW && pCell->HasCellProperty<DeltaLowPhenotypeProperty>())
+        {
+            pCell->RemoveCellProperty<DeltaLowPhenotypeProperty>();
+        }
+        if (new_phenotype != DELTA_HIGH && pCell->HasCellProperty<DeltaHighPhenotypeProperty>())
+        {
+            pCell->RemoveCellProperty<DeltaHighPhenotypeProperty>();
+        }
+        if (new_phenotype == DELTA_LOW && !pCell->HasCellProperty<DeltaLowPhenotypeProperty>())
         {
-            if(cell_iter->template HasCellProperty<DeltaLowPhenotypeProperty>())
-                cell_iter->template RemoveCellProperty<DeltaLowPhenotypeProperty>();
-            if(!(cell_iter->template HasCellProperty<DeltaHighPhenotypeProperty>()))
-                cell_iter->template AddCellProperty(p_dhigh); //StemCellProliferativeType
-            cell_iter->template SetCellProliferativeType(CellPropertyRegistry::Instance()->Get<StemCellProliferativeType>());
-            cell_iter->InitialiseCellCycleModel();
+            pCell->AddCellProperty(CellPropertyRegistry::Instance()->Get<DeltaLowPhenotypeProperty>());
         }
-        else // < 0.6
+        if (new_phenotype == DELTA_HIGH && !pCell->HasCellProperty<DeltaHighPhenotypeProperty>())
         {
-            if(cell_iter->template HasCellProperty<DeltaHighPhenotypeProperty>())
-                cell_iter->template RemoveCellProperty<DeltaHighPhenotypeProperty>();
-            // if Delta < 0.6, the cell stops dividing 
-            cell_iter->template SetCellProliferativeType(CellPropertyRegistry::Instance()->Get<DifferentiatedCellProliferativeType>());
-            cell_iter->InitialiseCellCycleModel();
-
-            if(this_delta<0.2)  // >0.6
-            {
-                if(!(cell_iter->template HasCellProperty<DeltaLowPhenotypeProperty>()))
-                    cell_iter->template AddCellProperty(p_dlow);
-            }
-            else    // [0.2, 0.6]
-            {   // in this case, i.e. delta in [0.2, 0.6] we remove all labels. i.e. cell has neither Delta-high nor Delta-low phenotype
-                if(cell_iter->template HasCellProperty<DeltaLowPhenotypeProperty>())
-                    cell_iter->template RemoveCellProperty<DeltaLowPhenotypeProperty>();
-            }
+            pCell->AddCellProperty(CellPropertyRegistry::Instance()->Get<DeltaHighPhenotypeProperty>());
         }
     }
+    DeltaPhenotypeFlags::SetPhenotype(pCell, new_phenotype);
+}
 
+template<unsigned DIM>
+void DeltaPhenotypeTrackingModifier<DIM>::SetCellPopulation(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    mpCellPopulation = dynamic_cast<DeltaPhenotypeVertexBasedCellPopulation<DIM>*>(&rCellPopulation);
+}
+
+template<unsigned DIM>
+double DeltaPhenotypeTrackingModifier<DIM>::GetDeltaHighThreshold()
+{
+    return mDeltaHighThreshold;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeTrackingModifier<DIM>::SetDeltaHighThreshold(double deltaHighThreshold)
+{
+    mDeltaHighThreshold = deltaHighThreshold;
+}
+
+template<unsigned DIM>
+double DeltaPhenotypeTrackingModifier<DIM>::GetDeltaLowThreshold()
+{
+    return mDeltaLowThreshold;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeTrackingModifier<DIM>::SetDeltaLowThreshold(double deltaLowThreshold)
+{
+    mDeltaLowThreshold = deltaLowThreshold;
+}
+
+template<unsigned DIM>
+bool DeltaPhenotypeTrackingModifier<DIM>::GetUsePhenotypeProperties()
+{
+    return mUsePhenotypeProperties;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeTrackingModifier<DIM>::SetUsePhenotypeProperties(bool usePhenotypeProperties)
+{
+    mUsePhenotypeProperties = usePhenotypeProperties;
+}
+
+template<unsigned DIM>
+unsigned DeltaPhenotypeTrackingModifier<DIM>::GetNumTransitions()
+{
+    return mNumTransitions;
 }
 
 template<unsigned DIM>
 void DeltaPhenotypeTrackingModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
 {
-    // No parameters to output, so just call method on direct parent class
+    *rParamsFile << "\t\t\t<DeltaHighThreshold>" << mDeltaHighThreshold << "</DeltaHighThreshold>\n";
+    *rParamsFile << "\t\t\t<DeltaLowThreshold>" << mDeltaLowThreshold << "</DeltaLowThreshold>\n";
+    *rParamsFile << "\t\t\t<UsePhenotypeProperties>" << mUsePhenotypeProperties << "</UsePhenotypeProperties>\n";
+
+    // Next, call method on direct parent class
     AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
 }
 
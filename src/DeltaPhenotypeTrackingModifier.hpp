@@ -3,6 +3,7 @@
 #define DELTAPHENOTYPETRACKINGMODIFIER_HPP_
 
 #include "AbstractCellBasedSimulationModifier.hpp"
+#include "DeltaPhenotypeVertexBasedCellPopulation.hpp"
 
 /**
  * A modifier class in which contact areas with Paneth and stem cells
@@ -11,6 +12,32 @@
 template<unsigned DIM>
 class DeltaPhenotypeTrackingModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
 {
+private:
+
+    /**
+     * Whether to label cells with DeltaHighPhenotypeProperty and DeltaLowPhenotypeProperty, as well as
+     * with DeltaPhenotypeFlags. Switching this off saves a property collection entry per labelled cell.
+     * Defaults to true.
+     */
+    bool mUsePhenotypeProperties;
+
+    /**
+     * Cells with Delta above this value have the Delta-high phenotype. Defaults to 0.6.
+     */
+    double mDeltaHighThreshold;
+
+    /**
+     * Cells with Delta below this value have the Delta-low phenotype. Defaults to 0.2.
+     */
+    double mDeltaLowThreshold;
+
+    /**
+     * Number of times a cell already labelled by this modifier has changed phenotype.
+     */
+    unsigned mNumTransitions;
+
+    /** The cell population, if it is a DeltaPhenotypeVertexBasedCellPopulation, or NULL; see SetCellPopulation(). */
+    DeltaPhenotypeVertexBasedCellPopulation<DIM>* mpCellPopulation;
 
 public:
 
@@ -54,6 +81,80 @@ public:
      */
     void UpdateCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
 
+    /**
+     * Helper method to update the Delta phenotype and proliferative type of a single cell,
+     * using the value of "delta" already stored in its CellData.
+     *
+     * This is called for each cell by UpdateCellData(), and may also be called by modifiers
+     * that fuse several per-cell updates into a single pass over the population.
+     *
+     * @param pCell pointer to the cell
+     */
+    void UpdatePhenotypeOfCell(CellPtr pCell);
+
+    /**
+     * Helper method to update the Delta phenotype and proliferative type of a single cell,
+     * given its level of Delta. If the cell population is a DeltaPhenotypeVertexBasedCellPopulation
+     * (see SetCellPopulation()), a change of phenotype, or the first phenotype given to a cell, is
+     * recorded in its event log, if it has one, and the cell's target area is marked as stale.
+     *
+     * @param pCell pointer to the cell
+     * @param delta the cell's level of Delta
+     */
+    void UpdatePhenotypeOfCell(CellPtr pCell, double delta);
+
+    /**
+     * Note the cell population whose cells UpdatePhenotypeOfCell() is given. If it is a
+     * DeltaPhenotypeVertexBasedCellPopulation, phenotype changes are recorded in its event log and
+     * the target areas of the cells concerned marked as stale (see
+     * DeltaPhenotypeVertexBasedCellPopulation::MarkTargetAreaStale()). Called by UpdateCellData(),
+     * and by modifiers calling UpdatePhenotypeOfCell() themselves.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void SetCellPopulation(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * @return #mDeltaHighThreshold
+     */
+    double GetDeltaHighThreshold();
+
+    /**
+     * Set #mDeltaHighThreshold.
+     *
+     * @param deltaHighThreshold the new value of #mDeltaHighThreshold
+     */
+    void SetDeltaHighThreshold(double deltaHighThreshold);
+
+    /**
+     * @return #mDeltaLowThreshold
+     */
+    double GetDeltaLowThreshold();
+
+    /**
+     * Set #mDeltaLowThreshold.
+     *
+     * @param deltaLowThreshold the new value of #mDeltaLowThreshold
+     */
+    void SetDeltaLowThreshold(double deltaLowThreshold);
+
+    /**
+     * @return #mUsePhenotypeProperties
+     */
+    bool GetUsePhenotypeProperties();
+
+    /**
+     * Set #mUsePhenotypeProperties.
+     *
+     * @param usePhenotypeProperties the new value of #mUsePhenotypeProperties
+     */
+    void SetUsePhenotypeProperties(bool usePhenotypeProperties);
+
+    /**
+     * @return #mNumTransitions
+     */
+    unsigned GetNumTransitions();
+
     /**
      * Overridden OutputSimulationModifierParameters() method.
      * Output any simulation modifier parameters to file.
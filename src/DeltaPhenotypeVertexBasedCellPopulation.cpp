@@ -0,0 +1,479 @@
+
+#include "DeltaPhenotypeVertexBasedCellPopulation.hpp"
+
+#include <cmath>
+#include <sstream>
+
+#include <boost/functional/hash.hpp>
+
+#include "AbstractQuantisedCellWriter.hpp"
+#include "OutputFileHandler.hpp"
+#include "SimulationTime.hpp"
+#include "VertexMeshWriter.hpp"
+
+#ifdef CHASTE_VTK
+#include <vtkVersion.h>
+#include <vtkCellData.h>
+#include <vtkDoubleArray.h>
+#include <vtkPoints.h>
+#include <vtkPolygon.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnstructuredGrid.h>
+#include <vtkXMLUnstructuredGridWriter.h>
+#include <vtkZLibDataCompressor.h>
+#endif //CHASTE_VTK
+
+template<unsigned DIM>
+DeltaPhenotypeVertexBasedCellPopulation<DIM>::DeltaPhenotypeVertexBasedCellPopulation(MutableVertexMesh<DIM, DIM>& rMesh,
+                                                                                      std::vector<CellPtr>& rCells,
+                                                                                      bool deleteMesh,
+                                                                                      bool validate,
+                                                                                      const std::vector<unsigned> locationIndices)
+    : VertexBasedCellPopulation<DIM>(rMesh, rCells, deleteMesh, validate, locationIndices),
+      mUseCompressedVtkOutput(false),
+      mGeometryTolerance(0.01),
+      mLastGeometryConnectivityHash(0),
+      mLastGeometryNumElements(0),
+      mLastGeometryTimeStep(UNSIGNED_UNSET),
+      mTopologyVersion(0),
+      mElementTargetAreasVersion(UNSIGNED_UNSET),
+      mTimeStepOffset(0),
+      mpEventLog(NULL),
+      mRecordCellsWithStaleTargetAreas(false)
+{
+}
+
+template<unsigned DIM>
+DeltaPhenotypeVertexBasedCellPopulation<DIM>::~DeltaPhenotypeVertexBasedCellPopulation()
+{
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeVertexBasedCellPopulation<DIM>::OpenWritersFiles(OutputFileHandler& rOutputFileHandler)
+{
+    VertexBasedCellPopulation<DIM>::OpenWritersFiles(rOutputFileHandler);
+
+    // Start each solve with a geometry frame
+    mLastGeometryTimeStep = UNSIGNED_UNSET;
+}
+
+template<unsigned DIM>
+CellPtr DeltaPhenotypeVertexBasedCellPopulation<DIM>::AddCell(CellPtr pNewCell, CellPtr pParentCell)
+{
+    /*
+     * Dividing an element gives the new element an unused index, so other element indices stay
+     * valid; the parent has a new birth time, so both target areas may have changed.
+     */
+    MarkTargetAreaStale(pNewCell);
+    if (pParentCell)
+    {
+        MarkTargetAreaStale(pParentCell);
+    }
+    if (mpEventLog && pParentCell)
+    {
+        // The daughter's proliferative type has already been chosen by its cell-cycle model
+        mpEventLog->RecordDivision(pParentCell, pNewCell);
+    }
+    return VertexBasedCellPopulation<DIM>::AddCell(pNewCell, pParentCell);
+}
+
+template<unsigned DIM>
+unsigned DeltaPhenotypeVertexBasedCellPopulation<DIM>::RemoveDeadCells()
+{
+    if (mpEventLog)
+    {
+        for (std::list<CellPtr>::iterator cell_iter = this->mCells.begin();
+             cell_iter != this->mCells.end();
+             ++cell_iter)
+        {
+            if ((*cell_iter)->IsDead())
+            {
+                mpEventLog->RecordDeath(*cell_iter);
+            }
+        }
+    }
+
+    unsigned num_removed = VertexBasedCellPopulation<DIM>::RemoveDeadCells();
+    if (num_removed > 0)
+    {
+        mTopologyVersion++;
+    }
+    return num_removed;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeVertexBasedCellPopulation<DIM>::Update(bool hasHadBirthsOrDeaths)
+{
+    // Remeshing renumbers the elements if any were removed, for example by T2 swaps
+    unsigned num_elements = this->rGetMesh().GetNumAllElements();
+    VertexBasedCellPopulation<DIM>::Update(hasHadBirthsOrDeaths);
+    if (this->rGetMesh().GetNumAllElements() != num_elements)
+    {
+        mTopologyVersion++;
+    }
+}
+
+template<unsigned DIM>
+std::vector<double>& DeltaPhenotypeVertexBasedCellPopulation<DIM>::rGetElementTargetAreas()
+{
+    return mElementTargetAreas;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeVertexBasedCellPopulation<DIM>::SetElementTargetAreasCurrent()
+{
+    mElementTargetAreasVersion = mTopologyVersion;
+}
+
+template<unsigned DIM>
+bool DeltaPhenotypeVertexBasedCellPopulation<DIM>::AreElementTargetAreasCurrent()
+{
+    return mElementTargetAreasVersion == mTopologyVersion
+           && mElementTargetAreas.size() == this->rGetMesh().GetNumAllElements();
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeVertexBasedCellPopulation<DIM>::MarkTargetAreaStale(CellPtr pCell)
+{
+    if (mRecordCellsWithStaleTargetAreas)
+    {
+        mCellsWithStaleTargetAreas.push_back(pCell);
+    }
+}
+
+template<unsigned DIM>
+std::vector<CellPtr>& DeltaPhenotypeVertexBasedCellPopulation<DIM>::rGetCellsWithStaleTargetAreas()
+{
+    return mCellsWithStaleTargetAreas;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeVertexBasedCellPopulation<DIM>::SetRecordCellsWithStaleTargetAreas(bool recordCellsWithStaleTargetAreas)
+{
+    mRecordCellsWithStaleTargetAreas = recordCellsWithStaleTargetAreas;
+    if (!mRecordCellsWithStaleTargetAreas)
+    {
+        mCellsWithStaleTargetAreas.clear();
+    }
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeVertexBasedCellPopulation<DIM>::WriteVtkResultsToFile(const std::string& rDirectory)
+{
+    // Quantised writers keep their values in their own files, so are left out of the VTK output
+    std::vector<boost::shared_ptr<AbstractCellWriter<DIM, DIM> > > all_cell_writers;
+    all_cell_writers.swap(this->mCellWriters);
+    for (unsigned i=0; i<all_cell_writers.size(); i++)
+    {
+        if (!boost::dynamic_pointer_cast<AbstractQuantisedCellWriter<DIM, DIM> >(all_cell_writers[i]))
+        {
+            this->mCellWriters.push_back(all_cell_writers[i]);
+        }
+    }
+
+    try
+    {
+        WriteVtkResults(rDirectory);
+    }
+    catch (...)
+    {
+        this->mCellWriters.swap(all_cell_writers);
+        throw;
+    }
+    this->mCellWriters.swap(all_cell_writers);
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeVertexBasedCellPopulation<DIM>::WriteVtkResults(const std::string& rDirectory)
+{
+    bool compressed = mUseCompressedVtkOutput && DIM == 2;
+    if (!compressed && mTimeStepOffset == 0)
+    {
+        VertexBasedCellPopulation<DIM>::WriteVtkResultsToFile(rDirectory);
+        return;
+    }
+
+#ifdef CHASTE_VTK
+    MutableVertexMesh<DIM, DIM>& r_mesh = this->rGetMesh();
+    unsigned num_elements = r_mesh.GetNumElements();
+    unsigned num_timesteps = mTimeStepOffset + SimulationTime::Instance()->GetTimeStepsElapsed();
+
+    // Gather the cell writer and CellData arrays, indexed by element
+    std::vector<std::string> array_names;
+    std::vector<std::vector<double> > arrays;
+
+    for (typename std::vector<boost::shared_ptr<AbstractCellWriter<DIM, DIM> > >::iterator cell_writer_iter = this->mCellWriters.begin();
+         cell_writer_iter != this->mCellWriters.end();
+         ++cell_writer_iter)
+    {
+        array_names.push_back((*cell_writer_iter)->GetVtkCellDataName());
+        arrays.push_back(std::vector<double>(num_elements));
+    }
+
+    std::vector<std::string> cell_data_names = this->Begin()->GetCellData()->GetKeys();
+    unsigned num_writer_arrays = arrays.size();
+    for (unsigned var=0; var<cell_data_names.size(); var++)
+    {
+        array_names.push_back(cell_data_names[var]);
+        arrays.push_back(std::vector<double>(num_elements));
+    }
+
+    for (typename VertexMesh<DIM,DIM>::VertexElementIterator elem_iter = r_mesh.GetElementIteratorBegin();
+         elem_iter != r_mesh.GetElementIteratorEnd();
+         ++elem_iter)
+    {
+        unsigned elem_index = elem_iter->GetIndex();
+        CellPtr p_cell = this->GetCellUsingLocationIndex(elem_index);
+        assert(p_cell);
+
+        for (unsigned i=0; i<num_writer_arrays; i++)
+        {
+            arrays[i][elem_index] = this->mCellWriters[i]->GetCellDataForVtkOutput(p_cell, this);
+        }
+        boost::shared_ptr<CellData> p_cell_data = p_cell->GetCellData();
+        for (unsigned var=0; var<cell_data_names.size(); var++)
+        {
+            arrays[num_writer_arrays + var][elem_index] = p_cell_data->GetItem(cell_data_names[var]);
+        }
+    }
+
+    if (!compressed)
+    {
+        // As VertexBasedCellPopulation writes it, but named by the time step counted from the start of the solve
+        VertexMeshWriter<DIM, DIM> mesh_writer(rDirectory, "results", false);
+        for (unsigned i=0; i<arrays.size(); i++)
+        {
+            mesh_writer.AddCellData(array_names[i], arrays[i]);
+        }
+        std::stringstream time_step;
+        time_step << num_timesteps;
+        mesh_writer.WriteVtkUsingMesh(r_mesh, time_step.str());
+
+        *(this->mpVtkMetaFile) << "        <DataSet timestep=\"" << num_timesteps;
+        *(this->mpVtkMetaFile) << "\" group=\"\" part=\"0\" file=\"results_";
+        *(this->mpVtkMetaFile) << num_timesteps;
+        *(this->mpVtkMetaFile) << ".vtu\"/>\n";
+        return;
+    }
+
+    if (HasGeometryChanged())
+    {
+        StoreGeometry(num_timesteps);
+    }
+    WriteCompressedVtu(rDirectory, num_timesteps, array_names, arrays);
+
+    *(this->mpVtkMetaFile) << "        <DataSet timestep=\"" << num_timesteps;
+    *(this->mpVtkMetaFile) << "\" group=\"\" part=\"0\" file=\"results_";
+    *(this->mpVtkMetaFile) << num_timesteps;
+    *(this->mpVtkMetaFile) << ".vtu\"/>\n";
+#endif //CHASTE_VTK
+}
+
+template<unsigned DIM>
+std::size_t DeltaPhenotypeVertexBasedCellPopulation<DIM>::ComputeConnectivityHash()
+{
+    MutableVertexMesh<DIM, DIM>& r_mesh = this->rGetMesh();
+
+    std::size_t hash = 0;
+    for (typename VertexMesh<DIM,DIM>::VertexElementIterator elem_iter = r_mesh.GetElementIteratorBegin();
+         elem_iter != r_mesh.GetElementIteratorEnd();
+         ++elem_iter)
+    {
+        boost::hash_combine(hash, elem_iter->GetIndex());
+        for (unsigned local_index=0; local_index<elem_iter->GetNumNodes(); local_index++)
+        {
+            boost::hash_combine(hash, elem_iter->GetNodeGlobalIndex(local_index));
+        }
+    }
+    return hash;
+}
+
+template<unsigned DIM>
+bool DeltaPhenotypeVertexBasedCellPopulation<DIM>::HasGeometryChanged()
+{
+    MutableVertexMesh<DIM, DIM>& r_mesh = this->rGetMesh();
+
+    if (mLastGeometryTimeStep == UNSIGNED_UNSET
+        || r_mesh.GetNumElements() != mLastGeometryNumElements
+        || DIM*r_mesh.GetNumNodes() != mLastGeometryNodeLocations.size())
+    {
+        return true;
+    }
+
+    double squared_tolerance = mGeometryTolerance*mGeometryTolerance;
+    for (unsigned node_index=0; node_index<r_mesh.GetNumNodes(); node_index++)
+    {
+        const c_vector<double, DIM>& r_location = r_mesh.GetNode(node_index)->rGetLocation();
+        double squared_displacement = 0.0;
+        for (unsigned i=0; i<DIM; i++)
+        {
+            double difference = r_location[i] - mLastGeometryNodeLocations[DIM*node_index + i];
+            squared_displacement += difference*difference;
+        }
+        if (squared_displacement > squared_tolerance)
+        {
+            return true;
+        }
+    }
+
+    return ComputeConnectivityHash() != mLastGeometryConnectivityHash;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeVertexBasedCellPopulation<DIM>::StoreGeometry(unsigned timeStep)
+{
+    MutableVertexMesh<DIM, DIM>& r_mesh = this->rGetMesh();
+
+    mLastGeometryTimeStep = timeStep;
+    mLastGeometryNumElements = r_mesh.GetNumElements();
+    mLastGeometryConnectivityHash = ComputeConnectivityHash();
+    mLastGeometryNodeLocations.resize(DIM*r_mesh.GetNumNodes());
+    for (unsigned node_index=0; node_index<r_mesh.GetNumNodes(); node_index++)
+    {
+        const c_vector<double, DIM>& r_location = r_mesh.GetNode(node_index)->rGetLocation();
+        for (unsigned i=0; i<DIM; i++)
+        {
+            mLastGeometryNodeLocations[DIM*node_index + i] = r_location[i];
+        }
+    }
+
+    mLastGeometryElementOffsets.clear();
+    mLastGeometryElementNodes.clear();
+    for (typename VertexMesh<DIM,DIM>::VertexElementIterator elem_iter = r_mesh.GetElementIteratorBegin();
+         elem_iter != r_mesh.GetElementIteratorEnd();
+         ++elem_iter)
+    {
+        mLastGeometryElementOffsets.push_back(mLastGeometryElementNodes.size());
+        for (unsigned local_index=0; local_index<elem_iter->GetNumNodes(); local_index++)
+        {
+            mLastGeometryElementNodes.push_back(elem_iter->GetNodeGlobalIndex(local_index));
+        }
+    }
+    mLastGeometryElementOffsets.push_back(mLastGeometryElementNodes.size());
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeVertexBasedCellPopulation<DIM>::WriteCompressedVtu(const std::string& rDirectory, unsigned timeStep,
+                                                                      const std::vector<std::string>& rArrayNames,
+                                                                      const std::vector<std::vector<double> >& rArrays)
+{
+#ifdef CHASTE_VTK
+    vtkSmartPointer<vtkUnstructuredGrid> p_grid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+    vtkSmartPointer<vtkPoints> p_points = vtkSmartPointer<vtkPoints>::New();
+    p_points->GetData()->SetName("Vertex positions");
+    unsigned num_nodes = mLastGeometryNodeLocations.size()/DIM;
+    for (unsigned node_index=0; node_index<num_nodes; node_index++)
+    {
+        p_points->InsertPoint(node_index, mLastGeometryNodeLocations[DIM*node_index],
+                              mLastGeometryNodeLocations[DIM*node_index + 1], 0.0);
+    }
+    p_grid->SetPoints(p_points);
+
+    for (unsigned elem=0; elem+1<mLastGeometryElementOffsets.size(); elem++)
+    {
+        vtkSmartPointer<vtkPolygon> p_cell = vtkSmartPointer<vtkPolygon>::New();
+        vtkIdList* p_cell_point_ids = p_cell->GetPointIds();
+        unsigned first = mLastGeometryElementOffsets[elem];
+        unsigned num_element_nodes = mLastGeometryElementOffsets[elem + 1] - first;
+        p_cell_point_ids->SetNumberOfIds(num_element_nodes);
+        for (unsigned local_index=0; local_index<num_element_nodes; local_index++)
+        {
+            p_cell_point_ids->SetId(local_index, mLastGeometryElementNodes[first + local_index]);
+        }
+        p_grid->InsertNextCell(p_cell->GetCellType(), p_cell_point_ids);
+    }
+
+    for (unsigned i=0; i<rArrays.size(); i++)
+    {
+        vtkSmartPointer<vtkDoubleArray> p_array = vtkSmartPointer<vtkDoubleArray>::New();
+        p_array->SetName(rArrayNames[i].c_str());
+        p_array->SetNumberOfTuples(rArrays[i].size());
+        for (unsigned j=0; j<rArrays[i].size(); j++)
+        {
+            p_array->SetValue(j, rArrays[i][j]);
+        }
+        p_grid->GetCellData()->AddArray(p_array);
+    }
+
+    OutputFileHandler handler(rDirectory, false);
+    std::stringstream file_name;
+    file_name << handler.GetOutputDirectoryFullPath() << "results_" << timeStep << ".vtu";
+
+    vtkSmartPointer<vtkXMLUnstructuredGridWriter> p_writer = vtkSmartPointer<vtkXMLUnstructuredGridWriter>::New();
+    vtkSmartPointer<vtkZLibDataCompressor> p_compressor = vtkSmartPointer<vtkZLibDataCompressor>::New();
+    p_writer->SetCompressor(p_compressor);
+    p_writer->SetDataModeToAppended();
+    p_writer->EncodeAppendedDataOff();
+#if VTK_MAJOR_VERSION >= 6
+    p_writer->SetInputData(p_grid);
+#else
+    p_writer->SetInput(p_grid);
+#endif
+    p_writer->SetFileName(file_name.str().c_str());
+    p_writer->Write();
+#endif //CHASTE_VTK
+}
+
+template<unsigned DIM>
+bool DeltaPhenotypeVertexBasedCellPopulation<DIM>::GetUseCompressedVtkOutput()
+{
+    return mUseCompressedVtkOutput;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeVertexBasedCellPopulation<DIM>::SetUseCompressedVtkOutput(bool useCompressedVtkOutput)
+{
+    mUseCompressedVtkOutput = useCompressedVtkOutput;
+}
+
+template<unsigned DIM>
+unsigned DeltaPhenotypeVertexBasedCellPopulation<DIM>::GetTimeStepOffset()
+{
+    return mTimeStepOffset;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeVertexBasedCellPopulation<DIM>::SetTimeStepOffset(unsigned timeStepOffset)
+{
+    mTimeStepOffset = timeStepOffset;
+}
+
+template<unsigned DIM>
+double DeltaPhenotypeVertexBasedCellPopulation<DIM>::GetGeometryTolerance()
+{
+    return mGeometryTolerance;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeVertexBasedCellPopulation<DIM>::SetGeometryTolerance(double geometryTolerance)
+{
+    assert(geometryTolerance >= 0.0);
+    mGeometryTolerance = geometryTolerance;
+}
+
+template<unsigned DIM>
+DeltaNotchEventLog* DeltaPhenotypeVertexBasedCellPopulation<DIM>::GetEventLog()
+{
+    return mpEventLog;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeVertexBasedCellPopulation<DIM>::SetEventLog(DeltaNotchEventLog* pEventLog)
+{
+    mpEventLog = pEventLog;
+}
+
+template<unsigned DIM>
+void DeltaPhenotypeVertexBasedCellPopulation<DIM>::OutputCellPopulationParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t<UseCompressedVtkOutput>" << mUseCompressedVtkOutput << "</UseCompressedVtkOutput>\n";
+    *rParamsFile << "\t\t<GeometryTolerance>" << mGeometryTolerance << "</GeometryTolerance>\n";
+
+    // Call method on direct parent class
+    VertexBasedCellPopulation<DIM>::OutputCellPopulationParameters(rParamsFile);
+}
+
+// Explicit instantiation (in 1D too, since the Delta phenotype modifiers are and refer to it)
+template class DeltaPhenotypeVertexBasedCellPopulation<1>;
+template class DeltaPhenotypeVertexBasedCellPopulation<2>;
+template class DeltaPhenotypeVertexBasedCellPopulation<3>;
@@ -0,0 +1,296 @@
+
+#ifndef DELTAPHENOTYPEVERTEXBASEDCELLPOPULATION_HPP_
+#define DELTAPHENOTYPEVERTEXBASEDCELLPOPULATION_HPP_
+
+#include <vector>
+
+#include "DeltaNotchEventLog.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+/**
+ * A vertex-based cell population with an optional, lighter VTK output mode for large tissues.
+ *
+ * By default this behaves exactly as VertexBasedCellPopulation. If compressed VTK output is
+ * switched on with SetUseCompressedVtkOutput(), then at each output time:
+ *
+ *  - if the mesh has changed since the last geometry frame (a node or element was added or
+ *    removed, an element's nodes changed, or a node moved by more than the geometry tolerance)
+ *    the node locations and element connectivity are recorded as a new geometry frame;
+ *
+ *  - otherwise the geometry of the last geometry frame is reused, without traversing the mesh.
+ *
+ * In both cases a VTU file "results_<timestep>.vtu" is written in zlib-compressed appended raw
+ * binary form, containing the geometry frame's mesh and the current cell writer and CellData
+ * arrays (e.g. "Delta Phenotype", "delta"), and is listed in results.pvd as usual. Every output
+ * time therefore carries its own cell data and can be opened in ParaView; only the node locations
+ * of frames between geometry frames are approximate, by up to the geometry tolerance.
+ *
+ * This mode is only used in 2D; in 3D the standard output is always written.
+ *
+ * In either mode, VTK files and results.pvd entries are named by the number of time steps taken
+ * since the start of the solve, #mTimeStepOffset plus SimulationTime's count, which restarts
+ * when the time step is changed.
+ *
+ * The population also holds a contiguous array of target areas indexed by element, filled by
+ * DeltaPhenotypeTargetAreaModifier and read by DeltaNotchNagaiHondaForce in place of each cell's
+ * "target area" CellData item. Since element indices change when cells are removed, and a
+ * division adds an element, the array is only current until the next such change. The population
+ * can also record which cells' target areas may have changed, by division or a change of
+ * phenotype, so that the modifier need only update those; see MarkTargetAreaStale().
+ */
+template<unsigned DIM>
+class DeltaPhenotypeVertexBasedCellPopulation : public VertexBasedCellPopulation<DIM>
+{
+private:
+
+    /** Whether to use the compressed VTK output mode. Defaults to false. */
+    bool mUseCompressedVtkOutput;
+
+    /**
+     * A node must move further than this from its position at the last geometry frame
+     * for the geometry to be rewritten. Defaults to 0.01, about 1% of a cell diameter in
+     * the tutorial's meshes; with 0, any movement causes a rewrite, so the geometry is
+     * written at almost every output time.
+     */
+    double mGeometryTolerance;
+
+    /** Node locations at the last geometry frame, stored as x0, y0, x1, y1, ... */
+    std::vector<double> mLastGeometryNodeLocations;
+
+    /** Offset of each element's first node in #mLastGeometryElementNodes, with one extra entry at the end. */
+    std::vector<unsigned> mLastGeometryElementOffsets;
+
+    /** Global index of each node of each element at the last geometry frame, in element iteration order. */
+    std::vector<unsigned> mLastGeometryElementNodes;
+
+    /** Hash of the element connectivity at the last geometry frame. */
+    std::size_t mLastGeometryConnectivityHash;
+
+    /** Number of elements at the last geometry frame. */
+    unsigned mLastGeometryNumElements;
+
+    /** Time step of the last geometry frame, or UNSIGNED_UNSET if none has been written. */
+    unsigned mLastGeometryTimeStep;
+
+    /**
+     * Counter incremented whenever element indices may have changed: a cell was removed, or the mesh
+     * lost elements. A division leaves the indices of existing elements unchanged.
+     */
+    unsigned mTopologyVersion;
+
+    /** Target area of the cell of each element; see SetElementTargetAreasCurrent(). */
+    std::vector<double> mElementTargetAreas;
+
+    /** Value of #mTopologyVersion when #mElementTargetAreas was last filled, or UNSIGNED_UNSET. */
+    unsigned mElementTargetAreasVersion;
+
+    /**
+     * Number of time steps taken in the solve before SimulationTime was last restarted, for example
+     * by a change of time step in DeltaNotchAdaptiveSimulation. VTK output is named by this plus the
+     * time steps elapsed since the restart, so that file names keep increasing. Defaults to 0.
+     */
+    unsigned mTimeStepOffset;
+
+    /** The log in which divisions and deaths are recorded, or NULL. Not owned; see DeltaNotchEventLogModifier. */
+    DeltaNotchEventLog* mpEventLog;
+
+    /** Whether MarkTargetAreaStale() records cells. Defaults to false. */
+    bool mRecordCellsWithStaleTargetAreas;
+
+    /** Cells whose target area may have changed since it was last computed; see MarkTargetAreaStale(). */
+    std::vector<CellPtr> mCellsWithStaleTargetAreas;
+
+    /**
+     * @return a hash of the node indices of every element of the mesh
+     */
+    std::size_t ComputeConnectivityHash();
+
+    /**
+     * @return whether the mesh has changed enough since the last geometry frame to be rewritten
+     */
+    bool HasGeometryChanged();
+
+    /**
+     * Write the VTK output for the current time, using the cell writers in this->mCellWriters.
+     *
+     * @param rDirectory  pathname of the output directory, relative to where Chaste output is stored
+     */
+    void WriteVtkResults(const std::string& rDirectory);
+
+    /**
+     * Record the current mesh as the geometry frame for the given time step.
+     *
+     * @param timeStep the current time step
+     */
+    void StoreGeometry(unsigned timeStep);
+
+    /**
+     * Write the mesh of the last geometry frame and the given cell data arrays to a compressed VTU file.
+     *
+     * @param rDirectory the output directory, relative to where Chaste output is stored
+     * @param timeStep the current time step
+     * @param rArrayNames the names of the cell data arrays
+     * @param rArrays the cell data arrays, one value per element
+     */
+    void WriteCompressedVtu(const std::string& rDirectory, unsigned timeStep,
+                            const std::vector<std::string>& rArrayNames,
+                            const std::vector<std::vector<double> >& rArrays);
+
+public:
+
+    /**
+     * Create a new cell population facade from a mesh and collection of cells.
+     * The arguments are as for VertexBasedCellPopulation.
+     *
+     * @param rMesh reference to MutableVertexMesh
+     * @param rCells reference to a vector of CellPtrs
+     * @param deleteMesh set to true if you want the cell population to free the mesh memory on destruction
+     * @param validate whether to validate the cell population when it is created (defaults to true)
+     * @param locationIndices an optional vector of location indices that correspond to real cells
+     */
+    DeltaPhenotypeVertexBasedCellPopulation(MutableVertexMesh<DIM, DIM>& rMesh,
+                                            std::vector<CellPtr>& rCells,
+                                            bool deleteMesh=false,
+                                            bool validate=true,
+                                            const std::vector<unsigned> locationIndices=std::vector<unsigned>());
+
+    /**
+     * Destructor.
+     */
+    virtual ~DeltaPhenotypeVertexBasedCellPopulation();
+
+    /**
+     * Overridden WriteVtkResultsToFile() method. Any AbstractQuantisedCellWriter is left out
+     * of the VTK output, since its values are already written, quantised, to its own file.
+     *
+     * @param rDirectory  pathname of the output directory, relative to where Chaste output is stored
+     */
+    virtual void WriteVtkResultsToFile(const std::string& rDirectory);
+
+    /**
+     * Overridden OpenWritersFiles() method. Also makes the first output time of the solve a
+     * geometry frame.
+     *
+     * @param rOutputFileHandler handler for the directory in which to open the files
+     */
+    virtual void OpenWritersFiles(OutputFileHandler& rOutputFileHandler);
+
+    /**
+     * Overridden AddCell() method, marking the target areas of the new cell and its parent as
+     * stale and, for a division, recording it in the event log, if there is one.
+     *
+     * @param pNewCell the cell to add
+     * @param pParentCell pointer to a parent cell
+     * @return address of cell as it appears in the cell list
+     */
+    virtual CellPtr AddCell(CellPtr pNewCell, CellPtr pParentCell=CellPtr());
+
+    /**
+     * Overridden RemoveDeadCells() method, noting that element indices have changed and
+     * recording each death in the event log, if there is one.
+     *
+     * @return number of cells removed
+     */
+    virtual unsigned RemoveDeadCells();
+
+    /**
+     * Overridden Update() method, noting that element indices have changed if remeshing removed elements.
+     *
+     * @param hasHadBirthsOrDeaths whether cell population has had Births Or Deaths
+     */
+    virtual void Update(bool hasHadBirthsOrDeaths=true);
+
+    /**
+     * @return the target area of each element, for filling; call SetElementTargetAreasCurrent() once filled
+     */
+    std::vector<double>& rGetElementTargetAreas();
+
+    /**
+     * Mark the element target areas as matching the current element indices.
+     */
+    void SetElementTargetAreasCurrent();
+
+    /**
+     * @return whether the element target areas were filled since element indices last changed
+     */
+    bool AreElementTargetAreasCurrent();
+
+    /**
+     * Note that a cell's target area may have changed since DeltaPhenotypeTargetAreaModifier last
+     * computed it, because the cell divided or changed phenotype, so that the modifier updates it
+     * at its next pass. Does nothing unless switched on with SetRecordCellsWithStaleTargetAreas().
+     *
+     * @param pCell the cell
+     */
+    void MarkTargetAreaStale(CellPtr pCell);
+
+    /**
+     * @return the cells marked by MarkTargetAreaStale() since the list was last cleared, possibly
+     * including dead cells and repeats; the reader clears it
+     */
+    std::vector<CellPtr>& rGetCellsWithStaleTargetAreas();
+
+    /**
+     * Set whether MarkTargetAreaStale() records cells. Switching it off empties the list.
+     *
+     * @param recordCellsWithStaleTargetAreas whether to record cells
+     */
+    void SetRecordCellsWithStaleTargetAreas(bool recordCellsWithStaleTargetAreas);
+
+    /**
+     * @return #mUseCompressedVtkOutput
+     */
+    bool GetUseCompressedVtkOutput();
+
+    /**
+     * Set #mUseCompressedVtkOutput.
+     *
+     * @param useCompressedVtkOutput the new value of #mUseCompressedVtkOutput
+     */
+    void SetUseCompressedVtkOutput(bool useCompressedVtkOutput);
+
+    /**
+     * @return #mTimeStepOffset
+     */
+    unsigned GetTimeStepOffset();
+
+    /**
+     * Set #mTimeStepOffset.
+     *
+     * @param timeStepOffset the new value of #mTimeStepOffset
+     */
+    void SetTimeStepOffset(unsigned timeStepOffset);
+
+    /**
+     * @return #mGeometryTolerance
+     */
+    double GetGeometryTolerance();
+
+    /**
+     * Set #mGeometryTolerance.
+     *
+     * @param geometryTolerance the new value of #mGeometryTolerance
+     */
+    void SetGeometryTolerance(double geometryTolerance);
+
+    /**
+     * @return #mpEventLog
+     */
+    DeltaNotchEventLog* GetEventLog();
+
+    /**
+     * Set #mpEventLog. The log must outlive its use by this population.
+     *
+     * @param pEventLog the log in which to record divisions and deaths, or NULL to stop recording
+     */
+    void SetEventLog(DeltaNotchEventLog* pEventLog);
+
+    /**
+     * Overridden OutputCellPopulationParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputCellPopulationParameters(out_stream& rParamsFile);
+};
+
+#endif /*DELTAPHENOTYPEVERTEXBASEDCELLPOPULATION_HPP_*/
@@ -1,8 +1,7 @@
 #include "DeltaPhenotypeWriter.hpp"
 
 #include "AbstractCellPopulation.hpp"
-#include "DeltaLowPhenotypeProperty.hpp"
-#include "DeltaHighPhenotypeProperty.hpp"
+#include "DeltaPhenotypeFlags.hpp"
 
 
 template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
@@ -14,23 +13,14 @@ DeltaPhenotypeWriter<ELEMENT_DIM, SPACE_DIM>::DeltaPhenotypeWriter()
 
 template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
 double DeltaPhenotypeWriter<ELEMENT_DIM, SPACE_DIM>::GetCellDataForVtkOutput(CellPtr pCell, AbstractCellPopulation<ELEMENT_DIM, SPACE_DIM>* pCellPopulation)
-{   
-    if(pCell->HasCellProperty<DeltaLowPhenotypeProperty>())
-        return 1.0;
-    if(pCell->HasCellProperty<DeltaHighPhenotypeProperty>())
-        return 2.0;
-    return 0.0;
+{
+    return DeltaPhenotypeFlags::GetPhenotype(pCell);
 }
 
 template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
 void DeltaPhenotypeWriter<ELEMENT_DIM, SPACE_DIM>::VisitCell(CellPtr pCell, AbstractCellPopulation<ELEMENT_DIM, SPACE_DIM>* pCellPopulation)
 {
-    if(pCell->HasCellProperty<DeltaLowPhenotypeProperty>())
-        *this->mpOutStream <<1<<" ";
-    else if(pCell->HasCellProperty<DeltaHighPhenotypeProperty>())
-         *this->mpOutStream <<2<<" ";
-    else
-         *this->mpOutStream <<0<<" ";
+    *this->mpOutStream << DeltaPhenotypeFlags::GetPhenotype(pCell) << " ";
 }
 
 // Explicit instantiation
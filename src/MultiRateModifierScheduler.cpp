@@ -0,0 +1,150 @@
+
+#include "MultiRateModifierScheduler.hpp"
+
+#include "Exception.hpp"
+#include "SimulationTime.hpp"
+#include "Timer.hpp"
+
+template<unsigned DIM>
+MultiRateModifierScheduler<DIM>::MultiRateModifierScheduler()
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mNumTimeSteps(0),
+      mNumOdeSubcycles(0)
+{
+}
+
+template<unsigned DIM>
+MultiRateModifierScheduler<DIM>::~MultiRateModifierScheduler()
+{
+}
+
+template<unsigned DIM>
+void MultiRateModifierScheduler<DIM>::AddModifier(boost::shared_ptr<AbstractCellBasedSimulationModifier<DIM,DIM> > pModifier, unsigned updateMultiple)
+{
+    if (updateMultiple == 0)
+    {
+        EXCEPTION("The update multiple of a scheduled modifier must be positive");
+    }
+    mModifiers.push_back(pModifier);
+    mUpdateMultiples.push_back(updateMultiple);
+    mModifierWallTimes.push_back(0.0);
+}
+
+template<unsigned DIM>
+const std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<DIM,DIM> > >& MultiRateModifierScheduler<DIM>::rGetModifiers() const
+{
+    return mModifiers;
+}
+
+template<unsigned DIM>
+unsigned MultiRateModifierScheduler<DIM>::GetUpdateMultiple(unsigned index)
+{
+    assert(index < mUpdateMultiples.size());
+    return mUpdateMultiples[index];
+}
+
+template<unsigned DIM>
+double MultiRateModifierScheduler<DIM>::GetModifierWallTime(unsigned index)
+{
+    assert(index < mModifierWallTimes.size());
+    return mModifierWallTimes[index];
+}
+
+template<unsigned DIM>
+unsigned MultiRateModifierScheduler<DIM>::GetNumOdeSubcycles()
+{
+    return mNumOdeSubcycles;
+}
+
+template<unsigned DIM>
+void MultiRateModifierScheduler<DIM>::SetNumOdeSubcycles(unsigned numOdeSubcycles)
+{
+    mNumOdeSubcycles = numOdeSubcycles;
+}
+
+template<unsigned DIM>
+void MultiRateModifierScheduler<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    mNumTimeSteps++;
+    for (unsigned i=0; i<mModifiers.size(); i++)
+    {
+        if (mNumTimeSteps % mUpdateMultiples[i] == 0)
+        {
+            double start_time = Timer::GetWallTime();
+            mModifiers[i]->UpdateAtEndOfTimeStep(rCellPopulation);
+            mModifierWallTimes[i] += Timer::GetWallTime() - start_time;
+        }
+    }
+
+    // Cells born during this time step need their SRN time step setting too
+    UpdateOdeTimeSteps(rCellPopulation);
+}
+
+template<unsigned DIM>
+void MultiRateModifierScheduler<DIM>::UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    for (unsigned i=0; i<mModifiers.size(); i++)
+    {
+        mModifiers[i]->UpdateAtEndOfOutputTimeStep(rCellPopulation);
+    }
+}
+
+template<unsigned DIM>
+void MultiRateModifierScheduler<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    mNumTimeSteps = 0;
+    UpdateOdeTimeSteps(rCellPopulation);
+    for (unsigned i=0; i<mModifiers.size(); i++)
+    {
+        mModifierWallTimes[i] = 0.0;
+        mModifiers[i]->SetupSolve(rCellPopulation, outputDirectory);
+    }
+}
+
+template<unsigned DIM>
+void MultiRateModifierScheduler<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    for (unsigned i=0; i<mModifiers.size(); i++)
+    {
+        mModifiers[i]->UpdateAtEndOfSolve(rCellPopulation);
+    }
+}
+
+template<unsigned DIM>
+void MultiRateModifierScheduler<DIM>::UpdateOdeTimeSteps(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (mNumOdeSubcycles == 0)
+    {
+        return;
+    }
+
+    double ode_dt = SimulationTime::Instance()->GetTimeStep()/mNumOdeSubcycles;
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        if (cell_iter->GetSrnModel()->GetDt() != ode_dt)
+        {
+            cell_iter->GetSrnModel()->SetDt(ode_dt);
+        }
+    }
+}
+
+template<unsigned DIM>
+void MultiRateModifierScheduler<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<NumOdeSubcycles>" << mNumOdeSubcycles << "</NumOdeSubcycles>\n";
+    for (unsigned i=0; i<mModifiers.size(); i++)
+    {
+        *rParamsFile << "\t\t\t<UpdateMultiple>" << mUpdateMultiples[i] << "</UpdateMultiple>\n";
+        mModifiers[i]->OutputSimulationModifierInfo(rParamsFile);
+    }
+
+    // Next, call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class MultiRateModifierScheduler<1>;
+template class MultiRateModifierScheduler<2>;
+template class MultiRateModifierScheduler<3>;
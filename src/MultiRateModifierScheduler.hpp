@@ -0,0 +1,146 @@
+
+#ifndef MULTIRATEMODIFIERSCHEDULER_HPP_
+#define MULTIRATEMODIFIERSCHEDULER_HPP_
+
+#include <vector>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+
+/**
+ * A modifier class that runs other modifiers less often than every time step.
+ *
+ * Each scheduled modifier is given an update multiple n, and its UpdateAtEndOfTimeStep() is
+ * called at every n-th time step, counting from the start of Solve(); the other hooks
+ * (SetupSolve(), UpdateAtEndOfOutputTimeStep() and UpdateAtEndOfSolve()) are always passed on.
+ * Modifiers due at the same time step are run in the order in which they were added, so
+ * dependent modifiers (such as DeltaNotchTrackingModifier before DeltaPhenotypeTrackingModifier)
+ * should be added in the order they would be added to the simulation.
+ *
+ * Optionally, the ODEs of every cell's SRN model may be sub-cycled, that is integrated with a
+ * time step equal to the simulation time step divided by a given number of sub-cycles.
+ *
+ * The wall time spent in each scheduled modifier is recorded and may be read with
+ * GetModifierWallTime().
+ */
+template<unsigned DIM>
+class MultiRateModifierScheduler : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+private:
+
+    /** The scheduled modifiers. */
+    std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<DIM,DIM> > > mModifiers;
+
+    /** The update multiple of each scheduled modifier. */
+    std::vector<unsigned> mUpdateMultiples;
+
+    /** The wall time spent in UpdateAtEndOfTimeStep() by each scheduled modifier, in seconds. */
+    std::vector<double> mModifierWallTimes;
+
+    /** Number of time steps since the start of Solve(). */
+    unsigned mNumTimeSteps;
+
+    /** Number of ODE sub-cycles per time step, or 0 to leave the SRN models' time steps alone. Defaults to 0. */
+    unsigned mNumOdeSubcycles;
+
+    /**
+     * Set the time step of every cell's SRN model for sub-cycling, if #mNumOdeSubcycles is set.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void UpdateOdeTimeSteps(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    MultiRateModifierScheduler();
+
+    /**
+     * Destructor.
+     */
+    virtual ~MultiRateModifierScheduler();
+
+    /**
+     * Add a modifier to be run at every updateMultiple-th time step.
+     *
+     * @param pModifier the modifier
+     * @param updateMultiple the number of time steps between updates (defaults to 1)
+     */
+    void AddModifier(boost::shared_ptr<AbstractCellBasedSimulationModifier<DIM,DIM> > pModifier, unsigned updateMultiple=1);
+
+    /**
+     * @return the scheduled modifiers
+     */
+    const std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<DIM,DIM> > >& rGetModifiers() const;
+
+    /**
+     * @return the update multiple of a scheduled modifier
+     *
+     * @param index the index of the modifier, in the order added
+     */
+    unsigned GetUpdateMultiple(unsigned index);
+
+    /**
+     * @return the wall time spent in UpdateAtEndOfTimeStep() by a scheduled modifier, in seconds
+     *
+     * @param index the index of the modifier, in the order added
+     */
+    double GetModifierWallTime(unsigned index);
+
+    /**
+     * @return #mNumOdeSubcycles
+     */
+    unsigned GetNumOdeSubcycles();
+
+    /**
+     * Set #mNumOdeSubcycles.
+     *
+     * @param numOdeSubcycles the new value of #mNumOdeSubcycles
+     */
+    void SetNumOdeSubcycles(unsigned numOdeSubcycles);
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Specifies what to do in the simulation at the end of each time step.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden UpdateAtEndOfOutputTimeStep() method.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Specifies what to do in the simulation before the start of the time loop.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file, followed by the
+     * information of each scheduled modifier.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#endif /*MULTIRATEMODIFIERSCHEDULER_HPP_*/
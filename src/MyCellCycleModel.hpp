@@ -1,14 +1,29 @@
 #ifndef MYCELLCYCLEMODEL_HPP_
 #define MYCELLCYCLEMODEL_HPP_
 
-#include "AbstractSimpleGenerationalCellCycleModel.hpp"
+#include "AbstractSimplePhaseBasedCellCycleModel.hpp"
 #include "StemCellProliferativeType.hpp"
 #include "TransitCellProliferativeType.hpp"
 #include "DifferentiatedCellProliferativeType.hpp"
 
-class MyCellCycleModel : public AbstractSimpleGenerationalCellCycleModel
+#include <climits>
+
+/**
+ * Cell-cycle model in which stem cells have exponentially distributed G1 durations and
+ * differentiated cells never divide. Generations are not tracked, so the model derives
+ * directly from AbstractSimplePhaseBasedCellCycleModel and carries no generation state.
+ *
+ * The model also holds the cell's DeltaPhenotypeFlags, since it is the one per-cell object owned
+ * by this project: it is reached from the cell without a search, is copied to the daughter cell
+ * at division and is destroyed with the cell.
+ */
+class MyCellCycleModel : public AbstractSimplePhaseBasedCellCycleModel
 {
 private:
+
+    /** The cell's DeltaPhenotypeFlags, or NO_DELTA_PHENOTYPE_FLAGS if they have not been set. */
+    unsigned mDeltaPhenotypeFlags;
+
     void SetG1Duration()
     {
         assert(mpCell != NULL);
@@ -51,8 +66,31 @@ private:
     }
 
 public:
+
+    /** Value of the Delta phenotype flags of a cell whose flags have not been set. */
+    static const unsigned NO_DELTA_PHENOTYPE_FLAGS = UINT_MAX;
+
     MyCellCycleModel()
+        : mDeltaPhenotypeFlags(NO_DELTA_PHENOTYPE_FLAGS)
+    {
+    }
+
+    /**
+     * @return the cell's DeltaPhenotypeFlags, or NO_DELTA_PHENOTYPE_FLAGS if they have not been set
+     */
+    unsigned GetDeltaPhenotypeFlags() const
+    {
+        return mDeltaPhenotypeFlags;
+    }
+
+    /**
+     * Set the cell's DeltaPhenotypeFlags.
+     *
+     * @param flags the new flags
+     */
+    void SetDeltaPhenotypeFlags(unsigned flags)
     {
+        mDeltaPhenotypeFlags = flags;
     }
 
     AbstractCellCycleModel *CreateCellCycleModel()
@@ -66,8 +104,7 @@ public:
         p_model->SetSDuration(mSDuration);
         p_model->SetG2Duration(mG2Duration);
         p_model->SetMDuration(mMDuration);
-        p_model->SetGeneration(mGeneration);
-        p_model->SetMaxTransitGenerations(mMaxTransitGenerations);
+        p_model->SetDeltaPhenotypeFlags(mDeltaPhenotypeFlags);
 
         return p_model;
     }
@@ -0,0 +1,24 @@
+#include "QuantisedCellAgesWriter.hpp"
+
+#include "AbstractCellPopulation.hpp"
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+QuantisedCellAgesWriter<ELEMENT_DIM, SPACE_DIM>::QuantisedCellAgesWriter(double scale)
+    : AbstractQuantisedCellWriter<ELEMENT_DIM, SPACE_DIM>("results.vizcellages.q16", scale)
+{
+    this->mVtkCellDataName = "Quantised ages";
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double QuantisedCellAgesWriter<ELEMENT_DIM, SPACE_DIM>::GetCellDataForVtkOutput(CellPtr pCell, AbstractCellPopulation<ELEMENT_DIM, SPACE_DIM>* pCellPopulation)
+{
+    return pCell->GetAge();
+}
+
+// Explicit instantiation
+template class QuantisedCellAgesWriter<1,1>;
+template class QuantisedCellAgesWriter<1,2>;
+template class QuantisedCellAgesWriter<2,2>;
+template class QuantisedCellAgesWriter<1,3>;
+template class QuantisedCellAgesWriter<2,3>;
+template class QuantisedCellAgesWriter<3,3>;
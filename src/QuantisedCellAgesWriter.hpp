@@ -0,0 +1,38 @@
+
+#ifndef QUANTISEDCELLAGESWRITER_HPP_
+#define QUANTISEDCELLAGESWRITER_HPP_
+
+#include "AbstractQuantisedCellWriter.hpp"
+
+/**
+ * A class written using the visitor pattern for writing the age of each cell to file at reduced precision.
+ *
+ * The output file is called results.vizcellages.q16 by default; see AbstractQuantisedCellWriter for its format.
+ * If VTK is switched on, then the writer also specifies the VTK output for each cell, which
+ * is stored in the VTK cell data "Quantised ages" at full precision, except by
+ * DeltaPhenotypeVertexBasedCellPopulation, which leaves quantised writers out of its VTK output.
+ */
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+class QuantisedCellAgesWriter : public AbstractQuantisedCellWriter<ELEMENT_DIM, SPACE_DIM>
+{
+public:
+
+    /**
+     * Default constructor.
+     *
+     * @param scale the scale by which values are multiplied before rounding (defaults to 100.0)
+     */
+    QuantisedCellAgesWriter(double scale=100.0);
+
+    /**
+     * Overridden GetCellDataForVtkOutput() method.
+     *
+     * @param pCell a cell
+     * @param pCellPopulation a pointer to the cell population owning the cell
+     *
+     * @return the age of the cell
+     */
+    double GetCellDataForVtkOutput(CellPtr pCell, AbstractCellPopulation<ELEMENT_DIM, SPACE_DIM>* pCellPopulation);
+};
+
+#endif /* QUANTISEDCELLAGESWRITER_HPP_ */
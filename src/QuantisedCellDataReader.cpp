@@ -0,0 +1,132 @@
+
+#include "QuantisedCellDataReader.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+#include "Exception.hpp"
+
+/** The first four bytes of a file written by a quantised cell writer. */
+static const char QUANTISED_MAGIC[4] = {'D', 'N', 'Q', '1'};
+
+QuantisedCellDataReader::QuantisedCellDataReader(const std::string& rFileName)
+    : mFileName(rFileName),
+      mScale(1.0)
+{
+    std::ifstream file(rFileName.c_str(), std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+        EXCEPTION("Could not open quantised cell data file " + rFileName);
+    }
+
+    char magic[4];
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&mScale), sizeof(mScale));
+    if (!file.good() || memcmp(magic, QUANTISED_MAGIC, sizeof(magic)) != 0)
+    {
+        EXCEPTION(rFileName + " is not a quantised cell data file");
+    }
+    if (!(mScale > 0.0))
+    {
+        EXCEPTION(rFileName + " has an invalid scale");
+    }
+
+    file.seekg(0, std::ios::end);
+    uint64_t file_size = static_cast<std::streamoff>(file.tellg());
+    uint64_t offset = HEADER_SIZE;
+    while (offset + FRAME_HEADER_SIZE <= file_size)
+    {
+        double time;
+        uint32_t num_cells;
+        file.seekg(offset, std::ios::beg);
+        file.read(reinterpret_cast<char*>(&time), sizeof(time));
+        file.read(reinterpret_cast<char*>(&num_cells), sizeof(num_cells));
+        if (!file.good())
+        {
+            EXCEPTION("Could not read quantised cell data file " + rFileName);
+        }
+
+        // A file cut short by a crash may end in a partial frame, which is ignored
+        uint64_t frame_size = FRAME_HEADER_SIZE + (uint64_t)num_cells*(sizeof(uint32_t) + sizeof(int16_t));
+        if (offset + frame_size > file_size)
+        {
+            break;
+        }
+        mTimes.push_back(time);
+        mNumCells.push_back(num_cells);
+        mFrameOffsets.push_back(offset);
+        offset += frame_size;
+    }
+}
+
+bool QuantisedCellDataReader::IsQuantisedFile(const std::string& rFileName)
+{
+    std::ifstream file(rFileName.c_str(), std::ios::in | std::ios::binary);
+    char magic[4];
+    file.read(magic, sizeof(magic));
+    return file.good() && memcmp(magic, QUANTISED_MAGIC, sizeof(magic)) == 0;
+}
+
+double QuantisedCellDataReader::GetScale() const
+{
+    return mScale;
+}
+
+unsigned QuantisedCellDataReader::GetNumFrames() const
+{
+    return mTimes.size();
+}
+
+double QuantisedCellDataReader::GetTime(unsigned frame) const
+{
+    assert(frame < mTimes.size());
+    return mTimes[frame];
+}
+
+unsigned QuantisedCellDataReader::GetNumCells(unsigned frame) const
+{
+    assert(frame < mNumCells.size());
+    return mNumCells[frame];
+}
+
+uint64_t QuantisedCellDataReader::GetValuesOffset(unsigned frame) const
+{
+    assert(frame < mFrameOffsets.size());
+    return mFrameOffsets[frame] + FRAME_HEADER_SIZE + (uint64_t)mNumCells[frame]*sizeof(uint32_t);
+}
+
+double QuantisedCellDataReader::Decode(int16_t storedValue) const
+{
+    return storedValue/mScale;
+}
+
+void QuantisedCellDataReader::GetFrame(unsigned frame, std::vector<unsigned>& rCellIds, std::vector<double>& rValues) const
+{
+    assert(frame < mFrameOffsets.size());
+    rCellIds.clear();
+    rValues.clear();
+    uint32_t num_cells = mNumCells[frame];
+    if (num_cells == 0)
+    {
+        return;
+    }
+
+    std::ifstream file(mFileName.c_str(), std::ios::in | std::ios::binary);
+    std::vector<uint32_t> cell_ids(num_cells);
+    std::vector<int16_t> stored_values(num_cells);
+    file.seekg(mFrameOffsets[frame] + FRAME_HEADER_SIZE, std::ios::beg);
+    file.read(reinterpret_cast<char*>(&cell_ids[0]), num_cells*sizeof(uint32_t));
+    file.read(reinterpret_cast<char*>(&stored_values[0]), num_cells*sizeof(int16_t));
+    if (!file.good())
+    {
+        EXCEPTION("Could not read quantised cell data file " + mFileName);
+    }
+
+    rCellIds.assign(cell_ids.begin(), cell_ids.end());
+    rValues.reserve(num_cells);
+    for (uint32_t i=0; i<num_cells; i++)
+    {
+        rValues.push_back(Decode(stored_values[i]));
+    }
+}
@@ -0,0 +1,109 @@
+
+#ifndef QUANTISEDCELLDATAREADER_HPP_
+#define QUANTISEDCELLDATAREADER_HPP_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * Reader for the packed binary files written by the quantised cell writers; see
+ * AbstractQuantisedCellWriter for the file format.
+ *
+ * The constructor reads the header and the time and number of cells of every frame, so that any
+ * frame can then be read without scanning the file. A file cut short part of the way through a
+ * frame, as by a crash during a run, ends in a partial frame, which is ignored.
+ */
+class QuantisedCellDataReader
+{
+private:
+
+    /** The file being read. */
+    std::string mFileName;
+
+    /** The scale by which values were multiplied before rounding. */
+    double mScale;
+
+    /** The time of each frame. */
+    std::vector<double> mTimes;
+
+    /** The number of cells in each frame. */
+    std::vector<uint32_t> mNumCells;
+
+    /** The byte offset of each frame from the start of the file. */
+    std::vector<uint64_t> mFrameOffsets;
+
+public:
+
+    /** Size of the file header (the magic number and the scale) in bytes. */
+    static const unsigned HEADER_SIZE = 12;
+
+    /** Size of the start of a frame (the time and the number of cells) in bytes. */
+    static const unsigned FRAME_HEADER_SIZE = 12;
+
+    /**
+     * Constructor. Reads the header and the frame table of a file.
+     *
+     * Throws an exception if the file cannot be opened or was not written by a quantised cell writer.
+     *
+     * @param rFileName the file
+     */
+    QuantisedCellDataReader(const std::string& rFileName);
+
+    /**
+     * @return whether a file starts with the header written by a quantised cell writer
+     *
+     * @param rFileName the file
+     */
+    static bool IsQuantisedFile(const std::string& rFileName);
+
+    /**
+     * @return #mScale
+     */
+    double GetScale() const;
+
+    /**
+     * @return the number of complete frames (output times) in the file
+     */
+    unsigned GetNumFrames() const;
+
+    /**
+     * @return the time of a frame
+     *
+     * @param frame the frame index
+     */
+    double GetTime(unsigned frame) const;
+
+    /**
+     * @return the number of cells in a frame
+     *
+     * @param frame the frame index
+     */
+    unsigned GetNumCells(unsigned frame) const;
+
+    /**
+     * @return the byte offset of the first stored value of a frame from the start of the file;
+     * the value of the i-th cell of the frame is the int16 this offset plus 2i bytes
+     *
+     * @param frame the frame index
+     */
+    uint64_t GetValuesOffset(unsigned frame) const;
+
+    /**
+     * @return a stored value converted back to the units of the original value
+     *
+     * @param storedValue the stored value
+     */
+    double Decode(int16_t storedValue) const;
+
+    /**
+     * Read the cell IDs and decoded values of a frame, in the order the cells were written.
+     *
+     * @param frame the frame index
+     * @param rCellIds vector to fill with the cell IDs
+     * @param rValues vector to fill with the decoded values
+     */
+    void GetFrame(unsigned frame, std::vector<unsigned>& rCellIds, std::vector<double>& rValues) const;
+};
+
+#endif /*QUANTISEDCELLDATAREADER_HPP_*/
@@ -0,0 +1,24 @@
+#include "QuantisedCellVolumesWriter.hpp"
+
+#include "AbstractCellPopulation.hpp"
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+QuantisedCellVolumesWriter<ELEMENT_DIM, SPACE_DIM>::QuantisedCellVolumesWriter(double scale)
+    : AbstractQuantisedCellWriter<ELEMENT_DIM, SPACE_DIM>("results.vizcellvolumes.q16", scale)
+{
+    this->mVtkCellDataName = "Quantised volumes";
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double QuantisedCellVolumesWriter<ELEMENT_DIM, SPACE_DIM>::GetCellDataForVtkOutput(CellPtr pCell, AbstractCellPopulation<ELEMENT_DIM, SPACE_DIM>* pCellPopulation)
+{
+    return pCellPopulation->GetVolumeOfCell(pCell);
+}
+
+// Explicit instantiation
+template class QuantisedCellVolumesWriter<1,1>;
+template class QuantisedCellVolumesWriter<1,2>;
+template class QuantisedCellVolumesWriter<2,2>;
+template class QuantisedCellVolumesWriter<1,3>;
+template class QuantisedCellVolumesWriter<2,3>;
+template class QuantisedCellVolumesWriter<3,3>;
@@ -0,0 +1,25 @@
+#include "QuantisedDeltaPhenotypeWriter.hpp"
+
+#include "AbstractCellPopulation.hpp"
+#include "DeltaPhenotypeFlags.hpp"
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+QuantisedDeltaPhenotypeWriter<ELEMENT_DIM, SPACE_DIM>::QuantisedDeltaPhenotypeWriter(double scale)
+    : AbstractQuantisedCellWriter<ELEMENT_DIM, SPACE_DIM>("results.vizcellphenotype.q16", scale)
+{
+    this->mVtkCellDataName = "Quantised Delta Phenotype";
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double QuantisedDeltaPhenotypeWriter<ELEMENT_DIM, SPACE_DIM>::GetCellDataForVtkOutput(CellPtr pCell, AbstractCellPopulation<ELEMENT_DIM, SPACE_DIM>* pCellPopulation)
+{
+    return DeltaPhenotypeFlags::GetPhenotype(pCell);
+}
+
+// Explicit instantiation
+template class QuantisedDeltaPhenotypeWriter<1,1>;
+template class QuantisedDeltaPhenotypeWriter<1,2>;
+template class QuantisedDeltaPhenotypeWriter<2,2>;
+template class QuantisedDeltaPhenotypeWriter<1,3>;
+template class QuantisedDeltaPhenotypeWriter<2,3>;
+template class QuantisedDeltaPhenotypeWriter<3,3>;
@@ -0,0 +1,38 @@
+
+#ifndef QUANTISEDDELTAPHENOTYPEWRITER_HPP_
+#define QUANTISEDDELTAPHENOTYPEWRITER_HPP_
+
+#include "AbstractQuantisedCellWriter.hpp"
+
+/**
+ * A class written using the visitor pattern for writing the Delta phenotype of each cell to file at reduced precision.
+ *
+ * The output file is called results.vizcellphenotype.q16 by default; see AbstractQuantisedCellWriter for its format.
+ * If VTK is switched on, then the writer also specifies the VTK output for each cell, which
+ * is stored in the VTK cell data "Quantised Delta Phenotype" at full precision, except by
+ * DeltaPhenotypeVertexBasedCellPopulation, which leaves quantised writers out of its VTK output.
+ */
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+class QuantisedDeltaPhenotypeWriter : public AbstractQuantisedCellWriter<ELEMENT_DIM, SPACE_DIM>
+{
+public:
+
+    /**
+     * Default constructor.
+     *
+     * @param scale the scale by which values are multiplied before rounding (defaults to 1.0)
+     */
+    QuantisedDeltaPhenotypeWriter(double scale=1.0);
+
+    /**
+     * Overridden GetCellDataForVtkOutput() method.
+     *
+     * @param pCell a cell
+     * @param pCellPopulation a pointer to the cell population owning the cell
+     *
+     * @return the Delta phenotype of the cell
+     */
+    double GetCellDataForVtkOutput(CellPtr pCell, AbstractCellPopulation<ELEMENT_DIM, SPACE_DIM>* pCellPopulation);
+};
+
+#endif /* QUANTISEDDELTAPHENOTYPEWRITER_HPP_ */
@@ -0,0 +1,294 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#ifndef DELTANOTCHPERFORMANCESCENARIOS_HPP_
+#define DELTANOTCHPERFORMANCESCENARIOS_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "DeltaNotchSimulationParameters.hpp"
+#include "DeltaNotchSimulationSummary.hpp"
+#include "DeltaNotchTutorialSimulation.hpp"
+#include "Exception.hpp"
+#include "FileFinder.hpp"
+
+/**
+ * The fixed-seed scenarios of the performance tests, and their recorded baseline.
+ *
+ * Each line of test/data/DeltaNotchPerformanceBaseline.txt is a scenario name, a wall time per
+ * time step in seconds and a checksum of the final state (see DeltaNotchSimulationSummary::mChecksum),
+ * or "-" if not yet recorded, which fails the checks below; a line "tolerance x" sets the allowed
+ * relative slow-down in the nightly timing test, and a line "continuous-tolerance x" the looser one
+ * allowed in the continuous tests, which run on loaded machines. Both values are recorded on the
+ * reference machine by running TestDeltaNotchPerformanceTimings and copying
+ * DeltaNotchPerformance/DeltaNotchPerformanceBaseline.txt from the Chaste output directory over the
+ * file in test/data.
+ */
+class DeltaNotchPerformanceScenarios
+{
+private:
+
+    /** Baseline time per step of each scenario, if recorded. */
+    std::map<std::string, double> mBaselineTimes;
+
+    /** Baseline checksum of each scenario, if recorded. */
+    std::map<std::string, double> mBaselineChecksums;
+
+    /** Allowed relative slow-down against the baseline time per step in the nightly timing test. */
+    double mTolerance;
+
+    /** Allowed relative slow-down against the baseline time per step in the continuous tests. */
+    double mContinuousTolerance;
+
+public:
+
+    /**
+     * Constructor. Reads the baseline file.
+     */
+    DeltaNotchPerformanceScenarios()
+        : mTolerance(0.0),
+          mContinuousTolerance(0.0)
+    {
+        FileFinder baseline_file("projects/DeltaNotchTutorial/test/data/DeltaNotchPerformanceBaseline.txt",
+                                 RelativeTo::ChasteSourceRoot);
+        std::ifstream baseline(baseline_file.GetAbsolutePath().c_str());
+        if (!baseline.is_open())
+        {
+            EXCEPTION("Could not open " + baseline_file.GetAbsolutePath());
+        }
+
+        std::string line;
+        while (std::getline(baseline, line))
+        {
+            if (line.empty() || line[0] == '#')
+            {
+                continue;
+            }
+            std::stringstream line_stream(line);
+            std::string name;
+            line_stream >> name;
+            if (name == "tolerance")
+            {
+                line_stream >> mTolerance;
+                continue;
+            }
+            if (name == "continuous-tolerance")
+            {
+                line_stream >> mContinuousTolerance;
+                continue;
+            }
+            std::string time_per_step;
+            std::string checksum;
+            line_stream >> time_per_step >> checksum;
+            if (line_stream.fail())
+            {
+                EXCEPTION("Badly formed line in performance baseline: " + line);
+            }
+            if (time_per_step != "-")
+            {
+                mBaselineTimes[name] = atof(time_per_step.c_str());
+            }
+            if (checksum != "-")
+            {
+                mBaselineChecksums[name] = atof(checksum.c_str());
+            }
+        }
+    }
+
+    /**
+     * @return the names of the scenarios, in the order they are listed in the baseline file
+     */
+    static std::vector<std::string> GetNames()
+    {
+        const char* names[] = {"three-pass", "fused", "compact", "multi-rate", "adaptive",
+                               "fast-nagai-honda", "event-log", "policy"};
+        return std::vector<std::string>(names, names + sizeof(names)/sizeof(names[0]));
+    }
+
+    /**
+     * @return the parameters of a scenario
+     *
+     * @param rName the scenario name
+     */
+    static DeltaNotchSimulationParameters GetParameters(const std::string& rName)
+    {
+        DeltaNotchSimulationParameters parameters;
+        parameters.mMeshWidth = 10;
+        parameters.mMeshHeight = 10;
+        parameters.mEndTime = 2.0;
+        parameters.mSeed = 0;
+        parameters.mWriters.clear();
+        parameters.mOutputDirectory = "DeltaNotchPerformance/" + rName;
+
+        if (rName == "fused")
+        {
+            parameters.mUseFusedModifier = true;
+        }
+        else if (rName == "compact")
+        {
+            parameters.mUseCompactStorage = true;
+        }
+        else if (rName == "multi-rate")
+        {
+            parameters.mPhenotypeUpdateMultiple = 5;
+            parameters.mTargetAreaUpdateMultiple = 5;
+            parameters.mNumOdeSubcycles = 2;
+        }
+        else if (rName == "adaptive")
+        {
+            parameters.mUseAdaptiveTimeStep = true;
+        }
+        else if (rName == "fast-nagai-honda")
+        {
+            parameters.mUseFastNagaiHondaForce = true;
+        }
+        else if (rName == "event-log")
+        {
+            parameters.mEventLogFile = "events.bin";
+        }
+        else if (rName == "policy")
+        {
+            parameters.mPhenotypePolicy = "three-band";
+        }
+        else if (rName != "three-pass")
+        {
+            EXCEPTION("Unknown performance scenario " + rName);
+        }
+        return parameters;
+    }
+
+    /**
+     * Run a scenario a number of times and check that every run reaches the same state.
+     *
+     * @param rName the scenario name
+     * @param numRepeats the number of runs
+     * @return the summary of the fastest run
+     */
+    static DeltaNotchSimulationSummary Run(const std::string& rName, unsigned numRepeats)
+    {
+        DeltaNotchSimulationParameters parameters = GetParameters(rName);
+        DeltaNotchTutorialSimulation simulation;
+        DeltaNotchSimulationSummary best;
+        for (unsigned i=0; i<numRepeats; i++)
+        {
+            DeltaNotchSimulationSummary summary = simulation.Run(parameters);
+            TS_ASSERT_LESS_THAN(0u, summary.mNumTimeSteps);
+            if (i == 0)
+            {
+                best = summary;
+            }
+            else
+            {
+                // Fixed seed, so every run must reach the same state
+                TS_ASSERT_EQUALS(summary.mNumCells, best.mNumCells);
+                TS_ASSERT_EQUALS(summary.mNumDeltaHigh, best.mNumDeltaHigh);
+                TS_ASSERT_EQUALS(summary.mNumTimeSteps, best.mNumTimeSteps);
+                TS_ASSERT_DELTA(summary.mChecksum, best.mChecksum, 1e-12*fabs(best.mChecksum));
+                if (summary.mWallTime < best.mWallTime)
+                {
+                    best = summary;
+                }
+            }
+        }
+
+        std::cout << "Performance " << rName << ": " << best.mWallTime/best.mNumTimeSteps << " s/step, checksum "
+                  << std::setprecision(16) << best.mChecksum << std::setprecision(6) << std::endl;
+        return best;
+    }
+
+    /**
+     * Compare the final state of a run of a scenario with its recorded checksum, failing if none is recorded.
+     *
+     * @param rName the scenario name
+     * @param rSummary the summary of the run
+     */
+    void CheckChecksum(const std::string& rName, const DeltaNotchSimulationSummary& rSummary)
+    {
+        if (mBaselineChecksums.find(rName) == mBaselineChecksums.end())
+        {
+            TS_FAIL("No checksum recorded for performance scenario " + rName);
+        }
+        else
+        {
+            TS_ASSERT_DELTA(rSummary.mChecksum, mBaselineChecksums[rName], 1e-8*fabs(mBaselineChecksums[rName]));
+        }
+    }
+
+    /**
+     * Compare the time per step of a run of a scenario with its recorded time, failing if none is recorded.
+     *
+     * @param rName the scenario name
+     * @param rSummary the summary of the run
+     * @param tolerance the allowed relative slow-down: #mTolerance or #mContinuousTolerance
+     */
+    void CheckTime(const std::string& rName, const DeltaNotchSimulationSummary& rSummary, double tolerance)
+    {
+        if (mBaselineTimes.find(rName) == mBaselineTimes.end())
+        {
+            TS_FAIL("No time per step recorded for performance scenario " + rName);
+        }
+        else
+        {
+            TS_ASSERT_LESS_THAN_EQUALS(rSummary.mWallTime/rSummary.mNumTimeSteps, mBaselineTimes[rName]*(1.0 + tolerance));
+        }
+    }
+
+    /**
+     * @return #mTolerance
+     */
+    double GetTolerance() const
+    {
+        return mTolerance;
+    }
+
+    /**
+     * @return #mContinuousTolerance
+     */
+    double GetContinuousTolerance() const
+    {
+        return mContinuousTolerance;
+    }
+};
+
+#endif /*DELTANOTCHPERFORMANCESCENARIOS_HPP_*/
@@ -0,0 +1,183 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#ifndef TESTDELTANOTCHADAPTIVESIMULATION_HPP_
+#define TESTDELTANOTCHADAPTIVESIMULATION_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "DeltaNotchSimulationParameters.hpp"
+#include "DeltaNotchSimulationSummary.hpp"
+#include "DeltaNotchTutorialSimulation.hpp"
+#include "FileFinder.hpp"
+#include "OutputFileHandler.hpp"
+
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests of DeltaNotchAdaptiveSimulation.
+ */
+class TestDeltaNotchAdaptiveSimulation : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * @return parameters for a short run whose time step doubles at the first output time
+     *
+     * @param rOutputDirectory the output directory
+     */
+    DeltaNotchSimulationParameters GetParameters(const std::string& rOutputDirectory)
+    {
+        DeltaNotchSimulationParameters parameters;
+        parameters.mMeshWidth = 4;
+        parameters.mMeshHeight = 4;
+        parameters.mDt = 0.002;
+        parameters.mSamplingTimestepMultiple = 10;
+        parameters.mEndTime = 0.2;
+        parameters.mSeed = 0;
+        parameters.mUseAdaptiveTimeStep = true;
+        parameters.mMinDt = 0.004;
+        parameters.mMaxDt = 0.004;
+        parameters.mWriters.clear();
+        parameters.mOutputDirectory = rOutputDirectory;
+        return parameters;
+    }
+
+    /**
+     * Read the time step and file name of each entry of a results.pvd file.
+     *
+     * @param rOutputDirectory the simulation output directory
+     * @param rTimeSteps filled with the time step of each entry
+     * @param rFiles filled with the file name of each entry
+     */
+    void ReadPvdFile(const std::string& rOutputDirectory, std::vector<unsigned>& rTimeSteps, std::vector<std::string>& rFiles)
+    {
+        OutputFileHandler handler(rOutputDirectory + "/results_from_time_0", false);
+        std::ifstream pvd_file((handler.GetOutputDirectoryFullPath() + "results.pvd").c_str());
+        TS_ASSERT(pvd_file.is_open());
+
+        std::string line;
+        while (std::getline(pvd_file, line))
+        {
+            std::size_t timestep_start = line.find("timestep=\"");
+            std::size_t file_start = line.find("file=\"");
+            if (timestep_start == std::string::npos || file_start == std::string::npos)
+            {
+                continue;
+            }
+            timestep_start += 10;
+            file_start += 6;
+            rTimeSteps.push_back(atoi(line.substr(timestep_start, line.find('"', timestep_start) - timestep_start).c_str()));
+            rFiles.push_back(line.substr(file_start, line.find('"', file_start) - file_start));
+
+            FileFinder vtu_file(handler.GetOutputDirectoryFullPath() + rFiles.back(), RelativeTo::Absolute);
+            TS_ASSERT(vtu_file.Exists());
+        }
+    }
+
+public:
+
+    void TestOutputNamesIncreaseAcrossTimeStepChange()
+    {
+#ifdef CHASTE_VTK
+        DeltaNotchSimulationParameters parameters = GetParameters("TestDeltaNotchAdaptiveSimulation/Standard");
+        DeltaNotchTutorialSimulation simulation;
+        DeltaNotchSimulationSummary summary = simulation.Run(parameters);
+
+        // 10 steps of 0.002 to the first output time, then 45 steps of 0.004
+        TS_ASSERT_EQUALS(summary.mNumTimeSteps, 55u);
+
+        std::vector<unsigned> time_steps;
+        std::vector<std::string> files;
+        ReadPvdFile(parameters.mOutputDirectory, time_steps, files);
+
+        // One entry per output time, each with its own file, named by the steps taken since the start
+        TS_ASSERT_EQUALS(time_steps.size(), 11u);
+        TS_ASSERT_EQUALS(std::set<std::string>(files.begin(), files.end()).size(), files.size());
+        for (unsigned i=1; i<time_steps.size(); i++)
+        {
+            TS_ASSERT_LESS_THAN(time_steps[i-1], time_steps[i]);
+        }
+        if (time_steps.size() == 11u)
+        {
+            TS_ASSERT_EQUALS(time_steps[1], 10u);
+            TS_ASSERT_EQUALS(time_steps[2], 15u);
+            TS_ASSERT_EQUALS(time_steps[10], 55u);
+            TS_ASSERT_EQUALS(files[2], "results_15.vtu");
+        }
+#endif //CHASTE_VTK
+    }
+
+    void TestCompressedOutputNamesIncreaseAcrossTimeStepChange()
+    {
+#ifdef CHASTE_VTK
+        DeltaNotchSimulationParameters parameters = GetParameters("TestDeltaNotchAdaptiveSimulation/Compressed");
+        parameters.mUseCompressedVtkOutput = true;
+        parameters.mVtkGeometryTolerance = 0.0;
+        DeltaNotchTutorialSimulation simulation;
+        simulation.Run(parameters);
+
+        std::vector<unsigned> time_steps;
+        std::vector<std::string> files;
+        ReadPvdFile(parameters.mOutputDirectory, time_steps, files);
+
+        // Entries may share a geometry frame, but each output time has its own file and increasing time step
+        TS_ASSERT_EQUALS(time_steps.size(), 11u);
+        TS_ASSERT_EQUALS(std::set<std::string>(files.begin(), files.end()).size(), files.size());
+        for (unsigned i=1; i<time_steps.size(); i++)
+        {
+            TS_ASSERT_LESS_THAN(time_steps[i-1], time_steps[i]);
+        }
+#endif //CHASTE_VTK
+    }
+
+    void TestAdaptiveTimeStepNeedsVertexPopulation()
+    {
+        std::vector<std::string> arguments;
+        arguments.push_back("--population=node");
+        arguments.push_back("--adaptive-dt=true");
+        DeltaNotchSimulationParameters parameters;
+        TS_ASSERT_THROWS_THIS(parameters.Parse(arguments),
+                              "Adaptive time stepping is only available for the vertex population");
+    }
+};
+
+#endif /*TESTDELTANOTCHADAPTIVESIMULATION_HPP_*/
@@ -0,0 +1,146 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#ifndef TESTDELTANOTCHENSEMBLERUNNER_HPP_
+#define TESTDELTANOTCHENSEMBLERUNNER_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "DeltaNotchEnsembleRunner.hpp"
+#include "DeltaNotchSimulationParameters.hpp"
+#include "DeltaNotchSimulationSummary.hpp"
+#include "DeltaNotchTutorialSimulation.hpp"
+#include "FileFinder.hpp"
+#include "OutputFileHandler.hpp"
+#include "PetscTools.hpp"
+
+#include "PetscSetupAndFinalize.hpp"
+
+/**
+ * Tests of DeltaNotchEnsembleRunner. This is in the parallel test pack; run it with, e.g.,
+ * mpirun -np 3 so that two processes run replicas.
+ */
+class TestDeltaNotchEnsembleRunner : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * @return parameters for a short run
+     *
+     * @param seed the random number seed
+     */
+    DeltaNotchSimulationParameters GetParameters(unsigned seed)
+    {
+        DeltaNotchSimulationParameters parameters;
+        parameters.mMeshWidth = 4;
+        parameters.mMeshHeight = 4;
+        parameters.mDt = 0.005;
+        parameters.mSamplingTimestepMultiple = 10;
+        parameters.mEndTime = 0.1;
+        parameters.mSeed = seed;
+        parameters.mWriters.clear();
+        return parameters;
+    }
+
+public:
+
+    void TestEveryReplicaRunsOnce()
+    {
+        const unsigned num_replicas = 7;
+        DeltaNotchEnsembleRunner runner("TestDeltaNotchEnsembleRunner");
+        for (unsigned seed=0; seed<num_replicas; seed++)
+        {
+            runner.AddReplica(GetParameters(seed));
+        }
+        TS_ASSERT_EQUALS(runner.GetNumReplicas(), num_replicas);
+
+        // Run() checks on process 0 that every replica's result arrived exactly once
+        TS_ASSERT_THROWS_NOTHING(runner.Run());
+        runner.WriteSummary();
+
+        if (PetscTools::AmMaster())
+        {
+            const std::vector<DeltaNotchSimulationSummary>& r_summaries = runner.rGetSummaries();
+            const std::vector<unsigned>& r_ranks = runner.rGetReplicaRanks();
+            TS_ASSERT_EQUALS(r_summaries.size(), num_replicas);
+            TS_ASSERT_EQUALS(r_ranks.size(), num_replicas);
+
+            // With more than one process, process 0 only hands out replicas
+            for (unsigned index=0; index<r_ranks.size(); index++)
+            {
+                if (PetscTools::IsParallel())
+                {
+                    TS_ASSERT_LESS_THAN(0u, r_ranks[index]);
+                    TS_ASSERT_LESS_THAN(r_ranks[index], PetscTools::GetNumProcs());
+                }
+                else
+                {
+                    TS_ASSERT_EQUALS(r_ranks[index], 0u);
+                }
+            }
+
+            // The other processes have gone on, so don't wait on them from here
+            PetscTools::IsolateProcesses(true);
+            OutputFileHandler handler("TestDeltaNotchEnsembleRunner", false);
+            FileFinder summary_file(handler.GetOutputDirectoryFullPath() + "ensemble_summary.dat", RelativeTo::Absolute);
+            TS_ASSERT(summary_file.Exists());
+
+            // Each summary is stored against its own replica: rerun every replica here and compare
+            DeltaNotchTutorialSimulation simulation;
+            for (unsigned index=0; index<r_summaries.size(); index++)
+            {
+                std::stringstream output_directory;
+                output_directory << "TestDeltaNotchEnsembleRunner/check_" << index;
+                DeltaNotchSimulationParameters parameters = GetParameters(index);
+                parameters.mOutputDirectory = output_directory.str();
+                DeltaNotchSimulationSummary expected = simulation.Run(parameters);
+
+                TS_ASSERT_EQUALS(r_summaries[index].mNumCells, expected.mNumCells);
+                TS_ASSERT_EQUALS(r_summaries[index].mNumDeltaHigh, expected.mNumDeltaHigh);
+                TS_ASSERT_EQUALS(r_summaries[index].mNumDeltaLow, expected.mNumDeltaLow);
+                TS_ASSERT_EQUALS(r_summaries[index].mNumTransient, expected.mNumTransient);
+                TS_ASSERT_EQUALS(r_summaries[index].mNumTimeSteps, expected.mNumTimeSteps);
+                TS_ASSERT_DELTA(r_summaries[index].mChecksum, expected.mChecksum, 1e-10);
+            }
+            PetscTools::IsolateProcesses(false);
+        }
+    }
+};
+
+#endif /*TESTDELTANOTCHENSEMBLERUNNER_HPP_*/
@@ -0,0 +1,236 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#ifndef TESTDELTANOTCHEVENTLOG_HPP_
+#define TESTDELTANOTCHEVENTLOG_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "DeltaNotchEventLog.hpp"
+#include "DeltaNotchPopulationBuilder.hpp"
+#include "DeltaNotchReplicaContext.hpp"
+#include "OutputFileHandler.hpp"
+#include "SimulationTime.hpp"
+
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests of DeltaNotchEventLog.
+ */
+class TestDeltaNotchEventLog : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * @return a division event
+     *
+     * @param parentCellId the parent cell
+     * @param daughterCellId the daughter cell
+     */
+    DeltaNotchEvent MakeDivision(unsigned parentCellId, unsigned daughterCellId)
+    {
+        DeltaNotchEvent event;
+        event.mTime = daughterCellId;
+        event.mCellId = daughterCellId;
+        event.mRelatedCellId = parentCellId;
+        event.mType = EVENT_DIVISION;
+        event.mPhenotype = 0;
+        event.mPreviousPhenotype = DeltaNotchEvent::NO_PHENOTYPE;
+        event.mProliferativeType = DeltaNotchEventLog::STEM;
+        event.mPadding = 0;
+        return event;
+    }
+
+    /**
+     * Write a log file by hand.
+     *
+     * @param rPath the file
+     * @param pMagic the first four bytes of the file
+     * @param recordSize the record size given in the header
+     * @param rEvents the events
+     * @param numExtraBytes number of bytes of a further, partial, record to write at the end
+     */
+    void WriteLog(const std::string& rPath, const char* pMagic, uint32_t recordSize,
+                  const std::vector<DeltaNotchEvent>& rEvents, unsigned numExtraBytes=0)
+    {
+        std::ofstream file(rPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        TS_ASSERT(file.is_open());
+        file.write(pMagic, 4);
+        file.write(reinterpret_cast<const char*>(&recordSize), sizeof(recordSize));
+        for (unsigned i=0; i<rEvents.size(); i++)
+        {
+            file.write(reinterpret_cast<const char*>(&rEvents[i]), sizeof(DeltaNotchEvent));
+        }
+        DeltaNotchEvent partial = MakeDivision(0, 1);
+        file.write(reinterpret_cast<const char*>(&partial), numExtraBytes);
+    }
+
+public:
+
+    void TestReadEventsChecksHeader()
+    {
+        OutputFileHandler handler("TestDeltaNotchEventLog");
+        std::string path = handler.GetOutputDirectoryFullPath() + "header.bin";
+        std::vector<DeltaNotchEvent> events(1, MakeDivision(1, 2));
+        std::vector<DeltaNotchEvent> read_events;
+
+        WriteLog(path, "DNQ1", sizeof(DeltaNotchEvent), events);
+        TS_ASSERT_THROWS_CONTAINS(DeltaNotchEventLog::ReadEvents(path, read_events), "is not a Delta/Notch event log");
+
+        WriteLog(path, "DNE1", sizeof(DeltaNotchEvent) + 8, events);
+        TS_ASSERT_THROWS_CONTAINS(DeltaNotchEventLog::ReadEvents(path, read_events), "was written with a different event record layout");
+
+        // A file too short to hold the header
+        {
+            std::ofstream file(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            file.write("DN", 2);
+        }
+        TS_ASSERT_THROWS_CONTAINS(DeltaNotchEventLog::ReadEvents(path, read_events), "is not a Delta/Notch event log");
+
+        TS_ASSERT_THROWS_CONTAINS(DeltaNotchEventLog::ReadEvents(handler.GetOutputDirectoryFullPath() + "missing.bin", read_events),
+                                  "Could not open event log");
+    }
+
+    void TestReadEventsIgnoresTruncatedRecord()
+    {
+        OutputFileHandler handler("TestDeltaNotchEventLog", false);
+        std::string path = handler.GetOutputDirectoryFullPath() + "truncated.bin";
+        std::vector<DeltaNotchEvent> events;
+        events.push_back(MakeDivision(1, 2));
+        events.push_back(MakeDivision(2, 3));
+
+        // As left by a crash part of the way through writing a third record
+        WriteLog(path, "DNE1", sizeof(DeltaNotchEvent), events, sizeof(DeltaNotchEvent)/2);
+
+        std::vector<DeltaNotchEvent> read_events;
+        DeltaNotchEventLog::ReadEvents(path, read_events);
+        TS_ASSERT_EQUALS(read_events.size(), 2u);
+        for (unsigned i=0; i<read_events.size() && i<events.size(); i++)
+        {
+            TS_ASSERT_EQUALS(read_events[i].mCellId, events[i].mCellId);
+            TS_ASSERT_EQUALS(read_events[i].mRelatedCellId, events[i].mRelatedCellId);
+            TS_ASSERT_EQUALS(read_events[i].mType, EVENT_DIVISION);
+            TS_ASSERT_DELTA(read_events[i].mTime, events[i].mTime, 1e-12);
+        }
+
+        // An empty log has no events
+        WriteLog(path, "DNE1", sizeof(DeltaNotchEvent), std::vector<DeltaNotchEvent>());
+        DeltaNotchEventLog::ReadEvents(path, read_events);
+        TS_ASSERT(read_events.empty());
+    }
+
+    void TestGetLineage()
+    {
+        // 1 divides into 2 and 3, 2 into 4, 4 into 5; 6 into 7 is another lineage
+        std::vector<DeltaNotchEvent> events;
+        events.push_back(MakeDivision(1, 2));
+        events.push_back(MakeDivision(1, 3));
+        events.push_back(MakeDivision(2, 4));
+        events.push_back(MakeDivision(6, 7));
+        events.push_back(MakeDivision(4, 5));
+
+        std::vector<unsigned> ancestors;
+        std::vector<unsigned> descendants;
+        DeltaNotchEventLog::GetLineage(events, 4, ancestors, descendants);
+        TS_ASSERT_EQUALS(ancestors.size(), 2u);
+        TS_ASSERT_EQUALS(ancestors[0], 2u);
+        TS_ASSERT_EQUALS(ancestors[1], 1u);
+        TS_ASSERT_EQUALS(descendants.size(), 1u);
+        TS_ASSERT_EQUALS(descendants[0], 5u);
+
+        DeltaNotchEventLog::GetLineage(events, 1, ancestors, descendants);
+        TS_ASSERT(ancestors.empty());
+        TS_ASSERT_EQUALS(descendants.size(), 4u);
+        TS_ASSERT_EQUALS(descendants[0], 2u);
+        TS_ASSERT_EQUALS(descendants[1], 3u);
+        TS_ASSERT_EQUALS(descendants[2], 4u);
+        TS_ASSERT_EQUALS(descendants[3], 5u);
+
+        // A cell that never divided, and was not born in the log
+        DeltaNotchEventLog::GetLineage(events, 9, ancestors, descendants);
+        TS_ASSERT(ancestors.empty());
+        TS_ASSERT(descendants.empty());
+    }
+
+    void TestSeveralLogsAtOnce()
+    {
+        DeltaNotchReplicaContext context(1);
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 1);
+        DeltaNotchPopulationBuilder builder;
+        std::vector<CellPtr> cells;
+        builder.CreateCells(3, cells);
+
+        OutputFileHandler handler("TestDeltaNotchEventLog", false);
+        std::string path_a = handler.GetOutputDirectoryFullPath() + "a.bin";
+        std::string path_b = handler.GetOutputDirectoryFullPath() + "b.bin";
+        {
+            // Each simulation has its own log, so two may be open at once
+            DeltaNotchEventLog log_a(path_a, 1);
+            DeltaNotchEventLog log_b(path_b);
+            log_a.RecordDivision(cells[0], cells[1]);
+            log_a.RecordDeath(cells[1]);
+            log_b.RecordDeath(cells[2]);
+            TS_ASSERT_EQUALS(log_a.GetNumEvents(), 2u);
+            TS_ASSERT_EQUALS(log_a.GetNumFlushes(), 1u);
+            TS_ASSERT_EQUALS(log_b.GetNumEvents(), 1u);
+        }
+
+        std::vector<DeltaNotchEvent> events;
+        DeltaNotchEventLog::ReadEvents(path_a, events);
+        TS_ASSERT_EQUALS(events.size(), 2u);
+        if (events.size() == 2u)
+        {
+            TS_ASSERT_EQUALS(events[0].mType, EVENT_DIVISION);
+            TS_ASSERT_EQUALS(events[0].mCellId, cells[1]->GetCellId());
+            TS_ASSERT_EQUALS(events[0].mRelatedCellId, cells[0]->GetCellId());
+            TS_ASSERT_EQUALS(events[1].mType, EVENT_DEATH);
+            TS_ASSERT_EQUALS(events[1].mCellId, cells[1]->GetCellId());
+        }
+
+        DeltaNotchEventLog::ReadEvents(path_b, events);
+        TS_ASSERT_EQUALS(events.size(), 1u);
+        if (events.size() == 1u)
+        {
+            TS_ASSERT_EQUALS(events[0].mType, EVENT_DEATH);
+            TS_ASSERT_EQUALS(events[0].mCellId, cells[2]->GetCellId());
+        }
+    }
+};
+
+#endif /*TESTDELTANOTCHEVENTLOG_HPP_*/
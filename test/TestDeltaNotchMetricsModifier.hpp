@@ -0,0 +1,165 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#ifndef TESTDELTANOTCHMETRICSMODIFIER_HPP_
+#define TESTDELTANOTCHMETRICSMODIFIER_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "DeltaNotchSimulationParameters.hpp"
+#include "DeltaNotchSimulationSummary.hpp"
+#include "DeltaNotchTutorialSimulation.hpp"
+#include "OutputFileHandler.hpp"
+#include "Warnings.hpp"
+
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests of DeltaNotchMetricsModifier.
+ */
+class TestDeltaNotchMetricsModifier : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * @return parameters for a short fixed-seed run
+     *
+     * @param rOutputDirectory the output directory
+     */
+    DeltaNotchSimulationParameters GetParameters(const std::string& rOutputDirectory)
+    {
+        DeltaNotchSimulationParameters parameters;
+        parameters.mMeshWidth = 4;
+        parameters.mMeshHeight = 4;
+        parameters.mEndTime = 0.1;
+        parameters.mSeed = 0;
+        parameters.mWriters.clear();
+        parameters.mOutputDirectory = rOutputDirectory;
+        return parameters;
+    }
+
+    /**
+     * Read the samples of a Prometheus text file, keyed by metric name and labels.
+     *
+     * @param rPath the file
+     * @return the value of each sample
+     */
+    std::map<std::string, double> ReadMetrics(const std::string& rPath)
+    {
+        std::map<std::string, double> metrics;
+        std::ifstream file(rPath.c_str());
+        TS_ASSERT(file.is_open());
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (line.empty() || line[0] == '#')
+            {
+                continue;
+            }
+            std::size_t separator = line.rfind(' ');
+            TS_ASSERT_DIFFERS(separator, std::string::npos);
+            std::stringstream value(line.substr(separator + 1));
+            value >> metrics[line.substr(0, separator)];
+            TS_ASSERT(!value.fail());
+        }
+        return metrics;
+    }
+
+public:
+
+    void TestMetricsFileDescribesFinalState()
+    {
+        DeltaNotchTutorialSimulation simulation;
+        DeltaNotchSimulationParameters parameters = GetParameters("TestDeltaNotchMetricsModifier/Plain");
+        DeltaNotchSimulationSummary plain = simulation.Run(parameters);
+
+        parameters = GetParameters("TestDeltaNotchMetricsModifier/Metrics");
+        parameters.mMetricsFile = "metrics.prom";
+        parameters.mMetricsInterval = 0.0;
+        DeltaNotchSimulationSummary summary = simulation.Run(parameters);
+
+        // Publishing metrics runs the modifiers in a scheduler, which must not change the results
+        TS_ASSERT_EQUALS(summary.mNumTimeSteps, plain.mNumTimeSteps);
+        TS_ASSERT_EQUALS(summary.mNumCells, plain.mNumCells);
+        TS_ASSERT_DELTA(summary.mChecksum, plain.mChecksum, 1e-12*fabs(plain.mChecksum));
+
+        OutputFileHandler handler(parameters.mOutputDirectory + "/results_from_time_0", false);
+        std::map<std::string, double> metrics = ReadMetrics(handler.GetOutputDirectoryFullPath() + "metrics.prom");
+
+        TS_ASSERT_EQUALS(metrics["deltanotch_running"], 0.0);
+        TS_ASSERT_DELTA(metrics["deltanotch_simulated_time"], parameters.mEndTime, 1e-9);
+        TS_ASSERT_EQUALS(metrics["deltanotch_time_steps_total"], summary.mNumTimeSteps);
+        TS_ASSERT_EQUALS(metrics["deltanotch_cells"], summary.mNumCells);
+        TS_ASSERT_EQUALS(metrics["deltanotch_phenotype_cells{phenotype=\"high\"}"], summary.mNumDeltaHigh);
+        TS_ASSERT_EQUALS(metrics["deltanotch_phenotype_cells{phenotype=\"low\"}"], summary.mNumDeltaLow);
+        TS_ASSERT_EQUALS(metrics["deltanotch_phenotype_cells{phenotype=\"transient\"}"], summary.mNumTransient);
+        TS_ASSERT_LESS_THAN_EQUALS(0.0, metrics["deltanotch_wall_seconds_total"]);
+        TS_ASSERT_EQUALS(metrics.count("deltanotch_phenotype_transitions_total"), 1u);
+
+        // The three modifiers are timed by the scheduler
+        unsigned num_modifier_times = 0;
+        for (std::map<std::string, double>::iterator iter = metrics.begin(); iter != metrics.end(); ++iter)
+        {
+            if (iter->first.find("deltanotch_modifier_wall_seconds_total{") == 0)
+            {
+                num_modifier_times++;
+                TS_ASSERT_LESS_THAN_EQUALS(0.0, iter->second);
+            }
+        }
+        TS_ASSERT_EQUALS(num_modifier_times, 3u);
+    }
+
+    void TestUnwritableMetricsFileOnlyWarns()
+    {
+        DeltaNotchTutorialSimulation simulation;
+        DeltaNotchSimulationParameters parameters = GetParameters("TestDeltaNotchMetricsModifier/Unwritable");
+        parameters.mMetricsFile = "/this/directory/does/not/exist/metrics.prom";
+        parameters.mMetricsInterval = 0.0;
+
+        DeltaNotchSimulationSummary summary;
+        TS_ASSERT_THROWS_NOTHING(summary = simulation.Run(parameters));
+        TS_ASSERT_LESS_THAN(0u, summary.mNumTimeSteps);
+        TS_ASSERT_EQUALS(Warnings::Instance()->GetNumWarnings(), 1u);
+        Warnings::QuietDestroy();
+    }
+};
+
+#endif /*TESTDELTANOTCHMETRICSMODIFIER_HPP_*/
@@ -0,0 +1,203 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#ifndef TESTDELTANOTCHNAGAIHONDAFORCE_HPP_
+#define TESTDELTANOTCHNAGAIHONDAFORCE_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+#include "DeltaNotchNagaiHondaForce.hpp"
+#include "DeltaNotchPopulationBuilder.hpp"
+#include "DeltaNotchReplicaContext.hpp"
+#include "DeltaNotchTrackingModifier.hpp"
+#include "DeltaPhenotypeTargetAreaModifier.hpp"
+#include "DeltaPhenotypeTrackingModifier.hpp"
+#include "DeltaPhenotypeVertexBasedCellPopulation.hpp"
+#include "MutableVertexMesh.hpp"
+#include "NagaiHondaForce.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "SimulationTime.hpp"
+
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests that DeltaNotchNagaiHondaForce gives the forces of NagaiHondaForce.
+ */
+class TestDeltaNotchNagaiHondaForce : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * Compute the forces on every node of a vertex population.
+     *
+     * @param rForce the force
+     * @param rCellPopulation the cell population
+     * @param rForces vector to fill with the forces, stored as x0, y0, x1, y1, ...
+     */
+    void ComputeForces(AbstractForce<2,2>& rForce, VertexBasedCellPopulation<2>& rCellPopulation, std::vector<double>& rForces)
+    {
+        unsigned num_nodes = rCellPopulation.GetNumNodes();
+        for (unsigned node_index=0; node_index<num_nodes; node_index++)
+        {
+            rCellPopulation.GetNode(node_index)->ClearAppliedForce();
+        }
+        rForce.AddForceContribution(rCellPopulation);
+
+        rForces.resize(2*num_nodes);
+        for (unsigned node_index=0; node_index<num_nodes; node_index++)
+        {
+            const c_vector<double, 2>& r_force = rCellPopulation.GetNode(node_index)->rGetAppliedForce();
+            rForces[2*node_index] = r_force[0];
+            rForces[2*node_index+1] = r_force[1];
+        }
+    }
+
+    /**
+     * Check that two sets of forces agree at every node, to within rounding.
+     *
+     * @param rForces the forces
+     * @param rExpected the expected forces
+     */
+    void CompareForces(const std::vector<double>& rForces, const std::vector<double>& rExpected)
+    {
+        TS_ASSERT_EQUALS(rForces.size(), rExpected.size());
+        for (unsigned i=0; i<rExpected.size(); i++)
+        {
+            TS_ASSERT_DELTA(rForces[i], rExpected[i], 1e-12*std::max(1.0, fabs(rExpected[i])));
+        }
+    }
+
+public:
+
+    void TestForcesMatchNagaiHondaForceOnDeformedMesh()
+    {
+        DeltaNotchReplicaContext context(1);
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 1);
+
+        DeltaNotchPopulationBuilder builder;
+        MutableVertexMesh<2,2>* p_mesh = builder.BuildHoneycombMesh(5, 4);
+        std::vector<CellPtr> cells;
+        builder.CreateCells(p_mesh->GetNumElements(), cells);
+
+        // Move every node, including those on the boundary, so that no two elements have the same shape
+        for (unsigned node_index=0; node_index<p_mesh->GetNumNodes(); node_index++)
+        {
+            c_vector<double, 2>& r_location = p_mesh->GetNode(node_index)->rGetModifiableLocation();
+            r_location[0] += 0.2*(RandomNumberGenerator::Instance()->ranf() - 0.5);
+            r_location[1] += 0.2*(RandomNumberGenerator::Instance()->ranf() - 0.5);
+        }
+        DeltaPhenotypeVertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        // Phenotype-dependent target areas, with some cells still growing, filling the per-element array too
+        DeltaNotchTrackingModifier<2> notch_modifier;
+        DeltaPhenotypeTrackingModifier<2> phenotype_modifier;
+        DeltaPhenotypeTargetAreaModifier<2> target_area_modifier;
+        target_area_modifier.SetDeltaHighPhenotypeTargetAreaCoefficient(1.5);
+        target_area_modifier.SetDeltaLowPhenotypeTargetAreaCoefficient(0.7);
+        notch_modifier.SetupSolve(cell_population, "");
+        phenotype_modifier.SetupSolve(cell_population, "");
+        target_area_modifier.SetupSolve(cell_population, "");
+        TS_ASSERT(cell_population.AreElementTargetAreasCurrent());
+
+        double min_target_area = DBL_MAX;
+        double max_target_area = 0.0;
+        for (unsigned i=0; i<cells.size(); i++)
+        {
+            double target_area = cells[i]->GetCellData()->GetItem("target area");
+            min_target_area = std::min(min_target_area, target_area);
+            max_target_area = std::max(max_target_area, target_area);
+        }
+        TS_ASSERT_LESS_THAN(min_target_area, max_target_area);
+
+        // Different adhesion on boundary and internal edges
+        NagaiHondaForce<2> stock_force;
+        DeltaNotchNagaiHondaForce<2> project_force;
+        stock_force.SetNagaiHondaCellCellAdhesionEnergyParameter(0.5);
+        stock_force.SetNagaiHondaCellBoundaryAdhesionEnergyParameter(1.3);
+        project_force.SetNagaiHondaCellCellAdhesionEnergyParameter(0.5);
+        project_force.SetNagaiHondaCellBoundaryAdhesionEnergyParameter(1.3);
+
+        std::vector<double> stock_forces;
+        ComputeForces(stock_force, cell_population, stock_forces);
+
+        std::vector<double> array_forces;
+        ComputeForces(project_force, cell_population, array_forces);
+        CompareForces(array_forces, stock_forces);
+
+        // Once the per-element array no longer matches the mesh, the force reads target areas from CellData
+        cell_population.rGetElementTargetAreas().clear();
+        std::vector<double> cell_data_forces;
+        ComputeForces(project_force, cell_population, cell_data_forces);
+        CompareForces(cell_data_forces, stock_forces);
+    }
+
+    void TestForcesMatchNagaiHondaForceOnClockwiseElement()
+    {
+        DeltaNotchReplicaContext context(1);
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 1);
+
+        // A single irregular quadrilateral, larger than its target area, whose nodes run clockwise
+        std::vector<Node<2>*> nodes;
+        nodes.push_back(new Node<2>(0, true, 0.0, 0.0));
+        nodes.push_back(new Node<2>(1, true, 0.1, 1.2));
+        nodes.push_back(new Node<2>(2, true, 1.1, 0.9));
+        nodes.push_back(new Node<2>(3, true, 1.0, -0.2));
+        std::vector<VertexElement<2,2>*> elements;
+        elements.push_back(new VertexElement<2,2>(0, nodes));
+        MutableVertexMesh<2,2> mesh(nodes, elements);
+        TS_ASSERT_LESS_THAN(0.5, mesh.GetVolumeOfElement(0));
+
+        DeltaNotchPopulationBuilder builder;
+        std::vector<CellPtr> cells;
+        builder.CreateCells(1, cells);
+        cells[0]->GetCellData()->SetItem("target area", 0.5);
+        VertexBasedCellPopulation<2> cell_population(mesh, cells);
+
+        NagaiHondaForce<2> stock_force;
+        DeltaNotchNagaiHondaForce<2> project_force;
+        std::vector<double> stock_forces;
+        ComputeForces(stock_force, cell_population, stock_forces);
+        std::vector<double> project_forces;
+        ComputeForces(project_force, cell_population, project_forces);
+        CompareForces(project_forces, stock_forces);
+    }
+};
+
+#endif /*TESTDELTANOTCHNAGAIHONDAFORCE_HPP_*/
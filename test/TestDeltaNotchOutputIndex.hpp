@@ -0,0 +1,170 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#ifndef TESTDELTANOTCHOUTPUTINDEX_HPP_
+#define TESTDELTANOTCHOUTPUTINDEX_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "DeltaNotchOutputIndex.hpp"
+#include "OutputFileHandler.hpp"
+
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests of DeltaNotchOutputIndex on small output files, with cells listed in a different order
+ * at each output time and blank lines between and after the output times.
+ */
+class TestDeltaNotchOutputIndex : public CxxTest::TestSuite
+{
+private:
+
+    /** The output directory, containing results.vizcellages and results.vizcellphenotype. */
+    std::string mDirectory;
+
+public:
+
+    void setUp()
+    {
+        OutputFileHandler handler("TestDeltaNotchOutputIndex");
+        mDirectory = handler.GetOutputDirectoryFullPath();
+
+        // Location index, cell ID, centroid and age of cells 3, 5 and 7
+        std::ofstream ages_file((mDirectory + "results.vizcellages").c_str());
+        ages_file << "0\t0 3 0.5 0.5 1.5 1 7 1.5 0.5 2.5 \n";
+        ages_file << "\n";
+        ages_file << "1\t0 7 1.5 0.5 3.5 1 3 0.5 0.5 2.5 2 5 1.0 1.0 0.25 \n";
+        ages_file << "2\t0 5 1.0 1.0 1.25 1 3 0.5 0.5 3.5 \n";
+        ages_file << "\n";
+        ages_file.close();
+
+        // The phenotypes of the same cells, in the same order
+        std::ofstream phenotype_file((mDirectory + "results.vizcellphenotype").c_str());
+        phenotype_file << "0\t2 1 \n";
+        phenotype_file << "1\t1 2 0 \n";
+        phenotype_file << "\n";
+        phenotype_file << "2\t0 2 \n";
+        phenotype_file.close();
+    }
+
+    void TestIndexWithCellIdColumn()
+    {
+        std::string data_file = mDirectory + "results.vizcellages";
+        std::string index_file = mDirectory + "results.vizcellages.index";
+        DeltaNotchOutputIndex::Build(data_file, index_file, DeltaNotchOutputIndex::GetDefaultLayout(data_file));
+        DeltaNotchOutputIndex index(data_file, index_file);
+
+        // Blank lines are not output times
+        TS_ASSERT_EQUALS(index.GetNumFrames(), 3u);
+        TS_ASSERT_DELTA(index.GetTime(0), 0.0, 1e-12);
+        TS_ASSERT_DELTA(index.GetTime(1), 1.0, 1e-12);
+        TS_ASSERT_DELTA(index.GetTime(2), 2.0, 1e-12);
+        TS_ASSERT_EQUALS(index.FindFrame(0.5), 0u);
+        TS_ASSERT_EQUALS(index.FindFrame(1.0), 1u);
+        TS_ASSERT_EQUALS(index.FindFrame(1.5), 1u);
+        TS_ASSERT_EQUALS(index.FindFrame(10.0), 2u);
+        TS_ASSERT(index.HasCellIds());
+
+        // A time slice is in order of cell ID
+        std::vector<double> values;
+        std::vector<unsigned> cell_ids;
+        index.GetTimeSlice(1, values, &cell_ids);
+        TS_ASSERT_EQUALS(values.size(), 3u);
+        TS_ASSERT_EQUALS(cell_ids.size(), 3u);
+        TS_ASSERT_EQUALS(cell_ids[0], 3u);
+        TS_ASSERT_EQUALS(cell_ids[1], 5u);
+        TS_ASSERT_EQUALS(cell_ids[2], 7u);
+        TS_ASSERT_DELTA(values[0], 2.5, 1e-12);
+        TS_ASSERT_DELTA(values[1], 0.25, 1e-12);
+        TS_ASSERT_DELTA(values[2], 3.5, 1e-12);
+
+        std::vector<double> times;
+        index.GetTrajectory(3, times, values);
+        TS_ASSERT_EQUALS(times.size(), 3u);
+        TS_ASSERT_EQUALS(values.size(), 3u);
+        for (unsigned i=0; i<times.size(); i++)
+        {
+            TS_ASSERT_DELTA(times[i], i, 1e-12);
+            TS_ASSERT_DELTA(values[i], 1.5 + i, 1e-12);
+        }
+
+        // Cell 5 is born after the first output time
+        index.GetTrajectory(5, times, values);
+        TS_ASSERT_EQUALS(times.size(), 2u);
+        TS_ASSERT_DELTA(times[0], 1.0, 1e-12);
+        TS_ASSERT_DELTA(values[0], 0.25, 1e-12);
+        TS_ASSERT_DELTA(times[1], 2.0, 1e-12);
+        TS_ASSERT_DELTA(values[1], 1.25, 1e-12);
+
+        index.GetTrajectory(4, times, values);
+        TS_ASSERT(times.empty());
+    }
+
+    void TestIndexWithCompanionIdFile()
+    {
+        std::string data_file = mDirectory + "results.vizcellphenotype";
+        std::string index_file = mDirectory + "results.vizcellphenotype.index";
+        DeltaNotchOutputIndex::Build(data_file, index_file, DeltaNotchOutputIndex::GetDefaultLayout(data_file),
+                                     mDirectory + "results.vizcellages");
+        DeltaNotchOutputIndex index(data_file, index_file);
+
+        TS_ASSERT_EQUALS(index.GetNumFrames(), 3u);
+        TS_ASSERT_EQUALS(index.FindFrame(2.0), 2u);
+        TS_ASSERT(index.HasCellIds());
+
+        std::vector<double> values;
+        std::vector<unsigned> cell_ids;
+        index.GetTimeSlice(1, values, &cell_ids);
+        TS_ASSERT_EQUALS(cell_ids.size(), 3u);
+        TS_ASSERT_EQUALS(cell_ids[0], 3u);
+        TS_ASSERT_EQUALS(cell_ids[2], 7u);
+        TS_ASSERT_DELTA(values[0], 2.0, 1e-12);
+        TS_ASSERT_DELTA(values[1], 0.0, 1e-12);
+        TS_ASSERT_DELTA(values[2], 1.0, 1e-12);
+
+        std::vector<double> times;
+        index.GetTrajectory(7, times, values);
+        TS_ASSERT_EQUALS(times.size(), 2u);
+        TS_ASSERT_DELTA(times[1], 1.0, 1e-12);
+        TS_ASSERT_DELTA(values[0], 1.0, 1e-12);
+        TS_ASSERT_DELTA(values[1], 1.0, 1e-12);
+    }
+};
+
+#endif /*TESTDELTANOTCHOUTPUTINDEX_HPP_*/
@@ -0,0 +1,172 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#ifndef TESTDELTANOTCHPERFORMANCE_HPP_
+#define TESTDELTANOTCHPERFORMANCE_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <cmath>
+#include <string>
+
+#include "DeltaNotchPerformanceScenarios.hpp"
+#include "DeltaNotchSimulationSummary.hpp"
+
+#include "FakePetscSetup.hpp"
+
+/**
+ * Correctness checks of the performance scenarios (see DeltaNotchPerformanceScenarios).
+ *
+ * Each scenario is run twice and must reach the same state both times, and the same state as
+ * its recorded checksum; its fastest time per step must also be within the loose continuous
+ * tolerance of its recorded time, which catches gross slow-downs. Scenarios that should not change the simulation are also
+ * compared with the three-pass scenario, which each such test runs itself if no earlier test
+ * in this suite has, so the tests may be run singly or in any order. The tighter timing checks
+ * are in TestDeltaNotchPerformanceTimings.
+ */
+class TestDeltaNotchPerformance : public CxxTest::TestSuite
+{
+private:
+
+    /** Number of times each scenario is run. */
+    static const unsigned NUM_REPEATS = 2;
+
+    /** The summary of the three-pass scenario, once run. */
+    DeltaNotchSimulationSummary mThreePass;
+
+    /** Whether #mThreePass has been run. */
+    bool mHaveThreePass;
+
+    /**
+     * @return the summary of the three-pass scenario, running it if needed
+     */
+    const DeltaNotchSimulationSummary& rGetThreePass()
+    {
+        if (!mHaveThreePass)
+        {
+            mThreePass = DeltaNotchPerformanceScenarios::Run("three-pass", NUM_REPEATS);
+            mHaveThreePass = true;
+        }
+        return mThreePass;
+    }
+
+    /**
+     * Run a scenario and compare it with its recorded checksum and time per step.
+     *
+     * @param rName the scenario name
+     * @return the summary of the scenario
+     */
+    DeltaNotchSimulationSummary RunScenario(const std::string& rName)
+    {
+        DeltaNotchSimulationSummary summary = DeltaNotchPerformanceScenarios::Run(rName, NUM_REPEATS);
+        DeltaNotchPerformanceScenarios scenarios;
+        scenarios.CheckChecksum(rName, summary);
+        scenarios.CheckTime(rName, summary, scenarios.GetContinuousTolerance());
+        return summary;
+    }
+
+    /**
+     * Run a scenario that should reach the same state as the three-pass scenario, and check that it does.
+     *
+     * @param rName the scenario name
+     * @param tolerance the relative tolerance on the checksum
+     */
+    void CheckMatchesThreePass(const std::string& rName, double tolerance)
+    {
+        DeltaNotchSimulationSummary summary = RunScenario(rName);
+        const DeltaNotchSimulationSummary& r_three_pass = rGetThreePass();
+        TS_ASSERT_EQUALS(summary.mNumTimeSteps, r_three_pass.mNumTimeSteps);
+        TS_ASSERT_EQUALS(summary.mNumCells, r_three_pass.mNumCells);
+        TS_ASSERT_EQUALS(summary.mNumDeltaHigh, r_three_pass.mNumDeltaHigh);
+        TS_ASSERT_EQUALS(summary.mNumDeltaLow, r_three_pass.mNumDeltaLow);
+        TS_ASSERT_DELTA(summary.mChecksum, r_three_pass.mChecksum, tolerance*fabs(r_three_pass.mChecksum));
+    }
+
+public:
+
+    /**
+     * Constructor.
+     */
+    TestDeltaNotchPerformance()
+        : mHaveThreePass(false)
+    {
+    }
+
+    void TestThreePassModifiers()
+    {
+        DeltaNotchPerformanceScenarios scenarios;
+        scenarios.CheckChecksum("three-pass", rGetThreePass());
+        scenarios.CheckTime("three-pass", rGetThreePass(), scenarios.GetContinuousTolerance());
+    }
+
+    void TestFusedModifierMatchesThreePass()
+    {
+        CheckMatchesThreePass("fused", 1e-8);
+    }
+
+    void TestCompactStorageMatchesThreePass()
+    {
+        CheckMatchesThreePass("compact", 1e-8);
+    }
+
+    void TestMultiRateScheduler()
+    {
+        RunScenario("multi-rate");
+    }
+
+    void TestAdaptiveTimeStep()
+    {
+        RunScenario("adaptive");
+    }
+
+    void TestFastNagaiHondaForceMatchesThreePass()
+    {
+        // The forces differ from those of NagaiHondaForce only by rounding
+        CheckMatchesThreePass("fast-nagai-honda", 1e-8);
+    }
+
+    void TestEventLogMatchesThreePass()
+    {
+        // Logging draws no random numbers and changes no cell state
+        CheckMatchesThreePass("event-log", 1e-12);
+    }
+
+    void TestPhenotypePolicyMatchesThreePass()
+    {
+        CheckMatchesThreePass("policy", 1e-8);
+    }
+};
+
+#endif /*TESTDELTANOTCHPERFORMANCE_HPP_*/
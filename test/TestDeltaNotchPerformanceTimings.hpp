@@ -0,0 +1,92 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#ifndef TESTDELTANOTCHPERFORMANCETIMINGS_HPP_
+#define TESTDELTANOTCHPERFORMANCETIMINGS_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "DeltaNotchPerformanceScenarios.hpp"
+#include "DeltaNotchSimulationSummary.hpp"
+#include "OutputFileHandler.hpp"
+
+#include "FakePetscSetup.hpp"
+
+/**
+ * Timing checks of the performance scenarios (see DeltaNotchPerformanceScenarios), in the
+ * nightly test pack since wall times depend on the machine and its load.
+ *
+ * Every scenario is run #NUM_REPEATS times, and the fastest time per step is compared with the
+ * recorded baseline, as is the checksum. The measured values are written to
+ * DeltaNotchPerformance/DeltaNotchPerformanceBaseline.txt in the Chaste output directory, in
+ * the format of the baseline file, so that the baseline can be recorded by copying that file
+ * over test/data/DeltaNotchPerformanceBaseline.txt on the reference machine.
+ */
+class TestDeltaNotchPerformanceTimings : public CxxTest::TestSuite
+{
+private:
+
+    /** Number of times each scenario is run; the fastest run is compared with the baseline. */
+    static const unsigned NUM_REPEATS = 3;
+
+public:
+
+    void TestScenarioTimes()
+    {
+        DeltaNotchPerformanceScenarios scenarios;
+        std::vector<std::string> names = DeltaNotchPerformanceScenarios::GetNames();
+
+        OutputFileHandler handler("DeltaNotchPerformance", false);
+        out_stream p_file = handler.OpenOutputFile("DeltaNotchPerformanceBaseline.txt");
+        *p_file << "tolerance " << scenarios.GetTolerance() << "\n";
+        *p_file << "continuous-tolerance " << scenarios.GetContinuousTolerance() << "\n";
+        *p_file << std::setprecision(16);
+        for (unsigned i=0; i<names.size(); i++)
+        {
+            DeltaNotchSimulationSummary summary = DeltaNotchPerformanceScenarios::Run(names[i], NUM_REPEATS);
+            *p_file << names[i] << " " << summary.mWallTime/summary.mNumTimeSteps << " " << summary.mChecksum << "\n";
+
+            scenarios.CheckTime(names[i], summary, scenarios.GetTolerance());
+            scenarios.CheckChecksum(names[i], summary);
+        }
+        p_file->close();
+    }
+};
+
+#endif /*TESTDELTANOTCHPERFORMANCETIMINGS_HPP_*/
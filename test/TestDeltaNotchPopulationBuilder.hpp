@@ -0,0 +1,149 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#ifndef TESTDELTANOTCHPOPULATIONBUILDER_HPP_
+#define TESTDELTANOTCHPOPULATIONBUILDER_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "DeltaNotchPopulationBuilder.hpp"
+#include "OutputFileHandler.hpp"
+
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests of the mesh cache of DeltaNotchPopulationBuilder.
+ */
+class TestDeltaNotchPopulationBuilder : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * Overwrite a 32-bit value in a file.
+     *
+     * @param rPath the file
+     * @param offset the offset of the value in bytes
+     * @param value the new value
+     */
+    void OverwriteValue(const std::string& rPath, std::streamoff offset, uint32_t value)
+    {
+        std::fstream file(rPath.c_str(), std::ios::binary | std::ios::in | std::ios::out);
+        TS_ASSERT(file.is_open());
+        file.seekp(offset);
+        file.write(reinterpret_cast<const char*>(&value), sizeof(uint32_t));
+    }
+
+public:
+
+    void TestCorruptCacheIsRebuilt()
+    {
+        OutputFileHandler handler("TestDeltaNotchPopulationBuilder");
+        std::string cache_directory = handler.GetOutputDirectoryFullPath();
+        std::string cache_path = cache_directory + "honeycomb_3x3.bin";
+
+        unsigned num_nodes;
+        {
+            DeltaNotchPopulationBuilder builder(cache_directory);
+            num_nodes = builder.BuildHoneycombMesh(3, 3)->GetNumNodes();
+            TS_ASSERT_EQUALS(builder.GetLastMeshWasCached(), false);
+            builder.BuildHoneycombMesh(3, 3);
+            TS_ASSERT_EQUALS(builder.GetLastMeshWasCached(), true);
+        }
+
+        // The cache is written through a temporary file, which is renamed into place
+        std::stringstream temp_path;
+        temp_path << cache_path << "." << getpid() << ".tmp";
+        TS_ASSERT(!std::ifstream(temp_path.str().c_str()).is_open());
+
+        // Header: magic, width, height, number of nodes; each node: x, y, boundary flag
+        std::streamoff elements_offset = 4 + 3*sizeof(uint32_t) + num_nodes*(2*sizeof(double) + sizeof(uint8_t));
+
+        // A node index out of range in the first element
+        OverwriteValue(cache_path, elements_offset + 2*sizeof(uint32_t), num_nodes);
+        {
+            DeltaNotchPopulationBuilder builder(cache_directory);
+            TS_ASSERT_EQUALS(builder.BuildHoneycombMesh(3, 3)->GetNumNodes(), num_nodes);
+            TS_ASSERT_EQUALS(builder.GetLastMeshWasCached(), false);
+
+            // The rebuilt mesh replaced the corrupt cache
+            builder.BuildHoneycombMesh(3, 3);
+            TS_ASSERT_EQUALS(builder.GetLastMeshWasCached(), true);
+        }
+
+        // A first element with only two nodes
+        OverwriteValue(cache_path, elements_offset + sizeof(uint32_t), 2u);
+        {
+            DeltaNotchPopulationBuilder builder(cache_directory);
+            TS_ASSERT_EQUALS(builder.BuildHoneycombMesh(3, 3)->GetNumElements(), 9u);
+            TS_ASSERT_EQUALS(builder.GetLastMeshWasCached(), false);
+
+            builder.BuildHoneycombMesh(3, 3);
+            TS_ASSERT_EQUALS(builder.GetLastMeshWasCached(), true);
+        }
+
+        // A number of nodes larger than the file could hold
+        OverwriteValue(cache_path, 4 + 2*sizeof(uint32_t), 0x7FFFFFFFu);
+        {
+            DeltaNotchPopulationBuilder builder(cache_directory);
+            TS_ASSERT_EQUALS(builder.BuildHoneycombMesh(3, 3)->GetNumNodes(), num_nodes);
+            TS_ASSERT_EQUALS(builder.GetLastMeshWasCached(), false);
+        }
+
+        // A number of elements larger than the file could hold
+        OverwriteValue(cache_path, elements_offset, 0x7FFFFFFFu);
+        {
+            DeltaNotchPopulationBuilder builder(cache_directory);
+            builder.BuildHoneycombMesh(3, 3);
+            TS_ASSERT_EQUALS(builder.GetLastMeshWasCached(), false);
+        }
+    }
+
+    void TestUnwritableCacheOnlyWarns()
+    {
+        DeltaNotchPopulationBuilder builder("/this/directory/does/not/exist");
+        MutableVertexMesh<2,2>* p_mesh = NULL;
+        TS_ASSERT_THROWS_NOTHING(p_mesh = builder.BuildHoneycombMesh(3, 3));
+        TS_ASSERT_EQUALS(p_mesh->GetNumElements(), 9u);
+        TS_ASSERT_EQUALS(builder.GetLastMeshWasCached(), false);
+    }
+};
+
+#endif /*TESTDELTANOTCHPOPULATIONBUILDER_HPP_*/
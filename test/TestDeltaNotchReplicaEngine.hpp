@@ -0,0 +1,108 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#ifndef TESTDELTANOTCHREPLICAENGINE_HPP_
+#define TESTDELTANOTCHREPLICAENGINE_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "DeltaNotchReplicaEngine.hpp"
+#include "DeltaNotchSimulationParameters.hpp"
+#include "DeltaNotchSimulationSummary.hpp"
+
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests of DeltaNotchReplicaEngine.
+ */
+class TestDeltaNotchReplicaEngine : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * Add a few short fixed-seed replicas to an engine.
+     *
+     * @param rEngine the engine
+     */
+    void AddReplicas(DeltaNotchReplicaEngine& rEngine)
+    {
+        DeltaNotchSimulationParameters parameters;
+        parameters.mMeshWidth = 4;
+        parameters.mMeshHeight = 4;
+        parameters.mEndTime = 0.5;
+        parameters.mWriters.clear();
+        for (unsigned i=0; i<5; i++)
+        {
+            parameters.mSeed = i + 1;
+            rEngine.AddReplica(parameters);
+        }
+    }
+
+public:
+
+    void TestWorkersMatchInProcess()
+    {
+        DeltaNotchReplicaEngine in_process_engine("TestDeltaNotchReplicaEngine/InProcess");
+        AddReplicas(in_process_engine);
+        in_process_engine.Run();
+
+        DeltaNotchReplicaEngine pool_engine("TestDeltaNotchReplicaEngine/Workers");
+        pool_engine.SetNumWorkers(3);
+        TS_ASSERT_EQUALS(pool_engine.GetNumWorkers(), 3u);
+        AddReplicas(pool_engine);
+        pool_engine.Run();
+
+        // Each replica sets up its own state, so gives the same results wherever it runs
+        const std::vector<DeltaNotchSimulationSummary>& r_expected = in_process_engine.rGetSummaries();
+        const std::vector<DeltaNotchSimulationSummary>& r_summaries = pool_engine.rGetSummaries();
+        TS_ASSERT_EQUALS(r_summaries.size(), 5u);
+        TS_ASSERT_EQUALS(r_expected.size(), 5u);
+        for (unsigned i=0; i<r_summaries.size() && i<r_expected.size(); i++)
+        {
+            TS_ASSERT_LESS_THAN(0u, r_summaries[i].mNumTimeSteps);
+            TS_ASSERT_EQUALS(r_summaries[i].mNumCells, r_expected[i].mNumCells);
+            TS_ASSERT_EQUALS(r_summaries[i].mNumDeltaHigh, r_expected[i].mNumDeltaHigh);
+            TS_ASSERT_EQUALS(r_summaries[i].mChecksum, r_expected[i].mChecksum);
+        }
+    }
+
+    void TestNumWorkersMustBePositive()
+    {
+        DeltaNotchReplicaEngine engine("TestDeltaNotchReplicaEngine/None");
+        TS_ASSERT_THROWS_THIS(engine.SetNumWorkers(0), "The number of replica workers must be positive");
+    }
+};
+
+#endif /*TESTDELTANOTCHREPLICAENGINE_HPP_*/
@@ -0,0 +1,173 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#ifndef TESTDELTANOTCHSIMULATIONPARAMETERS_HPP_
+#define TESTDELTANOTCHSIMULATIONPARAMETERS_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "DeltaNotchSimulationParameters.hpp"
+#include "Exception.hpp"
+#include "OutputFileHandler.hpp"
+
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests of the parsing of command-line and config file options by DeltaNotchSimulationParameters.
+ */
+class TestDeltaNotchSimulationParameters : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * @return the result of parsing space-separated arguments into a set of parameters
+     *
+     * @param rArguments the arguments
+     * @param rParameters the parameters to parse into
+     */
+    bool Parse(const std::string& rArguments, DeltaNotchSimulationParameters& rParameters)
+    {
+        std::vector<std::string> arguments;
+        std::string::size_type start = 0;
+        while (start < rArguments.size())
+        {
+            std::string::size_type end = rArguments.find(' ', start);
+            if (end == std::string::npos)
+            {
+                end = rArguments.size();
+            }
+            if (end > start)
+            {
+                arguments.push_back(rArguments.substr(start, end - start));
+            }
+            start = end + 1;
+        }
+        return rParameters.Parse(arguments);
+    }
+
+    /**
+     * Parse arguments into a fresh set of parameters, and check that this throws.
+     *
+     * @param rArguments the arguments
+     * @param rMessage text the exception message should contain
+     */
+    void CheckRejected(const std::string& rArguments, const std::string& rMessage)
+    {
+        DeltaNotchSimulationParameters parameters;
+        TS_ASSERT_THROWS_CONTAINS(Parse(rArguments, parameters), rMessage);
+    }
+
+public:
+
+    void TestCommandLineOptions()
+    {
+        DeltaNotchSimulationParameters parameters;
+        TS_ASSERT(Parse("", parameters));
+        TS_ASSERT_EQUALS(parameters.mDt, DOUBLE_UNSET);
+        TS_ASSERT_DELTA(parameters.mEndTime, 30.0, 1e-12);
+        TS_ASSERT(parameters.IsWriterEnabled("ages"));
+        TS_ASSERT(!parameters.IsWriterEnabled("quantised-ages"));
+
+        TS_ASSERT(Parse("--mesh-width 3 --dt 0.01 --end-time 2.5 --writers ages,quantised-ages --min-dt 0.001 --max-dt 0.1", parameters));
+        TS_ASSERT_EQUALS(parameters.mMeshWidth, 3u);
+        TS_ASSERT_DELTA(parameters.mDt, 0.01, 1e-12);
+        TS_ASSERT_DELTA(parameters.mEndTime, 2.5, 1e-12);
+        TS_ASSERT_DELTA(parameters.mMinDt, 0.001, 1e-12);
+        TS_ASSERT_DELTA(parameters.mMaxDt, 0.1, 1e-12);
+        TS_ASSERT_EQUALS(parameters.mWriters.size(), 2u);
+        TS_ASSERT(parameters.IsWriterEnabled("ages"));
+        TS_ASSERT(parameters.IsWriterEnabled("quantised-ages"));
+        TS_ASSERT(!parameters.IsWriterEnabled("volumes"));
+
+        TS_ASSERT(Parse("--writers none", parameters));
+        TS_ASSERT(parameters.mWriters.empty());
+    }
+
+    void TestCommandLineTakesPrecedenceOverConfigFile()
+    {
+        OutputFileHandler handler("TestDeltaNotchSimulationParameters");
+        std::string config_path = handler.GetOutputDirectoryFullPath() + "simulation.cfg";
+        {
+            std::ofstream config_file(config_path.c_str());
+            config_file << "end-time = 5\n";
+            config_file << "seed = 3\n";
+            config_file << "dt = 0.02\n";
+        }
+
+        DeltaNotchSimulationParameters parameters;
+        TS_ASSERT(Parse("--end-time 7 --config " + config_path, parameters));
+        TS_ASSERT_DELTA(parameters.mEndTime, 7.0, 1e-12);
+        TS_ASSERT_EQUALS(parameters.mSeed, 3u);
+        TS_ASSERT_DELTA(parameters.mDt, 0.02, 1e-12);
+
+        // Options in the config file are checked as those on the command line are
+        {
+            std::ofstream config_file(config_path.c_str());
+            config_file << "dt = 0\n";
+        }
+        CheckRejected("--config " + config_path, "The time step must be positive");
+        {
+            std::ofstream config_file(config_path.c_str());
+            config_file << "min-dt = 0.5\n";
+        }
+        CheckRejected("--max-dt 0.1 --config " + config_path, "The smallest adaptive time step must not exceed the largest");
+
+        CheckRejected("--config " + config_path + ".missing", "Could not open config file");
+    }
+
+    void TestInvalidOptionsAreRejected()
+    {
+        CheckRejected("--dt 0", "The time step must be positive");
+        CheckRejected("--dt=-0.01", "The time step must be positive");
+        CheckRejected("--end-time 0", "The end time must be positive");
+        CheckRejected("--end-time=-1", "The end time must be positive");
+        CheckRejected("--min-dt 0.1 --max-dt 0.01", "The smallest adaptive time step must not exceed the largest");
+        CheckRejected("--min-dt 0", "Time step bounds must be positive");
+        CheckRejected("--mesh-width=-1", "The option mesh-width must not be negative");
+        CheckRejected("--sampling-multiple 0", "The sampling multiple must be positive");
+        CheckRejected("--writers ages,unknown", "Unknown writer: unknown");
+        CheckRejected("--population potts", "Unknown population type: potts");
+
+        // Equal adaptive time step bounds give a fixed time step, which is allowed
+        DeltaNotchSimulationParameters parameters;
+        TS_ASSERT(Parse("--min-dt 0.01 --max-dt 0.01", parameters));
+    }
+};
+
+#endif /*TESTDELTANOTCHSIMULATIONPARAMETERS_HPP_*/
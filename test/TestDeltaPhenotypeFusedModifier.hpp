@@ -0,0 +1,151 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#ifndef TESTDELTAPHENOTYPEFUSEDMODIFIER_HPP_
+#define TESTDELTAPHENOTYPEFUSEDMODIFIER_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "DeltaNotchSimulationParameters.hpp"
+#include "DeltaNotchSimulationSummary.hpp"
+#include "DeltaNotchTutorialSimulation.hpp"
+
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests that DeltaPhenotypeFusedModifier reaches the same state as the separate
+ * DeltaNotchTrackingModifier, DeltaPhenotypeTrackingModifier and
+ * DeltaPhenotypeTargetAreaModifier, with and without update multiples.
+ */
+class TestDeltaPhenotypeFusedModifier : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * @return parameters for a short fixed-seed run
+     *
+     * @param rOutputDirectory the output directory
+     */
+    DeltaNotchSimulationParameters GetParameters(const std::string& rOutputDirectory)
+    {
+        DeltaNotchSimulationParameters parameters;
+        parameters.mMeshWidth = 6;
+        parameters.mMeshHeight = 6;
+        parameters.mEndTime = 1.0;
+        parameters.mSeed = 0;
+        parameters.mWriters.clear();
+        parameters.mOutputDirectory = rOutputDirectory;
+        return parameters;
+    }
+
+    /**
+     * Check that two runs reached the same state.
+     *
+     * @param rSummary the summary of one run
+     * @param rExpected the summary of the other
+     */
+    void CompareSummaries(const DeltaNotchSimulationSummary& rSummary, const DeltaNotchSimulationSummary& rExpected)
+    {
+        TS_ASSERT_EQUALS(rSummary.mNumTimeSteps, rExpected.mNumTimeSteps);
+        TS_ASSERT_EQUALS(rSummary.mNumCells, rExpected.mNumCells);
+        TS_ASSERT_EQUALS(rSummary.mNumDeltaHigh, rExpected.mNumDeltaHigh);
+        TS_ASSERT_EQUALS(rSummary.mNumDeltaLow, rExpected.mNumDeltaLow);
+        TS_ASSERT_EQUALS(rSummary.mNumTransient, rExpected.mNumTransient);
+        TS_ASSERT_DELTA(rSummary.mChecksum, rExpected.mChecksum, 1e-8*fabs(rExpected.mChecksum));
+    }
+
+public:
+
+    void TestUpdateMultiplesOfOneMatchSeparateModifiers()
+    {
+        DeltaNotchTutorialSimulation simulation;
+
+        DeltaNotchSimulationParameters parameters = GetParameters("TestDeltaPhenotypeFusedModifier/ThreePass");
+        DeltaNotchSimulationSummary three_pass = simulation.Run(parameters);
+
+        parameters = GetParameters("TestDeltaPhenotypeFusedModifier/Fused");
+        parameters.mUseFusedModifier = true;
+        CompareSummaries(simulation.Run(parameters), three_pass);
+
+        // With a metrics file the fused modifier runs inside a MultiRateModifierScheduler, with multiples of 1
+        parameters = GetParameters("TestDeltaPhenotypeFusedModifier/FusedScheduled");
+        parameters.mUseFusedModifier = true;
+        parameters.mMetricsFile = "metrics.prom";
+        CompareSummaries(simulation.Run(parameters), three_pass);
+
+        parameters = GetParameters("TestDeltaPhenotypeFusedModifier/Compact");
+        parameters.mUseCompactStorage = true;
+        CompareSummaries(simulation.Run(parameters), three_pass);
+    }
+
+    void TestUpdateMultiplesMatchScheduledSeparateModifiers()
+    {
+        DeltaNotchTutorialSimulation simulation;
+
+        DeltaNotchSimulationParameters parameters = GetParameters("TestDeltaPhenotypeFusedModifier/ThreePassMultiRate");
+        parameters.mPhenotypeUpdateMultiple = 5;
+        parameters.mTargetAreaUpdateMultiple = 3;
+        DeltaNotchSimulationSummary three_pass = simulation.Run(parameters);
+
+        // The mean neighbouring Delta is still updated every step, so the SRN models see the same inputs
+        parameters = GetParameters("TestDeltaPhenotypeFusedModifier/FusedMultiRate");
+        parameters.mPhenotypeUpdateMultiple = 5;
+        parameters.mTargetAreaUpdateMultiple = 3;
+        parameters.mUseFusedModifier = true;
+        CompareSummaries(simulation.Run(parameters), three_pass);
+
+        parameters = GetParameters("TestDeltaPhenotypeFusedModifier/CompactMultiRate");
+        parameters.mPhenotypeUpdateMultiple = 5;
+        parameters.mTargetAreaUpdateMultiple = 3;
+        parameters.mUseCompactStorage = true;
+        CompareSummaries(simulation.Run(parameters), three_pass);
+    }
+
+    void TestPhenotypePolicyRejectsUpdateMultiples()
+    {
+        std::vector<std::string> arguments;
+        arguments.push_back("--phenotype-policy=three-band");
+        arguments.push_back("--phenotype-update-multiple=2");
+        DeltaNotchSimulationParameters parameters;
+        TS_ASSERT_THROWS_THIS(parameters.Parse(arguments),
+                              "A phenotype policy updates every cell's mean Delta, phenotype and target area together, so cannot be used with update multiples greater than 1");
+    }
+};
+
+#endif /*TESTDELTAPHENOTYPEFUSEDMODIFIER_HPP_*/
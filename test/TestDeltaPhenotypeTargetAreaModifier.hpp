@@ -0,0 +1,242 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#ifndef TESTDELTAPHENOTYPETARGETAREAMODIFIER_HPP_
+#define TESTDELTAPHENOTYPETARGETAREAMODIFIER_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
+
+#include "DeltaNotchPopulationBuilder.hpp"
+#include "DeltaNotchReplicaContext.hpp"
+#include "DeltaNotchSimulationParameters.hpp"
+#include "DeltaNotchSimulationSummary.hpp"
+#include "DeltaNotchTrackingModifier.hpp"
+#include "DeltaNotchTutorialSimulation.hpp"
+#include "DeltaPhenotypeTargetAreaModifier.hpp"
+#include "DeltaPhenotypeTrackingModifier.hpp"
+#include "DeltaPhenotypeVertexBasedCellPopulation.hpp"
+#include "SimulationTime.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests that the lazy evaluation of target areas in DeltaPhenotypeTargetAreaModifier, and in the
+ * modifiers derived from it, gives exactly the target areas that recomputing them every step does.
+ */
+class TestDeltaPhenotypeTargetAreaModifier : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * Run the separate modifiers on a small vertex population with no mechanics, making one cell
+     * apoptotic and giving another a new birth time, as division would, part way through.
+     *
+     * @param useLazyEvaluation whether the target area modifier evaluates target areas lazily
+     * @param useDeltaPopulation whether to use a DeltaPhenotypeVertexBasedCellPopulation, so that
+     *     only active cells are visited, rather than a VertexBasedCellPopulation
+     * @param rTargetAreas filled with the target area of every cell after every time step
+     * @param rNumActiveCells set to the number of active cells at the end
+     * @param rNumFullPasses set to the number of passes that visited every cell
+     * @return the number of cells whose target area was recorded as stable at the end
+     */
+    unsigned RunModifiers(bool useLazyEvaluation, bool useDeltaPopulation, std::vector<double>& rTargetAreas,
+                          unsigned& rNumActiveCells, unsigned& rNumFullPasses)
+    {
+        DeltaNotchReplicaContext context(1);
+        unsigned num_steps = 200;
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(2.0, num_steps);
+
+        DeltaNotchPopulationBuilder builder;
+        MutableVertexMesh<2,2>* p_mesh = builder.BuildHoneycombMesh(4, 4);
+        std::vector<CellPtr> cells;
+        builder.CreateCells(p_mesh->GetNumElements(), cells);
+        boost::scoped_ptr<VertexBasedCellPopulation<2> > p_cell_population;
+        if (useDeltaPopulation)
+        {
+            p_cell_population.reset(new DeltaPhenotypeVertexBasedCellPopulation<2>(*p_mesh, cells));
+        }
+        else
+        {
+            p_cell_population.reset(new VertexBasedCellPopulation<2>(*p_mesh, cells));
+        }
+        VertexBasedCellPopulation<2>& cell_population = *p_cell_population;
+
+        DeltaNotchTrackingModifier<2> delta_notch_modifier;
+        DeltaPhenotypeTrackingModifier<2> phenotype_modifier;
+        DeltaPhenotypeTargetAreaModifier<2> target_area_modifier;
+        target_area_modifier.SetUseLazyEvaluation(useLazyEvaluation);
+        delta_notch_modifier.SetupSolve(cell_population, "");
+        phenotype_modifier.SetupSolve(cell_population, "");
+        target_area_modifier.SetupSolve(cell_population, "");
+
+        for (unsigned step=0; step<num_steps; step++)
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            if (step == num_steps/2)
+            {
+                cells[0]->StartApoptosis();
+                cells[1]->SetBirthTime(SimulationTime::Instance()->GetTime());
+                if (useDeltaPopulation)
+                {
+                    // As the population does for both cells of a division
+                    static_cast<DeltaPhenotypeVertexBasedCellPopulation<2>&>(cell_population).MarkTargetAreaStale(cells[1]);
+                }
+            }
+            delta_notch_modifier.UpdateAtEndOfTimeStep(cell_population);
+            phenotype_modifier.UpdateAtEndOfTimeStep(cell_population);
+            target_area_modifier.UpdateAtEndOfTimeStep(cell_population);
+
+            for (unsigned i=0; i<cells.size(); i++)
+            {
+                rTargetAreas.push_back(cells[i]->GetCellData()->GetItem("target area"));
+            }
+        }
+        rNumActiveCells = target_area_modifier.GetNumActiveCells();
+        rNumFullPasses = target_area_modifier.GetNumFullPasses();
+        return target_area_modifier.GetNumStableTargetAreas();
+    }
+
+    /**
+     * @return parameters for a short fixed-seed run
+     *
+     * @param rOutputDirectory the output directory
+     * @param useLazyTargetAreas whether target areas are evaluated lazily
+     */
+    DeltaNotchSimulationParameters GetParameters(const std::string& rOutputDirectory, bool useLazyTargetAreas)
+    {
+        DeltaNotchSimulationParameters parameters;
+        parameters.mMeshWidth = 6;
+        parameters.mMeshHeight = 6;
+        parameters.mEndTime = 5.0;
+        parameters.mSeed = 0;
+        parameters.mWriters.clear();
+        parameters.mOutputDirectory = rOutputDirectory;
+        parameters.mUseLazyTargetAreas = useLazyTargetAreas;
+        return parameters;
+    }
+
+    /**
+     * Check that two runs reached exactly the same state.
+     *
+     * @param rSummary the summary of one run
+     * @param rExpected the summary of the other
+     */
+    void CompareSummaries(const DeltaNotchSimulationSummary& rSummary, const DeltaNotchSimulationSummary& rExpected)
+    {
+        TS_ASSERT_EQUALS(rSummary.mNumTimeSteps, rExpected.mNumTimeSteps);
+        TS_ASSERT_EQUALS(rSummary.mNumCells, rExpected.mNumCells);
+        TS_ASSERT_EQUALS(rSummary.mNumDeltaHigh, rExpected.mNumDeltaHigh);
+        TS_ASSERT_EQUALS(rSummary.mNumDeltaLow, rExpected.mNumDeltaLow);
+        TS_ASSERT_EQUALS(rSummary.mNumTransient, rExpected.mNumTransient);
+        TS_ASSERT_EQUALS(rSummary.mChecksum, rExpected.mChecksum);
+    }
+
+public:
+
+    void TestLazyTargetAreasMatchEagerTargetAreas()
+    {
+        unsigned num_active_cells;
+        unsigned num_full_passes;
+        std::vector<double> eager_target_areas;
+        TS_ASSERT_EQUALS(RunModifiers(false, false, eager_target_areas, num_active_cells, num_full_passes), 0u);
+
+        // Without a DeltaPhenotypeVertexBasedCellPopulation, every pass visits every cell
+        std::vector<double> lazy_target_areas;
+        TS_ASSERT_LESS_THAN(0u, RunModifiers(true, false, lazy_target_areas, num_active_cells, num_full_passes));
+        TS_ASSERT_EQUALS(num_active_cells, 0u);
+        TS_ASSERT_EQUALS(num_full_passes, 201u);
+
+        TS_ASSERT_EQUALS(lazy_target_areas.size(), eager_target_areas.size());
+        for (unsigned i=0; i<eager_target_areas.size(); i++)
+        {
+            TS_ASSERT_EQUALS(lazy_target_areas[i], eager_target_areas[i]);
+        }
+    }
+
+    void TestActiveCellTargetAreasMatchEagerTargetAreas()
+    {
+        unsigned num_active_cells;
+        unsigned num_full_passes;
+        std::vector<double> eager_target_areas;
+        RunModifiers(false, true, eager_target_areas, num_active_cells, num_full_passes);
+
+        // Only the set-up pass and the pass after a stable cell became apoptotic need visit every
+        // cell, or a few more if the dead cell is still counted as apoptotic until it is removed
+        std::vector<double> lazy_target_areas;
+        unsigned num_stable_cells = RunModifiers(true, true, lazy_target_areas, num_active_cells, num_full_passes);
+        TS_ASSERT_LESS_THAN(0u, num_stable_cells);
+        TS_ASSERT_LESS_THAN(num_active_cells, 16u);
+        TS_ASSERT_LESS_THAN_EQUALS(2u, num_full_passes);
+        TS_ASSERT_LESS_THAN(num_full_passes, 200u);
+
+        TS_ASSERT_EQUALS(lazy_target_areas.size(), eager_target_areas.size());
+        for (unsigned i=0; i<eager_target_areas.size(); i++)
+        {
+            TS_ASSERT_EQUALS(lazy_target_areas[i], eager_target_areas[i]);
+        }
+    }
+
+    void TestLazyTargetAreasMatchEagerTargetAreasInTutorial()
+    {
+        DeltaNotchTutorialSimulation simulation;
+
+        DeltaNotchSimulationParameters parameters = GetParameters("TestDeltaPhenotypeTargetAreaModifier/ThreePassEager", false);
+        DeltaNotchSimulationSummary eager = simulation.Run(parameters);
+        parameters = GetParameters("TestDeltaPhenotypeTargetAreaModifier/ThreePassLazy", true);
+        CompareSummaries(simulation.Run(parameters), eager);
+
+        parameters = GetParameters("TestDeltaPhenotypeTargetAreaModifier/FusedEager", false);
+        parameters.mUseFusedModifier = true;
+        eager = simulation.Run(parameters);
+        parameters = GetParameters("TestDeltaPhenotypeTargetAreaModifier/FusedLazy", true);
+        parameters.mUseFusedModifier = true;
+        CompareSummaries(simulation.Run(parameters), eager);
+
+        parameters = GetParameters("TestDeltaPhenotypeTargetAreaModifier/PolicyEager", false);
+        parameters.mPhenotypePolicy = "three-band";
+        eager = simulation.Run(parameters);
+        parameters = GetParameters("TestDeltaPhenotypeTargetAreaModifier/PolicyLazy", true);
+        parameters.mPhenotypePolicy = "three-band";
+        CompareSummaries(simulation.Run(parameters), eager);
+    }
+};
+
+#endif /*TESTDELTAPHENOTYPETARGETAREAMODIFIER_HPP_*/
@@ -0,0 +1,148 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#ifndef TESTDELTAPHENOTYPEVERTEXBASEDCELLPOPULATION_HPP_
+#define TESTDELTAPHENOTYPEVERTEXBASEDCELLPOPULATION_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "DeltaNotchPopulationBuilder.hpp"
+#include "DeltaNotchReplicaContext.hpp"
+#include "DeltaPhenotypeVertexBasedCellPopulation.hpp"
+#include "OutputFileHandler.hpp"
+#include "SimulationTime.hpp"
+
+#ifdef CHASTE_VTK
+#include <vtkCellData.h>
+#include <vtkDataArray.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnstructuredGrid.h>
+#include <vtkXMLUnstructuredGridReader.h>
+#endif //CHASTE_VTK
+
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests of the compressed VTK output of DeltaPhenotypeVertexBasedCellPopulation.
+ */
+class TestDeltaPhenotypeVertexBasedCellPopulation : public CxxTest::TestSuite
+{
+public:
+
+    void TestCompressedOutputKeepsCellDataOfFramesWithoutNewGeometry()
+    {
+#ifdef CHASTE_VTK
+        DeltaNotchReplicaContext context(1);
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 2);
+
+        DeltaNotchPopulationBuilder builder;
+        MutableVertexMesh<2,2>* p_mesh = builder.BuildHoneycombMesh(3, 3);
+        std::vector<CellPtr> cells;
+        builder.CreateCells(p_mesh->GetNumElements(), cells);
+        DeltaPhenotypeVertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        cell_population.SetUseCompressedVtkOutput(true);
+        cell_population.SetGeometryTolerance(1.0);
+
+        unsigned num_elements = p_mesh->GetNumElements();
+        std::vector<double> initial_x(p_mesh->GetNumNodes());
+        for (unsigned node_index=0; node_index<p_mesh->GetNumNodes(); node_index++)
+        {
+            initial_x[node_index] = p_mesh->GetNode(node_index)->rGetLocation()[0];
+        }
+
+        std::string output_directory = "TestDeltaPhenotypeVertexBasedCellPopulation";
+        OutputFileHandler handler(output_directory, true);
+        cell_population.OpenWritersFiles(handler);
+
+        // The first output time is a geometry frame
+        for (unsigned elem_index=0; elem_index<num_elements; elem_index++)
+        {
+            cell_population.GetCellUsingLocationIndex(elem_index)->GetCellData()->SetItem("test value", elem_index);
+        }
+        SimulationTime::Instance()->IncrementTimeOneStep();
+        cell_population.WriteVtkResultsToFile(output_directory);
+
+        // Nodes move by less than the geometry tolerance, so the second output time reuses the geometry
+        for (unsigned node_index=0; node_index<p_mesh->GetNumNodes(); node_index++)
+        {
+            p_mesh->GetNode(node_index)->rGetModifiableLocation()[0] += 0.1;
+        }
+        for (unsigned elem_index=0; elem_index<num_elements; elem_index++)
+        {
+            cell_population.GetCellUsingLocationIndex(elem_index)->GetCellData()->SetItem("test value", 100.0 + elem_index);
+        }
+        SimulationTime::Instance()->IncrementTimeOneStep();
+        cell_population.WriteVtkResultsToFile(output_directory);
+        cell_population.CloseOutputFiles();
+
+        // The results.pvd entry for the second output time refers to its own file...
+        std::ifstream pvd_file((handler.GetOutputDirectoryFullPath() + "results.pvd").c_str());
+        TS_ASSERT(pvd_file.is_open());
+        std::string pvd_contents((std::istreambuf_iterator<char>(pvd_file)), std::istreambuf_iterator<char>());
+        TS_ASSERT_DIFFERS(pvd_contents.find("timestep=\"2\" group=\"\" part=\"0\" file=\"results_2.vtu\""), std::string::npos);
+
+        // ...which holds the cell data at that time, on the geometry of the first output time
+        vtkSmartPointer<vtkXMLUnstructuredGridReader> p_reader = vtkSmartPointer<vtkXMLUnstructuredGridReader>::New();
+        p_reader->SetFileName((handler.GetOutputDirectoryFullPath() + "results_2.vtu").c_str());
+        p_reader->Update();
+        vtkUnstructuredGrid* p_grid = p_reader->GetOutput();
+
+        TS_ASSERT_EQUALS((unsigned)p_grid->GetNumberOfCells(), num_elements);
+        TS_ASSERT_EQUALS((unsigned)p_grid->GetNumberOfPoints(), p_mesh->GetNumNodes());
+        for (unsigned node_index=0; node_index<p_mesh->GetNumNodes(); node_index++)
+        {
+            TS_ASSERT_DELTA(p_grid->GetPoint(node_index)[0], initial_x[node_index], 1e-12);
+        }
+
+        vtkDataArray* p_values = p_grid->GetCellData()->GetArray("test value");
+        TS_ASSERT(p_values != NULL);
+        if (p_values != NULL)
+        {
+            TS_ASSERT_EQUALS((unsigned)p_values->GetNumberOfTuples(), num_elements);
+            for (unsigned elem_index=0; elem_index<num_elements; elem_index++)
+            {
+                TS_ASSERT_DELTA(p_values->GetTuple1(elem_index), 100.0 + elem_index, 1e-12);
+            }
+        }
+#endif //CHASTE_VTK
+    }
+};
+
+#endif /*TESTDELTAPHENOTYPEVERTEXBASEDCELLPOPULATION_HPP_*/
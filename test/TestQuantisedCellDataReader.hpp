@@ -0,0 +1,209 @@
+/*
+
+Copyright (c) 2005-2016, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#ifndef TESTQUANTISEDCELLDATAREADER_HPP_
+#define TESTQUANTISEDCELLDATAREADER_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <cmath>
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "DeltaNotchOutputIndex.hpp"
+#include "DeltaNotchPopulationBuilder.hpp"
+#include "DeltaNotchReplicaContext.hpp"
+#include "OutputFileHandler.hpp"
+#include "QuantisedCellAgesWriter.hpp"
+#include "QuantisedCellDataReader.hpp"
+#include "SimulationTime.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests that files written by the quantised cell writers are read back by QuantisedCellDataReader
+ * and DeltaNotchOutputIndex to within the error bound of the writer.
+ */
+class TestQuantisedCellDataReader : public CxxTest::TestSuite
+{
+public:
+
+    void TestReadWrittenFrames()
+    {
+        DeltaNotchReplicaContext context(1);
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 1);
+
+        DeltaNotchPopulationBuilder builder;
+        MutableVertexMesh<2,2>* p_mesh = builder.BuildHoneycombMesh(3, 3);
+        std::vector<CellPtr> cells;
+        builder.CreateCells(p_mesh->GetNumElements(), cells);
+
+        // Ages that are not multiples of the resolution, and one too large to be stored
+        for (unsigned i=0; i<cells.size(); i++)
+        {
+            cells[i]->SetBirthTime(-(0.37*i + 0.001234));
+        }
+        cells[0]->SetBirthTime(-1000.0);
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        // Write one frame at time 0 and one at time 1
+        OutputFileHandler handler("TestQuantisedCellDataReader");
+        QuantisedCellAgesWriter<2,2> writer(100.0);
+        writer.OpenOutputFile(handler);
+        std::vector<std::vector<unsigned> > written_ids(2);
+        std::vector<std::vector<double> > written_ages(2);
+        for (unsigned frame=0; frame<2; frame++)
+        {
+            if (frame > 0)
+            {
+                SimulationTime::Instance()->IncrementTimeOneStep();
+            }
+            writer.WriteTimeStamp();
+            for (AbstractCellPopulation<2>::Iterator cell_iter = cell_population.Begin();
+                 cell_iter != cell_population.End();
+                 ++cell_iter)
+            {
+                writer.VisitCell(*cell_iter, &cell_population);
+                written_ids[frame].push_back(cell_iter->GetCellId());
+                written_ages[frame].push_back(cell_iter->GetAge());
+            }
+            writer.WriteNewline();
+        }
+        writer.CloseFile();
+
+        std::string data_file = handler.GetOutputDirectoryFullPath() + "results.vizcellages.q16";
+        TS_ASSERT(QuantisedCellDataReader::IsQuantisedFile(data_file));
+        QuantisedCellDataReader reader(data_file);
+        TS_ASSERT_DELTA(reader.GetScale(), 100.0, 1e-12);
+        TS_ASSERT_EQUALS(reader.GetNumFrames(), 2u);
+
+        // Each value is within half the resolution of the age written, unless it was saturated
+        double error_bound = 0.5/reader.GetScale();
+        unsigned long num_saturated = 0;
+        for (unsigned frame=0; frame<2; frame++)
+        {
+            TS_ASSERT_DELTA(reader.GetTime(frame), frame, 1e-12);
+            TS_ASSERT_EQUALS(reader.GetNumCells(frame), cells.size());
+
+            std::vector<unsigned> cell_ids;
+            std::vector<double> values;
+            reader.GetFrame(frame, cell_ids, values);
+            TS_ASSERT_EQUALS(cell_ids.size(), written_ids[frame].size());
+            TS_ASSERT_EQUALS(values.size(), written_ages[frame].size());
+            for (unsigned i=0; i<values.size(); i++)
+            {
+                TS_ASSERT_EQUALS(cell_ids[i], written_ids[frame][i]);
+                if (fabs(values[i] - written_ages[frame][i]) > error_bound + 1e-12)
+                {
+                    // A saturated value is clamped to the largest int16
+                    TS_ASSERT_DELTA(values[i], 327.67, 1e-12);
+                    TS_ASSERT_LESS_THAN(327.67, written_ages[frame][i]);
+                    num_saturated++;
+                }
+            }
+        }
+        TS_ASSERT_EQUALS(num_saturated, 2u);
+        TS_ASSERT_EQUALS(writer.GetNumSaturated(), num_saturated);
+        TS_ASSERT_LESS_THAN_EQUALS(writer.GetMaxError(), error_bound + 1e-12);
+
+        // The output index serves the same decoded values
+        std::string index_file = data_file + ".idx";
+        DeltaNotchOutputIndex::Build(data_file, index_file, DeltaNotchOutputIndex::GetDefaultLayout(data_file));
+        DeltaNotchOutputIndex index(data_file, index_file);
+        TS_ASSERT_EQUALS(index.GetNumFrames(), 2u);
+        TS_ASSERT(index.HasCellIds());
+
+        unsigned cell_id = written_ids[1][1];
+        std::vector<double> times;
+        std::vector<double> values;
+        index.GetTrajectory(cell_id, times, values);
+        TS_ASSERT_EQUALS(times.size(), 2u);
+        for (unsigned frame=0; frame<times.size(); frame++)
+        {
+            TS_ASSERT_DELTA(times[frame], frame, 1e-12);
+            TS_ASSERT_DELTA(values[frame], written_ages[frame][1], error_bound + 1e-12);
+        }
+    }
+
+    void TestReaderChecksHeaderAndIgnoresPartialFrame()
+    {
+        OutputFileHandler handler("TestQuantisedCellDataReader", false);
+        std::string path = handler.GetOutputDirectoryFullPath() + "partial.q16";
+
+        // A text file is not a quantised file
+        {
+            std::ofstream file(path.c_str());
+            file << "0\t1 2 3 \n";
+        }
+        TS_ASSERT(!QuantisedCellDataReader::IsQuantisedFile(path));
+        TS_ASSERT_THROWS_CONTAINS(QuantisedCellDataReader reader(path), "is not a quantised cell data file");
+        TS_ASSERT_THROWS_CONTAINS(QuantisedCellDataReader reader(path + ".missing"), "Could not open quantised cell data file");
+
+        // One frame of two cells, then the start of a second frame, as left by a crash
+        {
+            std::ofstream file(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            double scale = 10.0;
+            double time = 0.5;
+            uint32_t num_cells = 2;
+            uint32_t cell_ids[2] = {4, 9};
+            int16_t values[2] = {-15, 32767};
+            file.write("DNQ1", 4);
+            file.write(reinterpret_cast<const char*>(&scale), sizeof(scale));
+            file.write(reinterpret_cast<const char*>(&time), sizeof(time));
+            file.write(reinterpret_cast<const char*>(&num_cells), sizeof(num_cells));
+            file.write(reinterpret_cast<const char*>(cell_ids), sizeof(cell_ids));
+            file.write(reinterpret_cast<const char*>(values), sizeof(values));
+            file.write(reinterpret_cast<const char*>(&time), sizeof(time));
+            file.write(reinterpret_cast<const char*>(&num_cells), sizeof(num_cells));
+            file.write(reinterpret_cast<const char*>(cell_ids), sizeof(uint32_t));
+        }
+
+        QuantisedCellDataReader reader(path);
+        TS_ASSERT_EQUALS(reader.GetNumFrames(), 1u);
+        std::vector<unsigned> cell_ids;
+        std::vector<double> values;
+        reader.GetFrame(0, cell_ids, values);
+        TS_ASSERT_EQUALS(cell_ids.size(), 2u);
+        TS_ASSERT_EQUALS(cell_ids[0], 4u);
+        TS_ASSERT_EQUALS(cell_ids[1], 9u);
+        TS_ASSERT_DELTA(values[0], -1.5, 1e-12);
+        TS_ASSERT_DELTA(values[1], 3276.7, 1e-12);
+    }
+};
+
+#endif /*TESTQUANTISEDCELLDATAREADER_HPP_*/